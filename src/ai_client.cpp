@@ -0,0 +1,995 @@
+#include "ai_client.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "cJSON.h"
+#include "conn_pool.h"
+#include "esp_crt_bundle.h"
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "json_tok.h"
+#include "mbedtls/base64.h"
+#include "model_health.h"
+#include "rto.h"
+#include "trace.h"
+
+static const char *kChatUrl = "https://openrouter.ai/api/v1/chat/completions";
+static const char *kImageMarker = "\x01IMG\x01";  // cannot occur in escaped JSON text
+static const size_t kRawBlock = 768;              // multiple of 3: no padding mid-stream
+static const int kResponseMax = 4096;
+// Token budgets: completion replies and stream chunks carry "choices" before "usage", so a
+// reply that overflows still yields the fields we read.
+static const int kAnswerTokens = 64;
+static const int kChunkTokens = 96;
+static const int kToolArgTokens = 2 * AI_TOOL_PARAMS_MAX + 8;  // room for extra keys
+
+struct ai_image_upload {
+  esp_http_client_handle_t client;
+  char *body_json;       // full request JSON with the marker in place of the image
+  const char *suffix;    // points into body_json, just after the marker
+  uint8_t carry[3];      // bytes not yet encodable as a full base64 quantum
+  size_t carry_len;
+  size_t jpeg_bytes;
+  size_t body_bytes;
+  int http_status;
+  unsigned char b64[kRawBlock / 3 * 4 + 1];
+};
+
+static void set_transport(esp_http_client_config_t *http_cfg, const ai_client_config_t *cfg) {
+  http_cfg->url = cfg->url ? cfg->url : kChatUrl;
+  http_cfg->method = HTTP_METHOD_POST;
+  http_cfg->timeout_ms = cfg->timeout_ms;
+  if (cfg->cert_pem) {
+    http_cfg->cert_pem = cfg->cert_pem;
+  } else {
+    http_cfg->crt_bundle_attach = esp_crt_bundle_attach;
+  }
+}
+
+// Chunked transfer-encoding framing; esp_http_client leaves it to the caller.
+static esp_err_t write_chunk(ai_image_upload_t *up, const char *data, size_t len) {
+  if (len == 0) return ESP_OK;
+  char head[12];
+  int n = snprintf(head, sizeof(head), "%x\r\n", (unsigned)len);
+  if (esp_http_client_write(up->client, head, n) != n) return ESP_FAIL;
+  if (esp_http_client_write(up->client, data, (int)len) != (int)len) return ESP_FAIL;
+  if (esp_http_client_write(up->client, "\r\n", 2) != 2) return ESP_FAIL;
+  up->body_bytes += len;
+  return ESP_OK;
+}
+
+static esp_err_t encode_and_write(ai_image_upload_t *up, const uint8_t *data, size_t len) {
+  size_t olen = 0;
+  if (mbedtls_base64_encode(up->b64, sizeof(up->b64), &olen, data, len) != 0) return ESP_FAIL;
+  return write_chunk(up, (const char *)up->b64, olen);
+}
+
+// Request JSON built with cJSON (so the prompt is escaped properly), then split at the image.
+static char *build_body(const ai_client_config_t *cfg, const char *prompt) {
+  char url[32];
+  snprintf(url, sizeof(url), "data:image/jpeg;base64,%s", kImageMarker);
+
+  cJSON *root = cJSON_CreateObject();
+  cJSON_AddStringToObject(root, "model", cfg->model);
+  cJSON_AddNumberToObject(root, "max_tokens", cfg->max_tokens);
+  cJSON *messages = cJSON_AddArrayToObject(root, "messages");
+  cJSON *msg = cJSON_CreateObject();
+  cJSON_AddItemToArray(messages, msg);
+  cJSON_AddStringToObject(msg, "role", "user");
+  cJSON *content = cJSON_AddArrayToObject(msg, "content");
+  cJSON *text = cJSON_CreateObject();
+  cJSON_AddItemToArray(content, text);
+  cJSON_AddStringToObject(text, "type", "text");
+  cJSON_AddStringToObject(text, "text", prompt);
+  cJSON *image = cJSON_CreateObject();
+  cJSON_AddItemToArray(content, image);
+  cJSON_AddStringToObject(image, "type", "image_url");
+  cJSON *image_url = cJSON_AddObjectToObject(image, "image_url");
+  cJSON_AddStringToObject(image_url, "url", url);
+
+  char *body = cJSON_PrintUnformatted(root);
+  cJSON_Delete(root);
+  return body;
+}
+
+esp_err_t ai_image_upload_begin(const ai_client_config_t *cfg, const char *prompt,
+                                ai_image_upload_t **out) {
+  *out = NULL;
+  ai_image_upload_t *up = (ai_image_upload_t *)calloc(1, sizeof(*up));
+  if (up == NULL) return ESP_ERR_NO_MEM;
+
+  up->body_json = build_body(cfg, prompt ? prompt : "");
+  char *marker = up->body_json ? strstr(up->body_json, kImageMarker) : NULL;
+  if (marker == NULL) {
+    ai_image_upload_free(up);
+    return ESP_ERR_NO_MEM;
+  }
+  *marker = '\0';
+  up->suffix = marker + strlen(kImageMarker);
+
+  esp_http_client_config_t http_cfg = {};
+  set_transport(&http_cfg, cfg);
+  up->client = esp_http_client_init(&http_cfg);
+  if (up->client == NULL) {
+    ai_image_upload_free(up);
+    return ESP_ERR_NO_MEM;
+  }
+
+  char auth[160];
+  snprintf(auth, sizeof(auth), "Bearer %s", cfg->api_key);
+  esp_http_client_set_header(up->client, "Authorization", auth);
+  esp_http_client_set_header(up->client, "Content-Type", "application/json");
+
+  // Length -1: esp_http_client announces Transfer-Encoding: chunked.
+  esp_err_t err = esp_http_client_open(up->client, -1);
+  if (err == ESP_OK) err = write_chunk(up, up->body_json, strlen(up->body_json));
+  if (err != ESP_OK) {
+    ai_image_upload_free(up);
+    return err;
+  }
+  *out = up;
+  return ESP_OK;
+}
+
+esp_err_t ai_image_upload_write(ai_image_upload_t *up, const uint8_t *data, size_t len) {
+  up->jpeg_bytes += len;
+  uint8_t block[kRawBlock];
+  size_t fill = up->carry_len;
+  memcpy(block, up->carry, fill);
+  while (len > 0) {
+    size_t take = kRawBlock - fill;
+    if (take > len) take = len;
+    memcpy(block + fill, data, take);
+    fill += take;
+    data += take;
+    len -= take;
+    size_t whole = fill - fill % 3;
+    if (fill == kRawBlock || (len == 0 && whole > 0)) {
+      esp_err_t err = encode_and_write(up, block, whole);
+      if (err != ESP_OK) return err;
+      memmove(block, block + whole, fill - whole);
+      fill -= whole;
+    }
+  }
+  memcpy(up->carry, block, fill);
+  up->carry_len = fill;
+  return ESP_OK;
+}
+
+static esp_err_t extract_answer(const char *json, char *answer, size_t answer_size) {
+  json_tok_t toks[kAnswerTokens];
+  json_doc_t doc;
+  int n = json_tok_parse(&doc, json, strlen(json), toks, kAnswerTokens);
+  if (n < 0 && n != JSON_TOK_ERR_NOMEM) return ESP_ERR_INVALID_RESPONSE;
+  int first = json_tok_at(&doc, json_tok_get(&doc, 0, "choices"), 0);
+  int content = json_tok_get(&doc, json_tok_get(&doc, first, "message"), "content");
+  return json_tok_str_copy(&doc, content, answer, answer_size) < 0 ? ESP_ERR_INVALID_RESPONSE : ESP_OK;
+}
+
+esp_err_t ai_image_upload_finish(ai_image_upload_t *up, char *answer, size_t answer_size) {
+  answer[0] = '\0';
+  esp_err_t err = ESP_OK;
+  if (up->carry_len > 0) err = encode_and_write(up, up->carry, up->carry_len);  // padded tail
+  up->carry_len = 0;
+  if (err == ESP_OK) err = write_chunk(up, up->suffix, strlen(up->suffix));
+  if (err == ESP_OK && esp_http_client_write(up->client, "0\r\n\r\n", 5) != 5) err = ESP_FAIL;
+  if (err != ESP_OK) return err;
+
+  if (esp_http_client_fetch_headers(up->client) < 0) return ESP_FAIL;
+  up->http_status = esp_http_client_get_status_code(up->client);
+
+  char *resp = (char *)malloc(kResponseMax + 1);
+  if (resp == NULL) return ESP_ERR_NO_MEM;
+  int n = esp_http_client_read_response(up->client, resp, kResponseMax);
+  resp[n > 0 ? n : 0] = '\0';
+  if (up->http_status != 200) {
+    err = ESP_FAIL;
+  } else {
+    err = extract_answer(resp, answer, answer_size);
+  }
+  free(resp);
+  return err;
+}
+
+void ai_image_upload_stats(const ai_image_upload_t *up, ai_image_upload_stats_t *out) {
+  out->jpeg_bytes = up->jpeg_bytes;
+  out->body_bytes = up->body_bytes;
+  out->http_status = up->http_status;
+}
+
+void ai_image_upload_free(ai_image_upload_t *up) {
+  if (up == NULL) return;
+  if (up->client) {
+    esp_http_client_close(up->client);
+    esp_http_client_cleanup(up->client);
+  }
+  cJSON_free(up->body_json);
+  free(up);
+}
+
+// ── Streamed chat with tools ──
+
+#define AI_MAX_TOOL_CALLS 4
+static const size_t kToolIdMax = 48;
+static const size_t kToolNameMax = 32;
+static const size_t kToolArgsMax = 512;
+static const size_t kSseLineMax = 2048;
+static const size_t kRoundNoteMax = 256;
+// Socket timeout while the body streams: how long a cancel can go unnoticed.
+static const int kCancelPollMs = 200;
+
+typedef struct {
+  char id[kToolIdMax];
+  char name[kToolNameMax];
+  char args[kToolArgsMax];
+  size_t args_len;
+} ai_tool_call_t;
+
+typedef struct {
+  const ai_chat_config_t *cfg;
+  char *content;
+  size_t content_size;
+  size_t content_len;
+  ai_tool_call_t calls[AI_MAX_TOOL_CALLS];
+  int call_count;
+  bool done;
+  bool failed;
+  char line[kSseLineMax];
+  size_t line_len;
+} ai_stream_t;
+
+static void emit(const ai_chat_config_t *cfg, ai_chat_event_t event, const char *text, size_t len) {
+  if (cfg->on_event) cfg->on_event(event, text, len, cfg->event_ctx);
+}
+
+static bool cancelled(const ai_chat_config_t *cfg) {
+  return cfg->is_cancelled && cfg->is_cancelled(cfg->event_ctx);
+}
+
+static cJSON *build_tools_json(const ai_chat_config_t *cfg) {
+  cJSON *tools = cJSON_CreateArray();
+  for (size_t i = 0; i < cfg->tool_count; ++i) {
+    const ai_tool_t *t = &cfg->tools[i];
+    cJSON *tool = cJSON_CreateObject();
+    cJSON_AddItemToArray(tools, tool);
+    cJSON_AddStringToObject(tool, "type", "function");
+    cJSON *fn = cJSON_AddObjectToObject(tool, "function");
+    cJSON_AddStringToObject(fn, "name", t->name);
+    cJSON_AddStringToObject(fn, "description", t->description);
+    cJSON *params = cJSON_AddObjectToObject(fn, "parameters");
+    cJSON_AddStringToObject(params, "type", "object");
+    cJSON *props = cJSON_AddObjectToObject(params, "properties");
+    cJSON *required = cJSON_AddArrayToObject(params, "required");
+    for (const ai_tool_param_t *p = t->params; p && p->name; ++p) {
+      cJSON *prop = cJSON_AddObjectToObject(props, p->name);
+      const char *type = p->type == AI_PARAM_INT ? "integer" : p->type == AI_PARAM_BOOL ? "boolean" : "string";
+      cJSON_AddStringToObject(prop, "type", type);
+      cJSON_AddStringToObject(prop, "description", p->description);
+      if (p->type == AI_PARAM_INT) {
+        cJSON_AddNumberToObject(prop, "minimum", p->min);
+        cJSON_AddNumberToObject(prop, "maximum", p->max);
+        if (!p->required) cJSON_AddNumberToObject(prop, "default", p->def);
+      } else if (p->type == AI_PARAM_BOOL && !p->required) {
+        cJSON_AddBoolToObject(prop, "default", p->def != 0);
+      }
+      if (p->enum_values) {
+        cJSON *values = cJSON_AddArrayToObject(prop, "enum");
+        for (const char **v = p->enum_values; *v; ++v) cJSON_AddItemToArray(values, cJSON_CreateString(*v));
+      }
+      if (p->required) cJSON_AddItemToArray(required, cJSON_CreateString(p->name));
+    }
+  }
+  return tools;
+}
+
+static void append_bounded(char *dst, size_t *len, size_t size, const char *src, size_t n) {
+  if (*len + 1 >= size) return;
+  if (n > size - 1 - *len) n = size - 1 - *len;
+  memcpy(dst + *len, src, n);
+  *len += n;
+  dst[*len] = '\0';
+}
+
+// Unescapes string token i in place (the chunk text is ours to modify) and returns it.
+static const char *chunk_str(const json_doc_t *doc, int i, size_t *len) {
+  const char *raw;
+  if (!json_tok_str(doc, i, &raw, len)) return NULL;
+  *len = json_tok_unescape((char *)raw, *len + 1, raw, *len);
+  return raw;
+}
+
+// One SSE "data:" payload: a chat.completion.chunk. Tokenized in place: this runs for
+// every streamed token and must not allocate.
+static void handle_chunk(ai_stream_t *st, char *data) {
+  if (strcmp(data, "[DONE]") == 0) {
+    st->done = true;
+    return;
+  }
+  json_tok_t toks[kChunkTokens];
+  json_doc_t doc;
+  int n = json_tok_parse(&doc, data, strlen(data), toks, kChunkTokens);
+  if (n < 0 && n != JSON_TOK_ERR_NOMEM) return;
+  if (json_tok_get(&doc, 0, "error") >= 0) {
+    st->failed = true;
+    return;
+  }
+  int choice = json_tok_at(&doc, json_tok_get(&doc, 0, "choices"), 0);
+  int delta = json_tok_get(&doc, choice, "delta");
+
+  size_t len = 0;
+  const char *content = chunk_str(&doc, json_tok_get(&doc, delta, "content"), &len);
+  if (content != NULL && len > 0) {
+    append_bounded(st->content, &st->content_len, st->content_size, content, len);
+    emit(st->cfg, AI_CHAT_EVENT_TOKEN, content, len);
+  }
+
+  // Tool calls arrive in pieces keyed by index: id and name once, arguments in fragments.
+  int calls = json_tok_get(&doc, delta, "tool_calls");
+  int call;
+  for (int k = 0; (call = json_tok_at(&doc, calls, k)) >= 0; ++k) {
+    int idx = 0;
+    (void)json_tok_int(&doc, json_tok_get(&doc, call, "index"), &idx);
+    if (idx < 0 || idx >= AI_MAX_TOOL_CALLS) continue;
+    ai_tool_call_t *tc = &st->calls[idx];
+    if (idx >= st->call_count) st->call_count = idx + 1;
+    (void)json_tok_str_copy(&doc, json_tok_get(&doc, call, "id"), tc->id, sizeof(tc->id));
+    int fn = json_tok_get(&doc, call, "function");
+    (void)json_tok_str_copy(&doc, json_tok_get(&doc, fn, "name"), tc->name, sizeof(tc->name));
+    const char *args = chunk_str(&doc, json_tok_get(&doc, fn, "arguments"), &len);
+    if (args != NULL) append_bounded(tc->args, &tc->args_len, sizeof(tc->args), args, len);
+  }
+}
+
+static void feed_sse(ai_stream_t *st, const char *buf, int len) {
+  for (int i = 0; i < len; ++i) {
+    char c = buf[i];
+    if (c == '\r') continue;
+    if (c != '\n') {
+      if (st->line_len < sizeof(st->line) - 1) st->line[st->line_len++] = c;
+      continue;
+    }
+    st->line[st->line_len] = '\0';
+    // Comments (": OPENROUTER PROCESSING") and event/id fields carry nothing we need.
+    if (strncmp(st->line, "data:", 5) == 0) {
+      char *data = st->line + 5;
+      while (*data == ' ') data++;
+      handle_chunk(st, data);
+    }
+    st->line_len = 0;
+  }
+}
+
+// Streams the rest of a response whose first bytes the race already consumed. The body is
+// read in short polls so a cancel is seen without tearing the TLS session down from another
+// task.
+static esp_err_t stream_body(esp_http_client_handle_t client, ai_stream_t *st) {
+  esp_http_client_set_timeout_ms(client, kCancelPollMs);
+  char buf[256];
+  int idle_ms = 0;
+  while (!st->done && !st->failed) {
+    if (cancelled(st->cfg)) return ESP_ERR_NOT_FINISHED;
+    int n = esp_http_client_read(client, buf, sizeof(buf));
+    if (n == -ESP_ERR_HTTP_EAGAIN) {
+      idle_ms += kCancelPollMs;
+      if (idle_ms >= st->cfg->client.timeout_ms) return ESP_ERR_TIMEOUT;
+      continue;
+    }
+    if (n < 0) return ESP_FAIL;
+    if (n == 0) break;
+    idle_ms = 0;
+    feed_sse(st, buf, n);
+  }
+  if (st->failed) return ESP_ERR_INVALID_RESPONSE;
+  int ignored = 0;
+  (void)esp_http_client_flush_response(client, &ignored);  // keep the connection reusable
+  return ESP_OK;
+}
+
+// ── Connection pool ──
+// A single slot (see conn_pool.h); s_pool_open tracks the pooled client's connection.
+
+static std::atomic<bool> s_pool_open{false};
+static std::atomic<uint32_t> s_connects{0};
+static std::atomic<uint32_t> s_reuses{0};
+static std::atomic<uint32_t> s_retries{0};
+static std::atomic<uint32_t> s_prewarms{0};
+static std::atomic<uint32_t> s_idle_drops{0};
+
+// user_data: the std::atomic<bool> tracking whether this client's connection is open.
+static esp_err_t on_pool_event(esp_http_client_event_t *evt) {
+  std::atomic<bool> *open = (std::atomic<bool> *)evt->user_data;
+  if (evt->event_id == HTTP_EVENT_ON_CONNECTED) {
+    s_connects.fetch_add(1, std::memory_order_relaxed);
+    if (open) open->store(true, std::memory_order_relaxed);
+  } else if (evt->event_id == HTTP_EVENT_DISCONNECTED) {
+    if (open) open->store(false, std::memory_order_relaxed);
+  }
+  return ESP_OK;
+}
+
+static esp_http_client_handle_t client_new(const ai_client_config_t *cfg, std::atomic<bool> *open) {
+  esp_http_client_config_t http_cfg = {};
+  set_transport(&http_cfg, cfg);
+  http_cfg.event_handler = on_pool_event;
+  http_cfg.user_data = open;
+  http_cfg.save_client_session = true;  // reconnects resume the TLS session
+  esp_http_client_handle_t client = esp_http_client_init(&http_cfg);
+  if (client == nullptr) return nullptr;
+  open->store(false, std::memory_order_relaxed);
+  // Header waits are polled during a race; each timeout would otherwise log a warning.
+  esp_log_level_set("HTTP_CLIENT", ESP_LOG_ERROR);
+  char auth[160];
+  snprintf(auth, sizeof(auth), "Bearer %s", cfg->api_key);
+  esp_http_client_set_header(client, "Authorization", auth);
+  esp_http_client_set_header(client, "Content-Type", "application/json");
+  return client;
+}
+
+static esp_http_client_handle_t pool_acquire(const ai_client_config_t *cfg) {
+  esp_http_client_handle_t client = (esp_http_client_handle_t)conn_pool_take();
+  return client ? client : client_new(cfg, &s_pool_open);
+}
+
+static void pool_close(esp_http_client_handle_t client) {
+  esp_http_client_close(client);  // frees the TLS context; the handle keeps the session ticket
+  s_pool_open.store(false, std::memory_order_relaxed);
+}
+
+// reusable: the last response was read to the end, so the connection can carry another one.
+static void pool_release(esp_http_client_handle_t client, bool reusable) {
+  if (!reusable) pool_close(client);
+  if (!conn_pool_put(client, esp_timer_get_time())) {
+    esp_http_client_close(client);
+    esp_http_client_cleanup(client);
+  }
+}
+
+esp_err_t ai_client_prewarm(const ai_client_config_t *cfg) {
+  esp_http_client_handle_t client = pool_acquire(cfg);
+  if (client == nullptr) return ESP_ERR_NO_MEM;
+  if (s_pool_open.load(std::memory_order_relaxed)) {
+    pool_release(client, true);
+    return ESP_OK;
+  }
+  // Any status will do: the point is the handshake, and the keep-alive connection it leaves.
+  esp_http_client_set_method(client, HTTP_METHOD_HEAD);
+  esp_http_client_set_timeout_ms(client, cfg->timeout_ms);
+  esp_err_t err = esp_http_client_open(client, 0);
+  if (err == ESP_OK && esp_http_client_fetch_headers(client) < 0) err = ESP_FAIL;
+  if (err == ESP_OK) {
+    int ignored = 0;
+    (void)esp_http_client_flush_response(client, &ignored);
+    s_prewarms.fetch_add(1, std::memory_order_relaxed);
+  }
+  esp_http_client_set_method(client, HTTP_METHOD_POST);
+  pool_release(client, err == ESP_OK);
+  return err;
+}
+
+bool ai_client_drop_idle(uint32_t min_idle_ms) {
+  if (!s_pool_open.load(std::memory_order_relaxed)) return false;
+  int64_t now_us = esp_timer_get_time();
+  esp_http_client_handle_t client =
+      (esp_http_client_handle_t)conn_pool_take_idle(now_us, (int64_t)min_idle_ms * 1000);
+  if (client == nullptr) return false;  // not idle long enough, or a turn holds it
+  pool_close(client);
+  s_idle_drops.fetch_add(1, std::memory_order_relaxed);
+  if (!conn_pool_put(client, now_us)) esp_http_client_cleanup(client);
+  return true;
+}
+
+void ai_client_conn_stats(ai_conn_stats_t *out) {
+  out->connects = s_connects.load(std::memory_order_relaxed);
+  out->reuses = s_reuses.load(std::memory_order_relaxed);
+  out->retries = s_retries.load(std::memory_order_relaxed);
+  out->prewarms = s_prewarms.load(std::memory_order_relaxed);
+  out->idle_drops = s_idle_drops.load(std::memory_order_relaxed);
+  out->open = s_pool_open.load(std::memory_order_relaxed);
+}
+
+// ── Model tiers and hedging ──
+// Each round goes to the first tier whose circuit breaker is closed. If that model has not
+// started streaming by its observed p95 time-to-first-data, the same request also goes to the
+// next healthy tier on a second connection; whichever streams first wins, the other is closed.
+
+static const int kRacePollMs = 100;     // per-connection socket timeout while racing
+static const uint32_t kHedgeMinHeap = 60 * 1024;  // a second TLS session needs ~40 KB
+// Time to first data is given an RTO-style deadline per model (see rto.h): the configured
+// timeout until it has samples, then within these bounds.
+static const uint32_t kFirstDataMinMs = 4000;
+static const uint32_t kFirstDataMaxFactor = 2;  // times the configured timeout
+
+typedef struct {
+  std::atomic<const char *> name;
+  model_health_t health;              // chat worker only; p95 and breaker mirrored below
+  rto_est_t first_data;               // chat worker only
+  std::atomic<uint32_t> first_data_timeout_ms;
+  std::atomic<uint32_t> first_data_srtt_ms;
+  std::atomic<uint32_t> first_data_timeouts;
+  std::atomic<int64_t> open_until_us;  // breaker open until then; half-open afterwards
+  std::atomic<uint32_t> p95_ms;
+  std::atomic<uint32_t> requests;
+  std::atomic<uint32_t> failures;
+  std::atomic<uint32_t> hedges;
+  std::atomic<uint32_t> hedge_wins;
+} ai_model_health_t;
+
+static ai_model_health_t s_models[AI_MODEL_TIERS_MAX];
+
+static ai_model_health_t *model_health(const char *name) {
+  for (int i = 0; i < AI_MODEL_TIERS_MAX; ++i) {
+    const char *n = s_models[i].name.load(std::memory_order_relaxed);
+    if (n == nullptr) {
+      s_models[i].name.store(name, std::memory_order_relaxed);
+      return &s_models[i];
+    }
+    if (strcmp(n, name) == 0) return &s_models[i];
+  }
+  return nullptr;
+}
+
+static int model_tiers(const ai_client_config_t *cfg, ai_model_health_t **tiers) {
+  int count = 0;
+  ai_model_health_t *m = model_health(cfg->model);
+  if (m) tiers[count++] = m;
+  for (const char *const *f = cfg->fallback_models; f && *f && count < AI_MODEL_TIERS_MAX; ++f) {
+    m = model_health(*f);
+    if (m) tiers[count++] = m;
+  }
+  return count;
+}
+
+// Any task: reads the mirrored breaker deadline.
+static bool model_healthy(const ai_model_health_t *m) {
+  return esp_timer_get_time() >= m->open_until_us.load(std::memory_order_relaxed);
+}
+
+static int pick_tier(ai_model_health_t **tiers, int count, int after) {
+  const model_health_t *health[AI_MODEL_TIERS_MAX];
+  for (int i = 0; i < count; ++i) health[i] = &tiers[i]->health;
+  return model_health_pick(health, count, after, esp_timer_get_time());
+}
+
+static uint32_t first_data_timeout_ms(ai_model_health_t *m, const ai_client_config_t *cfg) {
+  if (m->first_data.initial_ms == 0) {
+    uint32_t configured = (uint32_t)cfg->timeout_ms;
+    rto_init(&m->first_data, configured, kFirstDataMinMs, configured * kFirstDataMaxFactor);
+  }
+  uint32_t t = rto_timeout_ms(&m->first_data);
+  m->first_data_timeout_ms.store(t, std::memory_order_relaxed);
+  return t;
+}
+
+static void model_ok(ai_model_health_t *m, uint32_t ttft_ms) {
+  if (m->first_data.initial_ms != 0) {
+    rto_sample(&m->first_data, ttft_ms);
+    m->first_data_srtt_ms.store(m->first_data.srtt_ms, std::memory_order_relaxed);
+    m->first_data_timeout_ms.store(rto_timeout_ms(&m->first_data), std::memory_order_relaxed);
+  }
+  model_health_ok(&m->health, ttft_ms);
+  m->open_until_us.store(m->health.open_until_us, std::memory_order_relaxed);
+  m->p95_ms.store(m->health.p95_ms, std::memory_order_relaxed);
+}
+
+static void model_failed(ai_model_health_t *m) {
+  m->failures.fetch_add(1, std::memory_order_relaxed);
+  model_health_failed(&m->health, esp_timer_get_time());
+  m->open_until_us.store(m->health.open_until_us, std::memory_order_relaxed);
+}
+
+size_t ai_client_model_stats(ai_model_stats_t *out, size_t max) {
+  size_t n = 0;
+  for (int i = 0; i < AI_MODEL_TIERS_MAX && n < max; ++i) {
+    const ai_model_health_t *m = &s_models[i];
+    const char *name = m->name.load(std::memory_order_relaxed);
+    if (name == nullptr) break;
+    ai_model_stats_t *o = &out[n++];
+    o->model = name;
+    o->requests = m->requests.load(std::memory_order_relaxed);
+    o->failures = m->failures.load(std::memory_order_relaxed);
+    o->hedges = m->hedges.load(std::memory_order_relaxed);
+    o->hedge_wins = m->hedge_wins.load(std::memory_order_relaxed);
+    o->p95_ms = m->p95_ms.load(std::memory_order_relaxed);
+    o->srtt_ms = m->first_data_srtt_ms.load(std::memory_order_relaxed);
+    o->timeout_ms = m->first_data_timeout_ms.load(std::memory_order_relaxed);
+    o->timeouts = m->first_data_timeouts.load(std::memory_order_relaxed);
+    o->breaker_open = !model_healthy(m);
+  }
+  return n;
+}
+
+// One request in a race. Bytes read before the race is decided stay in pend: SSE comments
+// are dropped, and the first "data:" line marks the leg ready.
+typedef struct {
+  esp_http_client_handle_t client;
+  std::atomic<bool> open_flag;  // connection state of a hedge client (the pool's has its own)
+  ai_model_health_t *model;
+  int64_t start_us;
+  int64_t timeout_us;  // time to first data
+  bool live;
+  bool headers;
+  bool reused;
+  bool retried;
+  bool ready;
+  size_t data_at;
+  size_t pend_len;
+  char pend[384];
+} ai_leg_t;
+
+static ai_chat_turn_stats_t s_last_turn;  // chatting task only
+
+static esp_err_t leg_send(ai_leg_t *leg, cJSON *root, const ai_chat_config_t *cfg,
+                          std::atomic<bool> *open) {
+  cJSON_ReplaceItemInObject(root, "model", cJSON_CreateString(leg->model->name.load()));
+  char *body = cJSON_PrintUnformatted(root);
+  if (body == NULL) return ESP_ERR_NO_MEM;
+  int body_len = (int)strlen(body);
+  s_last_turn.request_bytes += (uint32_t)body_len;
+  leg->reused = open->load(std::memory_order_relaxed);
+  if (leg->reused) s_reuses.fetch_add(1, std::memory_order_relaxed);
+  leg->start_us = esp_timer_get_time();
+  leg->headers = false;
+  leg->ready = false;
+  leg->pend_len = 0;
+  leg->model->requests.fetch_add(1, std::memory_order_relaxed);
+  leg->timeout_us = (int64_t)first_data_timeout_ms(leg->model, &cfg->client) * 1000;
+  // Connecting and sending get the full timeout; the wait for the answer is polled.
+  esp_http_client_set_timeout_ms(leg->client, cfg->client.timeout_ms);
+  trace_span_t connect = trace_begin(TRACE_CONNECT, leg->model->name.load());
+  esp_err_t err = esp_http_client_open(leg->client, body_len);
+  if (!leg->reused) trace_end(&connect, err);
+  if (err == ESP_OK && esp_http_client_write(leg->client, body, body_len) != body_len) err = ESP_FAIL;
+  cJSON_free(body);
+  esp_http_client_set_timeout_ms(leg->client, kRacePollMs);
+  leg->live = err == ESP_OK;
+  return err;
+}
+
+static esp_err_t leg_poll(ai_leg_t *leg) {
+  if (!leg->headers) {
+    int64_t r = esp_http_client_fetch_headers(leg->client);
+    if (r == -ESP_ERR_HTTP_EAGAIN) return ESP_OK;
+    if (r < 0) return ESP_FAIL;
+    leg->headers = true;
+    if (esp_http_client_get_status_code(leg->client) != 200) return ESP_ERR_INVALID_RESPONSE;
+  }
+  int n = esp_http_client_read(leg->client, leg->pend + leg->pend_len,
+                               (int)(sizeof(leg->pend) - 1 - leg->pend_len));
+  if (n == -ESP_ERR_HTTP_EAGAIN) return ESP_OK;
+  if (n <= 0) return ESP_FAIL;  // ended or broke before any data
+  leg->pend_len += n;
+  leg->pend[leg->pend_len] = '\0';
+  for (size_t i = 0; i + 5 <= leg->pend_len; ++i) {
+    if ((i == 0 || leg->pend[i - 1] == '\n') && strncmp(leg->pend + i, "data:", 5) == 0) {
+      leg->data_at = i;
+      leg->ready = true;
+      return ESP_OK;
+    }
+  }
+  // Only comments and blank lines so far: keep the unfinished last line.
+  char *nl = strrchr(leg->pend, '\n');
+  if (nl != NULL) {
+    size_t keep = leg->pend_len - (size_t)(nl + 1 - leg->pend);
+    memmove(leg->pend, nl + 1, keep);
+    leg->pend_len = keep;
+  } else if (leg->pend_len >= sizeof(leg->pend) - 1) {
+    leg->pend_len = 0;  // an overlong comment line
+  }
+  return ESP_OK;
+}
+
+static void leg_drop(ai_leg_t *leg, bool cleanup) {
+  esp_http_client_close(leg->client);
+  if (cleanup) esp_http_client_cleanup(leg->client);
+  leg->live = false;
+}
+
+// Runs one round; *client is the turn's pooled client on entry and the winning one on return.
+static esp_err_t race_round(const ai_chat_config_t *cfg, esp_http_client_handle_t *client,
+                            cJSON *root, ai_stream_t *st) {
+  ai_model_health_t *tiers[AI_MODEL_TIERS_MAX];
+  int tier_count = model_tiers(&cfg->client, tiers);
+  int primary = pick_tier(tiers, tier_count, -1);
+  if (primary < 0) return ESP_ERR_INVALID_ARG;
+  int hedge_tier = pick_tier(tiers, tier_count, primary);
+
+  // On the heap: two read buffers are more than the chat worker's stack should carry.
+  ai_leg_t *legs = (ai_leg_t *)calloc(2, sizeof(ai_leg_t));
+  if (legs == NULL) return ESP_ERR_NO_MEM;
+  ai_leg_t *main_leg = &legs[0];
+  ai_leg_t *hedge = &legs[1];
+  main_leg->client = *client;
+  main_leg->model = tiers[primary];
+  trace_span_t round_span = trace_begin(TRACE_MODEL_ROUND, main_leg->model->name.load());
+  esp_err_t err = leg_send(main_leg, root, cfg, &s_pool_open);
+  if (err != ESP_OK && main_leg->reused) {
+    s_retries.fetch_add(1, std::memory_order_relaxed);
+    main_leg->retried = true;
+    pool_close(main_leg->client);
+    err = leg_send(main_leg, root, cfg, &s_pool_open);
+  }
+  if (err != ESP_OK) model_failed(main_leg->model);
+  int64_t hedge_at_us = main_leg->start_us + (int64_t)model_health_hedge_delay_ms(&main_leg->model->health) * 1000;
+  bool hedge_tried = false;
+  ai_leg_t *winner = NULL;
+
+  while (winner == NULL) {
+    if (cancelled(cfg)) {
+      err = ESP_ERR_NOT_FINISHED;
+      break;
+    }
+    for (int i = 0; i < 2 && winner == NULL; ++i) {
+      ai_leg_t *leg = &legs[i];
+      if (!leg->live) continue;
+      esp_err_t e = leg_poll(leg);
+      if (e == ESP_OK && !leg->ready && esp_timer_get_time() - leg->start_us >= leg->timeout_us) {
+        e = ESP_ERR_TIMEOUT;
+        rto_timed_out(&leg->model->first_data);
+        leg->model->first_data_timeouts.fetch_add(1, std::memory_order_relaxed);
+      }
+      if (e == ESP_OK) {
+        if (leg->ready) winner = leg;
+        continue;
+      }
+      // A kept-alive connection the server quietly closed only shows as a failure before
+      // any response header: reconnect and send again, once.
+      if (leg == main_leg && leg->reused && !leg->headers && !leg->retried) {
+        s_retries.fetch_add(1, std::memory_order_relaxed);
+        leg->retried = true;
+        pool_close(leg->client);
+        e = leg_send(leg, root, cfg, &s_pool_open);
+        if (e == ESP_OK) continue;
+      }
+      leg->live = false;
+      model_failed(leg->model);
+      err = e;
+    }
+    if (winner != NULL) break;
+
+    // Hedge when the primary is slow or has already failed, if memory allows a second TLS.
+    if (!hedge_tried && hedge_tier >= 0 &&
+        (!main_leg->live || esp_timer_get_time() >= hedge_at_us)) {
+      hedge_tried = true;
+      hedge->model = tiers[hedge_tier];
+      if (esp_get_free_heap_size() >= kHedgeMinHeap) {
+        hedge->client = client_new(&cfg->client, &hedge->open_flag);
+      }
+      if (hedge->client != NULL) {
+        esp_http_client_set_header(hedge->client, "Accept", "text/event-stream");
+        main_leg->model->hedges.fetch_add(1, std::memory_order_relaxed);
+        esp_err_t e = leg_send(hedge, root, cfg, &hedge->open_flag);
+        if (e != ESP_OK) {
+          model_failed(hedge->model);
+          err = e;
+        }
+      }
+    }
+    if (!main_leg->live && !hedge->live && (hedge_tried || hedge_tier < 0)) break;
+  }
+
+  if (winner != NULL) {
+    round_span.name = winner->model->name.load();
+    trace_span_t first = trace_begin_at(TRACE_FIRST_BYTE, round_span.name, winner->start_us);
+    model_ok(winner->model, trace_end(&first, ESP_OK));
+    ai_leg_t *loser = winner == main_leg ? hedge : main_leg;
+    if (winner == hedge) {
+      hedge->model->hedge_wins.fetch_add(1, std::memory_order_relaxed);
+      // The hedge connection carries the rest of the turn and goes back to the pool.
+      esp_http_client_set_user_data(hedge->client, &s_pool_open);
+      *client = hedge->client;
+    }
+    if (loser->client != NULL) leg_drop(loser, true);
+    s_pool_open.store(true, std::memory_order_relaxed);
+    feed_sse(st, winner->pend + winner->data_at, (int)(winner->pend_len - winner->data_at));
+    err = stream_body(*client, st);
+  } else if (hedge->client != NULL) {
+    leg_drop(hedge, true);
+  }
+  free(legs);
+  trace_end(&round_span, err);
+  return err;
+}
+
+void ai_tool_args_decode(const ai_tool_t *tool, const char *arguments, ai_tool_args_t *out) {
+  json_tok_t toks[kToolArgTokens];
+  json_doc_t doc;
+  if (json_tok_parse(&doc, arguments, strlen(arguments), toks, kToolArgTokens) < 0) doc.count = 0;
+  size_t used = 0;
+  int i = 0;
+  for (const ai_tool_param_t *p = tool->params; p && p->name && i < AI_TOOL_PARAMS_MAX; ++p, ++i) {
+    int v = json_tok_get(&doc, 0, p->name);
+    out->num[i] = p->def;
+    out->str[i] = "";
+    if (p->type == AI_PARAM_INT) {
+      out->given[i] = json_tok_int(&doc, v, &out->num[i]);
+      if (out->num[i] < p->min) out->num[i] = p->min;
+      if (out->num[i] > p->max) out->num[i] = p->max;
+      continue;
+    }
+    if (p->type == AI_PARAM_BOOL) {
+      bool b = false;
+      out->given[i] = json_tok_bool(&doc, v, &b);
+      if (out->given[i]) out->num[i] = b ? 1 : 0;
+      continue;
+    }
+    char *dst = out->text + used;
+    int len = json_tok_str_copy(&doc, v, dst, sizeof(out->text) - used);
+    out->given[i] = len > 0;
+    if (out->given[i]) {
+      out->str[i] = dst;
+      used += (size_t)len + 1;
+    }
+    if (p->enum_values == NULL) continue;
+    out->num[i] = 0;
+    bool known = false;
+    for (int k = 0; out->given[i] && p->enum_values[k]; ++k) {
+      if (strcasecmp(dst, p->enum_values[k]) == 0) {
+        out->num[i] = k;
+        known = true;
+        break;
+      }
+    }
+    out->given[i] = known;
+    out->str[i] = p->enum_values[out->num[i]];
+  }
+}
+
+static char *run_tool(const ai_chat_config_t *cfg, const ai_tool_call_t *tc) {
+  for (size_t i = 0; i < cfg->tool_count; ++i) {
+    const ai_tool_t *t = &cfg->tools[i];
+    if (strcmp(t->name, tc->name) == 0) {
+      ai_tool_args_t args;
+      ai_tool_args_decode(t, tc->args_len ? tc->args : "{}", &args);
+      char *result = t->callback(&args, t->user_data);
+      if (result) return result;
+      break;
+    }
+  }
+  return strdup("{\"status\":\"error\",\"error\":\"unknown tool\"}");
+}
+
+// Appends the assistant's tool-call turn and one tool message per call to the history.
+static void run_tools(const ai_chat_config_t *cfg, ai_stream_t *st, cJSON *messages) {
+  cJSON *assistant = cJSON_CreateObject();
+  cJSON_AddItemToArray(messages, assistant);
+  cJSON_AddStringToObject(assistant, "role", "assistant");
+  if (st->content_len > 0) {
+    cJSON_AddStringToObject(assistant, "content", st->content);
+  } else {
+    cJSON_AddNullToObject(assistant, "content");
+  }
+  cJSON *calls = cJSON_AddArrayToObject(assistant, "tool_calls");
+  for (int i = 0; i < st->call_count; ++i) {
+    ai_tool_call_t *tc = &st->calls[i];
+    cJSON *call = cJSON_CreateObject();
+    cJSON_AddItemToArray(calls, call);
+    cJSON_AddStringToObject(call, "id", tc->id);
+    cJSON_AddStringToObject(call, "type", "function");
+    cJSON *fn = cJSON_AddObjectToObject(call, "function");
+    cJSON_AddStringToObject(fn, "name", tc->name);
+    cJSON_AddStringToObject(fn, "arguments", tc->args_len ? tc->args : "{}");
+  }
+
+  cJSON *content = NULL;
+  for (int i = 0; i < st->call_count && !cancelled(cfg); ++i) {
+    ai_tool_call_t *tc = &st->calls[i];
+    emit(cfg, AI_CHAT_EVENT_TOOL_CALL, tc->name, strlen(tc->name));
+    trace_span_t span = trace_begin(TRACE_TOOL, tc->name);
+    char *result = run_tool(cfg, tc);
+    trace_end(&span, ESP_OK);  // failures are reported to the model inside the result
+    cJSON *tool_msg = cJSON_CreateObject();
+    cJSON_AddItemToArray(messages, tool_msg);
+    cJSON_AddStringToObject(tool_msg, "role", "tool");
+    cJSON_AddStringToObject(tool_msg, "tool_call_id", tc->id);
+    content = cJSON_AddStringToObject(tool_msg, "content", result ? result : "");
+    cJSON_free(result);
+    emit(cfg, AI_CHAT_EVENT_TOOL_DONE, tc->name, strlen(tc->name));
+  }
+
+  char note[kRoundNoteMax];
+  if (content == NULL || cfg->round_note == NULL || cfg->round_note(note, sizeof(note), cfg->event_ctx) == 0) {
+    return;
+  }
+  size_t len = strlen(content->valuestring);
+  char *merged = (char *)cJSON_malloc(len + 1 + strlen(note) + 1);
+  if (merged == NULL) return;
+  memcpy(merged, content->valuestring, len);
+  merged[len] = '\n';
+  strcpy(merged + len + 1, note);
+  cJSON_free(content->valuestring);
+  content->valuestring = merged;
+}
+
+void ai_chat_last_turn(ai_chat_turn_stats_t *out) {
+  *out = s_last_turn;
+}
+
+static void add_message(cJSON *messages, const char *role, const char *content) {
+  cJSON *msg = cJSON_CreateObject();
+  cJSON_AddItemToArray(messages, msg);
+  cJSON_AddStringToObject(msg, "role", role);
+  cJSON_AddStringToObject(msg, "content", content);
+}
+
+static const char kSummaryPrefix[] = "Earlier in this conversation: ";
+
+static void add_history(cJSON *messages, const ai_chat_history_t *history) {
+  if (history->summary && history->summary[0]) {
+    size_t len = strlen(history->summary);
+    char *text = (char *)malloc(sizeof(kSummaryPrefix) + len);
+    if (text) {
+      memcpy(text, kSummaryPrefix, sizeof(kSummaryPrefix) - 1);
+      memcpy(text + sizeof(kSummaryPrefix) - 1, history->summary, len + 1);
+      add_message(messages, "system", text);
+      free(text);
+    }
+  }
+  for (size_t i = 0; i < history->exchange_count; ++i) {
+    add_message(messages, "user", history->exchanges[i].user);
+    add_message(messages, "assistant", history->exchanges[i].assistant);
+  }
+}
+
+esp_err_t ai_chat_with_tools(const ai_chat_config_t *cfg, const ai_chat_history_t *history,
+                             const char *prompt, char *response, size_t response_size) {
+  response[0] = '\0';
+  memset(&s_last_turn, 0, sizeof(s_last_turn));
+  ai_stream_t *st = (ai_stream_t *)calloc(1, sizeof(*st));
+  cJSON *root = cJSON_CreateObject();
+  if (st == NULL || root == NULL) {
+    free(st);
+    cJSON_Delete(root);
+    return ESP_ERR_NO_MEM;
+  }
+  st->cfg = cfg;
+  st->content = response;
+  st->content_size = response_size;
+
+  cJSON_AddStringToObject(root, "model", cfg->client.model);
+  cJSON_AddNumberToObject(root, "max_tokens", cfg->client.max_tokens);
+  cJSON_AddBoolToObject(root, "stream", true);
+  if (cfg->tool_count > 0) cJSON_AddItemToObject(root, "tools", build_tools_json(cfg));
+  cJSON *messages = cJSON_AddArrayToObject(root, "messages");
+  if (cfg->system_role) add_message(messages, "system", cfg->system_role);
+  if (history) add_history(messages, history);
+  add_message(messages, "user", prompt);
+
+  esp_http_client_handle_t client = pool_acquire(&cfg->client);
+  esp_err_t err = client ? ESP_OK : ESP_ERR_NO_MEM;
+  if (client) esp_http_client_set_header(client, "Accept", "text/event-stream");
+
+  bool answered = false;
+  for (int round = 0; err == ESP_OK && round < cfg->max_rounds && !answered; ++round) {
+    st->content_len = 0;
+    response[0] = '\0';
+    st->call_count = 0;
+    memset(st->calls, 0, sizeof(st->calls));
+    st->done = false;
+    st->line_len = 0;
+    err = race_round(cfg, &client, root, st);
+    s_last_turn.rounds++;
+    if (err != ESP_OK) break;
+
+    if (st->call_count == 0) {
+      answered = true;
+    } else {
+      s_last_turn.tool_rounds++;
+      s_last_turn.tool_calls += (uint32_t)st->call_count;
+      run_tools(cfg, st, messages);
+      if (cancelled(cfg)) err = ESP_ERR_NOT_FINISHED;
+    }
+  }
+  if (err == ESP_OK && !answered && response[0] == '\0') err = ESP_ERR_INVALID_STATE;  // rounds exhausted
+
+  // Only a fully read response leaves the connection fit for the next request.
+  if (client) pool_release(client, err == ESP_OK || err == ESP_ERR_INVALID_STATE);
+  cJSON_Delete(root);
+  free(st);
+  return err;
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// OpenRouter chat-completions client: the streamed tool-calling chat loop and image
+// questions whose payload must never be held in RAM at once.
+
+#define AI_MODEL_TIERS_MAX 3
+
+typedef struct {
+  const char *api_key;
+  const char *model;
+  // Chat only: NULL-terminated models to hedge to or fall back on, in order; may be NULL.
+  const char *const *fallback_models;
+  int timeout_ms;
+  int max_tokens;
+  const char *url;       // NULL: OpenRouter chat completions (set for a local stand-in server)
+  const char *cert_pem;  // NULL: verify against the built-in CA bundle
+} ai_client_config_t;
+
+typedef struct {
+  size_t jpeg_bytes;  // raw image bytes streamed
+  size_t body_bytes;  // request body bytes (JSON + base64)
+  int http_status;
+} ai_image_upload_stats_t;
+
+typedef struct ai_image_upload ai_image_upload_t;
+
+// Image question as a streamed upload: begin() connects and sends everything before the
+// image, write() base64-encodes JPEG bytes straight into the chunked request body, finish()
+// closes the body and reads the answer. Neither the JPEG nor its base64 form is ever held
+// whole; RAM use is a few small buffers plus the TLS session.
+esp_err_t ai_image_upload_begin(const ai_client_config_t *cfg, const char *prompt,
+                                ai_image_upload_t **out);
+esp_err_t ai_image_upload_write(ai_image_upload_t *up, const uint8_t *data, size_t len);
+// Copies choices[0].message.content into answer (truncated to answer_size).
+esp_err_t ai_image_upload_finish(ai_image_upload_t *up, char *answer, size_t answer_size);
+void ai_image_upload_stats(const ai_image_upload_t *up, ai_image_upload_stats_t *out);
+// Closes the connection and frees the session; safe at any point after begin().
+void ai_image_upload_free(ai_image_upload_t *up);
+
+// ── Connection reuse ──
+// Chat turns share one keep-alive client: rounds and consecutive turns reuse the open TLS
+// connection, and a reconnect resumes the saved session ticket instead of a full handshake.
+// The pool follows the first config it was created with.
+
+typedef struct {
+  uint32_t connects;     // TCP/TLS connections opened (full or resumed handshakes)
+  uint32_t reuses;       // requests sent on an already open connection
+  uint32_t retries;      // requests resent after a reused connection turned out stale
+  uint32_t prewarms;     // connections opened ahead of a turn
+  uint32_t idle_drops;   // idle connections closed by ai_client_drop_idle()
+  bool open;             // a pooled connection is open right now
+} ai_conn_stats_t;
+
+// Opens the pooled connection ahead of the first request (a HEAD round trip) unless it is
+// already open. Blocks for the handshake; call it from the task that chats.
+esp_err_t ai_client_prewarm(const ai_client_config_t *cfg);
+// Closes the pooled connection if it has been idle for at least min_idle_ms; the saved TLS
+// session survives, so the next turn resumes it. Safe from any task; true if closed.
+bool ai_client_drop_idle(uint32_t min_idle_ms);
+void ai_client_conn_stats(ai_conn_stats_t *out);
+
+// ── Model tiers ──
+// A chat round goes to the first model (model, then fallback_models) whose circuit breaker
+// is closed: three failures in a row open it for 30 s. If the model has not started
+// streaming by its p95 time-to-first-data (6 s until it has 5 samples), the round is sent
+// to the next healthy tier as well and the first one to stream wins. A model that sends
+// nothing within its adaptive deadline (timeout_ms until it has answered, then smoothed time
+// to first data plus four deviations, up to twice timeout_ms) counts as failed.
+
+typedef struct {
+  const char *model;
+  uint32_t requests;
+  uint32_t failures;
+  uint32_t hedges;      // rounds where this model was slow enough to trigger a hedge
+  uint32_t hedge_wins;  // hedged rounds this model won as the fallback
+  uint32_t p95_ms;      // time to first streamed data over the last 32 answers
+  uint32_t srtt_ms;     // smoothed time to first data
+  uint32_t timeout_ms;  // current deadline for first data, derived from it (see rto.h)
+  uint32_t timeouts;    // requests that ran into it
+  bool breaker_open;
+} ai_model_stats_t;
+
+// Fills up to max entries, in the order the models were first used; returns the count.
+size_t ai_client_model_stats(ai_model_stats_t *out, size_t max);
+
+// ── Streamed chat with tools ──
+
+// A tool is declared once as data: the request schema, argument decoding and range
+// clamping all come from its parameter table, and the callback gets typed values.
+
+#define AI_TOOL_PARAMS_MAX 5
+#define AI_TOOL_TEXT_MAX 320
+
+typedef enum {
+  AI_PARAM_INT = 0,  // JSON integer, clamped to [min, max]; def when missing
+  AI_PARAM_STRING,   // with enum_values, matched case-insensitively; else the first value
+  AI_PARAM_BOOL,     // JSON boolean as 0/1 in num; def when missing
+} ai_param_type_t;
+
+typedef struct {
+  const char *name;
+  ai_param_type_t type;
+  const char *description;
+  bool required;
+  const char **enum_values;  // NULL-terminated, optional
+  int min;
+  int max;
+  int def;
+} ai_tool_param_t;
+
+// Arguments decoded against a tool's parameters, by declaration index. Integers are always
+// valid; strings point into text ("" when missing) and num holds their enum index.
+typedef struct {
+  int num[AI_TOOL_PARAMS_MAX];
+  const char *str[AI_TOOL_PARAMS_MAX];
+  bool given[AI_TOOL_PARAMS_MAX];
+  char text[AI_TOOL_TEXT_MAX];
+} ai_tool_args_t;
+
+// Returns a result string from cJSON_malloc (or plain malloc); the chat loop releases it
+// with cJSON_free.
+typedef char *(*ai_tool_cb_t)(const ai_tool_args_t *args, void *user_data);
+
+typedef struct {
+  const char *name;
+  const char *description;
+  const ai_tool_param_t *params;  // terminated by an entry with name == NULL; may be NULL
+  ai_tool_cb_t callback;
+  void *user_data;
+} ai_tool_t;
+
+// Decodes a tool call's JSON arguments; malformed or missing values take their defaults.
+void ai_tool_args_decode(const ai_tool_t *tool, const char *arguments, ai_tool_args_t *out);
+
+typedef enum {
+  AI_CHAT_EVENT_TOKEN = 0,      // text: content delta as it arrives
+  AI_CHAT_EVENT_TOOL_CALL = 1,  // text: tool name, before the callback runs
+  AI_CHAT_EVENT_TOOL_DONE = 2,  // text: tool name, after the callback returned
+} ai_chat_event_t;
+
+// Called from the chatting task; must not block for long (it stalls the stream).
+typedef void (*ai_chat_event_cb_t)(ai_chat_event_t event, const char *text, size_t len, void *ctx);
+
+typedef struct {
+  ai_client_config_t client;
+  const char *system_role;
+  const ai_tool_t *tools;
+  size_t tool_count;
+  int max_rounds;  // model turns, including the ones that only call tools
+  ai_chat_event_cb_t on_event;
+  // Polled (with event_ctx) while the response streams and between tool calls; may be NULL.
+  bool (*is_cancelled)(void *ctx);
+  // Called (with event_ctx) after each round's tool calls; text it writes to out is appended
+  // to the round's last tool result, so the model sees it in the next round. May be NULL.
+  size_t (*round_note)(char *out, size_t size, void *ctx);
+  void *event_ctx;
+} ai_chat_config_t;
+
+// Earlier conversation to send ahead of the prompt: a summary of older turns (a second
+// system message) and recent exchanges verbatim, oldest first. Strings are only read during
+// the call.
+typedef struct {
+  const char *user;
+  const char *assistant;
+} ai_chat_exchange_t;
+
+typedef struct {
+  const char *summary;  // NULL or "": none
+  const ai_chat_exchange_t *exchanges;
+  size_t exchange_count;
+} ai_chat_history_t;
+
+// Runs the tool-calling conversation with stream:true: tokens and tool progress are reported
+// through on_event while the final assistant text is collected into response. history may be
+// NULL. Returns ESP_ERR_NOT_FINISHED within ~200 ms of is_cancelled turning true (tool calls
+// excepted).
+esp_err_t ai_chat_with_tools(const ai_chat_config_t *cfg, const ai_chat_history_t *history,
+                             const char *prompt, char *response, size_t response_size);
+
+typedef struct {
+  uint32_t rounds;       // model requests answered (or failed), tool-only rounds included
+  uint32_t tool_rounds;  // rounds that ended in tool calls
+  uint32_t tool_calls;
+  uint32_t request_bytes;  // request bodies sent, hedged copies included
+} ai_chat_turn_stats_t;
+
+// Figures of the last ai_chat_with_tools call; read them from the task that chats.
+void ai_chat_last_turn(ai_chat_turn_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
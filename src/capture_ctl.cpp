@@ -0,0 +1,130 @@
+#include "capture_ctl.h"
+
+typedef struct {
+  uint32_t latency_ms;
+  uint32_t max_bytes;
+  int q_min;
+  int q_max;
+  bool allow_lowres;
+} capture_budget_t;
+
+static const capture_budget_t kBudgets[CAPTURE_CONSUMER_COUNT] = {
+  {1200, 16384, 30, 80, true},   // preview
+  {4000, 30720, 50, 90, false},  // llm
+};
+
+static const int kQualitySteps[] = {30, 40, 50, 60, 70, 80, 90};
+static const int kStepCount = (int)(sizeof(kQualitySteps) / sizeof(kQualitySteps[0]));
+
+// Typical K210 JPEG sizes for an average indoor scene; the learned scene factor scales them.
+static const uint32_t kPriorBytes[CAPTURE_RES_COUNT][kStepCount] = {
+  {6000, 7500, 9000, 10500, 12500, 16000, 24000},  // QVGA
+  {1800, 2200, 2600, 3000, 3600, 4600, 6800},      // QQVGA
+};
+
+static const float kEwmaAlpha = 0.25f;
+static const float kLinkEfficiency = 0.9f;  // 8N1 plus inter-frame gaps
+static const float kFailureSizeScale = 1.25f;
+static const float kFailureRateScale = 0.75f;
+static const float kSceneFactorMin = 0.25f;
+static const float kSceneFactorMax = 4.0f;
+static const int kFloorBaud = 115200;  // the rate every link falls back to
+
+static float s_scene_factor[CAPTURE_RES_COUNT] = {1.0f, 1.0f};
+static float s_overhead_ms = 150.0f;  // capture + encode + header before the first byte
+static float s_bps = 0.0f;
+static int s_bps_baud = 0;
+
+const char *capture_res_name(capture_res_t res) {
+  return res == CAPTURE_RES_QQVGA ? "QQVGA" : "QVGA";
+}
+
+const char *capture_consumer_name(capture_consumer_t consumer) {
+  return consumer == CAPTURE_CONSUMER_LLM ? "llm" : "preview";
+}
+
+static float clamp_factor(float f) {
+  return f < kSceneFactorMin ? kSceneFactorMin : (f > kSceneFactorMax ? kSceneFactorMax : f);
+}
+
+static int step_index(int quality) {
+  int best = 0;
+  for (int i = 1; i < kStepCount; ++i) {
+    int d_best = quality - kQualitySteps[best];
+    int d_i = quality - kQualitySteps[i];
+    if ((d_i < 0 ? -d_i : d_i) < (d_best < 0 ? -d_best : d_best)) best = i;
+  }
+  return best;
+}
+
+static float nominal_bps(int baud) {
+  return (float)baud / 10.0f * kLinkEfficiency;
+}
+
+static float link_bps(int link_baud) {
+  if (s_bps_baud != link_baud || s_bps <= 0.0f) {
+    s_bps_baud = link_baud;
+    s_bps = nominal_bps(link_baud);
+  }
+  return s_bps;
+}
+
+// Failures and stalls must not talk the estimate down to nothing, or every plan would pick
+// the smallest frame for good: never below what the fallback rate carries.
+static float bps_floor(int link_baud) {
+  float floor = nominal_bps(kFloorBaud);
+  float nominal = nominal_bps(link_baud);
+  return nominal < floor ? nominal : floor;
+}
+
+static void predict(capture_res_t res, int step, int link_baud, capture_plan_t *out) {
+  float bytes = (float)kPriorBytes[res][step] * s_scene_factor[res];
+  out->quality = kQualitySteps[step];
+  out->res = res;
+  out->predicted_bytes = (uint32_t)bytes;
+  out->predicted_ms = (uint32_t)(s_overhead_ms + bytes * 1000.0f / link_bps(link_baud));
+}
+
+capture_plan_t capture_ctl_plan(capture_consumer_t consumer, int link_baud) {
+  const capture_budget_t *b = &kBudgets[consumer < CAPTURE_CONSUMER_COUNT ? consumer : 0];
+  capture_plan_t plan = {};
+  int res_count = b->allow_lowres ? CAPTURE_RES_COUNT : 1;
+  for (int r = 0; r < res_count; ++r) {
+    for (int i = kStepCount - 1; i >= 0; --i) {
+      if (kQualitySteps[i] > b->q_max || kQualitySteps[i] < b->q_min) continue;
+      predict((capture_res_t)r, i, link_baud, &plan);
+      if (plan.predicted_ms <= b->latency_ms && plan.predicted_bytes <= b->max_bytes) {
+        plan.within_budget = true;
+        return plan;
+      }
+    }
+  }
+  // Nothing fits: cheapest allowed setting, best effort.
+  predict((capture_res_t)(res_count - 1), step_index(b->q_min), link_baud, &plan);
+  plan.within_budget = false;
+  return plan;
+}
+
+void capture_ctl_observe(capture_res_t res, int quality, int link_baud, uint32_t bytes,
+                         uint32_t total_ms, uint32_t xfer_ms) {
+  if (res >= CAPTURE_RES_COUNT || bytes == 0) return;
+  float ratio = (float)bytes / (float)kPriorBytes[res][step_index(quality)];
+  s_scene_factor[res] = clamp_factor(s_scene_factor[res] + kEwmaAlpha * (ratio - s_scene_factor[res]));
+
+  float bps = link_bps(link_baud);
+  if (xfer_ms > 0) {
+    s_bps = bps + kEwmaAlpha * ((float)bytes * 1000.0f / (float)xfer_ms - bps);
+    if (s_bps < bps_floor(link_baud)) s_bps = bps_floor(link_baud);
+  }
+  if (total_ms >= xfer_ms) {
+    s_overhead_ms += kEwmaAlpha * ((float)(total_ms - xfer_ms) - s_overhead_ms);
+  }
+}
+
+void capture_ctl_observe_failure(capture_res_t res, int quality, int link_baud) {
+  (void)quality;
+  if (res >= CAPTURE_RES_COUNT) return;
+  s_scene_factor[res] = clamp_factor(s_scene_factor[res] * kFailureSizeScale);
+  s_bps = link_bps(link_baud) * kFailureRateScale;
+  if (s_bps < bps_floor(link_baud)) s_bps = bps_floor(link_baud);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Picks CAPTURE quality/resolution so a frame meets its consumer's latency and byte budget,
+// learning scene complexity, camera overhead and link throughput from completed captures.
+// Not thread-safe: callers serialise (main holds s_vision_mutex around plan/capture/observe).
+
+typedef enum {
+  CAPTURE_CONSUMER_PREVIEW = 0,  // web UI preview: fast, small
+  CAPTURE_CONSUMER_LLM = 1,      // image analysis: detail matters more than latency
+  CAPTURE_CONSUMER_COUNT,
+} capture_consumer_t;
+
+typedef enum {
+  CAPTURE_RES_QVGA = 0,   // 320x240, camera default
+  CAPTURE_RES_QQVGA = 1,  // 160x120
+  CAPTURE_RES_COUNT,
+} capture_res_t;
+
+typedef struct {
+  int quality;
+  capture_res_t res;
+  uint32_t predicted_bytes;
+  uint32_t predicted_ms;
+  bool within_budget;  // false: nothing fit, this is the cheapest allowed setting
+} capture_plan_t;
+
+const char *capture_res_name(capture_res_t res);
+const char *capture_consumer_name(capture_consumer_t consumer);
+
+// link_baud is the current UART rate; throughput learned at another rate is discarded.
+capture_plan_t capture_ctl_plan(capture_consumer_t consumer, int link_baud);
+void capture_ctl_observe(capture_res_t res, int quality, int link_baud, uint32_t bytes,
+                         uint32_t total_ms, uint32_t xfer_ms);
+// Timeout or transfer failure: assume frames are larger and the link slower than estimated,
+// but never slower than the 115200 fallback rate (successes pull the estimate back up).
+void capture_ctl_observe_failure(capture_res_t res, int quality, int link_baud);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,92 @@
+#include "chat_memory.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Length of s cut to at most max bytes without splitting a UTF-8 sequence.
+static size_t utf8_cut(const char *s, size_t max) {
+  size_t len = strnlen(s, max + 1);
+  if (len <= max) return len;
+  len = max;
+  while (len > 0 && ((unsigned char)s[len] & 0xC0) == 0x80) len--;
+  return len;
+}
+
+// Bytes of the exchange starting at off.
+static size_t turn_size(const chat_memory_t *m, size_t off) {
+  size_t user = strlen(m->buf + off) + 1;
+  return user + strlen(m->buf + off + user) + 1;
+}
+
+static void drop_oldest(chat_memory_t *m, size_t n) {
+  size_t off = 0;
+  for (size_t i = 0; i < n && i < m->count; ++i) off += turn_size(m, off);
+  memmove(m->buf, m->buf + off, m->used - off);
+  m->used = (uint16_t)(m->used - off);
+  m->count = (uint8_t)(m->count - (n < m->count ? n : m->count));
+}
+
+void chat_memory_clear(chat_memory_t *m) {
+  memset(m, 0, sizeof(*m));
+}
+
+bool chat_memory_empty(const chat_memory_t *m) {
+  return m->count == 0 && m->summary[0] == '\0';
+}
+
+void chat_memory_add(chat_memory_t *m, const char *user, const char *reply, uint32_t now_ms) {
+  size_t user_len = utf8_cut(user, CHAT_MEMORY_USER_MAX);
+  size_t reply_len = utf8_cut(reply, CHAT_MEMORY_REPLY_MAX);
+  size_t need = user_len + 1 + reply_len + 1;
+  while (m->count > 0 && (m->used + need > sizeof(m->buf) || m->count >= CHAT_MEMORY_TURNS_MAX)) {
+    drop_oldest(m, 1);
+    m->dropped++;
+  }
+  char *dst = m->buf + m->used;
+  memcpy(dst, user, user_len);
+  dst[user_len] = '\0';
+  memcpy(dst + user_len + 1, reply, reply_len);
+  dst[user_len + 1 + reply_len] = '\0';
+  m->used = (uint16_t)(m->used + need);
+  m->count++;
+  m->last_ms = now_ms;
+}
+
+size_t chat_memory_turns(const chat_memory_t *m, chat_memory_turn_t *out, size_t max) {
+  size_t off = 0;
+  size_t n = 0;
+  for (; n < m->count && n < max; ++n) {
+    out[n].user = m->buf + off;
+    out[n].reply = m->buf + off + strlen(m->buf + off) + 1;
+    off += turn_size(m, off);
+  }
+  return n;
+}
+
+uint32_t chat_memory_tokens(const chat_memory_t *m) {
+  return (uint32_t)((strlen(m->summary) + m->used + 3) / 4);
+}
+
+size_t chat_memory_compaction_input(const chat_memory_t *m, char *out, size_t size) {
+  if (m->count < 2 || m->used < CHAT_MEMORY_COMPACT_AT || size == 0) return 0;
+  int n = snprintf(out, size, "Summary so far: %s\n", m->summary[0] ? m->summary : "(none)");
+  if (n < 0 || (size_t)n >= size) return 0;
+  size_t len = (size_t)n;
+  chat_memory_turn_t turns[CHAT_MEMORY_TURNS_MAX];
+  size_t count = chat_memory_turns(m, turns, CHAT_MEMORY_TURNS_MAX);
+  size_t folded = 0;
+  for (; folded + 1 < count; ++folded) {
+    n = snprintf(out + len, size - len, "User: %s\nRover: %s\n", turns[folded].user, turns[folded].reply);
+    if (n < 0 || (size_t)n >= size - len) break;  // the rest waits for the next compaction
+    len += (size_t)n;
+  }
+  out[len] = '\0';
+  return folded;
+}
+
+void chat_memory_compact(chat_memory_t *m, const char *summary, size_t folded) {
+  size_t len = utf8_cut(summary, sizeof(m->summary) - 1);
+  memcpy(m->summary, summary, len);
+  m->summary[len] = '\0';
+  drop_oldest(m, folded);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Conversation memory for follow-ups ("again, but further"): the latest exchanges verbatim
+// plus a model-written summary of older ones, all in one fixed struct. Exchanges are packed
+// "user\0reply\0" pairs, oldest first; when a new one does not fit, the oldest are dropped
+// unsummarised. Not thread-safe: main keeps it on the chat worker.
+
+#define CHAT_MEMORY_SUMMARY_MAX 320
+#define CHAT_MEMORY_BYTES 1024        // packed exchanges
+#define CHAT_MEMORY_COMPACT_AT 512    // exchange bytes that make compaction worthwhile
+#define CHAT_MEMORY_USER_MAX 192      // longer prompts and replies are cut to these
+#define CHAT_MEMORY_REPLY_MAX 256
+#define CHAT_MEMORY_TURNS_MAX 8
+
+typedef struct {
+  char summary[CHAT_MEMORY_SUMMARY_MAX];
+  char buf[CHAT_MEMORY_BYTES];
+  uint16_t used;
+  uint8_t count;
+  uint32_t last_ms;  // when the last exchange was added
+  uint32_t dropped;  // exchanges evicted without being summarised
+} chat_memory_t;
+
+typedef struct {
+  const char *user;
+  const char *reply;
+} chat_memory_turn_t;
+
+void chat_memory_clear(chat_memory_t *m);
+bool chat_memory_empty(const chat_memory_t *m);
+void chat_memory_add(chat_memory_t *m, const char *user, const char *reply, uint32_t now_ms);
+
+// Exchanges oldest first, pointing into m (valid until the next change); returns the count.
+size_t chat_memory_turns(const chat_memory_t *m, chat_memory_turn_t *out, size_t max);
+
+// Rough prompt cost of the memory (about 4 bytes per token).
+uint32_t chat_memory_tokens(const chat_memory_t *m);
+
+// Writes the summarisation input (old summary, then every exchange but the newest) to out
+// and returns how many exchanges it covers; 0 while compaction is not worth a model call.
+size_t chat_memory_compaction_input(const chat_memory_t *m, char *out, size_t size);
+// Replaces the summary and drops the `folded` oldest exchanges it now covers.
+void chat_memory_compact(chat_memory_t *m, const char *summary, size_t folded);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,24 @@
+#include "conn_pool.h"
+
+#include <atomic>
+
+static std::atomic<void *> s_slot{nullptr};
+static std::atomic<int64_t> s_idle_since_us{0};
+
+void *conn_pool_take(void) {
+  return s_slot.exchange(nullptr);
+}
+
+bool conn_pool_put(void *handle, int64_t now_us) {
+  if (handle == nullptr) return false;
+  s_idle_since_us.store(now_us, std::memory_order_relaxed);
+  void *expected = nullptr;
+  return s_slot.compare_exchange_strong(expected, handle);
+}
+
+void *conn_pool_take_idle(int64_t now_us, int64_t min_idle_us) {
+  // A turn that puts the handle back between these two steps leaves a fresh stamp behind but
+  // may still lose its connection here; it reconnects, resuming the TLS session.
+  if (now_us - s_idle_since_us.load(std::memory_order_relaxed) < min_idle_us) return nullptr;
+  return s_slot.exchange(nullptr);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// One idle keep-alive connection kept between chat turns. The chat worker takes the handle
+// out while a turn runs and puts it back afterwards, so a task that takes it to close an idle
+// connection only ever gets an idle one. Handles are opaque: the caller creates, closes and
+// frees them. Thread-safe.
+
+// The pooled handle, or NULL if there is none or a turn holds it.
+void *conn_pool_take(void);
+
+// Returns a handle to the slot, idle from now_us. false if the slot is already occupied: the
+// handle was not pooled and the caller frees it.
+bool conn_pool_put(void *handle, int64_t now_us);
+
+// The pooled handle if it has been idle for at least min_idle_us, else NULL. The caller closes
+// its connection and puts it back.
+void *conn_pool_take_idle(int64_t now_us, int64_t min_idle_us);
+
+#ifdef __cplusplus
+}
+#endif
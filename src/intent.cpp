@@ -0,0 +1,492 @@
+#include "intent.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int kMaxTokens = 48;
+static const int kDefaultSpeed = 60;
+static const int kSlowSpeed = 35;
+static const int kFastSpeed = 90;
+static const int kDefaultMoveMs = 1000;
+static const int kDefaultTurnDeg = 90;
+static const int kChatTopicMaxWords = 6;
+
+typedef enum {
+  W_FILLER = 0,
+  W_SEP,       // step separator: then, and, потом, ","
+  W_MOVE,      // go, drive, едь: allowed, carries no direction
+  W_FORWARD,
+  W_BACK,
+  W_LEFT,
+  W_RIGHT,
+  W_TURN,
+  W_AROUND,
+  W_STOP,
+  W_OPEN,
+  W_CLOSE,
+  W_GRIPPER,
+  W_SECONDS,
+  W_MILLIS,
+  W_DEGREES,
+  W_SPEED,     // value: speed percent
+  W_NUMBER,    // value: number word
+} word_class_t;
+
+typedef struct {
+  const char *word;
+  word_class_t cls;
+  int value;
+} word_t;
+
+// Normalised forms: lower case, "ё" folded to "е".
+static const word_t kWords[] = {
+  {"please", W_FILLER, 0}, {"the", W_FILLER, 0}, {"a", W_FILLER, 0}, {"an", W_FILLER, 0},
+  {"for", W_FILLER, 0}, {"by", W_FILLER, 0}, {"now", W_FILLER, 0}, {"robot", W_FILLER, 0},
+  {"rover", W_FILLER, 0}, {"your", W_FILLER, 0}, {"пожалуйста", W_FILLER, 0},
+  {"робот", W_FILLER, 0}, {"ровер", W_FILLER, 0}, {"на", W_FILLER, 0}, {"в", W_FILLER, 0},
+  {"сейчас", W_FILLER, 0},
+
+  {"then", W_SEP, 0}, {"and", W_SEP, 0}, {"after", W_SEP, 0}, {"потом", W_SEP, 0},
+  {"затем", W_SEP, 0}, {"и", W_SEP, 0}, {"после", W_SEP, 0}, {"этого", W_FILLER, 0},
+  {"that", W_FILLER, 0},
+
+  {"go", W_MOVE, 0}, {"move", W_MOVE, 0}, {"drive", W_MOVE, 0}, {"roll", W_MOVE, 0},
+  {"едь", W_MOVE, 0}, {"езжай", W_MOVE, 0}, {"поезжай", W_MOVE, 0}, {"двигайся", W_MOVE, 0},
+  {"иди", W_MOVE, 0}, {"проедь", W_MOVE, 0}, {"катись", W_MOVE, 0}, {"вперед", W_FORWARD, 0},
+  {"forward", W_FORWARD, 0}, {"forwards", W_FORWARD, 0}, {"ahead", W_FORWARD, 0},
+  {"straight", W_FORWARD, 0}, {"прямо", W_FORWARD, 0},
+  {"back", W_BACK, 0}, {"backward", W_BACK, 0}, {"backwards", W_BACK, 0},
+  {"reverse", W_BACK, 0}, {"назад", W_BACK, 0},
+  {"left", W_LEFT, 0}, {"влево", W_LEFT, 0}, {"налево", W_LEFT, 0},
+  {"right", W_RIGHT, 0}, {"вправо", W_RIGHT, 0}, {"направо", W_RIGHT, 0},
+
+  {"turn", W_TURN, 0}, {"rotate", W_TURN, 0}, {"spin", W_TURN, 0}, {"поверни", W_TURN, 0},
+  {"повернись", W_TURN, 0}, {"поворот", W_TURN, 0}, {"развернись", W_AROUND, 0},
+  {"разворот", W_AROUND, 0}, {"around", W_AROUND, 0}, {"кругом", W_AROUND, 0},
+
+  {"stop", W_STOP, 0}, {"halt", W_STOP, 0}, {"freeze", W_STOP, 0}, {"стоп", W_STOP, 0},
+  {"стой", W_STOP, 0}, {"остановись", W_STOP, 0}, {"остановка", W_STOP, 0},
+  {"хватит", W_STOP, 0}, {"замри", W_STOP, 0},
+
+  {"open", W_OPEN, 0}, {"release", W_OPEN, 0}, {"открой", W_OPEN, 0},
+  {"открыть", W_OPEN, 0}, {"разожми", W_OPEN, 0}, {"отпусти", W_OPEN, 0},
+  {"close", W_CLOSE, 0}, {"grab", W_CLOSE, 0}, {"закрой", W_CLOSE, 0},
+  {"закрыть", W_CLOSE, 0}, {"сожми", W_CLOSE, 0}, {"схвати", W_CLOSE, 0},
+  {"gripper", W_GRIPPER, 0}, {"claw", W_GRIPPER, 0}, {"grip", W_GRIPPER, 0},
+  {"захват", W_GRIPPER, 0}, {"клешню", W_GRIPPER, 0}, {"клешня", W_GRIPPER, 0},
+  {"схват", W_GRIPPER, 0},
+
+  {"s", W_SECONDS, 0}, {"sec", W_SECONDS, 0}, {"secs", W_SECONDS, 0},
+  {"second", W_SECONDS, 0}, {"seconds", W_SECONDS, 0}, {"с", W_SECONDS, 0},
+  {"сек", W_SECONDS, 0}, {"секунд", W_SECONDS, 0}, {"секунду", W_SECONDS, 0},
+  {"секунды", W_SECONDS, 0}, {"секунда", W_SECONDS, 0},
+  {"ms", W_MILLIS, 0}, {"millisecond", W_MILLIS, 0}, {"milliseconds", W_MILLIS, 0},
+  {"мс", W_MILLIS, 0}, {"миллисекунд", W_MILLIS, 0},
+  {"deg", W_DEGREES, 0}, {"degree", W_DEGREES, 0}, {"degrees", W_DEGREES, 0},
+  {"\xc2\xb0", W_DEGREES, 0}, {"градус", W_DEGREES, 0}, {"градуса", W_DEGREES, 0},
+  {"градусов", W_DEGREES, 0},
+
+  {"slowly", W_SPEED, kSlowSpeed}, {"slow", W_SPEED, kSlowSpeed},
+  {"медленно", W_SPEED, kSlowSpeed}, {"тихо", W_SPEED, kSlowSpeed},
+  {"fast", W_SPEED, kFastSpeed}, {"quickly", W_SPEED, kFastSpeed},
+  {"быстро", W_SPEED, kFastSpeed},
+
+  {"one", W_NUMBER, 1}, {"two", W_NUMBER, 2}, {"three", W_NUMBER, 3},
+  {"four", W_NUMBER, 4}, {"five", W_NUMBER, 5}, {"один", W_NUMBER, 1},
+  {"одну", W_NUMBER, 1}, {"одна", W_NUMBER, 1}, {"два", W_NUMBER, 2}, {"две", W_NUMBER, 2},
+  {"три", W_NUMBER, 3}, {"четыре", W_NUMBER, 4}, {"пять", W_NUMBER, 5},
+};
+
+typedef struct {
+  word_class_t cls;
+  float value;
+} token_t;
+
+static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+// Lower-cases ASCII and Cyrillic (UTF-8), folds "ё" to "е", and splits words, numbers and
+// "°" into space-separated tokens. "," and ";" become the separator word "then"; a "-" right
+// before a number stays with it, so "-2" is read as a negative number, not as 2.
+// false if the prompt did not fit (never match a truncated command).
+static bool normalize(const char *in, char *out, size_t out_size, bool *cyrillic) {
+  size_t j = 0;
+  char prev = ' ';
+  size_t i = 0;
+  for (; in[i] != '\0' && j + 8 < out_size; ++i) {
+    unsigned char c = (unsigned char)in[i];
+    unsigned char n = (unsigned char)in[i + 1];
+    if (c >= 'A' && c <= 'Z') c = (unsigned char)(c - 'A' + 'a');
+    if (c >= 'a' && c <= 'z') {
+      if (is_digit(prev)) out[j++] = ' ';
+      out[j++] = (char)c;
+    } else if (c == '-' && !is_digit(prev) && is_digit((char)n)) {
+      if (prev != ' ') out[j++] = ' ';
+      out[j++] = (char)c;
+    } else if (is_digit((char)c) || (c == '.' && is_digit(prev) && is_digit((char)n))) {
+      if (prev != ' ' && !is_digit(prev) && prev != '.' && prev != '-') out[j++] = ' ';
+      out[j++] = (char)c;
+    } else if (c == ',' || c == ';') {
+      memcpy(out + j, " then ", 6);
+      j += 6;
+      c = ' ';
+    } else if (c == 0xC2 && n == 0xB0) {  // degree sign
+      out[j++] = ' ';
+      out[j++] = (char)0xC2;
+      out[j++] = (char)0xB0;
+      out[j++] = ' ';
+      ++i;
+      c = ' ';
+    } else if ((c == 0xD0 || c == 0xD1) && n >= 0x80 && n <= 0xBF) {
+      *cyrillic = true;
+      if (is_digit(prev)) out[j++] = ' ';
+      unsigned char lead = c, tail = n;
+      if (lead == 0xD0 && tail >= 0x90 && tail <= 0x9F) {
+        tail = (unsigned char)(tail + 0x20);             // А..П -> а..п
+      } else if (lead == 0xD0 && tail >= 0xA0 && tail <= 0xAF) {
+        lead = 0xD1;                                     // Р..Я -> р..я
+        tail = (unsigned char)(tail - 0x20);
+      } else if ((lead == 0xD0 && tail == 0x81) || (lead == 0xD1 && tail == 0x91)) {
+        lead = 0xD0;                                     // Ё, ё -> е
+        tail = 0xB5;
+      }
+      out[j++] = (char)lead;
+      out[j++] = (char)tail;
+      ++i;
+      c = 'a';  // any letter: marks "inside a word" for the next byte
+    } else {
+      if (j > 0 && out[j - 1] != ' ') out[j++] = ' ';
+      c = ' ';
+    }
+    prev = (char)c;
+  }
+  out[j] = '\0';
+  return in[i] == '\0';
+}
+
+static bool classify(const char *word, token_t *tok) {
+  if (is_digit(word[0]) || (word[0] == '-' && is_digit(word[1]))) {
+    char *end = NULL;
+    tok->cls = W_NUMBER;
+    tok->value = strtof(word, &end);
+    return end != NULL && *end == '\0';
+  }
+  for (size_t i = 0; i < sizeof(kWords) / sizeof(kWords[0]); ++i) {
+    if (strcmp(kWords[i].word, word) == 0) {
+      tok->cls = kWords[i].cls;
+      tok->value = (float)kWords[i].value;
+      return true;
+    }
+  }
+  return false;
+}
+
+static int clamp(int v, int lo, int hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+// A number the user gave is used as given or not at all: "forward 100 seconds" or "turn 1000
+// degrees" is not the simple command it looks like, so it goes to the model instead.
+static bool in_range(float v, int lo, int hi) { return isfinite(v) && v >= (float)lo && v <= (float)hi; }
+
+static bool parse_step(const token_t *toks, int count, intent_step_t *step) {
+  int dir = 0;  // W_FORWARD..W_RIGHT
+  int verb = 0; // W_TURN, W_AROUND, W_STOP, W_OPEN, W_CLOSE
+  bool moved = false, gripper = false;
+  int speed = 0;
+  float duration_ms = -1.0f, angle = -1.0f;
+
+  for (int i = 0; i < count; ++i) {
+    const token_t *t = &toks[i];
+    switch (t->cls) {
+      case W_FILLER:
+        break;
+      case W_MOVE:
+        moved = true;
+        break;
+      case W_FORWARD: case W_BACK: case W_LEFT: case W_RIGHT:
+        if (dir != 0) return false;
+        dir = t->cls;
+        break;
+      case W_TURN: case W_AROUND: case W_STOP: case W_OPEN: case W_CLOSE:
+        if (verb != 0 && !(verb == W_TURN && t->cls == W_AROUND)) return false;
+        verb = t->cls;
+        break;
+      case W_GRIPPER:
+        gripper = true;
+        break;
+      case W_SPEED:
+        if (speed != 0) return false;
+        speed = (int)t->value;
+        break;
+      case W_NUMBER: {
+        // A number binds to the unit after it; a bare number is only an angle.
+        if (!isfinite(t->value) || t->value < 0.0f) return false;
+        word_class_t unit = i + 1 < count ? toks[i + 1].cls : W_FILLER;
+        if (unit == W_SECONDS || unit == W_MILLIS) {
+          if (duration_ms >= 0.0f) return false;
+          duration_ms = unit == W_SECONDS ? t->value * 1000.0f : t->value;
+          ++i;
+        } else {
+          if (angle >= 0.0f) return false;
+          angle = t->value;
+          if (unit == W_DEGREES) ++i;
+        }
+        break;
+      }
+      default:
+        return false;  // stray unit or separator
+    }
+  }
+
+  memset(step, 0, sizeof(*step));
+  step->speed_pct = (uint8_t)(speed ? speed : kDefaultSpeed);
+  if (verb == W_STOP) {
+    if (dir || moved || gripper || duration_ms >= 0.0f || angle >= 0.0f) return false;
+    step->kind = INTENT_STOP;
+    return true;
+  }
+  if (verb == W_OPEN || verb == W_CLOSE) {
+    if (dir || moved || duration_ms >= 0.0f || angle >= 0.0f) return false;
+    step->kind = verb == W_OPEN ? INTENT_GRIPPER_OPEN : INTENT_GRIPPER_CLOSE;
+    return true;
+  }
+  if (gripper) return false;
+  if (verb == W_TURN || verb == W_AROUND) {
+    if (duration_ms >= 0.0f || dir == W_FORWARD || dir == W_BACK) return false;
+    if (verb == W_TURN && dir == 0) return false;  // "turn" alone: which way?
+    step->kind = INTENT_TURN;
+    step->turn_left = dir != W_RIGHT;
+    float deg = angle >= 0.0f ? angle : (float)(verb == W_AROUND ? 180 : kDefaultTurnDeg);
+    if (!in_range(deg, 5, 360)) return false;
+    step->angle_deg = (uint16_t)(deg + 0.5f);
+    step->speed_pct = (uint8_t)clamp(step->speed_pct, 20, 100);
+    return true;
+  }
+  if (dir == 0 || angle >= 0.0f) return false;
+  int v = step->speed_pct;
+  step->kind = INTENT_MOVE;
+  step->x = (int8_t)(dir == W_LEFT ? -v : (dir == W_RIGHT ? v : 0));
+  step->y = (int8_t)(dir == W_FORWARD ? v : (dir == W_BACK ? -v : 0));
+  float ms = duration_ms >= 0.0f ? duration_ms : (float)kDefaultMoveMs;
+  if (!in_range(ms, 100, 5000)) return false;
+  step->duration_ms = (uint16_t)(ms + 0.5f);
+  return true;
+}
+
+bool intent_normalize(const char *prompt, char *out, size_t out_size) {
+  if (prompt == NULL || out == NULL || out_size == 0) return false;
+  bool cyrillic = false;
+  if (!normalize(prompt, out, out_size, &cyrillic)) return false;
+  // Collapse the separator runs normalize() may leave behind.
+  size_t j = 0;
+  for (size_t i = 0; out[i] != '\0'; ++i) {
+    if (out[i] == ' ' && (j == 0 || out[j - 1] == ' ')) continue;
+    out[j++] = out[i];
+  }
+  if (j > 0 && out[j - 1] == ' ') j--;
+  out[j] = '\0';
+  return true;
+}
+
+bool intent_parse(const char *prompt, intent_plan_t *out) {
+  if (prompt == NULL || out == NULL) return false;
+  char norm[INTENT_PROMPT_MAX * 2];
+  bool cyrillic = false;
+  if (!normalize(prompt, norm, sizeof(norm), &cyrillic)) return false;
+
+  token_t toks[kMaxTokens];
+  int count = 0;
+  char *save = NULL;
+  for (char *w = strtok_r(norm, " ", &save); w; w = strtok_r(NULL, " ", &save)) {
+    if (count >= kMaxTokens || !classify(w, &toks[count])) return false;
+    count++;
+  }
+
+  memset(out, 0, sizeof(*out));
+  out->russian = cyrillic;
+  int start = 0;
+  for (int i = 0; i <= count; ++i) {
+    if (i < count && toks[i].cls != W_SEP) continue;
+    if (i > start) {
+      if (out->count >= INTENT_MAX_STEPS) return false;
+      if (!parse_step(&toks[start], i - start, &out->steps[out->count])) return false;
+      out->count++;
+    }
+    start = i + 1;
+  }
+  return out->count > 0;
+}
+
+int intent_describe(const intent_plan_t *plan, char *out, size_t out_size) {
+  if (out_size == 0) return -1;
+  int n = 0;
+  out[0] = '\0';
+  for (uint8_t i = 0; i < plan->count && n >= 0 && n < (int)out_size; ++i) {
+    const intent_step_t *s = &plan->steps[i];
+    const char *sep = i ? "; " : "";
+    switch (s->kind) {
+      case INTENT_MOVE:
+        n += snprintf(out + n, out_size - n, "%s%s %u.%us", sep,
+                      s->y > 0 ? "forward" : s->y < 0 ? "back" : s->x < 0 ? "left" : s->x > 0 ? "right"
+                      : s->z < 0 ? "spin left" : "spin right",
+                      (unsigned)(s->duration_ms / 1000), (unsigned)(s->duration_ms % 1000 / 100));
+        break;
+      case INTENT_TURN:
+        n += snprintf(out + n, out_size - n, "%sturn %s %udeg", sep, s->turn_left ? "left" : "right",
+                      (unsigned)s->angle_deg);
+        break;
+      case INTENT_STOP:
+        n += snprintf(out + n, out_size - n, "%sstop", sep);
+        break;
+      case INTENT_GRIPPER_OPEN:
+        n += snprintf(out + n, out_size - n, "%sopen gripper", sep);
+        break;
+      case INTENT_GRIPPER_CLOSE:
+        n += snprintf(out + n, out_size - n, "%sclose gripper", sep);
+        break;
+    }
+  }
+  if (n < 0 || n >= (int)out_size) return -1;
+  return n;
+}
+
+// Topic keywords beyond the command vocabulary above (whose motion words count as well).
+// prefix entries match any word starting with them, which covers Russian inflection.
+// Goal-directed words ("come here", "подъедь к") are left out on purpose: they need both.
+typedef struct {
+  const char *word;
+  intent_topic_t topic;
+  bool prefix;
+} topic_word_t;
+
+static const topic_word_t kTopicWords[] = {
+  {"dance", INTENT_TOPIC_MOTION, false}, {"spin", INTENT_TOPIC_MOTION, false},
+  {"поед", INTENT_TOPIC_MOTION, true}, {"танц", INTENT_TOPIC_MOTION, true},
+  {"крут", INTENT_TOPIC_MOTION, true}, {"ехать", INTENT_TOPIC_MOTION, false},
+
+  {"see", INTENT_TOPIC_VISION, false}, {"look", INTENT_TOPIC_VISION, true},
+  {"camera", INTENT_TOPIC_VISION, false}, {"photo", INTENT_TOPIC_VISION, true},
+  {"picture", INTENT_TOPIC_VISION, false}, {"find", INTENT_TOPIC_VISION, false},
+  {"search", INTENT_TOPIC_VISION, false}, {"who", INTENT_TOPIC_VISION, false},
+  {"face", INTENT_TOPIC_VISION, true}, {"person", INTENT_TOPIC_VISION, false},
+  {"people", INTENT_TOPIC_VISION, false}, {"colour", INTENT_TOPIC_VISION, true},
+  {"color", INTENT_TOPIC_VISION, true}, {"object", INTENT_TOPIC_VISION, true},
+  {"scan", INTENT_TOPIC_VISION, false}, {"track", INTENT_TOPIC_VISION, false},
+  {"follow", INTENT_TOPIC_VISION, false}, {"вид", INTENT_TOPIC_VISION, true},
+  {"виж", INTENT_TOPIC_VISION, true}, {"смотр", INTENT_TOPIC_VISION, true},
+  {"посмотр", INTENT_TOPIC_VISION, true}, {"камер", INTENT_TOPIC_VISION, true},
+  {"фото", INTENT_TOPIC_VISION, true}, {"найд", INTENT_TOPIC_VISION, true},
+  {"найти", INTENT_TOPIC_VISION, false}, {"ищи", INTENT_TOPIC_VISION, false},
+  {"кто", INTENT_TOPIC_VISION, false}, {"лиц", INTENT_TOPIC_VISION, true},
+  {"цвет", INTENT_TOPIC_VISION, true}, {"предмет", INTENT_TOPIC_VISION, true},
+  {"следуй", INTENT_TOPIC_VISION, false}, {"следи", INTENT_TOPIC_VISION, false},
+
+  {"hello", INTENT_TOPIC_CHAT, false}, {"hi", INTENT_TOPIC_CHAT, false},
+  {"hey", INTENT_TOPIC_CHAT, false}, {"thank", INTENT_TOPIC_CHAT, true},
+  {"joke", INTENT_TOPIC_CHAT, false}, {"battery", INTENT_TOPIC_CHAT, false},
+  {"name", INTENT_TOPIC_CHAT, false}, {"привет", INTENT_TOPIC_CHAT, true},
+  {"здравств", INTENT_TOPIC_CHAT, true}, {"спасиб", INTENT_TOPIC_CHAT, true},
+  {"шутк", INTENT_TOPIC_CHAT, true}, {"заряд", INTENT_TOPIC_CHAT, true},
+  {"зовут", INTENT_TOPIC_CHAT, false}, {"дела", INTENT_TOPIC_CHAT, false},
+};
+
+// Words that may follow a motion verb without naming anything: how much, how often, for whom.
+// Any other unknown word after the verb is taken for an object ("go to the cup", "grab the
+// box", "едь к двери"): finding it needs the camera, so the prompt keeps the full tool set.
+static const char *const kMotionModifiers[] = {
+  "bit", "little", "lot", "while", "slightly", "some", "more", "once", "twice", "times",
+  "circle", "circles", "me", "us", "ok", "okay", "немного", "чуть", "раз", "раза", "круг",
+  "кругу", "мне", "нам",
+};
+
+static bool is_motion_modifier(const char *word) {
+  for (size_t i = 0; i < sizeof(kMotionModifiers) / sizeof(kMotionModifiers[0]); ++i) {
+    if (strcmp(word, kMotionModifiers[i]) == 0) return true;
+  }
+  return false;
+}
+
+static intent_topic_t word_topic(const char *word) {
+  token_t tok;
+  if (!is_digit(word[0]) && classify(word, &tok) && tok.cls >= W_MOVE && tok.cls <= W_GRIPPER) {
+    return INTENT_TOPIC_MOTION;
+  }
+  for (size_t i = 0; i < sizeof(kTopicWords) / sizeof(kTopicWords[0]); ++i) {
+    const topic_word_t *t = &kTopicWords[i];
+    if (t->prefix ? strncmp(word, t->word, strlen(t->word)) == 0 : strcmp(word, t->word) == 0) {
+      return t->topic;
+    }
+  }
+  return INTENT_TOPIC_ANY;
+}
+
+intent_topic_t intent_topic(const char *prompt) {
+  if (prompt == NULL) return INTENT_TOPIC_ANY;
+  char norm[INTENT_PROMPT_MAX * 2];
+  bool cyrillic = false;
+  if (!normalize(prompt, norm, sizeof(norm), &cyrillic)) return INTENT_TOPIC_ANY;
+
+  bool seen[INTENT_TOPIC_COUNT] = {};
+  bool names_object = false;
+  int words = 0;
+  char *save = NULL;
+  for (char *w = strtok_r(norm, " ", &save); w; w = strtok_r(NULL, " ", &save)) {
+    intent_topic_t topic = word_topic(w);
+    token_t tok;
+    if (seen[INTENT_TOPIC_MOTION] && topic == INTENT_TOPIC_ANY && !classify(w, &tok) &&
+        !is_motion_modifier(w)) {
+      names_object = true;
+    }
+    seen[topic] = true;
+    words++;
+  }
+  if (names_object) return INTENT_TOPIC_ANY;
+  if (seen[INTENT_TOPIC_MOTION] && seen[INTENT_TOPIC_VISION]) return INTENT_TOPIC_ANY;
+  if (seen[INTENT_TOPIC_MOTION]) return INTENT_TOPIC_MOTION;
+  if (seen[INTENT_TOPIC_VISION]) return INTENT_TOPIC_VISION;
+  // Small talk only when short: a longer request may ask for something no keyword covers.
+  return seen[INTENT_TOPIC_CHAT] && words <= kChatTopicMaxWords ? INTENT_TOPIC_CHAT : INTENT_TOPIC_ANY;
+}
+
+// Words that point back into the conversation; prefix entries as in kTopicWords.
+typedef struct {
+  const char *word;
+  bool prefix;
+} back_word_t;
+
+static const back_word_t kBackWords[] = {
+  {"again", false}, {"more", false}, {"further", false}, {"farther", false},
+  {"same", false}, {"repeat", false}, {"continue", false}, {"previous", false},
+  {"it", false}, {"its", false}, {"those", false}, {"them", false}, {"there", false},
+  {"my", false}, {"me", false},
+  {"еще", false}, {"снова", false}, {"опять", false}, {"дальше", false}, {"повтор", true},
+  {"продолж", true}, {"прежн", true}, {"тот", false}, {"того", false}, {"тому", false},
+  {"ту", false}, {"туда", false}, {"там", false}, {"это", true}, {"его", false},
+  {"ее", false}, {"их", false}, {"мой", false}, {"моя", false}, {"мое", false},
+  {"меня", false}, {"мне", false},
+};
+
+bool intent_refers_back(const char *prompt) {
+  if (prompt == NULL) return false;
+  char norm[INTENT_PROMPT_MAX * 2];
+  bool cyrillic = false;
+  // Too long to normalise: assume it needs its context.
+  if (!normalize(prompt, norm, sizeof(norm), &cyrillic)) return true;
+  char *save = NULL;
+  for (char *w = strtok_r(norm, " ", &save); w; w = strtok_r(NULL, " ", &save)) {
+    for (size_t i = 0; i < sizeof(kBackWords) / sizeof(kBackWords[0]); ++i) {
+      const back_word_t *b = &kBackWords[i];
+      if (b->prefix ? strncmp(w, b->word, strlen(b->word)) == 0 : strcmp(w, b->word) == 0) return true;
+    }
+  }
+  return false;
+}
+
+const char *intent_topic_name(intent_topic_t topic) {
+  switch (topic) {
+    case INTENT_TOPIC_MOTION: return "motion";
+    case INTENT_TOPIC_VISION: return "vision";
+    case INTENT_TOPIC_CHAT: return "chat";
+    default: return "full";
+  }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Deterministic EN/RU command matcher in front of the LLM: "forward 2 seconds",
+// "turn left 90 then stop", "открой захват". Every word of the prompt must be understood;
+// anything else is not a match and goes to the model, and so does a number outside the ranges
+// below (negative, "forward 100 seconds", "turn 1000 degrees"). Pure: no I/O, no allocation.
+
+#define INTENT_MAX_STEPS 4
+#define INTENT_PROMPT_MAX 384
+
+typedef enum {
+  INTENT_MOVE = 1,
+  INTENT_TURN = 2,
+  INTENT_STOP = 3,
+  INTENT_GRIPPER_OPEN = 4,
+  INTENT_GRIPPER_CLOSE = 5,
+} intent_kind_t;
+
+typedef struct {
+  intent_kind_t kind;
+  int8_t x;              // MOVE: lateral speed -100..100 (left negative)
+  int8_t y;              // MOVE: forward speed -100..100 (back negative)
+  int8_t z;              // MOVE: rotation speed -100..100 (never set by the parser)
+  uint16_t duration_ms;  // MOVE: 100..5000
+  bool turn_left;        // TURN
+  uint16_t angle_deg;    // TURN: 5..360
+  uint8_t speed_pct;     // MOVE/TURN: 20..100
+} intent_step_t;
+
+typedef struct {
+  uint8_t count;
+  bool russian;  // the prompt was Cyrillic: answer in Russian
+  intent_step_t steps[INTENT_MAX_STEPS];
+} intent_plan_t;
+
+// Canonical form used for matching: lower case (ASCII and Cyrillic), "ё" -> "е", words,
+// numbers and units separated by single spaces, punctuation dropped. false if it did not fit.
+bool intent_normalize(const char *prompt, char *out, size_t out_size);
+
+// true only for a confident, complete match; out is unspecified otherwise.
+bool intent_parse(const char *prompt, intent_plan_t *out);
+
+// Short English summary ("forward 2.0s; turn left 90deg"); returns length or -1.
+int intent_describe(const intent_plan_t *plan, char *out, size_t out_size);
+
+// Coarse topic of a prompt the parser did not match, from keywords alone: picks the tool set
+// and system prompt the model gets. Anything mixed or unclear is INTENT_TOPIC_ANY, and so is
+// motion towards or onto something named ("go to the cup", "grab the box"): it needs vision.
+typedef enum {
+  INTENT_TOPIC_ANY = 0,
+  INTENT_TOPIC_MOTION,  // driving, turning, gripper
+  INTENT_TOPIC_VISION,  // looking, finding, following
+  INTENT_TOPIC_CHAT,    // greetings and small talk: no tools
+  INTENT_TOPIC_COUNT,
+} intent_topic_t;
+
+intent_topic_t intent_topic(const char *prompt);
+const char *intent_topic_name(intent_topic_t topic);
+
+// true if the prompt leans on the conversation before it ("again", "a bit further", "take
+// it", "ещё раз", "туда"): such a prompt needs the chat history and means something else
+// in another conversation, so it is never answered from or stored in the plan cache.
+bool intent_refers_back(const char *prompt);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,300 @@
+#include "json_tok.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int kOkTokens = 32;
+
+// What the parser accepts next inside the innermost container (or at the top level).
+typedef enum {
+  EXPECT_VALUE,
+  EXPECT_VALUE_OR_END,  // just after '['
+  EXPECT_KEY,
+  EXPECT_KEY_OR_END,    // just after '{'
+  EXPECT_COLON,
+  EXPECT_COMMA_OR_END,
+  EXPECT_NOTHING,       // top-level value complete
+} expect_t;
+
+typedef struct {
+  int tok;
+  expect_t after;  // state of the enclosing level once this container closes
+} frame_t;
+
+static bool is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool is_hex(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// Leaves the token array usable up to n: containers still open end where parsing stopped.
+static int truncated(json_doc_t *doc, json_tok_t *toks, int n, const frame_t *stack, int depth,
+                     size_t pos) {
+  for (int d = 0; d < depth; ++d) toks[stack[d].tok].end = (uint16_t)pos;
+  doc->count = n;
+  return JSON_TOK_ERR_NOMEM;
+}
+
+int json_tok_parse(json_doc_t *doc, const char *js, size_t len, json_tok_t *toks, int max) {
+  doc->js = js;
+  doc->toks = toks;
+  doc->count = 0;
+  len = strnlen(js, len);
+  if (len > JSON_TOK_MAX_LEN) return JSON_TOK_ERR_INVAL;
+
+  frame_t stack[JSON_TOK_MAX_DEPTH];
+  int depth = 0;
+  int n = 0;
+  expect_t state = EXPECT_VALUE;
+  for (size_t i = 0; i < len; ++i) {
+    char c = js[i];
+    if (is_space(c)) continue;
+    bool in_object = depth > 0 && toks[stack[depth - 1].tok].type == JSON_TOK_OBJECT;
+    expect_t after_value = depth == 0 ? EXPECT_NOTHING : EXPECT_COMMA_OR_END;
+
+    if (c == ':') {
+      if (state != EXPECT_COLON) return JSON_TOK_ERR_INVAL;
+      state = EXPECT_VALUE;
+    } else if (c == ',') {
+      if (state != EXPECT_COMMA_OR_END) return JSON_TOK_ERR_INVAL;
+      state = in_object ? EXPECT_KEY : EXPECT_VALUE;
+    } else if (c == '}' || c == ']') {
+      json_tok_type_t type = c == '}' ? JSON_TOK_OBJECT : JSON_TOK_ARRAY;
+      if (depth == 0 || toks[stack[depth - 1].tok].type != type) return JSON_TOK_ERR_INVAL;
+      if (state != EXPECT_COMMA_OR_END &&
+          state != (type == JSON_TOK_OBJECT ? EXPECT_KEY_OR_END : EXPECT_VALUE_OR_END)) {
+        return JSON_TOK_ERR_INVAL;
+      }
+      depth--;
+      toks[stack[depth].tok].end = (uint16_t)(i + 1);
+      state = stack[depth].after;
+    } else if (c == '"') {
+      bool key = state == EXPECT_KEY || state == EXPECT_KEY_OR_END;
+      if (!key && state != EXPECT_VALUE && state != EXPECT_VALUE_OR_END) return JSON_TOK_ERR_INVAL;
+      size_t start = i + 1;
+      for (++i; i < len && js[i] != '"'; ++i) {
+        if ((unsigned char)js[i] < 0x20) return JSON_TOK_ERR_INVAL;
+        if (js[i] != '\\') continue;
+        if (++i >= len) return JSON_TOK_ERR_PART;
+        if (js[i] == 'u') {
+          for (int k = 0; k < 4; ++k) {
+            if (++i >= len) return JSON_TOK_ERR_PART;
+            if (!is_hex(js[i])) return JSON_TOK_ERR_INVAL;
+          }
+        } else if (strchr("\"\\/bfnrt", js[i]) == NULL) {
+          return JSON_TOK_ERR_INVAL;
+        }
+      }
+      if (i >= len) return JSON_TOK_ERR_PART;
+      if (n >= max) return truncated(doc, toks, n, stack, depth, start - 1);
+      toks[n++] = {JSON_TOK_STRING, (uint16_t)start, (uint16_t)i, 0};
+      if (depth > 0 && (key || !in_object)) toks[stack[depth - 1].tok].size++;
+      state = key ? EXPECT_COLON : after_value;
+    } else if (c == '{' || c == '[') {
+      if (state != EXPECT_VALUE && state != EXPECT_VALUE_OR_END) return JSON_TOK_ERR_INVAL;
+      if (depth == JSON_TOK_MAX_DEPTH) return JSON_TOK_ERR_INVAL;
+      if (n >= max) return truncated(doc, toks, n, stack, depth, i);
+      if (depth > 0 && !in_object) toks[stack[depth - 1].tok].size++;
+      toks[n] = {(uint8_t)(c == '{' ? JSON_TOK_OBJECT : JSON_TOK_ARRAY), (uint16_t)i, 0, 0};
+      stack[depth++] = {n, after_value};
+      n++;
+      state = c == '{' ? EXPECT_KEY_OR_END : EXPECT_VALUE_OR_END;
+    } else {
+      if (state != EXPECT_VALUE && state != EXPECT_VALUE_OR_END) return JSON_TOK_ERR_INVAL;
+      size_t start = i;
+      while (i < len && strchr("0123456789+-.eEtruefalsn", js[i]) != NULL) ++i;
+      size_t plen = i - start;
+      bool word = (plen == 4 && (memcmp(js + start, "true", 4) == 0 || memcmp(js + start, "null", 4) == 0)) ||
+                  (plen == 5 && memcmp(js + start, "false", 5) == 0);
+      bool number = plen > 0 && (js[start] == '-' || (js[start] >= '0' && js[start] <= '9'));
+      for (size_t k = start; number && k < i; ++k) number = strchr("0123456789+-.eE", js[k]) != NULL;
+      if (!word && !number) return i >= len ? JSON_TOK_ERR_PART : JSON_TOK_ERR_INVAL;
+      if (n >= max) return truncated(doc, toks, n, stack, depth, start);
+      toks[n++] = {JSON_TOK_PRIMITIVE, (uint16_t)start, (uint16_t)i, 0};
+      if (depth > 0 && !in_object) toks[stack[depth - 1].tok].size++;
+      state = after_value;
+      --i;
+    }
+  }
+  if (state != EXPECT_NOTHING) return JSON_TOK_ERR_PART;
+  doc->count = n;
+  return n;
+}
+
+int json_tok_next(const json_doc_t *doc, int i) {
+  if (i < 0 || i >= doc->count) return doc->count;
+  uint16_t end = doc->toks[i].end;
+  int j = i + 1;
+  while (j < doc->count && doc->toks[j].start < end) ++j;
+  return j;
+}
+
+int json_tok_get(const json_doc_t *doc, int obj, const char *key) {
+  if (obj < 0 || obj >= doc->count || doc->toks[obj].type != JSON_TOK_OBJECT) return -1;
+  int i = obj + 1;
+  for (uint16_t k = 0; k < doc->toks[obj].size && i + 1 < doc->count; ++k) {
+    if (json_tok_str_eq(doc, i, key)) return i + 1;
+    i = json_tok_next(doc, i + 1);
+  }
+  return -1;
+}
+
+int json_tok_at(const json_doc_t *doc, int arr, int idx) {
+  if (arr < 0 || arr >= doc->count || doc->toks[arr].type != JSON_TOK_ARRAY) return -1;
+  if (idx < 0 || idx >= doc->toks[arr].size) return -1;
+  int i = arr + 1;
+  for (int k = 0; k < idx && i < doc->count; ++k) i = json_tok_next(doc, i);
+  return i < doc->count ? i : -1;
+}
+
+bool json_tok_number(const json_doc_t *doc, int i, double *out) {
+  if (i < 0 || i >= doc->count || doc->toks[i].type != JSON_TOK_PRIMITIVE) return false;
+  const json_tok_t *t = &doc->toks[i];
+  char c = doc->js[t->start];
+  size_t len = t->end - t->start;
+  char buf[32];
+  if ((c != '-' && (c < '0' || c > '9')) || len >= sizeof(buf)) return false;
+  memcpy(buf, doc->js + t->start, len);
+  buf[len] = '\0';
+  *out = strtod(buf, NULL);
+  return true;
+}
+
+bool json_tok_int(const json_doc_t *doc, int i, int *out) {
+  double v;
+  if (!json_tok_number(doc, i, &v)) return false;
+  if (v >= (double)INT_MAX) {
+    *out = INT_MAX;
+  } else if (v <= (double)INT_MIN) {
+    *out = INT_MIN;
+  } else {
+    *out = (int)v;
+  }
+  return true;
+}
+
+bool json_tok_bool(const json_doc_t *doc, int i, bool *out) {
+  if (i < 0 || i >= doc->count || doc->toks[i].type != JSON_TOK_PRIMITIVE) return false;
+  char c = doc->js[doc->toks[i].start];
+  if (c != 't' && c != 'f') return false;
+  *out = c == 't';
+  return true;
+}
+
+bool json_tok_str(const json_doc_t *doc, int i, const char **out, size_t *len) {
+  if (i < 0 || i >= doc->count || doc->toks[i].type != JSON_TOK_STRING) return false;
+  *out = doc->js + doc->toks[i].start;
+  *len = doc->toks[i].end - doc->toks[i].start;
+  return true;
+}
+
+int json_tok_str_copy(const json_doc_t *doc, int i, char *out, size_t size) {
+  const char *s;
+  size_t len;
+  if (size == 0 || !json_tok_str(doc, i, &s, &len)) return -1;
+  return (int)json_tok_unescape(out, size, s, len);
+}
+
+bool json_tok_str_eq(const json_doc_t *doc, int i, const char *s) {
+  const char *raw;
+  size_t len;
+  return json_tok_str(doc, i, &raw, &len) && strlen(s) == len && memcmp(raw, s, len) == 0;
+}
+
+bool json_tok_raw(const json_doc_t *doc, int i, const char **out, size_t *len) {
+  if (i < 0 || i >= doc->count) return false;
+  const json_tok_t *t = &doc->toks[i];
+  size_t quote = t->type == JSON_TOK_STRING ? 1 : 0;
+  *out = doc->js + t->start - quote;
+  *len = t->end - t->start + 2 * quote;
+  return true;
+}
+
+static unsigned hex4(const char *s) {
+  unsigned v = 0;
+  for (int k = 0; k < 4; ++k) {
+    char c = s[k];
+    v = v * 16 + (c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+  }
+  return v;
+}
+
+// Writes cp as UTF-8 if it fits in the room left; returns the bytes written.
+static size_t put_utf8(char *out, size_t room, unsigned cp) {
+  char b[4];
+  size_t n;
+  if (cp < 0x80) {
+    b[0] = (char)cp;
+    n = 1;
+  } else if (cp < 0x800) {
+    b[0] = (char)(0xC0 | (cp >> 6));
+    b[1] = (char)(0x80 | (cp & 0x3F));
+    n = 2;
+  } else if (cp < 0x10000) {
+    b[0] = (char)(0xE0 | (cp >> 12));
+    b[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    b[2] = (char)(0x80 | (cp & 0x3F));
+    n = 3;
+  } else {
+    b[0] = (char)(0xF0 | (cp >> 18));
+    b[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    b[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    b[3] = (char)(0x80 | (cp & 0x3F));
+    n = 4;
+  }
+  if (n > room) return 0;
+  memcpy(out, b, n);
+  return n;
+}
+
+size_t json_tok_unescape(char *out, size_t size, const char *src, size_t len) {
+  // Decoded text is never longer than the escaped text, so out may alias src.
+  size_t o = 0;
+  size_t i = 0;
+  while (i < len && o + 1 < size) {
+    char c = src[i++];
+    if (c != '\\' || i >= len) {
+      out[o++] = c;
+      continue;
+    }
+    c = src[i++];
+    if (c == 'u' && i + 4 <= len) {
+      unsigned cp = hex4(src + i);
+      i += 4;
+      if (cp >= 0xD800 && cp < 0xDC00 && i + 6 <= len && src[i] == '\\' && src[i + 1] == 'u') {
+        unsigned lo = hex4(src + i + 2);
+        if (lo >= 0xDC00 && lo < 0xE000) {
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+          i += 6;
+        }
+      }
+      size_t w = put_utf8(out + o, size - 1 - o, cp);
+      if (w == 0) break;
+      o += w;
+      continue;
+    }
+    switch (c) {
+      case 'b': c = '\b'; break;
+      case 'f': c = '\f'; break;
+      case 'n': c = '\n'; break;
+      case 'r': c = '\r'; break;
+      case 't': c = '\t'; break;
+      default: break;  // '"', '\\', '/'
+    }
+    out[o++] = c;
+  }
+  out[o] = '\0';
+  return o;
+}
+
+bool json_tok_ok(const char *js, size_t len) {
+  json_tok_t toks[kOkTokens];
+  json_doc_t doc;
+  int n = json_tok_parse(&doc, js, len, toks, kOkTokens);
+  if (n < 0 && n != JSON_TOK_ERR_NOMEM) return false;
+  bool ok = false;
+  return json_tok_bool(&doc, json_tok_get(&doc, 0, "ok"), &ok) && ok;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// In-place JSON tokenizer for small fixed-shape documents (tool arguments, UnitV replies,
+// stream chunks). Tokens index into the caller's text and live in a caller-provided array;
+// nothing is allocated and strings are only unescaped when copied out. Tokens are in
+// document order: an object is followed by its keys, each key by its value.
+
+#define JSON_TOK_ERR_NOMEM (-1)  // token array full; the tokens that fit form a truncated document
+#define JSON_TOK_ERR_INVAL (-2)  // not JSON
+#define JSON_TOK_ERR_PART (-3)   // JSON cut short
+#define JSON_TOK_MAX_LEN 0xFFFF
+#define JSON_TOK_MAX_DEPTH 16
+
+typedef enum {
+  JSON_TOK_OBJECT = 1,
+  JSON_TOK_ARRAY,
+  JSON_TOK_STRING,     // start/end exclude the quotes
+  JSON_TOK_PRIMITIVE,  // number, true, false or null
+} json_tok_type_t;
+
+typedef struct {
+  uint8_t type;   // json_tok_type_t
+  uint16_t start;
+  uint16_t end;
+  uint16_t size;  // object: keys, array: elements
+} json_tok_t;
+
+typedef struct {
+  const char *js;
+  const json_tok_t *toks;
+  int count;
+} json_doc_t;
+
+// Tokenizes js (up to len bytes or a NUL). Returns the token count or a JSON_TOK_ERR_*.
+int json_tok_parse(json_doc_t *doc, const char *js, size_t len, json_tok_t *toks, int max);
+
+// Token after i and everything nested in it; doc->count at the end.
+int json_tok_next(const json_doc_t *doc, int i);
+// Value token of key in object obj (0 is the root), or -1.
+int json_tok_get(const json_doc_t *doc, int obj, const char *key);
+// Element idx of array arr, or -1.
+int json_tok_at(const json_doc_t *doc, int arr, int idx);
+
+// Typed views of token i; false if it is missing (-1) or of another type. Integers
+// truncate and saturate like cJSON's valueint.
+bool json_tok_number(const json_doc_t *doc, int i, double *out);
+bool json_tok_int(const json_doc_t *doc, int i, int *out);
+bool json_tok_bool(const json_doc_t *doc, int i, bool *out);
+// Raw string bytes, still escaped, not NUL-terminated.
+bool json_tok_str(const json_doc_t *doc, int i, const char **out, size_t *len);
+// Unescaped copy, truncated to fit and NUL-terminated; returns the copied length or -1.
+int json_tok_str_copy(const json_doc_t *doc, int i, char *out, size_t size);
+bool json_tok_str_eq(const json_doc_t *doc, int i, const char *s);
+// JSON text of any value, quotes included: a subtree can be passed on without re-printing.
+bool json_tok_raw(const json_doc_t *doc, int i, const char **out, size_t *len);
+
+// Decodes a raw JSON string body into out (which may alias src). Returns the length.
+size_t json_tok_unescape(char *out, size_t size, const char *src, size_t len);
+
+// True for a {"ok":true,...} reply. Only the fields before the token budget runs out are
+// examined, so a long reply still counts when "ok" comes first.
+bool json_tok_ok(const char *js, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,4 +1,6 @@
 #include <atomic>
+#include <stdarg.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -11,26 +13,50 @@
 #include <strings.h>
 
 #include "M5Unified.h"
+#include "ai_client.h"
+#include "capture_ctl.h"
+#include "chat_memory.h"
+#include "cJSON.h"
+#include "intent.h"
+#include "json_tok.h"
+#include "plan_cache.h"
+#include "rto.h"
+#include "scene_delta.h"
+#include "trace.h"
+#include "track_ctl.h"
+#include "turn_arena.h"
 #include "logger_json.h"
+#include "vision_frame.h"
+#include "vision_world.h"
 #include "secrets.h"
+// Optional in secrets.h: send the AI requests to a local stand-in server instead of OpenRouter
+// (tools/openrouter_standin.py, see README) and trust its self-signed certificate.
+#ifndef OPENROUTER_URL
+#define OPENROUTER_URL NULL
+#endif
+#ifndef OPENROUTER_CERT_PEM
+#define OPENROUTER_CERT_PEM NULL
+#endif
 #include "driver/gpio.h"
 #include "driver/rtc_io.h"
 #include "driver/uart.h"
 #include "esp_event.h"
+#include "esp_heap_caps.h"
 #include "esp_http_server.h"
 #include "esp_log.h"
 #include "esp_netif.h"
 #include "esp_sleep.h"
 #include "esp_system.h"
 #include "esp_task_wdt.h"
+#include "esp_timer.h"
 #include "esp_wifi.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
+#include "freertos/ringbuf.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "mdns.h"
 #include "nvs_flash.h"
-#include "openrouter.h"
 
 static const char *TAG = "ai-rover-idf";
 
@@ -44,10 +70,37 @@ static const TickType_t kHeartbeatPeriod = pdMS_TO_TICKS(1000);
 static const TickType_t kVisionPingPeriod = pdMS_TO_TICKS(10000);
 static const TickType_t kLoopPeriod = pdMS_TO_TICKS(20);
 static const TickType_t kAiActionQueueSendTimeout = pdMS_TO_TICKS(100);
-static const TickType_t kAiActionResultTimeoutSlack = pdMS_TO_TICKS(1000);
+// Result wait beyond an action's own run time (queueing, stopping); adaptive, see rto.h.
+static const uint32_t kAiActionSlackMs = 1000;
+static const uint32_t kAiActionSlackMinMs = 300;
+static const uint32_t kAiActionSlackMaxMs = 3000;
 static const TickType_t kAiStopActionTimeout = pdMS_TO_TICKS(7000);
 static const int kAiActionQueueDepth = 4;
+static const TickType_t kAiActionIdlePoll = pdMS_TO_TICKS(1000);  // executor watchdog feed while idle
 static const int kAiHttpTimeoutMs = 15000;
+static const uint32_t kAiIdleCloseMs = 45000;         // before the server drops it anyway
+static const uint32_t kAiLowHeapBytes = 40 * 1024;    // below this an idle TLS link goes at once
+static const TickType_t kAiPrewarmMinGap = pdMS_TO_TICKS(10000);
+// cJSON trees and tool results of one LLM turn; reserved at boot, before the heap fragments.
+static const size_t kTurnArenaBytes = 16 * 1024;
+static const int kVisionReplyTokens = 128;  // a full VISION_RESP_MAX reply
+static const char *kAiVisionModel = "openai/gpt-4o-mini";
+static const char *kAiChatModel = "openai/gpt-4o-mini";
+// Hedge and fallback tiers for chat, tried in order when the one above is slow or failing.
+static const char *const kAiChatFallbackModels[] = {"google/gemini-2.0-flash-001", NULL};
+// Folds old conversation turns into the memory summary while the chat worker is idle.
+static const char *kAiSummaryModel = "google/gemini-2.0-flash-001";
+static const int kAiSummaryMaxTokens = 96;  // about CHAT_MEMORY_SUMMARY_MAX bytes
+static const TickType_t kChatIdlePoll = pdMS_TO_TICKS(3000);
+static const uint32_t kChatMemoryTtlMs = 10 * 60 * 1000;  // a conversation left this long starts over
+static const int kAiVisionMaxTokens = 200;
+static const size_t kChatResultChunk = 512;
+static const size_t kStatusChunkMax = 1024;  // largest /status section: a full world snapshot
+static const size_t kChatStreamRingBytes = 4096;
+static const size_t kChatStreamTextMax = 128;
+static const TickType_t kChatStreamEndSendTimeout = pdMS_TO_TICKS(100);
+static const TickType_t kChatStreamPingPeriod = pdMS_TO_TICKS(5000);
+static const TickType_t kChatStreamMaxDuration = pdMS_TO_TICKS(180000);
 static const TickType_t kWifiConnectTimeout = pdMS_TO_TICKS(30000);
 static const TickType_t kInactivitySleepTimeout = pdMS_TO_TICKS(120000);
 static const int WIFI_CONNECTED_BIT = BIT0;
@@ -66,19 +119,43 @@ static const uint8_t kGripperOpenAngle = 35;
 static const uint8_t kGripperCloseAngle = 150;
 #define CHAT_PROMPT_MAX 384
 #define CHAT_RESPONSE_MAX 2048
+#define CHAT_SLOT_COUNT 4
 
 // ── Vision (UnitV-M12) ──
 static const uart_port_t kVisionUart = UART_NUM_1;
 static const gpio_num_t kVisionTxPin = GPIO_NUM_32;
 static const gpio_num_t kVisionRxPin = GPIO_NUM_33;
-static const int kVisionBaud = 115200;
-static const int kVisionRxBuf = 2048;
+static const int kVisionBaud = 115200;            // boot/fallback rate, always supported
+static const int kVisionFastBauds[] = {1500000, 921600};  // tried in order after a good PING
+static const int kVisionBaudSwitchSettleMs = 20;
+static const int kVisionBaudConfirmMs = 1000;     // camera-side revert window after BAUD
+static const int kVisionBaudErrorBurst = 3;       // consecutive errors at a fast rate -> fallback
+static const TickType_t kVisionBaudRetryPeriod = pdMS_TO_TICKS(60000);
+static const int kVisionRxBuf = 8192;             // ~55 ms of headroom at 1.5 Mbaud
+static const int kVisionTxBuf = 2048;
+// Command and capture deadlines start here and then follow observed latency (rto.h).
 static const int kVisionTimeoutMs = 7000;
+static const int kVisionTimeoutMinMs = 1000;
+static const int kVisionTimeoutMaxMs = 12000;
 static const int kVisionPingTimeoutMs = 500;
 static const int kVisionCaptureTimeoutMs = 12000;
+static const int kVisionCaptureTimeoutMinMs = 3000;
+static const int kVisionCaptureTimeoutMaxMs = 20000;
 static const int kCaptureMaxJpegBytes = 40960;   // 40KB K210 limit
-static const int kCaptureDefaultQuality = 75;
 static const int kCaptureChunkSize = 2048;
+static const int kVisionFrameIdleMs = 300;        // silence after a frame before re-requesting
+static const int kVisionResendRounds = 3;         // RESEND rounds without progress before giving up
+static const int kVisionResendBatch = 16;         // seqs per RESEND request
+static const int kVisionSubscribeHz = 5;          // detection events per second in subscribe mode
+static const int kVisionEventStaleMs = 1500;      // no event for this long -> stream lost, PING
+static const int kVisionWorldFreshMs = 1000;      // tools answer from the snapshot if newer
+static const size_t kStateSnapshotMax = 224;       // bytes of rover state prepended to LLM prompts
+static const bool kStateSnapshotEnabled = true;    // false for a baseline of tool rounds per turn
+static const int kPrefetchScanFreshMs = 5000;     // speculative SCAN still answers vision_scan
+static const int kPrefetchImuFreshMs = 3000;      // speculative IMU sample still answers read_imu
+static const int kSceneStableMs = 5000;           // a scene seen twice unchanged is reused this long
+static const int kCaptureFrameChunkMin = 256;
+static const int kCaptureMaxChunks = kCaptureMaxJpegBytes / kCaptureFrameChunkMin;
 #define VISION_RESP_MAX 512
 
 // ── Rover FSM ──
@@ -128,7 +205,8 @@ static void send_syslog(const char *message);
 static EventGroupHandle_t s_wifi_event_group;
 static int s_retry_num;
 static int s_syslog_sock = -1;
-static openrouter_handle_t s_ai = NULL;
+static ai_chat_config_t s_ai_chat = {};
+static bool s_ai_ready = false;
 static SemaphoreHandle_t s_state_mutex;
 static SemaphoreHandle_t s_i2c_mutex;
 static SemaphoreHandle_t s_power_mutex;
@@ -140,16 +218,175 @@ static QueueHandle_t s_syslog_queue;
 static QueueHandle_t s_ai_action_queue;
 static QueueHandle_t s_ai_action_result_queue;
 static uint32_t s_chat_id = 0;
-static uint32_t s_chat_done_id = 0;
-static bool s_chat_pending = false;
-static esp_err_t s_chat_result_err = ESP_OK;
-static char s_chat_response[CHAT_RESPONSE_MAX];
+// Job id 0 on s_chat_queue asks the worker to open the LLM connection ahead of a prompt.
+static const uint32_t kChatPrewarmJob = 0;
+static std::atomic<bool> s_ai_prewarm_pending{false};
+static TickType_t s_ai_prewarm_tick = 0;
+// Jobs queued or running; read lock-free by the display.
+static std::atomic<int> s_chat_inflight{0};
+// Set under s_chat_mutex while a turn is RUNNING; the chat loop polls it.
+static std::atomic<bool> s_chat_cancel{false};
+static TickType_t s_chat_cancel_tick = 0;
+static const char *s_chat_cancel_reason = "";
+// Local intent fast path: prompts answered without the LLM, and the model time that saved
+// (the running average of LLM turn time minus the tool time inside it).
+static std::atomic<uint32_t> s_intent_hits{0};
+static std::atomic<uint32_t> s_intent_misses{0};
+static std::atomic<uint32_t> s_intent_saved_ms{0};
+static std::atomic<uint32_t> s_llm_overhead_ms{0};
+// Heap low-water mark of the last LLM turn and how far it sank below the free heap at start.
+static std::atomic<uint32_t> s_turn_heap_min{0};
+static std::atomic<uint32_t> s_turn_heap_used{0};
+// LLM turns and the tool rounds they took (a round that ends in tool calls costs one more
+// model request); with the state snapshot, sensor-only rounds should mostly disappear.
+static std::atomic<uint32_t> s_llm_turns{0};
+static std::atomic<uint32_t> s_llm_tool_rounds{0};
+// One chat config per prompt topic (intent_topic), built by init_ai: a topic that cannot need
+// a tool does not pay for its schema, and its system prompt only covers what it has. Turns,
+// request bytes and model time per topic show what the trimming buys.
+static const size_t kAiToolsMax = 12;
+static ai_chat_config_t s_ai_chat_topic[INTENT_TOPIC_COUNT];
+static ai_tool_t s_ai_topic_tools[INTENT_TOPIC_COUNT][kAiToolsMax];
+static std::atomic<uint32_t> s_topic_turns[INTENT_TOPIC_COUNT];
+static std::atomic<uint32_t> s_topic_request_bytes[INTENT_TOPIC_COUNT];
+static std::atomic<uint32_t> s_topic_llm_ms[INTENT_TOPIC_COUNT];
+// Recent exchanges and a summary of older ones, sent with LLM turns that need them (small
+// talk, prompts that refer back) so follow-ups have context. Compacted by a cheap model call
+// when the worker is idle. One conversation for the rover, shared by every web client, as
+// the motors and camera are. Chat worker only; the counters are read by /status.
+static chat_memory_t s_chat_memory;
+static ai_chat_config_t s_ai_summary;
+static std::atomic<uint32_t> s_memory_tokens{0};
+static std::atomic<uint32_t> s_memory_turns{0};
+static std::atomic<uint32_t> s_memory_dropped{0};
+static std::atomic<uint32_t> s_memory_compactions{0};
+// State snapshot plus the user's prompt for the running LLM turn. Chat worker only.
+static char s_llm_prompt[kStateSnapshotMax + CHAT_PROMPT_MAX];
+// Tool time inside the current LLM turn; touched only by the chat worker (event callback).
+static TickType_t s_chat_tool_start = 0;
+static TickType_t s_chat_tool_ticks = 0;
+// Actions an LLM turn executed, for the plan cache; valid only if every tool call the model
+// made is one of them (observations such as vision_scan make a turn non-replayable).
+// Chat worker only.
+static intent_plan_t s_plan_rec;
+static int s_plan_rec_calls = 0;
+// Actions an LLM tool started with async:true, by handle (the executor req_id). Core 0 files
+// the outcome here; action_status, wait_action and the round note read it. Under
+// s_ai_async_mutex.
+typedef struct {
+  uint32_t handle;  // 0: free
+  const char *name;
+  uint32_t started_ms;
+  uint32_t eta_ms;  // upper bound from started_ms, including actions queued ahead of it
+  bool done;
+  bool noted;       // outcome already reported to the model
+  esp_err_t err;
+  float turn_measured_deg;
+} ai_async_action_t;
+static SemaphoreHandle_t s_ai_async_mutex;
+static ai_async_action_t s_ai_async[4];
+// Speculative sensor reads for the running LLM turn (see prefetch_start). Everything below is
+// under s_prefetch_mutex; a generation bump retires whatever the previous turn left.
+typedef struct {
+  bool valid;
+  uint32_t gen;
+  uint32_t taken_ms;
+  char resp[VISION_RESP_MAX];
+} prefetch_scan_t;
+typedef struct {
+  bool valid;
+  uint32_t gen;
+  uint32_t taken_ms;
+  float accel[3];
+  float gyro[3];
+} prefetch_imu_t;
+static SemaphoreHandle_t s_prefetch_mutex;
+static TaskHandle_t s_prefetch_task = NULL;
+static uint32_t s_prefetch_gen = 1;
+static uint32_t s_prefetch_scan_want = 0;  // generation a SCAN was requested for; 0: none
+static prefetch_scan_t s_prefetch_scan;
+static prefetch_imu_t s_prefetch_imu;
+static std::atomic<uint32_t> s_prefetch_scans{0};
+static std::atomic<uint32_t> s_prefetch_scan_hits{0};
+static std::atomic<uint32_t> s_prefetch_scan_wasted{0};
+static std::atomic<uint32_t> s_prefetch_imu_hits{0};
+// What the model has already been shown of the scene in the running LLM turn, so a repeated
+// vision_scan can answer with a diff. Streamed snapshots are diffed box by box; SCAN replies
+// are opaque camera JSON, so only an identical one is recognised (by hash), and once two in a
+// row agree with the rover standing still, the next scan is skipped. Chat worker only.
+typedef struct {
+  bool valid;
+  const char *source;  // what the model saw it in: "rover line" or "last scan"
+  vision_world_t world;
+} scene_base_t;
+typedef struct {
+  bool valid;
+  uint32_t hash;
+  uint32_t gen;       // s_prefetch_gen when taken: no tool actuation since if still current
+  uint32_t motor_gen; // s_motor_gen when taken: no motor or servo write since if still current
+  uint32_t taken_ms;
+  uint8_t repeats;    // identical replies in a row after the first
+  uint16_t full_len;  // bytes of the reply, to count what an "unchanged" saves
+} scene_scan_t;
+static scene_base_t s_scene_base;
+static scene_scan_t s_scene_scan;
+static std::atomic<uint32_t> s_scene_diffs{0};
+static std::atomic<uint32_t> s_scene_saved_bytes{0};
+static std::atomic<uint32_t> s_scene_skipped_scans{0};
+// Live chat progress for /chat_stream: the chat worker pushes into a bounded ring only while
+// an SSE client is attached; a full ring drops tokens (the final "done" carries the full text).
+static RingbufHandle_t s_chat_stream_ring = NULL;
+static QueueHandle_t s_chat_stream_req_queue = NULL;
+static std::atomic<bool> s_chat_stream_active{false};
+static std::atomic<uint32_t> s_chat_stream_job{0};
+static std::atomic<uint32_t> s_chat_stream_drops{0};
 // Cross-core status flags: use atomics for lock-free reads in UI/tasks.
 static std::atomic<bool> s_wifi_connected{false};
 static httpd_handle_t s_httpd = NULL;
 static SemaphoreHandle_t s_vision_mutex;
+// Adaptive deadlines (rto.h). Each estimator is updated by one owner; its figures are
+// published for /metrics.
+typedef struct {
+  const char *name;
+  rto_est_t est;
+  std::atomic<uint32_t> srtt_ms;
+  std::atomic<uint32_t> timeout_ms;
+  std::atomic<uint32_t> samples;
+  std::atomic<uint32_t> timeouts;
+} op_rto_t;
+// Vision commands; other commands keep kVisionTimeoutMs. Under s_vision_mutex.
+typedef enum {
+  VISION_RTO_SCAN = 0,
+  VISION_RTO_SCAN_FAST,
+  VISION_RTO_OBJECTS,
+  VISION_RTO_WHO,
+  VISION_RTO_INFO,
+  VISION_RTO_COUNT,
+} vision_rto_op_t;
+static op_rto_t s_vision_rto[VISION_RTO_COUNT];
+// CAPTURE by expected frame size: QQVGA, QVGA below quality 60, QVGA from 60. Under s_vision_mutex.
+static op_rto_t s_capture_rto[3];
+// Action result slack; chat worker only.
+static op_rto_t s_action_rto;
 static uint32_t s_vision_req_id = 0;
 static std::atomic<bool> s_vision_available{false};
+// UART link rate state; written under s_vision_mutex, read lock-free by /status.
+static std::atomic<int> s_vision_baud{kVisionBaud};
+static std::atomic<uint32_t> s_vision_last_bps{0};
+static int s_vision_err_streak = 0;
+static bool s_vision_baud_unsupported = false;
+static TickType_t s_vision_baud_retry_tick = 0;
+static std::atomic<bool> s_vision_framed{false};
+static bool s_vision_framed_unsupported = false;
+static std::atomic<uint32_t> s_vision_frame_errors{0};
+static vision_frame_decoder_t s_vision_dec;
+static char s_vision_line[VISION_RESP_MAX];       // partial line kept across reads
+static int s_vision_line_len = 0;
+// Written by vision_ping_task, read lock-free by the chat, prefetch, track and main tasks.
+static std::atomic<bool> s_vision_subscribed{false};
+static bool s_vision_subscribe_unsupported = false;
+static std::atomic<uint32_t> s_vision_last_event_ms{0};
+static std::atomic<uint32_t> s_vision_events{0};
 
 static int8_t s_motion_x = 0;
 static int8_t s_motion_y = 0;
@@ -157,13 +394,93 @@ static int8_t s_motion_z = 0;
 static bool s_motion_active = false;
 static bool s_gripper_open = false;
 static TickType_t s_web_motion_deadline = 0;
+static track_ctl_t s_track = {};  // local visual tracking run, guarded by s_state_mutex
+// Speeds apply_motion last wrote; 127: unknown, write the next one whatever it is.
+static int8_t s_applied_x = 127;
+static int8_t s_applied_y = 127;
+static int8_t s_applied_z = 127;
+// Physical AI actions run on ai_action_task; while one does, it owns the motors and
+// main_loop_task leaves driving, tracking and sleep alone (but keeps its own cadence).
+static std::atomic<bool> s_ai_action_running{false};
+// Button B as of the main loop's last M5.update(); the executor stops an action on it.
+static std::atomic<bool> s_btn_b_held{false};
+// Main loop cadence: the longest wakeup-to-wakeup gap in the last heartbeat window, and
+// wakeups later than twice kLoopPeriod since boot.
+static std::atomic<uint32_t> s_loop_max_us{0};
+static std::atomic<uint32_t> s_loop_overruns{0};
 static std::atomic<uint32_t> s_last_activity_tick{0};
+// Bumped by every motor write that moves the rover and every servo write, whoever makes it
+// (buttons, web, tracking, the executor); s_motors_running: the last speed write was not 0.
+static std::atomic<uint32_t> s_motor_gen{0};
+static std::atomic<bool> s_motors_running{false};
 static std::atomic<uint32_t> s_ai_action_req_seq{0};
 
+typedef enum {
+  CHAT_SLOT_FREE = 0,
+  CHAT_SLOT_QUEUED = 1,
+  CHAT_SLOT_RUNNING = 2,
+  CHAT_SLOT_DONE = 3,
+} chat_slot_state_t;
+
+// One chat job from prompt to answer. The worker reads prompt and writes response in place
+// while the slot is RUNNING; a DONE slot is immutable until reclaimed, so result senders pin
+// it and stream straight from it without holding s_chat_mutex.
 typedef struct {
   uint32_t id;
+  chat_slot_state_t state;
+  esp_err_t err;
+  uint8_t readers;
+  TickType_t last_used;
+  size_t response_len;
   char prompt[CHAT_PROMPT_MAX];
-} chat_job_t;
+  char response[CHAT_RESPONSE_MAX];
+} chat_slot_t;
+
+// Allocated once; s_chat_queue carries job ids into it. Guarded by s_chat_mutex.
+static chat_slot_t s_chat_slots[CHAT_SLOT_COUNT];
+
+static chat_slot_t *chat_slot_find_locked(uint32_t id) {
+  for (int i = 0; id != 0 && i < CHAT_SLOT_COUNT; ++i) {
+    if (s_chat_slots[i].state != CHAT_SLOT_FREE && s_chat_slots[i].id == id) return &s_chat_slots[i];
+  }
+  return NULL;
+}
+
+// A free slot, else the least recently used finished one nobody is reading.
+static chat_slot_t *chat_slot_claim_locked(void) {
+  chat_slot_t *lru = NULL;
+  for (int i = 0; i < CHAT_SLOT_COUNT; ++i) {
+    chat_slot_t *slot = &s_chat_slots[i];
+    if (slot->state == CHAT_SLOT_FREE) return slot;
+    if (slot->state == CHAT_SLOT_DONE && slot->readers == 0 &&
+        (lru == NULL || (TickType_t)(slot->last_used - lru->last_used) > portMAX_DELAY / 2)) {
+      lru = slot;
+    }
+  }
+  return lru;
+}
+
+// Returns the slot pinned when the job is DONE; otherwise NULL with *state telling whether it
+// is still QUEUED/RUNNING or unknown/reclaimed (FREE). Release a pinned slot exactly once.
+static chat_slot_t *chat_slot_acquire(uint32_t id, chat_slot_state_t *state) {
+  xSemaphoreTake(s_chat_mutex, portMAX_DELAY);
+  chat_slot_t *slot = chat_slot_find_locked(id);
+  *state = slot ? slot->state : CHAT_SLOT_FREE;
+  if (slot && slot->state == CHAT_SLOT_DONE) {
+    slot->readers++;
+  } else {
+    slot = NULL;
+  }
+  xSemaphoreGive(s_chat_mutex);
+  return slot;
+}
+
+static void chat_slot_release(chat_slot_t *slot) {
+  xSemaphoreTake(s_chat_mutex, portMAX_DELAY);
+  slot->readers--;
+  slot->last_used = xTaskGetTickCount();
+  xSemaphoreGive(s_chat_mutex);
+}
 
 typedef enum {
   AI_ACTION_MOVE = 1,
@@ -182,12 +499,14 @@ typedef struct {
   uint16_t duration_ms;
   uint16_t turn_target_deg;
   uint16_t turn_timeout_ms;
+  bool async;  // outcome goes to s_ai_async instead of the result queue
 } ai_action_req_t;
 
 typedef struct {
   uint32_t req_id;
   esp_err_t err;
   float turn_measured_deg;
+  uint32_t run_ms;  // time the executor spent on the action itself
 } ai_action_result_t;
 
 static void wifi_event_handler(void *arg,
@@ -533,12 +852,16 @@ static esp_err_t rover_set_speed(int8_t x, int8_t y, int8_t z) {
   buffer[1] = (int8_t)((m1 > 100) ? 100 : (m1 < -100 ? -100 : m1));
   buffer[2] = (int8_t)((m2 > 100) ? 100 : (m2 < -100 ? -100 : m2));
   buffer[3] = (int8_t)((m3 > 100) ? 100 : (m3 < -100 ? -100 : m3));
+  bool running = x != 0 || y != 0 || z != 0;
+  if (running) s_motor_gen.fetch_add(1, std::memory_order_relaxed);
+  s_motors_running.store(running, std::memory_order_relaxed);
   return rover_write(0x00, (const uint8_t *)buffer, sizeof(buffer));
 }
 
 static esp_err_t rover_set_servo_angle(uint8_t pos, uint8_t angle) {
   uint8_t reg = (uint8_t)(0x10 + pos);
   uint8_t value = angle;
+  s_motor_gen.fetch_add(1, std::memory_order_relaxed);
   return rover_write(reg, &value, 1);
 }
 
@@ -556,7 +879,7 @@ static esp_err_t vision_uart_init(void) {
   uart_cfg.stop_bits = UART_STOP_BITS_1;
   uart_cfg.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
 
-  esp_err_t err = uart_driver_install(kVisionUart, kVisionRxBuf * 2, kVisionRxBuf, 0, NULL, 0);
+  esp_err_t err = uart_driver_install(kVisionUart, kVisionRxBuf, kVisionTxBuf, 0, NULL, 0);
   if (err != ESP_OK) return err;
   err = uart_param_config(kVisionUart, &uart_cfg);
   if (err != ESP_OK) return err;
@@ -564,40 +887,234 @@ static esp_err_t vision_uart_init(void) {
                       UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
 }
 
-static esp_err_t vision_cmd_timeout(const char *cmd, const char *args_json,
-                                    char *resp, size_t resp_size, int timeout_ms) {
-  uint32_t rid = ++s_vision_req_id;
+// Sends one request as a JSON line, or as a JSON frame once framing is negotiated.
+static esp_err_t vision_write_request(uint32_t rid, const char *cmd, const char *args_json) {
   char req[256];
   int n = snprintf(req, sizeof(req),
                    "{\"cmd\":\"%s\",\"req_id\":\"%" PRIu32 "\",\"args\":%s}\n",
                    cmd, rid, args_json ? args_json : "{}");
   if (n >= (int)sizeof(req)) return ESP_ERR_NO_MEM;
 
-  uart_flush_input(kVisionUart);
+  if (!s_vision_framed.load(std::memory_order_relaxed)) {
+    int sent = uart_write_bytes(kVisionUart, req, n);
+    return sent == n ? ESP_OK : ESP_FAIL;
+  }
+
+  vision_frame_t frame = {
+    .type = VISION_FRAME_JSON,
+    .flags = 0,
+    .req_id = (uint16_t)rid,
+    .seq = 0,
+    .total = 1,
+    .payload = (const uint8_t *)req,
+    .len = (uint16_t)(n - 1),  // no trailing newline inside a frame
+  };
+  uint8_t wire[320];
+  size_t w = vision_frame_encode(&frame, wire, sizeof(wire));
+  if (w == 0) return ESP_ERR_NO_MEM;
+  int sent = uart_write_bytes(kVisionUart, wire, w);
+  return sent == (int)w ? ESP_OK : ESP_FAIL;
+}
 
-  int sent = uart_write_bytes(kVisionUart, req, n);
-  if (sent != n) return ESP_FAIL;
+static void vision_ingest_event(const char *json, size_t len) {
+  vision_world_t world;
+  if (!vision_world_parse(json, len, &world)) return;
+  world.rx_ms = (uint32_t)esp_log_timestamp();
+  vision_world_publish(&world);
+  s_vision_last_event_ms.store(world.rx_ms, std::memory_order_relaxed);
+  s_vision_events.fetch_add(1, std::memory_order_relaxed);
+}
 
-  // Read until \n or timeout
-  int pos = 0;
-  TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeout_ms);
-  while (pos < (int)resp_size - 1) {
+// Legacy transport: accumulate one byte of a newline-terminated line, dropping control
+// characters. Streamed events are published on the spot; returns true when a reply line
+// is complete in s_vision_line.
+static bool vision_line_push(uint8_t byte) {
+  if (byte == '\n') {
+    if (s_vision_line_len == 0) return false;
+    s_vision_line[s_vision_line_len] = '\0';
+    if (vision_world_is_event(s_vision_line, s_vision_line_len)) {
+      vision_ingest_event(s_vision_line, s_vision_line_len);
+      s_vision_line_len = 0;
+      return false;
+    }
+    return true;
+  }
+  if (byte >= 0x20 && s_vision_line_len < (int)sizeof(s_vision_line) - 1) {
+    s_vision_line[s_vision_line_len++] = (char)byte;
+  }
+  return false;
+}
+
+// Legacy transport: read one reply line. A partial line survives between calls, so a
+// drain never splits a streamed event from its tail.
+static esp_err_t vision_read_line(char *out, size_t out_size, TickType_t deadline, int *len_out) {
+  while (1) {
     TickType_t now = xTaskGetTickCount();
     if ((int32_t)(deadline - now) <= 0) return ESP_ERR_TIMEOUT;
-    TickType_t remaining = deadline - now;
-
     uint8_t byte;
-    int rd = uart_read_bytes(kVisionUart, &byte, 1, remaining);
+    int rd = uart_read_bytes(kVisionUart, &byte, 1, deadline - now);
     if (rd <= 0) return ESP_ERR_TIMEOUT;
-    if (byte == '\n') break;
-    if (byte >= 0x20) resp[pos++] = (char)byte; // skip control chars
+    if (vision_line_push(byte)) break;
+  }
+  strlcpy(out, s_vision_line, out_size);
+  int pos = s_vision_line_len < (int)out_size - 1 ? s_vision_line_len : (int)out_size - 1;
+  s_vision_line_len = 0;
+  *len_out = pos;
+  return ESP_OK;
+}
+
+typedef bool (*vision_frame_handler_t)(const vision_frame_t *frame, void *ctx);
+
+// Framed transport: decode wire bytes and hand frames of req_id to the handler until it
+// reports completion. Frames of other requests are stale and skipped; damaged frames are
+// counted and, with stop_on_bad, end the pump so the caller can re-request. Once idle is
+// armed (by the first decoded frame or by the caller), idle_ms of silence returns
+// ESP_ERR_NOT_FINISHED. Must be called with s_vision_mutex held.
+static esp_err_t vision_pump_frames(uint16_t req_id, TickType_t deadline, bool idle_armed,
+                                    bool stop_on_bad, vision_frame_handler_t handler, void *ctx) {
+  uint8_t rx[128];
+  while (1) {
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(deadline - now) <= 0) return ESP_ERR_TIMEOUT;
+    TickType_t wait = deadline - now;
+    if (idle_armed && wait > pdMS_TO_TICKS(kVisionFrameIdleMs)) wait = pdMS_TO_TICKS(kVisionFrameIdleMs);
+
+    size_t avail = 0;
+    (void)uart_get_buffered_data_len(kVisionUart, &avail);
+    int want = avail == 0 ? 1 : (avail > sizeof(rx) ? (int)sizeof(rx) : (int)avail);
+    int rd = uart_read_bytes(kVisionUart, rx, want, avail == 0 ? wait : 0);
+    if (rd <= 0) {
+      if (idle_armed) return ESP_ERR_NOT_FINISHED;
+      continue;
+    }
+
+    for (int i = 0; i < rd; i++) {
+      vision_frame_t frame;
+      vision_frame_status_t st = vision_frame_decoder_push(&s_vision_dec, rx[i], &frame);
+      if (st == VISION_FRAME_NEED_MORE) continue;
+      if (st == VISION_FRAME_OK) {
+        if (frame.type == VISION_FRAME_EVENT) {
+          vision_ingest_event((const char *)frame.payload, frame.len);
+          continue;
+        }
+        if (frame.req_id != req_id) continue;
+        idle_armed = true;
+        if (handler(&frame, ctx)) return ESP_OK;
+        continue;
+      }
+      idle_armed = true;
+      s_vision_frame_errors.fetch_add(1, std::memory_order_relaxed);
+      if (stop_on_bad) return ESP_ERR_INVALID_CRC;
+    }
+  }
+}
+
+// Consumes whatever is already buffered without blocking: streamed events are published,
+// stale replies are dropped. Used between commands instead of flushing the RX buffer.
+// Must be called with s_vision_mutex held.
+static void vision_events_drain(void) {
+  uint8_t rx[128];
+  bool framed = s_vision_framed.load(std::memory_order_relaxed);
+  while (1) {
+    size_t avail = 0;
+    (void)uart_get_buffered_data_len(kVisionUart, &avail);
+    if (avail == 0) return;
+    int rd = uart_read_bytes(kVisionUart, rx, avail > sizeof(rx) ? sizeof(rx) : avail, 0);
+    if (rd <= 0) return;
+    for (int i = 0; i < rd; i++) {
+      if (!framed) {
+        if (vision_line_push(rx[i])) s_vision_line_len = 0;
+        continue;
+      }
+      vision_frame_t frame;
+      vision_frame_status_t st = vision_frame_decoder_push(&s_vision_dec, rx[i], &frame);
+      if (st == VISION_FRAME_OK && frame.type == VISION_FRAME_EVENT) {
+        vision_ingest_event((const char *)frame.payload, frame.len);
+      } else if (st != VISION_FRAME_OK && st != VISION_FRAME_NEED_MORE) {
+        s_vision_frame_errors.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+// Drops all receive state (after a rate change the buffered bytes are garbage).
+static void vision_rx_reset(void) {
+  uart_flush_input(kVisionUart);
+  vision_frame_decoder_reset(&s_vision_dec);
+  s_vision_line_len = 0;
+}
+
+// Asks the camera to retransmit individual frames of an earlier response. The camera
+// answers with the original frames (original req_id and seq), not with a JSON reply.
+static esp_err_t vision_resend(uint32_t orig_rid, const uint16_t *seqs, int count) {
+  char args[160];
+  int n = snprintf(args, sizeof(args), "{\"req_id\":%u,\"seqs\":[", (unsigned)(uint16_t)orig_rid);
+  for (int i = 0; i < count && n < (int)sizeof(args); i++) {
+    n += snprintf(args + n, sizeof(args) - n, "%s%u", i ? "," : "", (unsigned)seqs[i]);
+  }
+  if (n >= (int)sizeof(args) - 3) return ESP_ERR_NO_MEM;
+  strlcat(args, "]}", sizeof(args));
+  return vision_write_request(++s_vision_req_id, "RESEND", args);
+}
+
+typedef struct {
+  char *resp;
+  size_t resp_size;
+  int len;
+} vision_json_reply_t;
+
+static bool vision_json_reply_handler(const vision_frame_t *frame, void *ctx) {
+  vision_json_reply_t *reply = (vision_json_reply_t *)ctx;
+  if (frame->type != VISION_FRAME_JSON || frame->seq != 0) return false;
+  int pos = 0;
+  for (uint16_t i = 0; i < frame->len && pos < (int)reply->resp_size - 1; i++) {
+    if (frame->payload[i] >= 0x20) reply->resp[pos++] = (char)frame->payload[i];
+  }
+  reply->resp[pos] = '\0';
+  reply->len = pos;
+  return true;
+}
+
+// Single request/response exchange over either transport. Callers must hold s_vision_mutex.
+static esp_err_t vision_cmd_exchange(const char *cmd, const char *args_json,
+                                     char *resp, size_t resp_size, int timeout_ms) {
+  uint32_t rid = ++s_vision_req_id;
+  vision_events_drain();
+
+  esp_err_t err = vision_write_request(rid, cmd, args_json);
+  if (err != ESP_OK) return err;
+
+  TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeout_ms);
+  int pos = 0;
+  int resent = 0;
+  if (s_vision_framed.load(std::memory_order_relaxed)) {
+    vision_json_reply_t reply = {.resp = resp, .resp_size = resp_size, .len = 0};
+    err = vision_pump_frames((uint16_t)rid, deadline, false, true, vision_json_reply_handler, &reply);
+    // A damaged reply is re-requested instead of re-running the command.
+    while ((err == ESP_ERR_INVALID_CRC || (err == ESP_ERR_NOT_FINISHED && resent > 0)) &&
+           resent < kVisionResendRounds) {
+      uint16_t seq = 0;
+      resent++;
+      err = vision_resend(rid, &seq, 1);
+      if (err != ESP_OK) return err;
+      err = vision_pump_frames((uint16_t)rid, deadline, true, true, vision_json_reply_handler, &reply);
+    }
+    if (err == ESP_ERR_NOT_FINISHED) {
+      // The command may still be running (RESEND of a pending reply is ignored): keep waiting.
+      err = vision_pump_frames((uint16_t)rid, deadline, false, false, vision_json_reply_handler, &reply);
+    }
+    if (err == ESP_ERR_INVALID_CRC || err == ESP_ERR_NOT_FINISHED) err = ESP_ERR_INVALID_RESPONSE;
+    if (err != ESP_OK) return err;
+    pos = reply.len;
+  } else {
+    err = vision_read_line(resp, resp_size, deadline, &pos);
+    if (err != ESP_OK) return err;
   }
-  resp[pos] = '\0';
-  if (pos == 0) return ESP_ERR_TIMEOUT;
 
   rover_log_field_t fields[] = {
     rover_log_field_str("cmd", cmd),
     rover_log_field_int("resp_bytes", pos),
+    rover_log_field_int("resent", resent),
   };
   rover_log_record_t rec = {
     .level = ESP_LOG_INFO,
@@ -610,199 +1127,753 @@ static esp_err_t vision_cmd_timeout(const char *cmd, const char *args_json,
   return ESP_OK;
 }
 
-static esp_err_t vision_cmd(const char *cmd, const char *args_json,
-                            char *resp, size_t resp_size) {
-  return vision_cmd_timeout(cmd, args_json, resp, resp_size, kVisionTimeoutMs);
-}
+// ── Vision link rate negotiation ──
+// Protocol (see docs/vision-protocol.md): BAUD is acknowledged at the old rate, then both
+// sides switch. The camera reverts to 115200 on its own if no valid command arrives at the
+// new rate within its confirm window, or after repeated undecodable lines.
 
-static esp_err_t vision_capture(int quality, uint8_t **jpeg_out, size_t *jpeg_size_out) {
-  *jpeg_out = NULL;
-  *jpeg_size_out = 0;
+static esp_err_t vision_uart_set_baud(int baud) {
+  (void)uart_wait_tx_done(kVisionUart, pdMS_TO_TICKS(100));
+  esp_err_t err = uart_set_baudrate(kVisionUart, (uint32_t)baud);
+  if (err != ESP_OK) return err;
+  vTaskDelay(pdMS_TO_TICKS(kVisionBaudSwitchSettleMs));
+  vision_rx_reset();
+  s_vision_baud.store(baud, std::memory_order_relaxed);
+  s_vision_err_streak = 0;
+  return ESP_OK;
+}
 
-  uint32_t rid = ++s_vision_req_id;
-  char req[128];
-  int n = snprintf(req, sizeof(req),
-                   "{\"cmd\":\"CAPTURE\",\"req_id\":\"%" PRIu32 "\",\"args\":{\"quality\":%d}}\n",
-                   rid, quality);
-  if (n >= (int)sizeof(req)) return ESP_ERR_NO_MEM;
+// Must be called with s_vision_mutex held.
+static void vision_link_fallback(const char *reason) {
+  int from = s_vision_baud.load(std::memory_order_relaxed);
+  if (from == kVisionBaud) return;
 
-  uart_flush_input(kVisionUart);
-  int sent = uart_write_bytes(kVisionUart, req, n);
-  if (sent != n) return ESP_FAIL;
+  // Best effort: ask the camera to drop back as well. If the line is too noisy for this to
+  // arrive, the camera's own revert rule brings it back to 115200.
+  char resp[96];
+  char args[32];
+  snprintf(args, sizeof(args), "{\"baud\":%d}", kVisionBaud);
+  (void)vision_cmd_exchange("BAUD", args, resp, sizeof(resp), kVisionPingTimeoutMs);
+  (void)vision_uart_set_baud(kVisionBaud);
+  s_vision_baud_retry_tick = xTaskGetTickCount() + kVisionBaudRetryPeriod;
 
-  TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(kVisionCaptureTimeoutMs);
+  rover_log_field_t fields[] = {
+    rover_log_field_int("from_baud", from),
+    rover_log_field_int("to_baud", kVisionBaud),
+    rover_log_field_str("reason", reason),
+  };
+  rover_log_record_t rec = {
+    .level = ESP_LOG_WARN,
+    .component = TAG,
+    .event = "vision_baud_fallback",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
+}
 
-  // Phase 1: read JSON header until \n
-  char hdr[256];
-  int pos = 0;
-  while (pos < (int)sizeof(hdr) - 1) {
-    TickType_t now = xTaskGetTickCount();
-    if ((int32_t)(deadline - now) <= 0) return ESP_ERR_TIMEOUT;
-    uint8_t byte;
-    int rd = uart_read_bytes(kVisionUart, &byte, 1, deadline - now);
-    if (rd <= 0) return ESP_ERR_TIMEOUT;
-    if (byte == '\n') break;
-    if (byte >= 0x20) hdr[pos++] = (char)byte;
+// Counts link-level failures (no reply / garbled reply) and falls back on an error burst.
+// Must be called with s_vision_mutex held.
+static void vision_link_record(esp_err_t err) {
+  if (err != ESP_ERR_TIMEOUT && err != ESP_ERR_INVALID_RESPONSE) {
+    s_vision_err_streak = 0;
+    return;
+  }
+  s_vision_err_streak++;
+  if (s_vision_baud.load(std::memory_order_relaxed) != kVisionBaud &&
+      s_vision_err_streak >= kVisionBaudErrorBurst) {
+    vision_link_fallback("error_burst");
   }
-  hdr[pos] = '\0';
-  if (pos == 0) return ESP_ERR_TIMEOUT;
+}
 
-  // Parse JSON header
-  cJSON *root = cJSON_Parse(hdr);
-  if (!root) return ESP_ERR_INVALID_RESPONSE;
+// Try the fast rates in order after a good PING at the boot rate.
+// Must be called with s_vision_mutex held.
+static void vision_link_negotiate(void) {
+  if (s_vision_baud.load(std::memory_order_relaxed) != kVisionBaud) return;
+  if (s_vision_baud_unsupported) return;
+  if ((int32_t)(xTaskGetTickCount() - s_vision_baud_retry_tick) < 0) return;
+
+  int refused = 0;
+  const int candidates = (int)(sizeof(kVisionFastBauds) / sizeof(kVisionFastBauds[0]));
+  for (int i = 0; i < candidates; i++) {
+    int baud = kVisionFastBauds[i];
+    char args[32];
+    char resp[128];
+    snprintf(args, sizeof(args), "{\"baud\":%d}", baud);
+    esp_err_t err = vision_cmd_exchange("BAUD", args, resp, sizeof(resp), kVisionPingTimeoutMs);
+    if (err != ESP_OK) break;  // camera went quiet; retry after the backoff
+    if (!json_tok_ok(resp, sizeof(resp))) {
+      refused++;
+      continue;
+    }
 
-  cJSON *ok_field = cJSON_GetObjectItem(root, "ok");
-  if (!cJSON_IsTrue(ok_field)) {
-    cJSON_Delete(root);
-    return ESP_FAIL;
+    if (vision_uart_set_baud(baud) == ESP_OK) {
+      char ping_resp[128];
+      esp_err_t ping_err =
+          vision_cmd_exchange("PING", "{}", ping_resp, sizeof(ping_resp), kVisionPingTimeoutMs);
+      if (ping_err == ESP_OK && json_tok_ok(ping_resp, sizeof(ping_resp))) {
+        rover_log_field_t fields[] = {
+          rover_log_field_int("baud", baud),
+          rover_log_field_int("prev_baud", kVisionBaud),
+        };
+        rover_log_record_t rec = {
+          .level = ESP_LOG_INFO,
+          .component = TAG,
+          .event = "vision_baud_negotiated",
+          .fields = fields,
+          .field_count = sizeof(fields) / sizeof(fields[0]),
+        };
+        rover_log(&rec);
+        return;
+      }
+    }
+
+    // Confirmation failed: go back and let the camera's confirm window expire.
+    (void)vision_uart_set_baud(kVisionBaud);
+    vTaskDelay(pdMS_TO_TICKS(kVisionBaudConfirmMs));
   }
 
-  cJSON *result = cJSON_GetObjectItem(root, "result");
-  cJSON *size_field = result ? cJSON_GetObjectItem(result, "size") : NULL;
-  if (!size_field || !cJSON_IsNumber(size_field)) {
-    cJSON_Delete(root);
-    return ESP_ERR_INVALID_RESPONSE;
+  s_vision_baud_retry_tick = xTaskGetTickCount() + kVisionBaudRetryPeriod;
+  if (refused == candidates) {
+    // Camera firmware without BAUD support; stay at the boot rate until it reconnects.
+    s_vision_baud_unsupported = true;
   }
-  int jpeg_size = size_field->valueint;
-  cJSON_Delete(root);
+  rover_log_field_t fields[] = {
+    rover_log_field_int("baud", kVisionBaud),
+    rover_log_field_bool("unsupported", s_vision_baud_unsupported),
+  };
+  rover_log_record_t rec = {
+    .level = ESP_LOG_INFO,
+    .component = TAG,
+    .event = "vision_baud_negotiate_failed",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
+}
 
-  if (jpeg_size <= 0 || jpeg_size > kCaptureMaxJpegBytes) return ESP_ERR_INVALID_RESPONSE;
+// Switch to the framed transport once the camera answers a framed PING. Old camera scripts
+// cannot parse the frame and stay silent, so a timeout means "not supported".
+// Must be called with s_vision_mutex held.
+static void vision_link_probe_framing(void) {
+  if (s_vision_framed.load(std::memory_order_relaxed) || s_vision_framed_unsupported) return;
 
-  // Phase 2: read binary JPEG data
-  uint8_t *buf = (uint8_t *)malloc(jpeg_size);
-  if (!buf) return ESP_ERR_NO_MEM;
+  char resp[128];
+  s_vision_framed.store(true, std::memory_order_relaxed);
+  esp_err_t err = vision_cmd_exchange("PING", "{}", resp, sizeof(resp), kVisionPingTimeoutMs);
+  bool ok = (err == ESP_OK && json_tok_ok(resp, sizeof(resp)));
+  if (!ok) {
+    s_vision_framed.store(false, std::memory_order_relaxed);
+    s_vision_framed_unsupported = true;
+    // Let the camera drop whatever partial line the frame left in its buffer.
+    char line_resp[128];
+    (void)vision_cmd_exchange("PING", "{}", line_resp, sizeof(line_resp), kVisionPingTimeoutMs);
+  }
 
-  int total = 0;
-  while (total < jpeg_size) {
-    TickType_t now = xTaskGetTickCount();
-    if ((int32_t)(deadline - now) <= 0) { free(buf); return ESP_ERR_TIMEOUT; }
-    int want = jpeg_size - total;
-    if (want > kCaptureChunkSize) want = kCaptureChunkSize;
-    int rd = uart_read_bytes(kVisionUart, buf + total, want, deadline - now);
-    if (rd <= 0) { free(buf); return ESP_ERR_TIMEOUT; }
-    total += rd;
+  rover_log_field_t fields[] = {
+    rover_log_field_int("baud", s_vision_baud.load(std::memory_order_relaxed)),
+    rover_log_field_str("err", esp_err_to_name(err)),
+  };
+  rover_log_record_t rec = {
+    .level = ESP_LOG_INFO,
+    .component = TAG,
+    .event = ok ? "vision_framing_enabled" : "vision_framing_unsupported",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
+}
+
+// Ask the camera to stream detection events; liveness then comes from that traffic and the
+// periodic PING is only used when the stream goes quiet. Must be called with s_vision_mutex held.
+static void vision_link_subscribe(void) {
+  if (s_vision_subscribed.load(std::memory_order_relaxed) || s_vision_subscribe_unsupported) return;
+
+  char args[32];
+  char resp[128];
+  snprintf(args, sizeof(args), "{\"rate_hz\":%d}", kVisionSubscribeHz);
+  esp_err_t err = vision_cmd_exchange("SUBSCRIBE", args, resp, sizeof(resp), kVisionPingTimeoutMs);
+  if (err != ESP_OK) return;  // retried on the next PING
+  bool subscribed = json_tok_ok(resp, sizeof(resp));
+  if (!subscribed) {
+    s_vision_subscribe_unsupported = true;
+  } else {
+    s_vision_subscribed.store(true, std::memory_order_relaxed);
+    // Grace period for the first event.
+    s_vision_last_event_ms.store((uint32_t)esp_log_timestamp(), std::memory_order_relaxed);
   }
 
   rover_log_field_t fields[] = {
-    rover_log_field_str("cmd", "CAPTURE"),
-    rover_log_field_int("jpeg_bytes", jpeg_size),
+    rover_log_field_int("rate_hz", kVisionSubscribeHz),
   };
   rover_log_record_t rec = {
     .level = ESP_LOG_INFO,
     .component = TAG,
-    .event = "vision_capture_ok",
+    .event = subscribed ? "vision_subscribed" : "vision_subscribe_unsupported",
     .fields = fields,
     .field_count = sizeof(fields) / sizeof(fields[0]),
   };
   rover_log(&rec);
+}
 
-  *jpeg_out = buf;
-  *jpeg_size_out = (size_t)jpeg_size;
-  return ESP_OK;
+// Age of the newest streamed event, or -1 when not subscribed.
+static int32_t vision_stream_age_ms(void) {
+  if (!s_vision_subscribed.load(std::memory_order_relaxed)) return -1;
+  return (int32_t)((uint32_t)esp_log_timestamp() -
+                   s_vision_last_event_ms.load(std::memory_order_relaxed));
 }
 
-static esp_err_t rover_init_i2c(void) {
-  if (!M5.Ex_I2C.begin(I2C_NUM_0, kI2cSdaPin, kI2cSclPin)) {
-    return ESP_FAIL;
-  }
+// ── Adaptive timeouts ──
 
-  uint8_t zero[4] = {0, 0, 0, 0};
-  return rover_write(0x00, zero, sizeof(zero));
+static void op_rto_publish(op_rto_t *o) {
+  o->srtt_ms.store(o->est.srtt_ms, std::memory_order_relaxed);
+  o->timeout_ms.store(rto_timeout_ms(&o->est), std::memory_order_relaxed);
+  o->samples.store(o->est.samples, std::memory_order_relaxed);
+  o->timeouts.store(o->est.timeouts, std::memory_order_relaxed);
 }
 
-static void set_motion(int8_t x, int8_t y, int8_t z, bool active) {
-  s_motion_x = x;
-  s_motion_y = y;
-  s_motion_z = z;
-  s_motion_active = active;
+static void op_rto_init(op_rto_t *o, const char *name, uint32_t initial_ms, uint32_t min_ms, uint32_t max_ms) {
+  o->name = name;
+  rto_init(&o->est, initial_ms, min_ms, max_ms);
+  op_rto_publish(o);
 }
 
-static void mark_activity(void) {
-  s_last_activity_tick.store((uint32_t)xTaskGetTickCount(), std::memory_order_relaxed);
+static void op_rto_sample(op_rto_t *o, uint32_t ms) {
+  rto_sample(&o->est, ms);
+  op_rto_publish(o);
 }
 
-static void apply_motion(void) {
-  static int8_t last_x = 127;
-  static int8_t last_y = 127;
-  static int8_t last_z = 127;
-  int8_t x = s_motion_active ? s_motion_x : 0;
-  int8_t y = s_motion_active ? s_motion_y : 0;
-  int8_t z = s_motion_active ? s_motion_z : 0;
-  if (x == last_x && y == last_y && z == last_z) {
-    return;
-  }
-  (void)rover_set_speed(x, y, z);
-  last_x = x;
-  last_y = y;
-  last_z = z;
+static void op_rto_timed_out(op_rto_t *o) {
+  rto_timed_out(&o->est);
+  op_rto_publish(o);
 }
 
-static void apply_action(const char *action, bool from_web) {
-  TickType_t now = xTaskGetTickCount();
-  mark_activity();
-  if (strcmp(action, "forward") == 0) {
-    set_motion(0, kMoveSpeed, 0, true);
-  } else if (strcmp(action, "back") == 0 || strcmp(action, "backward") == 0) {
-    set_motion(0, -kMoveSpeed, 0, true);
-  } else if (strcmp(action, "left") == 0) {
-    set_motion(-kMoveSpeed, 0, 0, true);
-  } else if (strcmp(action, "right") == 0) {
-    set_motion(kMoveSpeed, 0, 0, true);
-  } else if (strcmp(action, "rotate_left") == 0) {
-    set_motion(0, 0, -60, true);
-  } else if (strcmp(action, "rotate_right") == 0) {
-    set_motion(0, 0, 60, true);
-  } else if (strcmp(action, "open") == 0) {
-    s_gripper_open = true;
-    (void)rover_set_servo_angle(kGripperServo, kGripperOpenAngle);
-  } else if (strcmp(action, "close") == 0) {
-    s_gripper_open = false;
-    (void)rover_set_servo_angle(kGripperServo, kGripperCloseAngle);
-  } else {
-    set_motion(0, 0, 0, false);
+static void init_timeouts(void) {
+  static const char *const kVisionNames[VISION_RTO_COUNT] = {"scan", "scan_fast", "objects", "who", "info"};
+  for (int i = 0; i < VISION_RTO_COUNT; ++i) {
+    op_rto_init(&s_vision_rto[i], kVisionNames[i], kVisionTimeoutMs, kVisionTimeoutMinMs, kVisionTimeoutMaxMs);
   }
+  static const char *const kCaptureNames[3] = {"capture_qqvga", "capture_qvga", "capture_qvga_hq"};
+  for (int i = 0; i < 3; ++i) {
+    op_rto_init(&s_capture_rto[i], kCaptureNames[i], kVisionCaptureTimeoutMs, kVisionCaptureTimeoutMinMs,
+                kVisionCaptureTimeoutMaxMs);
+  }
+  op_rto_init(&s_action_rto, "action_slack", kAiActionSlackMs, kAiActionSlackMinMs, kAiActionSlackMaxMs);
+}
 
-  if (from_web) {
-    if (s_motion_active) {
-      s_web_motion_deadline = now + pdMS_TO_TICKS(1500);
-    } else {
-      s_web_motion_deadline = 0;
-    }
+static op_rto_t *vision_rto(const char *cmd, const char *args_json) {
+  if (strcmp(cmd, "SCAN") == 0) {
+    bool fast = args_json != NULL && strstr(args_json, "\"FAST\"") != NULL;
+    return &s_vision_rto[fast ? VISION_RTO_SCAN_FAST : VISION_RTO_SCAN];
   }
+  if (strcmp(cmd, "OBJECTS") == 0) return &s_vision_rto[VISION_RTO_OBJECTS];
+  if (strcmp(cmd, "WHO") == 0) return &s_vision_rto[VISION_RTO_WHO];
+  if (strcmp(cmd, "INFO") == 0) return &s_vision_rto[VISION_RTO_INFO];
+  return NULL;
 }
 
-static void enter_deep_sleep(void) {
-  rover_emergency_stop();
-  rover_log_record_t rec = {
-    .level = ESP_LOG_INFO,
-    .component = TAG,
-    .event = "power_deep_sleep_enter",
-    .fields = NULL,
-    .field_count = 0,
-  };
-  rover_log(&rec);
-  draw_boot_status("sleeping...", "press A/B wake");
-  vTaskDelay(pdMS_TO_TICKS(200));
+static op_rto_t *capture_rto(int quality, capture_res_t res) {
+  if (res == CAPTURE_RES_QQVGA) return &s_capture_rto[0];
+  return &s_capture_rto[quality < 60 ? 1 : 2];
+}
 
-  // Shutdown mDNS, WiFi and display before sleep
-  mdns_free();
-  esp_wifi_disconnect();
-  esp_wifi_stop();
-  M5.Display.setBrightness(0);
-  M5.Display.sleep();
+static TickType_t ai_action_slack(void) {
+  return pdMS_TO_TICKS(s_action_rto.timeout_ms.load(std::memory_order_relaxed));
+}
 
-  // Reset previous wake sources and reconfigure button pins for RTC wake.
-  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
-  (void)rtc_gpio_deinit(kBtnAPin);
-  (void)rtc_gpio_deinit(kBtnBPin);
-  (void)rtc_gpio_init(kBtnAPin);
-  (void)rtc_gpio_init(kBtnBPin);
-  (void)rtc_gpio_set_direction(kBtnAPin, RTC_GPIO_MODE_INPUT_ONLY);
-  (void)rtc_gpio_set_direction(kBtnBPin, RTC_GPIO_MODE_INPUT_ONLY);
-  (void)rtc_gpio_pulldown_dis(kBtnAPin);
-  (void)rtc_gpio_pulldown_dis(kBtnBPin);
+// "name":{...} members for /metrics, comma-separated.
+static int timeouts_json(char *out, size_t size) {
+  const op_rto_t *ops[VISION_RTO_COUNT + 3 + 1];
+  size_t count = 0;
+  for (const op_rto_t &o : s_vision_rto) ops[count++] = &o;
+  for (const op_rto_t &o : s_capture_rto) ops[count++] = &o;
+  ops[count++] = &s_action_rto;
+  size_t len = 0;
+  for (size_t i = 0; i < count; ++i) {
+    int w = snprintf(out + len, size - len,
+                     "%s\"%s\":{\"srtt_ms\":%" PRIu32 ",\"timeout_ms\":%" PRIu32 ",\"n\":%" PRIu32 ","
+                     "\"timeouts\":%" PRIu32 "}",
+                     i ? "," : "", ops[i]->name, ops[i]->srtt_ms.load(std::memory_order_relaxed),
+                     ops[i]->timeout_ms.load(std::memory_order_relaxed),
+                     ops[i]->samples.load(std::memory_order_relaxed),
+                     ops[i]->timeouts.load(std::memory_order_relaxed));
+    if (w < 0 || (size_t)w >= size - len) return -1;
+    len += (size_t)w;
+  }
+  ai_model_stats_t models[AI_MODEL_TIERS_MAX];
+  size_t model_count = ai_client_model_stats(models, AI_MODEL_TIERS_MAX);
+  for (size_t i = 0; i < model_count; ++i) {
+    int w = snprintf(out + len, size - len,
+                     ",\"llm:%s\":{\"srtt_ms\":%" PRIu32 ",\"timeout_ms\":%" PRIu32 ",\"n\":%" PRIu32 ","
+                     "\"timeouts\":%" PRIu32 "}",
+                     models[i].model, models[i].srtt_ms, models[i].timeout_ms, models[i].requests,
+                     models[i].timeouts);
+    if (w < 0 || (size_t)w >= size - len) return -1;
+    len += (size_t)w;
+  }
+  return (int)len;
+}
 
-  // BtnA (G37) — ext0, wakeup on LOW (active-low button)
+static esp_err_t vision_cmd_timeout(const char *cmd, const char *args_json,
+                                    char *resp, size_t resp_size, int timeout_ms) {
+  trace_span_t span = trace_begin(TRACE_UART, cmd);
+  esp_err_t err = vision_cmd_exchange(cmd, args_json, resp, resp_size, timeout_ms);
+  trace_end(&span, err);
+  vision_link_record(err);
+  return err;
+}
+
+static esp_err_t vision_cmd(const char *cmd, const char *args_json,
+                            char *resp, size_t resp_size) {
+  op_rto_t *rto = vision_rto(cmd, args_json);
+  int timeout_ms = rto ? (int)rto_timeout_ms(&rto->est) : kVisionTimeoutMs;
+  int64_t start_us = esp_timer_get_time();
+  esp_err_t err = vision_cmd_timeout(cmd, args_json, resp, resp_size, timeout_ms);
+  if (rto && err == ESP_OK) op_rto_sample(rto, (uint32_t)((esp_timer_get_time() - start_us) / 1000));
+  if (rto && err == ESP_ERR_TIMEOUT) op_rto_timed_out(rto);
+  return err;
+}
+
+// Parses a CAPTURE header reply. ESP_FAIL means the camera reported an error.
+static esp_err_t vision_parse_capture_header(const char *hdr, int *size_out, int *chunk_out) {
+  json_tok_t toks[24];
+  json_doc_t doc;
+  int n = json_tok_parse(&doc, hdr, strlen(hdr), toks, sizeof(toks) / sizeof(toks[0]));
+  if (n < 0 && n != JSON_TOK_ERR_NOMEM) return ESP_ERR_INVALID_RESPONSE;
+
+  bool ok = false;
+  if (!json_tok_bool(&doc, json_tok_get(&doc, 0, "ok"), &ok) || !ok) return ESP_FAIL;
+
+  int result = json_tok_get(&doc, 0, "result");
+  if (!json_tok_int(&doc, json_tok_get(&doc, result, "size"), size_out)) {
+    return ESP_ERR_INVALID_RESPONSE;
+  }
+  *chunk_out = 0;
+  (void)json_tok_int(&doc, json_tok_get(&doc, result, "chunk"), chunk_out);
+
+  if (*size_out <= 0 || *size_out > kCaptureMaxJpegBytes) return ESP_ERR_INVALID_RESPONSE;
+  return ESP_OK;
+}
+
+// Where CAPTURE bytes go. begin() gets the JPEG size from the header. A sink that sets buf
+// there takes the bytes in place (out-of-order chunks are fine); otherwise write() receives
+// them strictly in order and may stream them onward.
+typedef struct vision_jpeg_sink vision_jpeg_sink_t;
+struct vision_jpeg_sink {
+  esp_err_t (*begin)(vision_jpeg_sink_t *sink, size_t size);
+  esp_err_t (*write)(vision_jpeg_sink_t *sink, const uint8_t *data, size_t len);
+  void *ctx;
+  uint8_t *buf;
+};
+
+// Legacy transport: header line followed by raw JPEG bytes.
+static esp_err_t vision_capture_read_line(TickType_t deadline, vision_jpeg_sink_t *sink,
+                                          int *size_out, uint32_t *xfer_start_ms_out) {
+  char hdr[256];
+  int hdr_len = 0;
+  esp_err_t err = vision_read_line(hdr, sizeof(hdr), deadline, &hdr_len);
+  if (err != ESP_OK) return err;
+
+  int jpeg_size = 0;
+  int chunk = 0;
+  err = vision_parse_capture_header(hdr, &jpeg_size, &chunk);
+  if (err != ESP_OK) return err;
+  err = sink->begin(sink, (size_t)jpeg_size);
+  if (err != ESP_OK) return err;
+
+  uint8_t tmp[512];
+  *xfer_start_ms_out = (uint32_t)esp_log_timestamp();
+  int total = 0;
+  while (total < jpeg_size) {
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(deadline - now) <= 0) return ESP_ERR_TIMEOUT;
+    int want = jpeg_size - total;
+    int cap = sink->buf ? kCaptureChunkSize : (int)sizeof(tmp);
+    if (want > cap) want = cap;
+    uint8_t *dst = sink->buf ? sink->buf + total : tmp;
+    int rd = uart_read_bytes(kVisionUart, dst, want, deadline - now);
+    if (rd <= 0) return ESP_ERR_TIMEOUT;
+    if (!sink->buf) {
+      // No retransmission in line mode: a sink slower than the link loses the frame.
+      err = sink->write(sink, tmp, (size_t)rd);
+      if (err != ESP_OK) return err;
+    }
+    total += rd;
+  }
+  *size_out = jpeg_size;
+  return ESP_OK;
+}
+
+// Framed CAPTURE reply: JSON header as seq 0, then JPEG chunks as DATA seq 1..N.
+typedef struct {
+  vision_jpeg_sink_t *sink;
+  int size;
+  int chunk;
+  int chunks;
+  int received;
+  int next;  // first chunk not yet delivered to an in-order sink
+  bool have_header;
+  esp_err_t status;
+  uint32_t xfer_start_ms;
+  bool got[kCaptureMaxChunks];
+} vision_capture_rx_t;
+
+static bool vision_capture_frame_handler(const vision_frame_t *frame, void *ctx) {
+  vision_capture_rx_t *rx = (vision_capture_rx_t *)ctx;
+  if (frame->type == VISION_FRAME_JSON && frame->seq == 0) {
+    if (rx->have_header) return false;  // duplicate after a RESEND
+    char hdr[256];
+    size_t n = frame->len < sizeof(hdr) - 1 ? frame->len : sizeof(hdr) - 1;
+    memcpy(hdr, frame->payload, n);
+    hdr[n] = '\0';
+    rx->status = vision_parse_capture_header(hdr, &rx->size, &rx->chunk);
+    if (rx->status == ESP_OK &&
+        (rx->chunk < kCaptureFrameChunkMin || rx->chunk > VISION_FRAME_PAYLOAD_MAX)) {
+      rx->status = ESP_ERR_INVALID_RESPONSE;
+    }
+    if (rx->status == ESP_OK) rx->status = rx->sink->begin(rx->sink, (size_t)rx->size);
+    if (rx->status != ESP_OK) return true;
+    rx->chunks = (rx->size + rx->chunk - 1) / rx->chunk;
+    rx->have_header = true;
+    rx->xfer_start_ms = (uint32_t)esp_log_timestamp();
+    return false;
+  }
+  if (frame->type != VISION_FRAME_DATA || !rx->have_header) return false;
+
+  int idx = (int)frame->seq - 1;
+  if (idx < 0 || idx >= rx->chunks || rx->got[idx]) return false;
+  int off = idx * rx->chunk;
+  int expect = rx->size - off < rx->chunk ? rx->size - off : rx->chunk;
+  if (frame->len != expect) return false;  // treated as lost; re-requested below
+  if (rx->sink->buf) {
+    memcpy(rx->sink->buf + off, frame->payload, expect);
+  } else {
+    // In-order sink: chunks after a gap are dropped and re-requested with it.
+    if (idx != rx->next) return false;
+    rx->status = rx->sink->write(rx->sink, frame->payload, (size_t)expect);
+    if (rx->status != ESP_OK) return true;
+  }
+  rx->got[idx] = true;
+  rx->received++;
+  while (rx->next < rx->chunks && rx->got[rx->next]) rx->next++;
+  return rx->received == rx->chunks;
+}
+
+static esp_err_t vision_capture_read_framed(uint32_t rid, TickType_t deadline,
+                                            vision_jpeg_sink_t *sink, int *size_out,
+                                            uint32_t *xfer_start_ms_out, int *resent_out) {
+  vision_capture_rx_t rx = {};
+  rx.sink = sink;
+  rx.status = ESP_OK;
+  esp_err_t err = vision_pump_frames((uint16_t)rid, deadline, false, false,
+                                     vision_capture_frame_handler, &rx);
+
+  // Re-request only what is missing; give up after several rounds without progress.
+  int stalled = 0;
+  int progress = rx.received + (rx.have_header ? 1 : 0);
+  while (err == ESP_ERR_NOT_FINISHED && rx.status == ESP_OK && stalled < kVisionResendRounds) {
+    uint16_t seqs[kVisionResendBatch];
+    int count = 0;
+    if (!rx.have_header) {
+      seqs[count++] = 0;
+    } else {
+      for (int i = rx.next; i < rx.chunks && count < kVisionResendBatch; i++) {
+        if (!rx.got[i]) seqs[count++] = (uint16_t)(i + 1);
+      }
+    }
+    *resent_out += count;
+    err = vision_resend(rid, seqs, count);
+    if (err != ESP_OK) break;
+    err = vision_pump_frames((uint16_t)rid, deadline, true, false, vision_capture_frame_handler, &rx);
+
+    int now_progress = rx.received + (rx.have_header ? 1 : 0);
+    stalled = now_progress > progress ? 0 : stalled + 1;
+    progress = now_progress;
+  }
+
+  if (err == ESP_OK) err = rx.status;
+  if (err == ESP_ERR_NOT_FINISHED) err = ESP_ERR_INVALID_RESPONSE;
+  if (err != ESP_OK) return err;
+  *size_out = rx.size;
+  *xfer_start_ms_out = rx.xfer_start_ms;
+  return ESP_OK;
+}
+
+static esp_err_t vision_capture_exchange(int quality, capture_res_t res, vision_jpeg_sink_t *sink,
+                                         size_t *jpeg_size_out) {
+  *jpeg_size_out = 0;
+
+  uint32_t rid = ++s_vision_req_id;
+  char args[48];
+  snprintf(args, sizeof(args), "{\"quality\":%d,\"res\":\"%s\"}", quality, capture_res_name(res));
+  uint32_t start_ms = (uint32_t)esp_log_timestamp();
+
+  vision_events_drain();
+  esp_err_t err = vision_write_request(rid, "CAPTURE", args);
+  if (err != ESP_OK) return err;
+
+  op_rto_t *rto = capture_rto(quality, res);
+  TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(rto_timeout_ms(&rto->est));
+  bool framed = s_vision_framed.load(std::memory_order_relaxed);
+  int jpeg_size = 0;
+  uint32_t xfer_start_ms = 0;
+  int resent = 0;
+  if (framed) {
+    err = vision_capture_read_framed(rid, deadline, sink, &jpeg_size, &xfer_start_ms, &resent);
+  } else {
+    err = vision_capture_read_line(deadline, sink, &jpeg_size, &xfer_start_ms);
+  }
+  if (err == ESP_ERR_TIMEOUT) op_rto_timed_out(rto);
+  if (err != ESP_OK) return err;
+
+  uint32_t end_ms = (uint32_t)esp_log_timestamp();
+  uint32_t xfer_ms = end_ms - xfer_start_ms;
+  uint32_t total_ms = end_ms - start_ms;
+  uint32_t bps = (uint32_t)(((uint64_t)jpeg_size * 1000u) / (xfer_ms > 0 ? xfer_ms : 1));
+  s_vision_last_bps.store(bps, std::memory_order_relaxed);
+  int baud = s_vision_baud.load(std::memory_order_relaxed);
+  capture_ctl_observe(res, quality, baud, (uint32_t)jpeg_size, total_ms, xfer_ms);
+  op_rto_sample(rto, total_ms);
+
+  rover_log_field_t fields[] = {
+    rover_log_field_str("cmd", "CAPTURE"),
+    rover_log_field_int("jpeg_bytes", jpeg_size),
+    rover_log_field_int("quality", quality),
+    rover_log_field_str("res", capture_res_name(res)),
+    rover_log_field_int("baud", baud),
+    rover_log_field_int("total_ms", total_ms),
+    rover_log_field_int("xfer_ms", xfer_ms),
+    rover_log_field_int("bps", bps),
+    rover_log_field_bool("framed", framed),
+    rover_log_field_int("resent", resent),
+  };
+  rover_log_record_t rec = {
+    .level = ESP_LOG_INFO,
+    .component = TAG,
+    .event = "vision_capture_ok",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
+
+  *jpeg_size_out = (size_t)jpeg_size;
+  return ESP_OK;
+}
+
+// Callers must hold s_vision_mutex (it also serialises the capture controller).
+static esp_err_t vision_capture_to(int quality, capture_res_t res, vision_jpeg_sink_t *sink,
+                                   size_t *jpeg_size_out) {
+  trace_span_t span = trace_begin(TRACE_UART, "CAPTURE");
+  esp_err_t err = vision_capture_exchange(quality, res, sink, jpeg_size_out);
+  trace_end(&span, err);
+  if (err == ESP_ERR_TIMEOUT || err == ESP_ERR_INVALID_RESPONSE) {
+    capture_ctl_observe_failure(res, quality, s_vision_baud.load(std::memory_order_relaxed));
+  }
+  vision_link_record(err);
+  return err;
+}
+
+static esp_err_t vision_buffer_sink_begin(vision_jpeg_sink_t *sink, size_t size) {
+  sink->buf = (uint8_t *)malloc(size);
+  return sink->buf ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+// Whole frame in one heap buffer; the caller frees *jpeg_out.
+static esp_err_t vision_capture(int quality, capture_res_t res, uint8_t **jpeg_out,
+                                size_t *jpeg_size_out) {
+  vision_jpeg_sink_t sink = {.begin = vision_buffer_sink_begin, .write = NULL, .ctx = NULL, .buf = NULL};
+  esp_err_t err = vision_capture_to(quality, res, &sink, jpeg_size_out);
+  if (err != ESP_OK) {
+    free(sink.buf);
+    *jpeg_out = NULL;
+    return err;
+  }
+  *jpeg_out = sink.buf;
+  return ESP_OK;
+}
+
+// Lets the capture controller pick quality/resolution for the consumer's budget.
+// Callers must hold s_vision_mutex.
+static capture_plan_t vision_capture_plan(capture_consumer_t consumer) {
+  capture_plan_t plan = capture_ctl_plan(consumer, s_vision_baud.load(std::memory_order_relaxed));
+  rover_log_field_t fields[] = {
+    rover_log_field_str("consumer", capture_consumer_name(consumer)),
+    rover_log_field_int("quality", plan.quality),
+    rover_log_field_str("res", capture_res_name(plan.res)),
+    rover_log_field_int("predicted_bytes", plan.predicted_bytes),
+    rover_log_field_int("predicted_ms", plan.predicted_ms),
+    rover_log_field_bool("within_budget", plan.within_budget),
+  };
+  rover_log_record_t rec = {
+    .level = ESP_LOG_DEBUG,
+    .component = TAG,
+    .event = "vision_capture_plan",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
+  return plan;
+}
+
+static esp_err_t vision_capture_auto(capture_consumer_t consumer, uint8_t **jpeg_out,
+                                     size_t *jpeg_size_out) {
+  capture_plan_t plan = vision_capture_plan(consumer);
+  return vision_capture(plan.quality, plan.res, jpeg_out, jpeg_size_out);
+}
+
+static esp_err_t rover_init_i2c(void) {
+  if (!M5.Ex_I2C.begin(I2C_NUM_0, kI2cSdaPin, kI2cSclPin)) {
+    return ESP_FAIL;
+  }
+
+  uint8_t zero[4] = {0, 0, 0, 0};
+  return rover_write(0x00, zero, sizeof(zero));
+}
+
+static void set_motion(int8_t x, int8_t y, int8_t z, bool active) {
+  s_motion_x = x;
+  s_motion_y = y;
+  s_motion_z = z;
+  s_motion_active = active;
+}
+
+static void mark_activity(void) {
+  s_last_activity_tick.store((uint32_t)xTaskGetTickCount(), std::memory_order_relaxed);
+}
+
+static void apply_motion(void) {
+  int8_t x = s_motion_active ? s_motion_x : 0;
+  int8_t y = s_motion_active ? s_motion_y : 0;
+  int8_t z = s_motion_active ? s_motion_z : 0;
+  if (x == s_applied_x && y == s_applied_y && z == s_applied_z) {
+    return;
+  }
+  (void)rover_set_speed(x, y, z);
+  s_applied_x = x;
+  s_applied_y = y;
+  s_applied_z = z;
+}
+
+// Must be called with s_state_mutex held, after someone else drove the motors directly.
+static void motion_forget_applied(void) {
+  s_applied_x = s_applied_y = s_applied_z = 127;
+}
+
+// Must be called with s_state_mutex held. result: reached, lost, or why it was stopped.
+static void track_log_done(const char *result) {
+  rover_log_field_t fields[] = {
+    rover_log_field_str("target", s_track.label[0] ? s_track.label : "any"),
+    rover_log_field_str("mode", track_mode_name(s_track.mode)),
+    rover_log_field_str("result", result),
+    rover_log_field_int("width", s_track.width),
+    rover_log_field_int("ms", (int64_t)((uint32_t)esp_log_timestamp() - s_track.started_ms)),
+  };
+  rover_log_record_t rec = {
+    .level = ESP_LOG_INFO,
+    .component = TAG,
+    .event = "track_done",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
+}
+
+// Must be called with s_state_mutex held. Any other motion source takes over from tracking.
+static void track_stop_locked(const char *reason) {
+  if (!s_track.active) return;
+  track_ctl_stop(&s_track);
+  set_motion(0, 0, 0, false);
+  track_log_done(reason);
+}
+
+// Must be called with s_state_mutex held.
+static void track_start_locked(track_mode_t mode, const char *label, const char *source) {
+  track_stop_locked(source);
+  s_web_motion_deadline = 0;
+  track_ctl_start(&s_track, mode, label, (uint32_t)esp_log_timestamp());
+  mark_activity();
+  rover_log_field_t fields[] = {
+    rover_log_field_str("target", label[0] ? label : "any"),
+    rover_log_field_str("mode", track_mode_name(mode)),
+    rover_log_field_str("source", source),
+  };
+  rover_log_record_t rec = {
+    .level = ESP_LOG_INFO,
+    .component = TAG,
+    .event = "track_start",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
+}
+
+static void apply_action(const char *action, bool from_web) {
+  TickType_t now = xTaskGetTickCount();
+  mark_activity();
+  track_stop_locked(from_web ? "web" : "action");
+  if (strcmp(action, "forward") == 0) {
+    set_motion(0, kMoveSpeed, 0, true);
+  } else if (strcmp(action, "back") == 0 || strcmp(action, "backward") == 0) {
+    set_motion(0, -kMoveSpeed, 0, true);
+  } else if (strcmp(action, "left") == 0) {
+    set_motion(-kMoveSpeed, 0, 0, true);
+  } else if (strcmp(action, "right") == 0) {
+    set_motion(kMoveSpeed, 0, 0, true);
+  } else if (strcmp(action, "rotate_left") == 0) {
+    set_motion(0, 0, -60, true);
+  } else if (strcmp(action, "rotate_right") == 0) {
+    set_motion(0, 0, 60, true);
+  } else if (strcmp(action, "open") == 0) {
+    s_gripper_open = true;
+    (void)rover_set_servo_angle(kGripperServo, kGripperOpenAngle);
+  } else if (strcmp(action, "close") == 0) {
+    s_gripper_open = false;
+    (void)rover_set_servo_angle(kGripperServo, kGripperCloseAngle);
+  } else {
+    set_motion(0, 0, 0, false);
+  }
+
+  if (from_web) {
+    if (s_motion_active) {
+      s_web_motion_deadline = now + pdMS_TO_TICKS(1500);
+    } else {
+      s_web_motion_deadline = 0;
+    }
+  }
+}
+
+static void enter_deep_sleep(void) {
+  rover_emergency_stop();
+  rover_log_record_t rec = {
+    .level = ESP_LOG_INFO,
+    .component = TAG,
+    .event = "power_deep_sleep_enter",
+    .fields = NULL,
+    .field_count = 0,
+  };
+  rover_log(&rec);
+  draw_boot_status("sleeping...", "press A/B wake");
+  vTaskDelay(pdMS_TO_TICKS(200));
+
+  // Shutdown mDNS, WiFi and display before sleep
+  mdns_free();
+  esp_wifi_disconnect();
+  esp_wifi_stop();
+  M5.Display.setBrightness(0);
+  M5.Display.sleep();
+
+  // Reset previous wake sources and reconfigure button pins for RTC wake.
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+  (void)rtc_gpio_deinit(kBtnAPin);
+  (void)rtc_gpio_deinit(kBtnBPin);
+  (void)rtc_gpio_init(kBtnAPin);
+  (void)rtc_gpio_init(kBtnBPin);
+  (void)rtc_gpio_set_direction(kBtnAPin, RTC_GPIO_MODE_INPUT_ONLY);
+  (void)rtc_gpio_set_direction(kBtnBPin, RTC_GPIO_MODE_INPUT_ONLY);
+  (void)rtc_gpio_pulldown_dis(kBtnAPin);
+  (void)rtc_gpio_pulldown_dis(kBtnBPin);
+
+  // BtnA (G37) — ext0, wakeup on LOW (active-low button)
   // Note: GPIO37/GPIO39 are input-only on ESP32; internal pull-ups may be unavailable,
   // so wake reliability depends on the board's external button circuitry.
   (void)rtc_gpio_pullup_en(kBtnAPin);
@@ -870,10 +1941,10 @@ static inline int clamp_int(int v, int lo, int hi) {
 static char *make_tool_response(const char *status, const char *action) {
   char buf[96];
   snprintf(buf, sizeof(buf), "{\"status\":\"%s\",\"action\":\"%s\"}", status, action);
-  return strdup(buf);
+  return turn_arena_strdup(buf);
 }
 
-static bool ai_action_wait_result_obj(uint32_t req_id, TickType_t timeout, ai_action_result_t *out) {
+static bool ai_action_wait_result_raw(uint32_t req_id, TickType_t timeout, ai_action_result_t *out) {
   if (s_ai_action_result_queue == NULL) {
     if (out) {
       *out = {};
@@ -923,10 +1994,12 @@ static bool ai_action_wait_result_obj(uint32_t req_id, TickType_t timeout, ai_ac
   }
 }
 
-static bool ai_action_wait_result(uint32_t req_id, TickType_t timeout, esp_err_t *err_out) {
+static bool ai_action_wait_result_obj(uint32_t req_id, TickType_t timeout, ai_action_result_t *out) {
+  trace_span_t span = trace_begin(TRACE_ACTION, "wait_result");
   ai_action_result_t result = {};
-  bool ok = ai_action_wait_result_obj(req_id, timeout, &result);
-  if (err_out) *err_out = result.err;
+  bool ok = ai_action_wait_result_raw(req_id, timeout, &result);
+  trace_end(&span, result.err);
+  if (out) *out = result;
   return ok;
 }
 
@@ -948,13 +2021,67 @@ static void ai_action_send_result(uint32_t req_id, esp_err_t err) {
     .req_id = req_id,
     .err = err,
     .turn_measured_deg = 0.0f,
+    .run_ms = 0,
   };
   ai_action_send_result_obj(&result);
 }
 
+// ── Asynchronous actions ──
+// A long move or turn started with async:true returns a handle and an ETA at once, so the
+// model can plan its next step while the motors run; the outcome is picked up later.
+
+static uint32_t ai_async_remaining_ms_locked(const ai_async_action_t *a, uint32_t now_ms) {
+  uint32_t elapsed = now_ms - a->started_ms;
+  return (a->done || elapsed >= a->eta_ms) ? 0 : a->eta_ms - elapsed;
+}
+
+// Longest time until every async action still queued or running is done.
+static uint32_t ai_async_backlog_ms(void) {
+  if (s_ai_async_mutex == NULL) return 0;
+  uint32_t now_ms = (uint32_t)esp_log_timestamp();
+  uint32_t backlog = 0;
+  xSemaphoreTake(s_ai_async_mutex, portMAX_DELAY);
+  for (const ai_async_action_t &a : s_ai_async) {
+    if (a.handle == 0) continue;
+    uint32_t remaining = ai_async_remaining_ms_locked(&a, now_ms);
+    if (remaining > backlog) backlog = remaining;
+  }
+  xSemaphoreGive(s_ai_async_mutex);
+  return backlog;
+}
+
+static void ai_async_complete(const ai_action_result_t *result) {
+  xSemaphoreTake(s_ai_async_mutex, portMAX_DELAY);
+  for (ai_async_action_t &a : s_ai_async) {
+    if (a.handle != result->req_id) continue;
+    a.done = true;
+    a.err = result->err;
+    a.turn_measured_deg = result->turn_measured_deg;
+  }
+  xSemaphoreGive(s_ai_async_mutex);
+}
+
+// Forgets reported outcomes between turns; actions still running keep their slots.
+static void ai_async_reset(void) {
+  xSemaphoreTake(s_ai_async_mutex, portMAX_DELAY);
+  for (ai_async_action_t &a : s_ai_async) {
+    if (a.done) a = {};
+  }
+  xSemaphoreGive(s_ai_async_mutex);
+}
+
+static void ai_action_complete(const ai_action_req_t *req, const ai_action_result_t *result) {
+  if (req->async) {
+    ai_async_complete(result);
+  } else {
+    ai_action_send_result_obj(result);
+  }
+}
+
 static void ai_action_apply_stop_state(void) {
   rover_emergency_stop();
   xSemaphoreTake(s_state_mutex, portMAX_DELAY);
+  track_stop_locked("ai");
   set_motion(0, 0, 0, false);
   s_web_motion_deadline = 0;
   xSemaphoreGive(s_state_mutex);
@@ -1000,6 +2127,7 @@ static esp_err_t ai_action_execute_on_core0(const ai_action_req_t *req, ai_actio
   rover_state_t prev_state = STATE_IDLE;
   bool restore_ai_state = false;
   xSemaphoreTake(s_state_mutex, portMAX_DELAY);
+  track_stop_locked("ai");
   prev_state = s_rover_state;
   if (s_rover_state == STATE_AI_THINKING || s_rover_state == STATE_AI_EXECUTING) {
     transition_to(STATE_AI_EXECUTING);
@@ -1016,8 +2144,7 @@ static esp_err_t ai_action_execute_on_core0(const ai_action_req_t *req, ai_actio
 
     while ((int32_t)(end - xTaskGetTickCount()) > 0) {
       esp_task_wdt_reset();
-      M5.update();
-      if (M5.BtnB.isPressed()) {
+      if (s_btn_b_held.load(std::memory_order_relaxed)) {
         action_err = ESP_ERR_INVALID_STATE;
         break;
       }
@@ -1043,8 +2170,7 @@ static esp_err_t ai_action_execute_on_core0(const ai_action_req_t *req, ai_actio
     while (turned < target &&
            (xTaskGetTickCount() - start_tick) < pdMS_TO_TICKS(req->turn_timeout_ms)) {
       esp_task_wdt_reset();
-      M5.update();
-      if (M5.BtnB.isPressed()) {
+      if (s_btn_b_held.load(std::memory_order_relaxed)) {
         action_err = ESP_ERR_INVALID_STATE;
         break;
       }
@@ -1108,41 +2234,195 @@ static esp_err_t ai_action_execute_on_core0(const ai_action_req_t *req, ai_actio
   return action_err;
 }
 
-static void ai_action_poll_and_execute(void) {
-  if (s_ai_action_queue == NULL) return;
-  if (s_ai_action_queue_mutex == NULL) return;
-  ai_action_req_t req = {};
-  xSemaphoreTake(s_ai_action_queue_mutex, portMAX_DELAY);
-  BaseType_t got = xQueueReceive(s_ai_action_queue, &req, 0);
-  xSemaphoreGive(s_ai_action_queue_mutex);
-  if (got != pdTRUE) {
-    return;
+// Core 0, above main_loop_task: runs queued actions to completion (a move or turn blocks
+// for seconds) without stalling the control loop, display, heartbeat or deadman.
+static void ai_action_task(void *arg) {
+  (void)arg;
+  esp_task_wdt_add(NULL);
+  while (1) {
+    esp_task_wdt_reset();
+    ai_action_req_t req = {};
+    // Peek first: the queue lock must not be held while blocking, and
+    // ai_action_cancel_pending may empty the queue before we take it.
+    if (xQueuePeek(s_ai_action_queue, &req, kAiActionIdlePoll) != pdTRUE) continue;
+    xSemaphoreTake(s_ai_action_queue_mutex, portMAX_DELAY);
+    BaseType_t got = xQueueReceive(s_ai_action_queue, &req, 0);
+    if (got == pdTRUE) s_ai_action_running.store(true, std::memory_order_relaxed);
+    xSemaphoreGive(s_ai_action_queue_mutex);
+    if (got != pdTRUE) continue;
+
+    ai_action_result_t result = {
+      .req_id = req.req_id,
+      .err = ESP_OK,
+      .turn_measured_deg = 0.0f,
+      .run_ms = 0,
+    };
+    TickType_t start = xTaskGetTickCount();
+    result.err = ai_action_execute_on_core0(&req, &result);
+    result.run_ms = (uint32_t)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS);
+    s_ai_action_running.store(false, std::memory_order_relaxed);
+    ai_action_complete(&req, &result);
   }
-  ai_action_result_t result = {
-    .req_id = req.req_id,
-    .err = ESP_OK,
-    .turn_measured_deg = 0.0f,
-  };
-  result.err = ai_action_execute_on_core0(&req, &result);
-  ai_action_send_result_obj(&result);
 }
 
-static char *cb_move(const char *fn, const char *arguments, void *ud) {
-  (void)fn; (void)ud;
-  int x = 0, y = 0, z = 0, duration_ms = 1500;
-  cJSON *args = cJSON_Parse(arguments ? arguments : "{}");
-  if (args) {
-    cJSON *v;
-    v = cJSON_GetObjectItem(args, "x"); if (v && cJSON_IsNumber(v)) x = v->valueint;
-    v = cJSON_GetObjectItem(args, "y"); if (v && cJSON_IsNumber(v)) y = v->valueint;
-    v = cJSON_GetObjectItem(args, "z"); if (v && cJSON_IsNumber(v)) z = v->valueint;
-    v = cJSON_GetObjectItem(args, "duration_ms"); if (v && cJSON_IsNumber(v)) duration_ms = v->valueint;
-    cJSON_Delete(args);
+static void plan_rec_add(intent_kind_t kind, int8_t x, int8_t y, int8_t z, uint16_t duration_ms,
+                         bool turn_left, uint16_t angle_deg, uint8_t speed_pct) {
+  if (s_plan_rec.count >= INTENT_MAX_STEPS) return;
+  intent_step_t *step = &s_plan_rec.steps[s_plan_rec.count++];
+  memset(step, 0, sizeof(*step));
+  step->kind = kind;
+  step->x = x;
+  step->y = y;
+  step->z = z;
+  step->duration_ms = duration_ms;
+  step->turn_left = turn_left;
+  step->angle_deg = angle_deg;
+  step->speed_pct = speed_pct;
+}
+
+// Queues one action for core 0 and assigns its req_id. ESP_ERR_NOT_SUPPORTED: no executor;
+// ESP_ERR_INVALID_STATE: queue full.
+static esp_err_t ai_action_submit(ai_action_req_t *req) {
+  if (s_ai_action_queue == NULL || s_ai_action_queue_mutex == NULL) return ESP_ERR_NOT_SUPPORTED;
+  req->req_id = ++s_ai_action_req_seq;
+  xSemaphoreTake(s_ai_action_queue_mutex, portMAX_DELAY);
+  BaseType_t sent = xQueueSend(s_ai_action_queue, req, 0);
+  xSemaphoreGive(s_ai_action_queue_mutex);
+  return sent == pdTRUE ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+// Queues one action and waits for its result; the wait also covers async actions still
+// ahead of it in the queue. Errors as ai_action_submit, otherwise the wait or action outcome.
+static esp_err_t ai_action_run(ai_action_req_t *req, TickType_t timeout, ai_action_result_t *out) {
+  req->async = false;
+  esp_err_t err = ai_action_submit(req);
+  if (err != ESP_OK) return err;
+  uint32_t backlog_ms = ai_async_backlog_ms();
+  timeout += pdMS_TO_TICKS(backlog_ms);
+  TickType_t start = xTaskGetTickCount();
+  ai_action_result_t result = {};
+  bool answered = ai_action_wait_result_obj(req->req_id, timeout, &result);
+  // The slack estimate covers what is left once the action's own time is taken out; an
+  // async backlog ahead of it would skew that.
+  uint32_t waited_ms = (uint32_t)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS);
+  if (answered && backlog_ms == 0) {
+    op_rto_sample(&s_action_rto, waited_ms > result.run_ms ? waited_ms - result.run_ms : 0);
+  } else if (!answered && result.err == ESP_ERR_TIMEOUT) {
+    op_rto_timed_out(&s_action_rto);
+  }
+  if (out) *out = result;
+  return result.err;
+}
+
+// Queues req as an async action and returns at once; *eta_ms bounds when it will be done.
+// Errors as ai_action_submit; ESP_ERR_INVALID_STATE also when every async slot holds an
+// outcome the model has not seen yet.
+static esp_err_t ai_action_start(ai_action_req_t *req, const char *name, uint32_t max_ms,
+                                 uint32_t *eta_ms) {
+  if (s_ai_async_mutex == NULL) return ESP_ERR_NOT_SUPPORTED;
+  *eta_ms = ai_async_backlog_ms() + max_ms;
+  req->async = true;
+  // Held across the submit: core 0 may finish the action before the slot is filled otherwise.
+  xSemaphoreTake(s_ai_async_mutex, portMAX_DELAY);
+  ai_async_action_t *slot = NULL;
+  for (ai_async_action_t &a : s_ai_async) {
+    if (a.handle == 0 || (a.done && a.noted)) {
+      slot = &a;
+      break;
+    }
+  }
+  esp_err_t err = slot != NULL ? ai_action_submit(req) : ESP_ERR_INVALID_STATE;
+  if (err == ESP_OK) {
+    *slot = {};
+    slot->handle = req->req_id;
+    slot->name = name;
+    slot->started_ms = (uint32_t)esp_log_timestamp();
+    slot->eta_ms = *eta_ms;
+  }
+  xSemaphoreGive(s_ai_async_mutex);
+  return err;
+}
+
+// Tool status for an ai_action_run() outcome.
+static const char *action_status(esp_err_t err) {
+  switch (err) {
+    case ESP_OK: return "ok";
+    case ESP_ERR_NOT_SUPPORTED: return "unavailable";
+    case ESP_ERR_INVALID_STATE: return "busy";
+    case ESP_ERR_TIMEOUT: return "timeout";
+    default: return "failed";
+  }
+}
+
+static char *make_async_response(esp_err_t err, const char *action, uint32_t handle, uint32_t eta_ms) {
+  if (err != ESP_OK) return make_tool_response(action_status(err), action);
+  char buf[112];
+  snprintf(buf, sizeof(buf),
+           "{\"status\":\"started\",\"action\":\"%s\",\"handle\":%" PRIu32 ",\"eta_ms\":%" PRIu32 "}",
+           action, handle, eta_ms);
+  return turn_arena_strdup(buf);
+}
+
+// Appends one JSON object per async action matching handle (0: all) to out and marks the
+// finished ones as reported; done_only skips those still running. Returns the count.
+static int ai_async_describe_locked(char *out, size_t size, size_t *len, uint32_t handle, bool done_only) {
+  uint32_t now_ms = (uint32_t)esp_log_timestamp();
+  int count = 0;
+  for (ai_async_action_t &a : s_ai_async) {
+    if (a.handle == 0 || (handle != 0 && a.handle != handle) || (done_only && (!a.done || a.noted))) continue;
+    int n;
+    if (!a.done) {
+      n = snprintf(out + *len, size - *len,
+                   "%s{\"handle\":%" PRIu32 ",\"action\":\"%s\",\"state\":\"running\",\"remaining_ms\":%" PRIu32 "}",
+                   count ? "," : "", a.handle, a.name, ai_async_remaining_ms_locked(&a, now_ms));
+    } else if (strcmp(a.name, "turn") == 0) {
+      n = snprintf(out + *len, size - *len,
+                   "%s{\"handle\":%" PRIu32 ",\"action\":\"turn\",\"state\":\"done\",\"status\":\"%s\",\"measured_deg\":%.1f}",
+                   count ? "," : "", a.handle, action_status(a.err), (double)a.turn_measured_deg);
+    } else {
+      n = snprintf(out + *len, size - *len,
+                   "%s{\"handle\":%" PRIu32 ",\"action\":\"%s\",\"state\":\"done\",\"status\":\"%s\"}",
+                   count ? "," : "", a.handle, a.name, action_status(a.err));
+    }
+    if (n < 0 || (size_t)n >= size - *len) break;
+    *len += (size_t)n;
+    if (a.done) a.noted = true;
+    count++;
   }
-  x = clamp_int(x, -100, 100);
-  y = clamp_int(y, -100, 100);
-  z = clamp_int(z, -100, 100);
-  duration_ms = clamp_int(duration_ms, 100, 5000);
+  return count;
+}
+
+// ai_chat_config_t.round_note: async actions that finished since the model last heard.
+static size_t ai_async_round_note(char *out, size_t size, void *ctx) {
+  (void)ctx;
+  static const char kPrefix[] = "{\"completed\":[";
+  if (s_ai_async_mutex == NULL || size < sizeof(kPrefix) + 2) return 0;
+  size_t len = strlcpy(out, kPrefix, size);
+  xSemaphoreTake(s_ai_async_mutex, portMAX_DELAY);
+  int count = ai_async_describe_locked(out, size - 2, &len, 0, true);
+  xSemaphoreGive(s_ai_async_mutex);
+  if (count == 0) return 0;
+  len += strlcpy(out + len, "]}", size - len);
+  return len;
+}
+
+enum { kMoveX, kMoveY, kMoveZ, kMoveDurationMs, kMoveAsync };
+static const ai_tool_param_t kMoveParams[] = {
+    {"x", AI_PARAM_INT, "Lateral speed, left negative", true, NULL, -100, 100, 0},
+    {"y", AI_PARAM_INT, "Forward speed, back negative", true, NULL, -100, 100, 0},
+    {"z", AI_PARAM_INT, "Rotation speed", false, NULL, -100, 100, 0},
+    {"duration_ms", AI_PARAM_INT, "Move duration in ms", false, NULL, 100, 5000, 1500},
+    {"async", AI_PARAM_BOOL, "Return at once with a handle instead of waiting; see wait_action", false, NULL, 0, 0, 0},
+    {NULL, AI_PARAM_INT, NULL, false, NULL, 0, 0, 0},
+};
+
+static char *cb_move(const ai_tool_args_t *args, void *ud) {
+  (void)ud;
+  int x = args->num[kMoveX];
+  int y = args->num[kMoveY];
+  int z = args->num[kMoveZ];
+  int duration_ms = args->num[kMoveDurationMs];
+  bool async = args->num[kMoveAsync] != 0;
 
   mark_activity();
   rover_log_field_t fields[] = {
@@ -1150,6 +2430,7 @@ static char *cb_move(const char *fn, const char *arguments, void *ud) {
     rover_log_field_int("y", y),
     rover_log_field_int("z", z),
     rover_log_field_int("duration_ms", duration_ms),
+    rover_log_field_bool("async", async),
   };
   rover_log_record_t rec = {
     .level = ESP_LOG_INFO,
@@ -1160,69 +2441,46 @@ static char *cb_move(const char *fn, const char *arguments, void *ud) {
   };
   rover_log(&rec);
 
-  if (s_ai_action_queue == NULL) {
-    return make_tool_response("unavailable", "move");
-  }
-  if (s_ai_action_queue_mutex == NULL) {
-    return make_tool_response("unavailable", "move");
-  }
-
-  ai_action_req_t req = {
-    .req_id = ++s_ai_action_req_seq,
-    .kind = AI_ACTION_MOVE,
-    .x = (int8_t)x,
-    .y = (int8_t)y,
-    .z = (int8_t)z,
-    .duration_ms = (uint16_t)duration_ms,
-    .turn_target_deg = 0,
-    .turn_timeout_ms = 0,
-  };
-  xSemaphoreTake(s_ai_action_queue_mutex, portMAX_DELAY);
-  BaseType_t sent = xQueueSend(s_ai_action_queue, &req, 0);
-  xSemaphoreGive(s_ai_action_queue_mutex);
-  if (sent != pdTRUE) {
-    return make_tool_response("busy", "move");
-  }
-  esp_err_t action_err = ESP_OK;
-  TickType_t wait_timeout = pdMS_TO_TICKS(duration_ms) + kAiActionResultTimeoutSlack;
-  if (!ai_action_wait_result(req.req_id, wait_timeout, &action_err)) {
-    return make_tool_response("timeout", "move");
+  ai_action_req_t req = {};
+  req.kind = AI_ACTION_MOVE;
+  req.x = (int8_t)x;
+  req.y = (int8_t)y;
+  req.z = (int8_t)z;
+  req.duration_ms = (uint16_t)duration_ms;
+  if (async) {
+    uint32_t eta_ms = 0;
+    esp_err_t err = ai_action_start(&req, "move", (uint32_t)duration_ms, &eta_ms);
+    return make_async_response(err, "move", req.req_id, eta_ms);
   }
-  if (action_err != ESP_OK) {
-    return make_tool_response("failed", "move");
+  esp_err_t err = ai_action_run(&req, pdMS_TO_TICKS(duration_ms) + ai_action_slack(), NULL);
+  if (err == ESP_OK) {
+    plan_rec_add(INTENT_MOVE, (int8_t)x, (int8_t)y, (int8_t)z, (uint16_t)duration_ms, false, 0, 0);
   }
-
-  return make_tool_response("ok", "move"); // openrouter_client frees this
+  return make_tool_response(action_status(err), "move"); // the chat loop (ai_client) frees this
 }
 
-static char *cb_turn(const char *fn, const char *arguments, void *ud) {
-  (void)fn; (void)ud;
-  const char *direction = "left";
-  int angle_deg = 90, speed_pct = 50;
-  char dir_buf[8] = "left";
-
-  cJSON *args = cJSON_Parse(arguments ? arguments : "{}");
-  if (args) {
-    cJSON *v;
-    v = cJSON_GetObjectItem(args, "direction");
-    if (v && cJSON_IsString(v)) {
-      strlcpy(dir_buf, v->valuestring, sizeof(dir_buf));
-      direction = dir_buf;
-    }
-    v = cJSON_GetObjectItem(args, "angle_deg"); if (v && cJSON_IsNumber(v)) angle_deg = v->valueint;
-    v = cJSON_GetObjectItem(args, "speed_percent"); if (v && cJSON_IsNumber(v)) speed_pct = v->valueint;
-    cJSON_Delete(args);
-  }
-
+static const char *kTurnDirEnum[] = {"left", "right", NULL};
+enum { kTurnDirection, kTurnAngleDeg, kTurnSpeedPct, kTurnAsync };
+static const ai_tool_param_t kTurnParams[] = {
+    {"direction", AI_PARAM_STRING, "Turn direction", true, kTurnDirEnum, 0, 0, 0},
+    {"angle_deg", AI_PARAM_INT, "Target angle in degrees", false, NULL, 5, 360, 90},
+    {"speed_percent", AI_PARAM_INT, "Rotation speed percent", false, NULL, 20, 100, 50},
+    {"async", AI_PARAM_BOOL, "Return at once with a handle instead of waiting; see wait_action", false, NULL, 0, 0, 0},
+    {NULL, AI_PARAM_INT, NULL, false, NULL, 0, 0, 0},
+};
+
+static char *cb_turn(const ai_tool_args_t *args, void *ud) {
+  (void)ud;
   if (!M5.Imu.isEnabled()) {
     return make_tool_response("imu_unavailable", "turn");
   }
 
-  bool turn_left = (strcmp(direction, "right") != 0);
-  float target = (float)clamp_int(angle_deg, 5, 360);
-  int8_t spd = (int8_t)clamp_int(speed_pct, 20, 100);
+  bool turn_left = args->num[kTurnDirection] == 0;
+  float target = (float)args->num[kTurnAngleDeg];
+  int8_t spd = (int8_t)args->num[kTurnSpeedPct];
   int8_t turn_z = turn_left ? (int8_t)-spd : spd;
   uint32_t timeout_ms = (uint32_t)clamp_int((int)(target * 100.0f), 2000, 12000);
+  bool async = args->num[kTurnAsync] != 0;
 
   mark_activity();
   rover_log_field_t fields[] = {
@@ -1230,6 +2488,7 @@ static char *cb_turn(const char *fn, const char *arguments, void *ud) {
     rover_log_field_int("angle_deg", (int)target),
     rover_log_field_int("speed_pct", spd),
     rover_log_field_int("timeout_ms", timeout_ms),
+    rover_log_field_bool("async", async),
   };
   rover_log_record_t rec = {
     .level = ESP_LOG_INFO,
@@ -1240,189 +2499,258 @@ static char *cb_turn(const char *fn, const char *arguments, void *ud) {
   };
   rover_log(&rec);
 
-  if (s_ai_action_queue == NULL) {
-    return make_tool_response("unavailable", "turn");
-  }
-  if (s_ai_action_queue_mutex == NULL) {
-    return make_tool_response("unavailable", "turn");
-  }
-
-  ai_action_req_t req = {
-    .req_id = ++s_ai_action_req_seq,
-    .kind = AI_ACTION_TURN,
-    .x = 0,
-    .y = 0,
-    .z = turn_z,
-    .duration_ms = 0,
-    .turn_target_deg = (uint16_t)target,
-    .turn_timeout_ms = (uint16_t)timeout_ms,
-  };
-  xSemaphoreTake(s_ai_action_queue_mutex, portMAX_DELAY);
-  BaseType_t sent = xQueueSend(s_ai_action_queue, &req, 0);
-  xSemaphoreGive(s_ai_action_queue_mutex);
-  if (sent != pdTRUE) {
-    return make_tool_response("busy", "turn");
+  ai_action_req_t req = {};
+  req.kind = AI_ACTION_TURN;
+  req.z = turn_z;
+  req.turn_target_deg = (uint16_t)target;
+  req.turn_timeout_ms = (uint16_t)timeout_ms;
+  if (async) {
+    uint32_t eta_ms = 0;
+    esp_err_t err = ai_action_start(&req, "turn", timeout_ms, &eta_ms);
+    return make_async_response(err, "turn", req.req_id, eta_ms);
   }
-
   ai_action_result_t result = {};
-  TickType_t wait_timeout = pdMS_TO_TICKS(timeout_ms) + kAiActionResultTimeoutSlack;
-  if (!ai_action_wait_result_obj(req.req_id, wait_timeout, &result)) {
-    result.err = ESP_ERR_TIMEOUT;
-  }
-
-  const char *status = "failed";
-  if (result.err == ESP_OK) {
-    status = "ok";
-  } else if (result.err == ESP_ERR_TIMEOUT) {
-    status = "timeout";
+  esp_err_t err = ai_action_run(&req, pdMS_TO_TICKS(timeout_ms) + ai_action_slack(), &result);
+  if (err == ESP_OK) {
+    plan_rec_add(INTENT_TURN, 0, 0, 0, 0, turn_left, (uint16_t)target, (uint8_t)spd);
   }
 
   char payload[160];
   snprintf(payload, sizeof(payload),
            "{\"status\":\"%s\",\"action\":\"turn\",\"target_deg\":%.1f,\"measured_deg\":%.1f}",
-           status, (double)target, (double)result.turn_measured_deg);
-  return strdup(payload); // openrouter_client frees this
+           action_status(err), (double)target, (double)result.turn_measured_deg);
+  return turn_arena_strdup(payload); // the chat loop (ai_client) frees this
 }
 
-static char *cb_stop(const char *fn, const char *arguments, void *ud) {
-  (void)fn; (void)arguments; (void)ud;
+// Argument-less tools that map one-to-one onto an executor action (user_data).
+typedef struct {
+  ai_action_kind_t kind;
+  intent_kind_t step;  // for the plan cache
+  const char *name;
+  const char *event;
+} tool_action_t;
+
+static const tool_action_t kStopAction = {AI_ACTION_STOP, INTENT_STOP, "stop", "tool_stop"};
+static const tool_action_t kGripperOpenAction = {
+    AI_ACTION_GRIPPER_OPEN, INTENT_GRIPPER_OPEN, "gripper_open", "tool_gripper_open"};
+static const tool_action_t kGripperCloseAction = {
+    AI_ACTION_GRIPPER_CLOSE, INTENT_GRIPPER_CLOSE, "gripper_close", "tool_gripper_close"};
+
+static char *cb_action(const ai_tool_args_t *args, void *ud) {
+  (void)args;
+  const tool_action_t *action = (const tool_action_t *)ud;
   mark_activity();
   rover_log_record_t rec = {
     .level = ESP_LOG_INFO,
     .component = TAG,
-    .event = "tool_stop",
+    .event = action->event,
     .fields = NULL,
     .field_count = 0,
   };
   rover_log(&rec);
 
-  if (s_ai_action_queue == NULL) {
-    return make_tool_response("unavailable", "stop");
-  }
-  if (s_ai_action_queue_mutex == NULL) {
-    return make_tool_response("unavailable", "stop");
+  ai_action_req_t req = {};
+  req.kind = action->kind;
+  esp_err_t err = ai_action_run(&req, kAiStopActionTimeout, NULL);
+  if (err == ESP_OK) {
+    plan_rec_add(action->step, 0, 0, 0, 0, false, 0, 0);
   }
+  return make_tool_response(action_status(err), action->name); // the chat loop (ai_client) frees this
+}
 
-  ai_action_req_t req = {
-    .req_id = ++s_ai_action_req_seq,
-    .kind = AI_ACTION_STOP,
-    .x = 0,
-    .y = 0,
-    .z = 0,
-    .duration_ms = 0,
-    .turn_target_deg = 0,
-    .turn_timeout_ms = 0,
-  };
-  xSemaphoreTake(s_ai_action_queue_mutex, portMAX_DELAY);
-  BaseType_t sent = xQueueSend(s_ai_action_queue, &req, 0);
-  xSemaphoreGive(s_ai_action_queue_mutex);
-  if (sent != pdTRUE) {
-    return make_tool_response("busy", "stop");
-  }
-  esp_err_t action_err = ESP_OK;
-  if (!ai_action_wait_result(req.req_id, kAiStopActionTimeout, &action_err)) {
-    return make_tool_response("timeout", "stop");
+// action_status reports async actions as they stand; wait_action first blocks until the ones
+// asked for are done (bounded by their ETA).
+enum { kActionHandle };
+static const ai_tool_param_t kActionStatusParams[] = {
+    {"handle", AI_PARAM_INT, "Handle from an async move or turn; 0 for all", false, NULL, 0, INT32_MAX, 0},
+    {NULL, AI_PARAM_INT, NULL, false, NULL, 0, 0, 0},
+};
+
+static bool ai_async_settled(uint32_t handle) {
+  bool settled = true;
+  xSemaphoreTake(s_ai_async_mutex, portMAX_DELAY);
+  for (const ai_async_action_t &a : s_ai_async) {
+    if (a.handle != 0 && (handle == 0 || a.handle == handle) && !a.done) settled = false;
   }
-  if (action_err != ESP_OK) {
-    return make_tool_response("failed", "stop");
+  xSemaphoreGive(s_ai_async_mutex);
+  return settled;
+}
+
+static char *cb_action_status(const ai_tool_args_t *args, void *ud) {
+  bool wait = ud != NULL;
+  const char *name = wait ? "wait_action" : "action_status";
+  if (s_ai_async_mutex == NULL) return make_tool_response("unavailable", name);
+  uint32_t handle = (uint32_t)args->num[kActionHandle];
+
+  if (wait) {
+    TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(ai_async_backlog_ms()) +
+                          ai_action_slack();
+    while (!ai_async_settled(handle) && !s_chat_cancel.load(std::memory_order_relaxed) &&
+           (int32_t)(deadline - xTaskGetTickCount()) > 0) {
+      vTaskDelay(pdMS_TO_TICKS(50));
+    }
   }
 
-  return make_tool_response("ok", "stop"); // openrouter_client frees this
+  char buf[384];
+  size_t len = strlcpy(buf, "{\"status\":\"ok\",\"actions\":[", sizeof(buf));
+  xSemaphoreTake(s_ai_async_mutex, portMAX_DELAY);
+  int count = ai_async_describe_locked(buf, sizeof(buf) - 2, &len, handle, false);
+  xSemaphoreGive(s_ai_async_mutex);
+  if (count == 0 && handle != 0) return make_tool_response("unknown_handle", name);
+  strlcpy(buf + len, "]}", sizeof(buf) - len);
+  return turn_arena_strdup(buf);  // the chat loop (ai_client) frees this
 }
 
-static char *cb_gripper_open(const char *fn, const char *arguments, void *ud) {
-  (void)fn; (void)arguments; (void)ud;
-  mark_activity();
-  if (s_ai_action_queue == NULL) {
-    return make_tool_response("unavailable", "gripper_open");
-  }
-  if (s_ai_action_queue_mutex == NULL) {
-    return make_tool_response("unavailable", "gripper_open");
-  }
-  ai_action_req_t req = {
-    .req_id = ++s_ai_action_req_seq,
-    .kind = AI_ACTION_GRIPPER_OPEN,
-    .x = 0,
-    .y = 0,
-    .z = 0,
-    .duration_ms = 0,
-    .turn_target_deg = 0,
-    .turn_timeout_ms = 0,
-  };
-  xSemaphoreTake(s_ai_action_queue_mutex, portMAX_DELAY);
-  BaseType_t sent = xQueueSend(s_ai_action_queue, &req, 0);
-  xSemaphoreGive(s_ai_action_queue_mutex);
-  if (sent != pdTRUE) {
-    return make_tool_response("busy", "gripper_open");
-  }
-  esp_err_t action_err = ESP_OK;
-  if (!ai_action_wait_result(req.req_id, kAiStopActionTimeout, &action_err)) {
-    return make_tool_response("timeout", "gripper_open");
-  }
-  if (action_err != ESP_OK) {
-    return make_tool_response("failed", "gripper_open");
+// ── Speculative sensor prefetch ──
+// The camera and IMU sit idle while the first LLM request of a turn is in flight, and the
+// model very often opens with vision_scan or read_imu. So the chat worker snapshots the IMU
+// and asks sensor_prefetch_task for a SCAN when it starts the request; the tools answer from
+// those if they are still fresh and nothing has been actuated since. Each result serves one
+// call; anything unused when the turn ends or the rover moves counts as wasted.
+
+static void prefetch_retire_locked(void) {
+  if (s_prefetch_scan.valid && s_prefetch_scan.gen == s_prefetch_gen) {
+    s_prefetch_scan_wasted.fetch_add(1, std::memory_order_relaxed);
   }
-  rover_log_record_t rec = {
-    .level = ESP_LOG_INFO,
-    .component = TAG,
-    .event = "tool_gripper_open",
-    .fields = NULL,
-    .field_count = 0,
-  };
-  rover_log(&rec);
-  return make_tool_response("ok", "gripper_open"); // openrouter_client frees this
+  s_prefetch_scan.valid = false;
+  s_prefetch_imu.valid = false;
+  s_prefetch_scan_want = 0;
+  s_prefetch_gen++;
 }
 
-static char *cb_gripper_close(const char *fn, const char *arguments, void *ud) {
-  (void)fn; (void)arguments; (void)ud;
-  mark_activity();
-  if (s_ai_action_queue == NULL) {
-    return make_tool_response("unavailable", "gripper_close");
-  }
-  if (s_ai_action_queue_mutex == NULL) {
-    return make_tool_response("unavailable", "gripper_close");
+// Turn over, or an actuation is about to change what the sensors would report.
+static void prefetch_retire(void) {
+  xSemaphoreTake(s_prefetch_mutex, portMAX_DELAY);
+  prefetch_retire_locked();
+  xSemaphoreGive(s_prefetch_mutex);
+}
+
+static void prefetch_start(void) {
+  uint32_t now_ms = (uint32_t)esp_log_timestamp();
+  float accel[3] = {0, 0, 0};
+  float gyro[3] = {0, 0, 0};
+  bool imu_ok = M5.Imu.isEnabled() && M5.Imu.getAccel(&accel[0], &accel[1], &accel[2]) &&
+                M5.Imu.getGyro(&gyro[0], &gyro[1], &gyro[2]);
+  // With the event stream running, vision_scan answers from its snapshot anyway.
+  vision_world_t world;
+  bool streamed = s_vision_subscribed.load(std::memory_order_relaxed) &&
+                  vision_world_latest(&world) &&
+                  (now_ms - world.rx_ms) <= (uint32_t)kVisionWorldFreshMs;
+  bool want_scan = s_prefetch_task != NULL && s_vision_available.load(std::memory_order_relaxed) &&
+                   !streamed;
+
+  xSemaphoreTake(s_prefetch_mutex, portMAX_DELAY);
+  prefetch_retire_locked();
+  if (imu_ok) {
+    s_prefetch_imu.valid = true;
+    s_prefetch_imu.gen = s_prefetch_gen;
+    s_prefetch_imu.taken_ms = now_ms;
+    memcpy(s_prefetch_imu.accel, accel, sizeof(accel));
+    memcpy(s_prefetch_imu.gyro, gyro, sizeof(gyro));
   }
-  ai_action_req_t req = {
-    .req_id = ++s_ai_action_req_seq,
-    .kind = AI_ACTION_GRIPPER_CLOSE,
-    .x = 0,
-    .y = 0,
-    .z = 0,
-    .duration_ms = 0,
-    .turn_target_deg = 0,
-    .turn_timeout_ms = 0,
-  };
-  xSemaphoreTake(s_ai_action_queue_mutex, portMAX_DELAY);
-  BaseType_t sent = xQueueSend(s_ai_action_queue, &req, 0);
-  xSemaphoreGive(s_ai_action_queue_mutex);
-  if (sent != pdTRUE) {
-    return make_tool_response("busy", "gripper_close");
+  if (want_scan) s_prefetch_scan_want = s_prefetch_gen;
+  xSemaphoreGive(s_prefetch_mutex);
+  if (want_scan) xTaskNotifyGive(s_prefetch_task);
+}
+
+// Caller holds s_vision_mutex, so a SCAN the prefetch task is running has finished by now.
+// On a miss, a prefetch not yet started is dropped: the caller is about to scan itself.
+static bool prefetch_take_scan(char *resp, size_t resp_size) {
+  uint32_t now_ms = (uint32_t)esp_log_timestamp();
+  bool hit = false;
+  xSemaphoreTake(s_prefetch_mutex, portMAX_DELAY);
+  if (s_prefetch_scan.valid && s_prefetch_scan.gen == s_prefetch_gen) {
+    if (now_ms - s_prefetch_scan.taken_ms <= (uint32_t)kPrefetchScanFreshMs) {
+      strlcpy(resp, s_prefetch_scan.resp, resp_size);
+      hit = true;
+    } else {
+      s_prefetch_scan_wasted.fetch_add(1, std::memory_order_relaxed);
+    }
+    s_prefetch_scan.valid = false;
   }
-  esp_err_t action_err = ESP_OK;
-  if (!ai_action_wait_result(req.req_id, kAiStopActionTimeout, &action_err)) {
-    return make_tool_response("timeout", "gripper_close");
+  if (!hit) s_prefetch_scan_want = 0;
+  xSemaphoreGive(s_prefetch_mutex);
+  if (hit) s_prefetch_scan_hits.fetch_add(1, std::memory_order_relaxed);
+  return hit;
+}
+
+static bool prefetch_take_imu(float accel[3], float gyro[3]) {
+  uint32_t now_ms = (uint32_t)esp_log_timestamp();
+  bool hit = false;
+  xSemaphoreTake(s_prefetch_mutex, portMAX_DELAY);
+  if (s_prefetch_imu.valid && s_prefetch_imu.gen == s_prefetch_gen &&
+      now_ms - s_prefetch_imu.taken_ms <= (uint32_t)kPrefetchImuFreshMs) {
+    memcpy(accel, s_prefetch_imu.accel, sizeof(s_prefetch_imu.accel));
+    memcpy(gyro, s_prefetch_imu.gyro, sizeof(s_prefetch_imu.gyro));
+    hit = true;
   }
-  if (action_err != ESP_OK) {
-    return make_tool_response("failed", "gripper_close");
+  s_prefetch_imu.valid = false;
+  xSemaphoreGive(s_prefetch_mutex);
+  if (hit) s_prefetch_imu_hits.fetch_add(1, std::memory_order_relaxed);
+  return hit;
+}
+
+static void sensor_prefetch_task(void *arg) {
+  (void)arg;
+  char resp[VISION_RESP_MAX];
+  while (1) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    // Waits behind any other camera user; the request may be withdrawn meanwhile.
+    xSemaphoreTake(s_vision_mutex, portMAX_DELAY);
+    xSemaphoreTake(s_prefetch_mutex, portMAX_DELAY);
+    uint32_t gen = s_prefetch_scan_want;
+    bool wanted = gen != 0 && gen == s_prefetch_gen;
+    s_prefetch_scan_want = 0;
+    xSemaphoreGive(s_prefetch_mutex);
+    if (!wanted) {
+      xSemaphoreGive(s_vision_mutex);
+      continue;
+    }
+    s_prefetch_scans.fetch_add(1, std::memory_order_relaxed);
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t err = vision_cmd("SCAN", "{\"mode\":\"RELIABLE\",\"frames\":1}", resp, sizeof(resp));
+    uint32_t done_ms = (uint32_t)esp_log_timestamp();
+    // Publish before letting the camera go, so a vision_scan waiting on it sees the result.
+    xSemaphoreTake(s_prefetch_mutex, portMAX_DELAY);
+    bool current = gen == s_prefetch_gen;
+    if (err == ESP_OK && current) {
+      s_prefetch_scan.valid = true;
+      s_prefetch_scan.gen = gen;
+      s_prefetch_scan.taken_ms = done_ms;
+      strlcpy(s_prefetch_scan.resp, resp, sizeof(s_prefetch_scan.resp));
+    } else {
+      s_prefetch_scan_wasted.fetch_add(1, std::memory_order_relaxed);
+    }
+    xSemaphoreGive(s_prefetch_mutex);
+    xSemaphoreGive(s_vision_mutex);
+
+    rover_log_field_t fields[] = {
+      rover_log_field_str("err", esp_err_to_name(err)),
+      rover_log_field_int("ms", (esp_timer_get_time() - start_us) / 1000),
+      rover_log_field_bool("current", current),
+      rover_log_field_int("stack_free", (int64_t)uxTaskGetStackHighWaterMark(NULL)),
+    };
+    rover_log_record_t rec = {
+      .level = ESP_LOG_INFO,
+      .component = TAG,
+      .event = "vision_prefetch",
+      .fields = fields,
+      .field_count = sizeof(fields) / sizeof(fields[0]),
+    };
+    rover_log(&rec);
   }
-  rover_log_record_t rec = {
-    .level = ESP_LOG_INFO,
-    .component = TAG,
-    .event = "tool_gripper_close",
-    .fields = NULL,
-    .field_count = 0,
-  };
-  rover_log(&rec);
-  return make_tool_response("ok", "gripper_close"); // openrouter_client frees this
 }
 
-static char *cb_read_imu(const char *fn, const char *arguments, void *ud) {
-  (void)fn; (void)arguments; (void)ud;
+static char *cb_read_imu(const ai_tool_args_t *args, void *ud) {
+  (void)args; (void)ud;
   if (!M5.Imu.isEnabled()) {
     return make_tool_response("imu_unavailable", "read_imu");
   }
-  float ax = 0, ay = 0, az = 0, gx = 0, gy = 0, gz = 0;
-  bool ok = M5.Imu.getAccel(&ax, &ay, &az) && M5.Imu.getGyro(&gx, &gy, &gz);
+  float accel[3] = {0, 0, 0};
+  float gyro[3] = {0, 0, 0};
+  bool ok = prefetch_take_imu(accel, gyro) ||
+            (M5.Imu.getAccel(&accel[0], &accel[1], &accel[2]) &&
+             M5.Imu.getGyro(&gyro[0], &gyro[1], &gyro[2]));
   if (!ok) {
     return make_tool_response("imu_read_failed", "read_imu");
   }
@@ -1430,52 +2758,171 @@ static char *cb_read_imu(const char *fn, const char *arguments, void *ud) {
   snprintf(buf, sizeof(buf),
            "{\"status\":\"ok\",\"accel\":{\"x\":%.3f,\"y\":%.3f,\"z\":%.3f},"
            "\"gyro\":{\"x\":%.3f,\"y\":%.3f,\"z\":%.3f}}",
-           (double)ax, (double)ay, (double)az,
-           (double)gx, (double)gy, (double)gz);
-  return strdup(buf);
+           (double)accel[0], (double)accel[1], (double)accel[2],
+           (double)gyro[0], (double)gyro[1], (double)gyro[2]);
+  return turn_arena_strdup(buf);
+}
+
+// ── Scene deltas ──
+
+static void scene_reset(void) {
+  s_scene_base.valid = false;
+  s_scene_scan.valid = false;
+}
+
+static void scene_base_set(const vision_world_t *world, const char *source) {
+  s_scene_base.valid = true;
+  s_scene_base.source = source;
+  s_scene_base.world = *world;
+}
+
+static uint32_t scene_hash(const char *text, size_t len) {
+  uint32_t h = 2166136261u;  // FNV-1a
+  for (size_t i = 0; i < len; ++i) h = (h ^ (uint8_t)text[i]) * 16777619u;
+  return h;
+}
+
+static uint32_t scene_actuation_gen(void) {
+  xSemaphoreTake(s_prefetch_mutex, portMAX_DELAY);
+  uint32_t gen = s_prefetch_gen;
+  xSemaphoreGive(s_prefetch_mutex);
+  return gen;
+}
+
+// The last two scans agreed, it was recently, and the rover stands still: nothing has moved
+// it since, from a tool, the executor, tracking, the buttons or the web.
+static bool scene_scan_stable(uint32_t now_ms) {
+  return s_scene_scan.valid && s_scene_scan.repeats > 0 && s_scene_scan.gen == scene_actuation_gen() &&
+         s_scene_scan.motor_gen == s_motor_gen.load(std::memory_order_relaxed) &&
+         !s_motors_running.load(std::memory_order_relaxed) &&
+         !s_ai_action_running.load(std::memory_order_relaxed) &&
+         now_ms - s_scene_scan.taken_ms <= (uint32_t)kSceneStableMs;
 }
 
-static char *cb_vision_scan(const char *fn, const char *arguments, void *ud) {
-  (void)fn; (void)ud;
-  const char *mode = "RELIABLE";
-  cJSON *args = cJSON_Parse(arguments ? arguments : "{}");
-  if (args) {
-    cJSON *m = cJSON_GetObjectItem(args, "mode");
-    if (m && cJSON_IsString(m) && strcasecmp(m->valuestring, "fast") == 0) {
-      mode = "FAST";
+static char *scene_unchanged_response(const char *since, size_t full_len) {
+  char buf[64];
+  int n = snprintf(buf, sizeof(buf), "{\"status\":\"ok\",\"changes\":\"unchanged\",\"since\":\"%s\"}", since);
+  if (n > 0 && (size_t)n < full_len) {
+    s_scene_diffs.fetch_add(1, std::memory_order_relaxed);
+    s_scene_saved_bytes.fetch_add((uint32_t)(full_len - (size_t)n), std::memory_order_relaxed);
+  }
+  return turn_arena_strdup(buf);  // the chat loop (ai_client) frees this
+}
+
+// A streamed snapshot as a diff against the scene the model saw last, if that is shorter
+// than the full JSON; NULL otherwise. Either way it becomes the new base.
+static char *scene_stream_response(const vision_world_t *world, size_t full_len) {
+  char *out = NULL;
+  if (s_scene_base.valid) {
+    char changes[192];
+    scene_delta_counts_t counts;
+    int n = scene_delta_describe(&s_scene_base.world, world, changes, sizeof(changes), &counts);
+    char buf[256];
+    int m = n < 0 ? -1 : snprintf(buf, sizeof(buf), "{\"status\":\"ok\",\"changes\":\"%s\",\"since\":\"%s\"}",
+                                  changes, s_scene_base.source);
+    if (m > 0 && (size_t)m < sizeof(buf) && (size_t)m < full_len) {
+      out = turn_arena_strdup(buf);  // the chat loop (ai_client) frees this
+      s_scene_diffs.fetch_add(1, std::memory_order_relaxed);
+      s_scene_saved_bytes.fetch_add((uint32_t)(full_len - (size_t)m), std::memory_order_relaxed);
+      rover_log_field_t fields[] = {
+        rover_log_field_int("added", counts.added),
+        rover_log_field_int("removed", counts.removed),
+        rover_log_field_int("moved", counts.moved),
+        rover_log_field_int("kept", counts.kept),
+        rover_log_field_int("saved_bytes", (int64_t)(full_len - (size_t)m)),
+      };
+      rover_log_record_t rec = {
+        .level = ESP_LOG_INFO,
+        .component = TAG,
+        .event = "scene_delta",
+        .fields = fields,
+        .field_count = sizeof(fields) / sizeof(fields[0]),
+      };
+      rover_log(&rec);
     }
-    cJSON_Delete(args);
   }
+  scene_base_set(world, "last scan");
+  return out;
+}
+
+static const char *kVisionModeEnum[] = {"reliable", "fast", NULL};
+enum { kVisionScanMode };
+static const ai_tool_param_t kVisionScanParams[] = {
+    {"mode", AI_PARAM_STRING, "reliable: a full camera scan; fast or omitted: live detections if available",
+     false, kVisionModeEnum, 0, 0, 0},
+    {NULL, AI_PARAM_INT, NULL, false, NULL, 0, 0, 0},
+};
+
+static char *cb_vision_scan(const ai_tool_args_t *args, void *ud) {
+  (void)ud;
+  const char *mode = args->num[kVisionScanMode] == 1 ? "FAST" : "RELIABLE";
 
   char cmd_args[64];
   snprintf(cmd_args, sizeof(cmd_args), "{\"mode\":\"%s\",\"frames\":1}", mode);
 
   mark_activity();
+
+  // A fresh streamed snapshot answers instantly without a UART round trip. The stream runs
+  // the camera's single-frame pipeline, which is what FAST asks for; an explicit RELIABLE
+  // gets a real SCAN.
+  vision_world_t world;
+  uint32_t now_ms = (uint32_t)esp_log_timestamp();
+  bool want_reliable = args->given[kVisionScanMode] && args->num[kVisionScanMode] == 0;
+  bool fresh = !want_reliable && vision_world_latest(&world) &&
+               (now_ms - world.rx_ms) <= (uint32_t)kVisionWorldFreshMs;
+  char world_json[640];
+  if (fresh && vision_world_to_json(&world, now_ms, world_json, sizeof(world_json)) <= 0) {
+    fresh = false;
+  }
+
+  char resp[VISION_RESP_MAX];
+  bool prefetched = false;
+  bool skipped = !fresh && scene_scan_stable(now_ms);
+  esp_err_t err = ESP_OK;
+  if (!fresh && !skipped) {
+    xSemaphoreTake(s_vision_mutex, portMAX_DELAY);
+    // A RELIABLE prefetch serves FAST requests too.
+    prefetched = prefetch_take_scan(resp, sizeof(resp));
+    if (!prefetched) err = vision_cmd("SCAN", cmd_args, resp, sizeof(resp));
+    xSemaphoreGive(s_vision_mutex);
+  }
+  rover_log_field_t fields[] = {
+    rover_log_field_str("source", fresh ? "stream" : (skipped ? "stable" : (prefetched ? "prefetch" : "scan"))),
+  };
   rover_log_record_t rec = {
     .level = ESP_LOG_INFO,
     .component = TAG,
     .event = "tool_vision_scan",
-    .fields = NULL,
-    .field_count = 0,
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
   };
   rover_log(&rec);
-
-  char resp[VISION_RESP_MAX];
-  xSemaphoreTake(s_vision_mutex, portMAX_DELAY);
-  esp_err_t err = vision_cmd("SCAN", cmd_args, resp, sizeof(resp));
-  xSemaphoreGive(s_vision_mutex);
+  if (fresh) {
+    char *diff = scene_stream_response(&world, strlen(world_json));
+    return diff ? diff : turn_arena_strdup(world_json);  // the chat loop (ai_client) frees this
+  }
+  if (skipped) {
+    s_scene_skipped_scans.fetch_add(1, std::memory_order_relaxed);
+    s_scene_scan.taken_ms = now_ms;
+    return scene_unchanged_response("last scan", s_scene_scan.full_len);
+  }
 
   if (err != ESP_OK) {
     return make_tool_response("camera_timeout", "vision_scan");
   }
 
   // Parse and extract result for clean AI response
-  cJSON *json = cJSON_Parse(resp);
-  if (!json) return strdup(resp);
+  json_tok_t reply_toks[kVisionReplyTokens];
+  json_doc_t json;
+  if (json_tok_parse(&json, resp, sizeof(resp), reply_toks, kVisionReplyTokens) < 0) {
+    return turn_arena_strdup(resp);
+  }
 
-  cJSON *ok_field = cJSON_GetObjectItem(json, "ok");
-  cJSON *result = cJSON_GetObjectItem(json, "result");
-  if (ok_field && cJSON_IsTrue(ok_field) && result) {
+  bool ok = false;
+  const char *result;
+  size_t result_len;
+  if (json_tok_bool(&json, json_tok_get(&json, 0, "ok"), &ok) && ok &&
+      json_tok_raw(&json, json_tok_get(&json, 0, "result"), &result, &result_len)) {
     if (!s_vision_available.load(std::memory_order_relaxed)) {
       s_vision_available.store(true, std::memory_order_relaxed);
       rover_log_record_t rec = {
@@ -1487,34 +2934,649 @@ static char *cb_vision_scan(const char *fn, const char *arguments, void *ud) {
       };
       rover_log(&rec);
     }
-    char *result_str = cJSON_PrintUnformatted(result);
-    cJSON_Delete(json);
-    return result_str ? result_str : make_tool_response("memory_error", "vision_scan");
+    // The result subtree is already compact JSON: pass its text on as is, unless the model
+    // got exactly this in its last scan.
+    uint32_t hash = scene_hash(result, result_len);
+    bool same = s_scene_scan.valid && s_scene_scan.hash == hash;
+    s_scene_scan.repeats = same ? (uint8_t)(s_scene_scan.repeats + 1) : 0;
+    s_scene_scan.valid = true;
+    s_scene_scan.hash = hash;
+    s_scene_scan.gen = scene_actuation_gen();
+    s_scene_scan.motor_gen = s_motor_gen.load(std::memory_order_relaxed);
+    s_scene_scan.taken_ms = (uint32_t)esp_log_timestamp();
+    s_scene_scan.full_len = (uint16_t)result_len;
+    if (same) return scene_unchanged_response("last scan", result_len);
+    char *out = (char *)turn_arena_malloc(result_len + 1);
+    if (out == NULL) return make_tool_response("memory_error", "vision_scan");
+    memcpy(out, result, result_len);
+    out[result_len] = '\0';
+    return out;  // the chat loop (ai_client) frees this
   }
 
   // Return raw error from camera
-  char *raw = cJSON_PrintUnformatted(json);
-  cJSON_Delete(json);
-  return raw ? raw : make_tool_response("error", "vision_scan");
+  return turn_arena_strdup(resp);
+}
+
+static esp_err_t vision_upload_sink_begin(vision_jpeg_sink_t *sink, size_t size) {
+  (void)sink; (void)size;
+  return ESP_OK;
+}
+
+static esp_err_t vision_upload_sink_write(vision_jpeg_sink_t *sink, const uint8_t *data, size_t len) {
+  return ai_image_upload_write((ai_image_upload_t *)sink->ctx, data, len);
+}
+
+// Image question to a vision model. The JPEG goes from the UART through base64 straight into
+// the HTTPS request body, so no full frame or encoding is ever held (see ai_client.h).
+enum { kVisionCaptureQuestion };
+static const ai_tool_param_t kVisionCaptureParams[] = {
+    {"question", AI_PARAM_STRING, "What to look for in the photo (optional)", false, NULL, 0, 0, 0},
+    {NULL, AI_PARAM_INT, NULL, false, NULL, 0, 0, 0},
+};
+
+static char *cb_vision_capture(const ai_tool_args_t *args, void *ud) {
+  (void)ud;
+  const char *question = args->given[kVisionCaptureQuestion]
+                             ? args->str[kVisionCaptureQuestion]
+                             : "Describe what the rover camera sees: objects, people, obstacles and their positions.";
+  mark_activity();
+
+  // Connect first: the TLS handshake must not run while the camera is already sending.
+  ai_client_config_t cfg = {
+    .api_key = OPENROUTER_API_KEY,
+    .model = kAiVisionModel,
+    .timeout_ms = kAiHttpTimeoutMs,
+    .max_tokens = kAiVisionMaxTokens,
+    .url = OPENROUTER_URL,
+    .cert_pem = OPENROUTER_CERT_PEM,
+  };
+  ai_image_upload_t *up = NULL;
+  trace_span_t span = trace_begin(TRACE_VISION_MODEL, kAiVisionModel);
+  esp_err_t err = ai_image_upload_begin(&cfg, question, &up);
+  if (err != ESP_OK) {
+    trace_end(&span, err);
+    return make_tool_response("llm_unavailable", "vision_capture");
+  }
+
+  vision_jpeg_sink_t sink = {
+    .begin = vision_upload_sink_begin,
+    .write = vision_upload_sink_write,
+    .ctx = up,
+    .buf = NULL,
+  };
+  size_t jpeg_size = 0;
+  xSemaphoreTake(s_vision_mutex, portMAX_DELAY);
+  capture_plan_t plan = vision_capture_plan(CAPTURE_CONSUMER_LLM);
+  err = vision_capture_to(plan.quality, plan.res, &sink, &jpeg_size);
+  xSemaphoreGive(s_vision_mutex);
+
+  bool captured = (err == ESP_OK);
+  char answer[512];
+  if (captured) err = ai_image_upload_finish(up, answer, sizeof(answer));
+  trace_end(&span, err);
+  ai_image_upload_stats_t stats;
+  ai_image_upload_stats(up, &stats);
+  ai_image_upload_free(up);
+
+  rover_log_field_t fields[] = {
+    rover_log_field_str("err", esp_err_to_name(err)),
+    rover_log_field_int("quality", plan.quality),
+    rover_log_field_str("res", capture_res_name(plan.res)),
+    rover_log_field_int("jpeg_bytes", (int64_t)stats.jpeg_bytes),
+    rover_log_field_int("body_bytes", (int64_t)stats.body_bytes),
+    rover_log_field_int("http_status", stats.http_status),
+    rover_log_field_int("heap_free", (int64_t)esp_get_free_heap_size()),
+  };
+  rover_log_record_t rec = {
+    .level = err == ESP_OK ? ESP_LOG_INFO : ESP_LOG_WARN,
+    .component = TAG,
+    .event = "tool_vision_capture",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
+
+  if (err != ESP_OK) {
+    return make_tool_response(captured ? "vision_model_failed" : "camera_timeout", "vision_capture");
+  }
+  cJSON *result = cJSON_CreateObject();
+  cJSON_AddStringToObject(result, "status", "ok");
+  cJSON_AddStringToObject(result, "description", answer);
+  char *out = cJSON_PrintUnformatted(result);
+  cJSON_Delete(result);
+  return out ? out : make_tool_response("memory_error", "vision_capture");  // the chat loop (ai_client) frees this
+}
+
+// Starts or stops a local tracking run; "stop" ends one. Errors: INVALID_ARG for an unknown
+// mode, NOT_SUPPORTED while the camera is not streaming detections.
+static esp_err_t track_command(const char *mode, const char *target, const char *source) {
+  bool stop = strcasecmp(mode, "stop") == 0;
+  track_mode_t track_mode = TRACK_MODE_APPROACH;
+  if (strcasecmp(mode, "follow") == 0) {
+    track_mode = TRACK_MODE_FOLLOW;
+  } else if (strcasecmp(mode, "grab") == 0) {
+    track_mode = TRACK_MODE_GRAB;
+  } else if (!stop && strcasecmp(mode, "approach") != 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (strpbrk(target, "\"\\") != NULL) return ESP_ERR_INVALID_ARG;  // echoed in /status
+  if (!stop && !s_vision_subscribed.load(std::memory_order_relaxed)) return ESP_ERR_NOT_SUPPORTED;
+
+  xSemaphoreTake(s_state_mutex, portMAX_DELAY);
+  if (stop) {
+    track_stop_locked(source);
+    apply_motion();
+  } else {
+    track_start_locked(track_mode, target, source);
+  }
+  xSemaphoreGive(s_state_mutex);
+  return ESP_OK;
+}
+
+// Hands the base to the tracking loop in main_loop_task and returns at once: the loop steers
+// at camera rate without further model rounds until the target is reached or lost.
+static const char *kTrackModeEnum[] = {"approach", "follow", "grab", "stop", NULL};
+enum { kTrackTarget, kTrackMode };
+static const ai_tool_param_t kTrackParams[] = {
+    {"target", AI_PARAM_STRING, "Class or person name as reported by vision_scan; omit for the largest object", false, NULL, 0, 0, 0},
+    {"mode", AI_PARAM_STRING, "approach drives up to it, grab then closes the gripper, follow only turns to face it, stop ends tracking", false, kTrackModeEnum, 0, 0, 0},
+    {NULL, AI_PARAM_INT, NULL, false, NULL, 0, 0, 0},
+};
+
+static char *cb_track(const ai_tool_args_t *args, void *ud) {
+  (void)ud;
+  const char *target = args->given[kTrackTarget] ? args->str[kTrackTarget] : "";
+  const char *mode = kTrackModeEnum[args->num[kTrackMode]];
+  esp_err_t err = track_command(mode, target, "ai");
+  if (err == ESP_ERR_NOT_SUPPORTED) return make_tool_response("vision_unavailable", "track");
+  if (err != ESP_OK) return make_tool_response("invalid_args", "track");
+
+  cJSON *result = cJSON_CreateObject();
+  cJSON_AddStringToObject(result, "status", strcmp(mode, "stop") == 0 ? "stopped" : "started");
+  cJSON_AddStringToObject(result, "action", "track");
+  cJSON_AddStringToObject(result, "mode", mode);
+  if (target[0] != '\0') cJSON_AddStringToObject(result, "target", target);
+  char *out = cJSON_PrintUnformatted(result);
+  cJSON_Delete(result);
+  return out ? out : make_tool_response("memory_error", "track");  // the chat loop (ai_client) frees this
+}
+
+// The LLM's tool set; each parameter table above is the single source of its schema,
+// defaults and ranges.
+static const ai_tool_t kTools[] = {
+    {"move", "Move the rover for duration_ms, then stop.", kMoveParams, cb_move, NULL},
+    {"turn", "Rotate the rover in place by angle_deg using IMU gyroscope feedback.", kTurnParams, cb_turn, NULL},
+    {"stop", "Stop all rover motion immediately.", NULL, cb_action, (void *)&kStopAction},
+    {"gripper_open", "Open the rover gripper.", NULL, cb_action, (void *)&kGripperOpenAction},
+    {"gripper_close", "Close the rover gripper.", NULL, cb_action, (void *)&kGripperCloseAction},
+    {"read_imu", "Read current accelerometer and gyroscope values.", NULL, cb_read_imu, NULL},
+    {"vision_scan", "Look at the scene using the camera. Returns detected faces and objects, or only what changed since the scene you were last shown.", kVisionScanParams, cb_vision_scan, NULL},
+    {"vision_capture", "Take a photo and ask a vision model about it. Slower than vision_scan; use it for details vision_scan cannot report (colours, text, layout).", kVisionCaptureParams, cb_vision_capture, NULL},
+    {"action_status", "Report async move/turn actions: running with remaining_ms, or done with their status.", kActionStatusParams, cb_action_status, NULL},
+    {"wait_action", "Wait until an async move/turn (or all of them) has finished, then report like action_status.", kActionStatusParams, cb_action_status, (void *)1},
+    {"track", "Follow or drive up to an object or person seen by the camera, steering locally without further tool calls. Returns immediately; the rover stops on its own when the target is reached or lost.", kTrackParams, cb_track, NULL},
+};
+
+typedef enum {
+  CHAT_STREAM_TOKEN = 0,
+  CHAT_STREAM_TOOL_CALL = 1,
+  CHAT_STREAM_TOOL_DONE = 2,
+  CHAT_STREAM_DONE = 3,
+  CHAT_STREAM_ERROR = 4,
+} chat_stream_item_type_t;
+
+typedef struct {
+  uint32_t job_id;
+  uint8_t type;
+  uint8_t len;
+  char text[kChatStreamTextMax];
+} chat_stream_item_t;
+
+static void chat_stream_push(uint32_t job_id, chat_stream_item_type_t type, const char *text,
+                             size_t len, TickType_t timeout) {
+  if (!s_chat_stream_active.load(std::memory_order_relaxed) || s_chat_stream_ring == NULL) return;
+  // Long deltas are split at arbitrary bytes; the SSE side re-joins UTF-8 sequences.
+  do {
+    chat_stream_item_t item;
+    size_t n = len < kChatStreamTextMax ? len : kChatStreamTextMax;
+    item.job_id = job_id;
+    item.type = (uint8_t)type;
+    item.len = (uint8_t)n;
+    if (n > 0) memcpy(item.text, text, n);
+    if (xRingbufferSend(s_chat_stream_ring, &item, offsetof(chat_stream_item_t, text) + n,
+                        timeout) != pdTRUE) {
+      s_chat_stream_drops.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    text += n;
+    len -= n;
+  } while (len > 0);
+}
+
+static void chat_stream_on_event(ai_chat_event_t event, const char *text, size_t len, void *ctx) {
+  (void)ctx;
+  uint32_t job_id = s_chat_stream_job.load(std::memory_order_relaxed);
+  switch (event) {
+    case AI_CHAT_EVENT_TOKEN:
+      chat_stream_push(job_id, CHAT_STREAM_TOKEN, text, len, 0);
+      break;
+    case AI_CHAT_EVENT_TOOL_CALL:
+      s_chat_tool_start = xTaskGetTickCount();
+      s_plan_rec_calls++;
+      // Anything but an observation may move the rover: prefetched readings no longer hold.
+      if (strcmp(text, "read_imu") != 0 && strcmp(text, "vision_scan") != 0 &&
+          strcmp(text, "vision_capture") != 0) {
+        prefetch_retire();
+      }
+      chat_stream_push(job_id, CHAT_STREAM_TOOL_CALL, text, len, 0);
+      break;
+    case AI_CHAT_EVENT_TOOL_DONE:
+      s_chat_tool_ticks += xTaskGetTickCount() - s_chat_tool_start;
+      chat_stream_push(job_id, CHAT_STREAM_TOOL_DONE, text, len, 0);
+      break;
+  }
+}
+
+static bool chat_is_cancelled(void *ctx) {
+  (void)ctx;
+  return s_chat_cancel.load(std::memory_order_relaxed);
+}
+
+// Drops queued AI actions (their waiters get an error at once) and queues a STOP, which an
+// action already executing on core 0 picks up within one control period.
+static int ai_action_cancel_pending(void) {
+  if (s_ai_action_queue == NULL || s_ai_action_queue_mutex == NULL) return 0;
+  ai_action_req_t dropped[kAiActionQueueDepth];
+  int dropped_count = 0;
+  xSemaphoreTake(s_ai_action_queue_mutex, portMAX_DELAY);
+  ai_action_req_t queued = {};
+  while (dropped_count < kAiActionQueueDepth && xQueueReceive(s_ai_action_queue, &queued, 0) == pdTRUE) {
+    dropped[dropped_count++] = queued;
+  }
+  ai_action_req_t stop = {
+    .req_id = ++s_ai_action_req_seq,
+    .kind = AI_ACTION_STOP,
+    .x = 0,
+    .y = 0,
+    .z = 0,
+    .duration_ms = 0,
+    .turn_target_deg = 0,
+    .turn_timeout_ms = 0,
+    .async = false,
+  };
+  (void)xQueueSend(s_ai_action_queue, &stop, 0);
+  xSemaphoreGive(s_ai_action_queue_mutex);
+
+  // Outside the queue lock: completing an async action takes s_ai_async_mutex, which
+  // ai_action_start holds while it submits.
+  for (int i = 0; i < dropped_count; ++i) {
+    ai_action_result_t result = {
+      .req_id = dropped[i].req_id,
+      .err = ESP_ERR_INVALID_STATE,
+      .turn_measured_deg = 0.0f,
+      .run_ms = 0,
+    };
+    ai_action_complete(&dropped[i], &result);
+  }
+  return dropped_count;
+}
+
+// Abandons queued chat jobs and the running turn ("replace" prompt or any stop). The worker
+// logs time-to-cancel once the turn has actually unwound and released s_ai_mutex.
+static void chat_cancel(const char *reason) {
+  int queued = 0;
+  bool running = false;
+  uint32_t cancelled_ids[CHAT_SLOT_COUNT];
+  xSemaphoreTake(s_chat_mutex, portMAX_DELAY);
+  for (int i = 0; i < CHAT_SLOT_COUNT; ++i) {
+    chat_slot_t *slot = &s_chat_slots[i];
+    if (slot->state == CHAT_SLOT_QUEUED) {
+      slot->state = CHAT_SLOT_DONE;
+      slot->err = ESP_ERR_NOT_FINISHED;
+      slot->response_len = 0;
+      slot->last_used = xTaskGetTickCount();
+      cancelled_ids[queued++] = slot->id;
+    } else if (slot->state == CHAT_SLOT_RUNNING && !s_chat_cancel.load(std::memory_order_relaxed)) {
+      s_chat_cancel_tick = xTaskGetTickCount();
+      s_chat_cancel_reason = reason;
+      s_chat_cancel.store(true, std::memory_order_relaxed);
+      running = true;
+    }
+  }
+  if (queued > 0) {
+    // Take the cancelled ids out of s_chat_queue, or with a prewarm they can fill it while
+    // slots are free. Every queued job was just cancelled; only a prewarm request stays.
+    // (An id the worker took before we locked is skipped by it: the slot is no longer QUEUED.)
+    uint32_t job_id = 0;
+    bool prewarm = false;
+    while (xQueueReceive(s_chat_queue, &job_id, 0) == pdTRUE) {
+      if (job_id == kChatPrewarmJob) prewarm = true;
+    }
+    if (prewarm) (void)xQueueSend(s_chat_queue, &kChatPrewarmJob, 0);
+  }
+  xSemaphoreGive(s_chat_mutex);
+  if (queued == 0 && !running) return;
+
+  s_chat_inflight.fetch_sub(queued, std::memory_order_relaxed);
+  for (int i = 0; i < queued; ++i) {
+    chat_stream_push(cancelled_ids[i], CHAT_STREAM_ERROR, NULL, 0, kChatStreamEndSendTimeout);
+  }
+  int actions = running ? ai_action_cancel_pending() : 0;
+
+  rover_log_field_t fields[] = {
+    rover_log_field_str("reason", reason),
+    rover_log_field_int("queued", queued),
+    rover_log_field_bool("running", running),
+    rover_log_field_int("actions_dropped", actions),
+  };
+  rover_log_record_t rec = {
+    .level = ESP_LOG_INFO,
+    .component = TAG,
+    .event = "chat_cancel_requested",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
+}
+
+static esp_err_t intent_run_step(const intent_step_t *step) {
+  ai_action_req_t req = {};
+  TickType_t timeout = ai_action_slack();
+  switch (step->kind) {
+    case INTENT_MOVE:
+      req.kind = AI_ACTION_MOVE;
+      req.x = step->x;
+      req.y = step->y;
+      req.z = step->z;
+      req.duration_ms = step->duration_ms;
+      timeout += pdMS_TO_TICKS(step->duration_ms);
+      break;
+    case INTENT_TURN: {
+      if (!M5.Imu.isEnabled()) return ESP_ERR_NOT_SUPPORTED;
+      uint32_t timeout_ms = (uint32_t)clamp_int(step->angle_deg * 100, 2000, 12000);
+      req.kind = AI_ACTION_TURN;
+      req.z = step->turn_left ? (int8_t)-step->speed_pct : (int8_t)step->speed_pct;
+      req.turn_target_deg = step->angle_deg;
+      req.turn_timeout_ms = (uint16_t)timeout_ms;
+      timeout += pdMS_TO_TICKS(timeout_ms);
+      break;
+    }
+    case INTENT_STOP:
+      req.kind = AI_ACTION_STOP;
+      timeout = kAiStopActionTimeout;
+      break;
+    case INTENT_GRIPPER_OPEN:
+      req.kind = AI_ACTION_GRIPPER_OPEN;
+      break;
+    case INTENT_GRIPPER_CLOSE:
+      req.kind = AI_ACTION_GRIPPER_CLOSE;
+      break;
+  }
+  return ai_action_run(&req, timeout, NULL);
+}
+
+// Runs a locally matched plan through the same core-0 executor the LLM tools use.
+// reply: text for a successful run (a cached LLM answer); NULL describes the plan instead.
+static esp_err_t intent_execute(uint32_t job_id, const intent_plan_t *plan, const char *reply,
+                                char *response, size_t response_size) {
+  static const char *kStepNames[] = {"", "move", "turn", "stop", "gripper_open", "gripper_close"};
+  esp_err_t err = ESP_OK;
+  mark_activity();
+  for (uint8_t i = 0; i < plan->count && err == ESP_OK; ++i) {
+    if (s_chat_cancel.load(std::memory_order_relaxed)) {
+      err = ESP_ERR_NOT_FINISHED;
+      break;
+    }
+    const char *name = kStepNames[plan->steps[i].kind];
+    chat_stream_push(job_id, CHAT_STREAM_TOOL_CALL, name, strlen(name), 0);
+    err = intent_run_step(&plan->steps[i]);
+    chat_stream_push(job_id, CHAT_STREAM_TOOL_DONE, name, strlen(name), 0);
+  }
+  if (err == ESP_OK && s_chat_cancel.load(std::memory_order_relaxed)) err = ESP_ERR_NOT_FINISHED;
+
+  char summary[160];
+  if (intent_describe(plan, summary, sizeof(summary)) < 0) summary[0] = '\0';
+  if (err == ESP_OK && reply != NULL) {
+    strlcpy(response, reply, response_size);
+  } else if (err == ESP_OK) {
+    snprintf(response, response_size, "%s: %s", plan->russian ? "Готово" : "Done", summary);
+  } else {
+    snprintf(response, response_size, "%s: %s (0x%x)", plan->russian ? "Не удалось" : "Failed",
+             summary, (unsigned)err);
+  }
+  return err;
+}
+
+static void chat_prewarm(void) {
+  s_ai_prewarm_pending.store(false, std::memory_order_relaxed);
+  if (!s_ai_ready) return;
+  int64_t start_us = esp_timer_get_time();
+  xSemaphoreTake(s_ai_mutex, portMAX_DELAY);
+  esp_err_t err = ai_client_prewarm(&s_ai_chat.client);
+  xSemaphoreGive(s_ai_mutex);
+  rover_log_field_t fields[] = {
+    rover_log_field_str("err", esp_err_to_name(err)),
+    rover_log_field_int("ms", (esp_timer_get_time() - start_us) / 1000),
+    rover_log_field_int("heap_free", (int64_t)esp_get_free_heap_size()),
+  };
+  rover_log_record_t rec = {
+    .level = err == ESP_OK ? ESP_LOG_INFO : ESP_LOG_WARN,
+    .component = TAG,
+    .event = "ai_prewarm",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
+}
+
+static void log_turn_memory(uint32_t job_id, uint32_t heap_start, uint32_t heap_min) {
+  turn_arena_stats_t arena;
+  turn_arena_stats(&arena);
+  uint32_t used = heap_start > heap_min ? heap_start - heap_min : 0;
+  s_turn_heap_min.store(heap_min, std::memory_order_relaxed);
+  s_turn_heap_used.store(used, std::memory_order_relaxed);
+  rover_log_field_t fields[] = {
+    rover_log_field_int("id", job_id),
+    rover_log_field_int("arena_peak", arena.peak),
+    rover_log_field_int("arena_allocs", arena.allocs),
+    rover_log_field_int("arena_overflows", arena.overflows),
+    rover_log_field_int("arena_leaked", arena.leaked),
+    rover_log_field_int("heap_start", heap_start),
+    rover_log_field_int("heap_min", heap_min),
+    rover_log_field_int("heap_used", used),
+  };
+  rover_log_record_t rec = {
+    .level = ESP_LOG_INFO,
+    .component = TAG,
+    .event = "turn_memory",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
+}
+
+// One bracketed line of rover state for the model, at most size - 1 bytes (detections that do
+// not fit are counted, not cut), so it rarely needs read_imu or vision_scan for the basics.
+// *scene_dependent: the line lists detections or a tracking run the answer may rely on.
+static size_t build_state_snapshot(char *out, size_t size, bool *scene_dependent) {
+  *scene_dependent = false;
+  int32_t bat_pct = -1;
+  read_power_metrics(NULL, &bat_pct);
+  xSemaphoreTake(s_state_mutex, portMAX_DELAY);
+  const char *state = state_name(s_rover_state);
+  bool moving = s_motion_active;
+  int x = s_motion_x, y = s_motion_y, z = s_motion_z;
+  bool gripper_open = s_gripper_open;
+  bool tracking = s_track.active;
+  char track_label[VISION_WORLD_LABEL_MAX];
+  strlcpy(track_label, s_track.label, sizeof(track_label));
+  const char *track_phase = track_phase_name(s_track.phase);
+  xSemaphoreGive(s_state_mutex);
+
+  size_t len = 0;
+  int n = snprintf(out, size, "[rover state=%s gripper=%s bat=%d%%", state,
+                   gripper_open ? "open" : "closed", (int)bat_pct);
+  if (n > 0) len = (size_t)n < size ? (size_t)n : size - 1;
+  if (moving) {
+    n = snprintf(out + len, size - len, " motion=%d,%d,%d", x, y, z);
+    if (n > 0) len += (size_t)n < size - len ? (size_t)n : size - len - 1;
+  }
+  if (tracking) {
+    *scene_dependent = true;
+    n = snprintf(out + len, size - len, " track=%s:%s", track_phase, track_label[0] ? track_label : "any");
+    if (n > 0) len += (size_t)n < size - len ? (size_t)n : size - len - 1;
+  }
+
+  uint32_t now_ms = (uint32_t)esp_log_timestamp();
+  vision_world_t world;
+  const char *camera = s_vision_available.load(std::memory_order_relaxed) ? "ok" : "offline";
+  if (!s_vision_subscribed.load(std::memory_order_relaxed) || !vision_world_latest(&world) ||
+      now_ms - world.rx_ms > (uint32_t)kVisionWorldFreshMs) {
+    // No live detections: the model has to scan if it needs to know.
+    n = snprintf(out + len, size - len, " camera=%s seen=unknown]\n", camera);
+    if (n > 0 && (size_t)n < size - len) len += (size_t)n;
+    return len;
+  }
+  n = snprintf(out + len, size - len, " camera=%s seen=", camera);
+  if (n > 0) len += (size_t)n < size - len ? (size_t)n : size - len - 1;
+  if (world.count == 0) len += strlcpy(out + len, "nothing", size - len);
+  if (world.count > 0) *scene_dependent = true;
+  static const size_t kTail = sizeof(" +8]\n");
+  int omitted = 0;
+  for (uint8_t i = 0; i < world.count; ++i) {
+    const vision_det_t *d = &world.dets[i];
+    char det[48];
+    int dn = snprintf(det, sizeof(det), "%s%s%s %u%% x%d w%d", i ? "," : "",
+                      d->kind == VISION_DET_FACE ? "face:" : "", d->label, d->score,
+                      d->x + d->w / 2, d->w);
+    if (dn <= 0 || (size_t)dn >= sizeof(det) || len + (size_t)dn + kTail > size) {
+      omitted++;
+      continue;
+    }
+    memcpy(out + len, det, (size_t)dn + 1);
+    len += (size_t)dn;
+  }
+  // Everything listed: a vision_scan in this turn can answer with what changed since.
+  if (omitted == 0) scene_base_set(&world, "rover line");
+  n = omitted ? snprintf(out + len, size - len, " +%d]\n", omitted) : snprintf(out + len, size - len, "]\n");
+  if (n > 0 && (size_t)n < size - len) len += (size_t)n;
+  return len;
+}
+
+static void chat_memory_publish(void) {
+  s_memory_tokens.store(chat_memory_tokens(&s_chat_memory), std::memory_order_relaxed);
+  s_memory_turns.store(s_chat_memory.count, std::memory_order_relaxed);
+  s_memory_dropped.store(s_chat_memory.dropped, std::memory_order_relaxed);
+}
+
+// Forgets a conversation nobody has continued for kChatMemoryTtlMs.
+static void chat_memory_expire(uint32_t now_ms) {
+  if (chat_memory_empty(&s_chat_memory) || now_ms - s_chat_memory.last_ms < kChatMemoryTtlMs) return;
+  uint32_t dropped = s_chat_memory.dropped;
+  chat_memory_clear(&s_chat_memory);
+  s_chat_memory.dropped = dropped;
+  chat_memory_publish();
+  rover_log_field_t fields[] = {
+    rover_log_field_int("idle_ms", (int64_t)kChatMemoryTtlMs),
+  };
+  rover_log_record_t rec = {
+    .level = ESP_LOG_INFO,
+    .component = TAG,
+    .event = "chat_memory_reset",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
+}
+
+static void chat_memory_remember(const char *user, const char *reply) {
+  chat_memory_add(&s_chat_memory, user, reply, (uint32_t)esp_log_timestamp());
+  chat_memory_publish();
+}
+
+// A prompt waiting beats a summary: the compaction is simply retried on the next idle poll.
+static bool chat_summary_cancelled(void *ctx) {
+  (void)ctx;
+  return uxQueueMessagesWaiting(s_chat_queue) > 0;
+}
+
+// Idle time only: folds all but the newest exchange into the summary with one cheap model
+// call, so later turns send a few hundred bytes of summary instead of every old exchange.
+static void chat_memory_compact_idle(void) {
+  static char input[CHAT_MEMORY_SUMMARY_MAX + CHAT_MEMORY_BYTES + CHAT_MEMORY_TURNS_MAX * 16];
+  static char summary[CHAT_MEMORY_SUMMARY_MAX + 128];  // chat_memory_compact cuts it to fit
+  static TickType_t s_retry_tick = 0;
+  if (!s_ai_ready || (s_retry_tick != 0 && (int32_t)(xTaskGetTickCount() - s_retry_tick) < 0)) return;
+  size_t folded = chat_memory_compaction_input(&s_chat_memory, input, sizeof(input));
+  if (folded == 0) return;
+  uint32_t tokens_before = chat_memory_tokens(&s_chat_memory);
+  int64_t start_us = esp_timer_get_time();
+  xSemaphoreTake(s_ai_mutex, portMAX_DELAY);
+  esp_err_t err = ai_chat_with_tools(&s_ai_summary, NULL, input, summary, sizeof(summary));
+  xSemaphoreGive(s_ai_mutex);
+  if (err == ESP_ERR_NOT_FINISHED) return;
+  if (err == ESP_OK && summary[0] == '\0') err = ESP_ERR_INVALID_RESPONSE;
+  s_retry_tick = err == ESP_OK ? 0 : xTaskGetTickCount() + pdMS_TO_TICKS(60000);
+  if (err == ESP_OK) {
+    chat_memory_compact(&s_chat_memory, summary, folded);
+    chat_memory_publish();
+    s_memory_compactions.fetch_add(1, std::memory_order_relaxed);
+  }
+  rover_log_field_t fields[] = {
+    rover_log_field_str("err", esp_err_to_name(err)),
+    rover_log_field_int("folded", (int64_t)folded),
+    rover_log_field_int("tokens_before", tokens_before),
+    rover_log_field_int("tokens_after", chat_memory_tokens(&s_chat_memory)),
+    rover_log_field_int("ms", (esp_timer_get_time() - start_us) / 1000),
+  };
+  rover_log_record_t rec = {
+    .level = err == ESP_OK ? ESP_LOG_INFO : ESP_LOG_WARN,
+    .component = TAG,
+    .event = "chat_memory_compact",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
 }
 
 static void chat_worker_task(void *arg) {
   (void)arg;
-  chat_job_t job;
-  char response[CHAT_RESPONSE_MAX];
+  uint32_t job_id = 0;
   while (1) {
-    if (xQueueReceive(s_chat_queue, &job, portMAX_DELAY) != pdTRUE) {
+    if (xQueueReceive(s_chat_queue, &job_id, kChatIdlePoll) != pdTRUE) {
+      chat_memory_expire((uint32_t)esp_log_timestamp());
+      chat_memory_compact_idle();
+      continue;
+    }
+    if (job_id == kChatPrewarmJob) {
+      chat_prewarm();
+      continue;
+    }
+    xSemaphoreTake(s_chat_mutex, portMAX_DELAY);
+    chat_slot_t *slot = chat_slot_find_locked(job_id);
+    if (slot != NULL && slot->state == CHAT_SLOT_QUEUED) {
+      slot->state = CHAT_SLOT_RUNNING;
+      s_chat_cancel.store(false, std::memory_order_relaxed);
+    } else {
+      slot = NULL;
+    }
+    xSemaphoreGive(s_chat_mutex);
+    if (slot == NULL) {
       continue;
     }
 
     esp_err_t err = ESP_FAIL;
-    response[0] = '\0';
+    slot->response[0] = '\0';
+    rover_log_field_t start_fields[] = {
+      rover_log_field_int("id", job_id),
+      rover_log_field_int("inflight", s_chat_inflight.load(std::memory_order_relaxed)),
+    };
     rover_log_record_t start_rec = {
       .level = ESP_LOG_INFO,
       .component = TAG,
       .event = "web_chat_start",
-      .fields = NULL,
-      .field_count = 0,
+      .fields = start_fields,
+      .field_count = sizeof(start_fields) / sizeof(start_fields[0]),
     };
     rover_log(&start_rec);
 
@@ -1522,19 +3584,195 @@ static void chat_worker_task(void *arg) {
     transition_to(STATE_AI_THINKING);
     xSemaphoreGive(s_state_mutex);
 
-    if (s_ai == NULL) {
+    s_chat_stream_job.store(job_id, std::memory_order_relaxed);
+    trace_turn_set(job_id);
+    trace_span_t turn_span = trace_begin(TRACE_TURN, "llm");
+    intent_plan_t plan;
+    int64_t parse_start_us = esp_timer_get_time();
+    bool local = intent_parse(slot->prompt, &plan);
+    int64_t parse_us = esp_timer_get_time() - parse_start_us;
+    TickType_t turn_start = xTaskGetTickCount();
+    uint32_t plan_key = 0;
+    char cached_reply[PLAN_CACHE_REPLY_MAX];
+    bool cached = false;
+    // "again", "a bit further": meaningless without the earlier turns, so never cached.
+    bool refers_back = !local && intent_refers_back(slot->prompt);
+    if (!local && !refers_back) {
+      xSemaphoreTake(s_state_mutex, portMAX_DELAY);
+      uint8_t state_bits = s_gripper_open ? PLAN_STATE_GRIPPER_OPEN : 0;
+      xSemaphoreGive(s_state_mutex);
+      if (s_vision_available.load(std::memory_order_relaxed)) state_bits |= PLAN_STATE_VISION_OK;
+      plan_key = plan_cache_key(slot->prompt, state_bits);
+      cached = plan_cache_lookup(plan_key, (uint32_t)(esp_log_timestamp() / 1000), &plan,
+                                 cached_reply, sizeof(cached_reply));
+    }
+    if (local) {
+      turn_span.name = "intent";
+      err = intent_execute(job_id, &plan, NULL, slot->response, sizeof(slot->response));
+      uint32_t saved_ms = s_llm_overhead_ms.load(std::memory_order_relaxed);
+      s_intent_hits.fetch_add(1, std::memory_order_relaxed);
+      s_intent_saved_ms.fetch_add(saved_ms, std::memory_order_relaxed);
+      rover_log_field_t intent_fields[] = {
+        rover_log_field_int("id", job_id),
+        rover_log_field_int("steps", plan.count),
+        rover_log_field_int("parse_us", parse_us),
+        rover_log_field_int("exec_ms", (int64_t)((xTaskGetTickCount() - turn_start) * portTICK_PERIOD_MS)),
+        rover_log_field_int("saved_ms", saved_ms),
+        rover_log_field_str("status", err == ESP_OK ? "ok" : "failed"),
+      };
+      rover_log_record_t intent_rec = {
+        .level = ESP_LOG_INFO,
+        .component = TAG,
+        .event = "intent_hit",
+        .fields = intent_fields,
+        .field_count = sizeof(intent_fields) / sizeof(intent_fields[0]),
+      };
+      rover_log(&intent_rec);
+    } else if (cached) {
+      turn_span.name = "plan_cache";
+      err = intent_execute(job_id, &plan, cached_reply, slot->response, sizeof(slot->response));
+      if (err != ESP_OK) {
+        plan_cache_invalidate(plan_key);
+      }
+      uint32_t saved_ms = s_llm_overhead_ms.load(std::memory_order_relaxed);
+      s_intent_saved_ms.fetch_add(saved_ms, std::memory_order_relaxed);
+      rover_log_field_t cache_fields[] = {
+        rover_log_field_int("id", job_id),
+        rover_log_field_int("steps", plan.count),
+        rover_log_field_int("exec_ms", (int64_t)((xTaskGetTickCount() - turn_start) * portTICK_PERIOD_MS)),
+        rover_log_field_int("saved_ms", saved_ms),
+        rover_log_field_str("status", err == ESP_OK ? "ok" : "failed"),
+      };
+      rover_log_record_t cache_rec = {
+        .level = ESP_LOG_INFO,
+        .component = TAG,
+        .event = "plan_cache_hit",
+        .fields = cache_fields,
+        .field_count = sizeof(cache_fields) / sizeof(cache_fields[0]),
+      };
+      rover_log(&cache_rec);
+    } else if (!s_ai_ready) {
+      s_intent_misses.fetch_add(1, std::memory_order_relaxed);
       err = ESP_ERR_INVALID_STATE;
-      strlcpy(response, "AI unavailable", sizeof(response));
+      strlcpy(slot->response, "AI unavailable", sizeof(slot->response));
     } else {
+      s_intent_misses.fetch_add(1, std::memory_order_relaxed);
+      s_chat_tool_ticks = 0;
+      memset(&s_plan_rec, 0, sizeof(s_plan_rec));
+      s_plan_rec_calls = 0;
+      ai_async_reset();
+      scene_reset();
+      prefetch_start();
+      uint32_t heap_start = (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+      heap_caps_monitor_local_minimum_free_size_start();
+      turn_arena_begin();
+      intent_topic_t topic = intent_topic(slot->prompt);
+      // A plan may lean on what the snapshot showed ("the cup is on the left"); the cache key
+      // does not hold the scene, so such plans are not stored.
+      bool scene_dependent = false;
+      size_t snapshot_len =
+          kStateSnapshotEnabled ? build_state_snapshot(s_llm_prompt, kStateSnapshotMax, &scene_dependent) : 0;
+      strlcpy(s_llm_prompt + snapshot_len, slot->prompt, sizeof(s_llm_prompt) - snapshot_len);
+      chat_memory_expire((uint32_t)esp_log_timestamp());
+      chat_memory_turn_t memory_turns[CHAT_MEMORY_TURNS_MAX];
+      ai_chat_exchange_t exchanges[CHAT_MEMORY_TURNS_MAX];
+      ai_chat_history_t history = {};
+      history.summary = s_chat_memory.summary;
+      history.exchanges = exchanges;
+      history.exchange_count = chat_memory_turns(&s_chat_memory, memory_turns, CHAT_MEMORY_TURNS_MAX);
+      for (size_t i = 0; i < history.exchange_count; ++i) {
+        exchanges[i].user = memory_turns[i].user;
+        exchanges[i].assistant = memory_turns[i].reply;
+      }
+      // Self-contained commands go without history, so their plans stay cacheable; small
+      // talk and prompts that refer back get it.
+      bool with_history = (refers_back || topic == INTENT_TOPIC_CHAT) && !chat_memory_empty(&s_chat_memory);
+      uint32_t memory_tokens = with_history ? chat_memory_tokens(&s_chat_memory) : 0;
       xSemaphoreTake(s_ai_mutex, portMAX_DELAY);
-      err = openrouter_call_with_tools(s_ai, job.prompt, response, sizeof(response), 5);
+      err = ai_chat_with_tools(&s_ai_chat_topic[topic], with_history ? &history : NULL, s_llm_prompt,
+                               slot->response, sizeof(slot->response));
+      ai_chat_turn_stats_t turn_stats;
+      ai_chat_last_turn(&turn_stats);
       xSemaphoreGive(s_ai_mutex);
+      turn_arena_end();
+      uint32_t heap_min = (uint32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+      heap_caps_monitor_local_minimum_free_size_stop();
+      prefetch_retire();
+      log_turn_memory(job_id, heap_start, heap_min);
+      s_llm_turns.fetch_add(1, std::memory_order_relaxed);
+      s_llm_tool_rounds.fetch_add(turn_stats.tool_rounds, std::memory_order_relaxed);
+      // Model time only, as for s_llm_overhead_ms below.
+      uint32_t llm_ms = (uint32_t)((xTaskGetTickCount() - turn_start - s_chat_tool_ticks) * portTICK_PERIOD_MS);
+      s_topic_turns[topic].fetch_add(1, std::memory_order_relaxed);
+      s_topic_request_bytes[topic].fetch_add(turn_stats.request_bytes, std::memory_order_relaxed);
+      s_topic_llm_ms[topic].fetch_add(llm_ms, std::memory_order_relaxed);
+      rover_log_field_t llm_fields[] = {
+        rover_log_field_int("id", job_id),
+        rover_log_field_str("topic", intent_topic_name(topic)),
+        rover_log_field_int("tools", (int64_t)s_ai_chat_topic[topic].tool_count),
+        rover_log_field_int("request_bytes", turn_stats.request_bytes),
+        rover_log_field_int("llm_ms", llm_ms),
+        rover_log_field_int("snapshot_bytes", (int64_t)snapshot_len),
+        rover_log_field_int("memory_tokens", memory_tokens),
+        rover_log_field_int("rounds", turn_stats.rounds),
+        rover_log_field_int("tool_rounds", turn_stats.tool_rounds),
+        rover_log_field_int("tool_calls", turn_stats.tool_calls),
+      };
+      rover_log_record_t llm_rec = {
+        .level = ESP_LOG_INFO,
+        .component = TAG,
+        .event = "llm_turn",
+        .fields = llm_fields,
+        .field_count = sizeof(llm_fields) / sizeof(llm_fields[0]),
+      };
+      rover_log(&llm_rec);
+      if (err == ESP_OK && !with_history && !refers_back && !scene_dependent && s_plan_rec_calls > 0 &&
+          s_plan_rec_calls == s_plan_rec.count) {
+        // Every call was a successful action and none of it came from earlier turns: the
+        // prompt alone replays it.
+        uint32_t uptime_s = (uint32_t)(esp_log_timestamp() / 1000);
+        plan_cache_store(plan_key, uptime_s, &s_plan_rec, slot->response);
+        esp_err_t flush_err = plan_cache_flush(uptime_s);
+        if (flush_err != ESP_OK) {
+          ESP_LOGW(TAG, "plan cache flush failed: %s", esp_err_to_name(flush_err));
+        }
+      }
+      if (err == ESP_OK) {
+        // Model overhead only: tool execution would have happened on the local path too.
+        TickType_t turn = xTaskGetTickCount() - turn_start;
+        uint32_t overhead_ms = (uint32_t)((turn - s_chat_tool_ticks) * portTICK_PERIOD_MS);
+        uint32_t avg = s_llm_overhead_ms.load(std::memory_order_relaxed);
+        s_llm_overhead_ms.store(avg == 0 ? overhead_ms : (avg * 3 + overhead_ms) / 4,
+                                std::memory_order_relaxed);
+      }
+    }
+
+    trace_end(&turn_span, err);
+    trace_turn_set(0);
+    if (err == ESP_OK) chat_memory_remember(slot->prompt, slot->response);
+
+    if (err == ESP_ERR_NOT_FINISHED) {
+      rover_log_field_t cancel_fields[] = {
+        rover_log_field_int("id", job_id),
+        rover_log_field_str("reason", s_chat_cancel_reason),
+        rover_log_field_int("time_to_cancel_ms",
+                            (int64_t)((xTaskGetTickCount() - s_chat_cancel_tick) * portTICK_PERIOD_MS)),
+      };
+      rover_log_record_t cancel_rec = {
+        .level = ESP_LOG_INFO,
+        .component = TAG,
+        .event = "web_chat_cancelled",
+        .fields = cancel_fields,
+        .field_count = sizeof(cancel_fields) / sizeof(cancel_fields[0]),
+      };
+      rover_log(&cancel_rec);
     }
 
     // Safety: on AI error, stop motors
     if (err != ESP_OK) {
       rover_emergency_stop();
       xSemaphoreTake(s_state_mutex, portMAX_DELAY);
+      track_stop_locked("ai");
       set_motion(0, 0, 0, false);
       transition_to(STATE_IDLE);
       xSemaphoreGive(s_state_mutex);
@@ -1545,19 +3783,19 @@ static void chat_worker_task(void *arg) {
     }
 
     xSemaphoreTake(s_chat_mutex, portMAX_DELAY);
-    if (job.id >= s_chat_done_id) {
-      s_chat_done_id = job.id;
-      s_chat_result_err = err;
-      s_chat_pending = false;
-      if (err == ESP_OK) {
-        strlcpy(s_chat_response, response, sizeof(s_chat_response));
-      } else {
-        s_chat_response[0] = '\0';
-      }
-    }
+    slot->err = err;
+    slot->response_len = err == ESP_OK ? strlen(slot->response) : 0;
+    slot->last_used = xTaskGetTickCount();
+    slot->state = CHAT_SLOT_DONE;
+    s_chat_cancel.store(false, std::memory_order_relaxed);
     xSemaphoreGive(s_chat_mutex);
+    s_chat_inflight.fetch_sub(1, std::memory_order_relaxed);
+    // After the result is published: the SSE task reads the final text from the slot.
+    chat_stream_push(job_id, err == ESP_OK ? CHAT_STREAM_DONE : CHAT_STREAM_ERROR, NULL, 0,
+                     kChatStreamEndSendTimeout);
 
     rover_log_field_t fields[] = {
+      rover_log_field_int("id", job_id),
       rover_log_field_str("status", err == ESP_OK ? "ok" : "failed"),
     };
     rover_log_record_t done_rec = {
@@ -1648,7 +3886,7 @@ static esp_err_t handle_root(httpd_req_t *req) {
       "const C=document.getElementById('joy'),ctx=C.getContext('2d');"
       "const R=90,DR=30;"
       "let jx=0,jy=0,jDown=false,jTimer=0;"
-      "let holdAct='',holdT=0,lastId=0;"
+      "let holdAct='',holdT=0,lastId=0,busy=false;"
       "const spd=()=>parseInt(document.getElementById('spdSlider').value);"
       "document.getElementById('spdSlider').oninput=function(){document.getElementById('spdVal').textContent=this.value+'%'};"
       /* draw joystick */
@@ -1697,18 +3935,30 @@ static esp_err_t handle_root(httpd_req_t *req) {
       "document.getElementById('stMotion').textContent=j.motion?'Moving x:'+j.x+' y:'+j.y+' z:'+j.z:'Stopped';"
       "document.getElementById('stGrip').textContent='Grip: '+j.gripper;"
       "}catch(e){document.getElementById('stPill').textContent='ERR';}}"
-      /* chat */
+      /* chat: open the LLM connection while the user is still typing */
+      "let warmT=0;function warm(){const n=Date.now();if(n-warmT<10000)return;warmT=n;"
+      "fetch('/ai_warm',{method:'POST'}).catch(()=>{});}"
       "async function ask(){const m=document.getElementById('msg').value.trim();if(!m)return;"
       "document.getElementById('chatInfo').textContent='sending...';"
-      "const r=await fetch('/chat',{method:'POST',headers:{'Content-Type':'text/plain;charset=utf-8'},body:m});"
+      "const r=await fetch('/chat'+(busy?'?replace=1':''),{method:'POST',headers:{'Content-Type':'text/plain;charset=utf-8'},body:m});"
       "const t=await r.text();"
       "document.getElementById('chatInfo').textContent=t;"
-      "try{const j=JSON.parse(t);if(j.id){lastId=j.id;setTimeout(poll,600);}}catch(_){}}"
+      "try{const j=JSON.parse(t);if(j.id){lastId=j.id;stream(j.id);}}catch(_){}}"
+      "function stream(id){if(!window.EventSource){setTimeout(poll,600);return;}"
+      "const out=document.getElementById('chatOut'),info=document.getElementById('chatInfo');"
+      "out.textContent='';busy=true;let fin=false;const es=new EventSource('/chat_stream?id='+id);"
+      "es.addEventListener('token',e=>{out.textContent+=JSON.parse(e.data).t;});"
+      "es.addEventListener('tool',e=>{const j=JSON.parse(e.data);"
+      "info.textContent=(j.phase==='call'?'running ':'finished ')+j.name;});"
+      "es.addEventListener('done',e=>{fin=true;busy=false;es.close();out.textContent=JSON.parse(e.data).text;"
+      "info.textContent='done id='+id;});"
+      "es.addEventListener('error',e=>{es.close();if(fin)return;fin=true;"
+      "if(e.data){busy=false;info.textContent='ai error '+JSON.parse(e.data).err;return;}setTimeout(poll,600);});}"
       "async function poll(){if(!lastId){document.getElementById('chatInfo').textContent='no chat id';return;}"
       "const r=await fetch('/chat_result?id='+lastId);const t=await r.text();"
       "if(r.status===202||t==='pending'){document.getElementById('chatInfo').textContent='pending id='+lastId;"
       "setTimeout(poll,900);return;}"
-      "document.getElementById('chatInfo').textContent='done id='+lastId;"
+      "busy=false;document.getElementById('chatInfo').textContent='done id='+lastId;"
       "document.getElementById('chatOut').textContent=t;}"
       /* vision */
       "async function vscan(c){"
@@ -1721,7 +3971,7 @@ static esp_err_t handle_root(httpd_req_t *req) {
       "async function vcapture(){"
       "const vo=document.getElementById('visionOut'),img=document.getElementById('camImg');"
       "vo.textContent='capturing...';"
-      "try{const r=await fetch('/vision?cmd=CAPTURE&quality=75');"
+      "try{const r=await fetch('/vision?cmd=CAPTURE&for=preview');"
       "if(!r.ok){vo.textContent='capture failed: '+r.status;return;}"
       "const b=await r.blob();"
       "const u=URL.createObjectURL(b);"
@@ -1729,35 +3979,244 @@ static esp_err_t handle_root(httpd_req_t *req) {
       "img.src=u;img.style.display='block';"
       "vo.textContent='captured '+b.size+' bytes';}"
       "catch(e){vo.textContent='error: '+e;}}"
-      "drawJ();setInterval(refresh,1500);refresh();"
+      "document.getElementById('msg').addEventListener('input',warm);"
+      "drawJ();setInterval(refresh,1500);refresh();warm();"
       "</script></body></html>";
   httpd_resp_set_type(req, "text/html");
   return httpd_resp_send(req, html, HTTPD_RESP_USE_STRLEN);
 }
 
+// Lowest stack headroom the httpd task has reported so far, in bytes; httpd task only.
+static UBaseType_t s_httpd_stack_min = UINT32_MAX;
+
+// Logs the httpd task's stack high-water mark each time a handler takes it to a new low, so
+// the headroom left by the heaviest handlers can be checked on hardware.
+static void log_httpd_stack(const char *handler, esp_err_t err) {
+  UBaseType_t stack_free = uxTaskGetStackHighWaterMark(NULL);
+  if (stack_free >= s_httpd_stack_min) return;
+  s_httpd_stack_min = stack_free;
+  rover_log_field_t fields[] = {
+    rover_log_field_str("handler", handler),
+    rover_log_field_int("stack_free", (int64_t)stack_free),
+    rover_log_field_str("err", esp_err_to_name(err)),
+  };
+  rover_log_record_t rec = {
+    .level = ESP_LOG_INFO,
+    .component = TAG,
+    .event = "httpd_stack",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
+}
+
+// Formats one section of a chunked response into buf and sends it. A section that does not
+// fit is not sent at all, so the client sees a short response rather than broken JSON.
+static esp_err_t send_chunk_fmt(httpd_req_t *req, char *buf, size_t size, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+static esp_err_t send_chunk_fmt(httpd_req_t *req, char *buf, size_t size, const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, size, fmt, ap);
+  va_end(ap);
+  if (n < 0 || (size_t)n >= size) return ESP_ERR_INVALID_SIZE;
+  return httpd_resp_send_chunk(req, buf, n);
+}
+
+// Per-phase chat latency aggregates (see trace.h); the individual spans go to the log.
+static esp_err_t handle_metrics(httpd_req_t *req) {
+  char body[2048];
+  int n = trace_metrics_json(body, sizeof(body));
+  // Adaptive timeout estimates go in as one more member of the same object.
+  static const char kTimeouts[] = ",\"timeouts\":{";
+  if (n > 0 && (size_t)n + sizeof(kTimeouts) < sizeof(body)) {
+    memcpy(body + n - 1, kTimeouts, sizeof(kTimeouts));
+    n += sizeof(kTimeouts) - 2;
+    int w = timeouts_json(body + n, sizeof(body) - n - 2);
+    if (w < 0) {
+      n = -1;
+    } else {
+      n += w;
+      memcpy(body + n, "}}", 3);
+      n += 2;
+    }
+  }
+  if (n < 0) {
+    httpd_resp_set_status(req, "500 Internal Server Error");
+    return httpd_resp_send(req, "metrics overflow", HTTPD_RESP_USE_STRLEN);
+  }
+  httpd_resp_set_type(req, "application/json");
+  esp_err_t err = httpd_resp_send(req, body, n);
+  log_httpd_stack("metrics", err);
+  return err;
+}
+
+// Sent in sections through one heap buffer: the document outgrew what the httpd stack can
+// hold, and every counter added to it would otherwise grow the handler's frame.
 static esp_err_t handle_status(httpd_req_t *req) {
-  char body[256];
+  char *buf = (char *)malloc(kStatusChunkMax);
+  if (buf == NULL) {
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    return httpd_resp_send(req, "no memory", HTTPD_RESP_USE_STRLEN);
+  }
   int16_t vbus_mv = 0;
   int32_t bat_pct = -1;
   read_power_metrics(&vbus_mv, &bat_pct);
+  plan_cache_stats_t plan_stats;
+  plan_cache_stats(&plan_stats);
+  ai_conn_stats_t conn_stats;
+  ai_client_conn_stats(&conn_stats);
+  turn_arena_stats_t arena_stats;
+  turn_arena_stats(&arena_stats);
+
   xSemaphoreTake(s_state_mutex, portMAX_DELAY);
-  int n = snprintf(body,
-                   sizeof(body),
-                   "{\"state\":\"%s\",\"motion\":%d,\"x\":%d,\"y\":%d,\"z\":%d,"
-                   "\"gripper\":\"%s\",\"vision\":\"%s\","
-                   "\"bat_pct\":%d,\"vbus_mv\":%d}",
-                   state_name(s_rover_state),
-                   s_motion_active ? 1 : 0,
-                   s_motion_x,
-                   s_motion_y,
-                   s_motion_z,
-                   s_gripper_open ? "open" : "close",
-                   s_vision_available.load(std::memory_order_relaxed) ? "ok" : "offline",
-                   (int)bat_pct,
-                   (int)vbus_mv);
+  rover_state_t state = s_rover_state;
+  bool motion_active = s_motion_active;
+  int motion_x = s_motion_x, motion_y = s_motion_y, motion_z = s_motion_z;
+  bool gripper_open = s_gripper_open;
+  track_phase_t track_phase = s_track.phase;
+  track_mode_t track_mode = s_track.mode;
+  char track_label[VISION_WORLD_LABEL_MAX];
+  strlcpy(track_label, s_track.label, sizeof(track_label));
   xSemaphoreGive(s_state_mutex);
+
+  httpd_resp_set_type(req, "application/json");
+  esp_err_t err = send_chunk_fmt(
+      req, buf, kStatusChunkMax,
+      "{\"state\":\"%s\",\"motion\":%d,\"x\":%d,\"y\":%d,\"z\":%d,"
+      "\"gripper\":\"%s\",\"vision\":\"%s\","
+      "\"vision_baud\":%d,\"vision_bps\":%" PRIu32 ","
+      "\"vision_link\":\"%s\",\"vision_frame_err\":%" PRIu32 ","
+      "\"vision_events\":%" PRIu32 ",\"world\":",
+      state_name(state), motion_active ? 1 : 0, motion_x, motion_y, motion_z,
+      gripper_open ? "open" : "close",
+      s_vision_available.load(std::memory_order_relaxed) ? "ok" : "offline",
+      s_vision_baud.load(std::memory_order_relaxed),
+      s_vision_last_bps.load(std::memory_order_relaxed),
+      s_vision_framed.load(std::memory_order_relaxed) ? "framed" : "line",
+      s_vision_frame_errors.load(std::memory_order_relaxed),
+      s_vision_events.load(std::memory_order_relaxed));
+
+  if (err == ESP_OK) {
+    vision_world_t world;
+    int w = -1;
+    if (vision_world_latest(&world)) {
+      w = vision_world_to_json(&world, (uint32_t)esp_log_timestamp(), buf, kStatusChunkMax);
+    }
+    err = w > 0 ? httpd_resp_send_chunk(req, buf, w) : httpd_resp_send_chunk(req, "null", 4);
+  }
+  if (err == ESP_OK) {
+    err = send_chunk_fmt(
+        req, buf, kStatusChunkMax,
+        ",\"intent_hits\":%" PRIu32 ",\"intent_misses\":%" PRIu32 ","
+        "\"intent_saved_ms\":%" PRIu32 ",\"plan_hits\":%" PRIu32 ","
+        "\"plan_misses\":%" PRIu32 ",\"plan_entries\":%" PRIu32 ","
+        "\"ai_conn_open\":%s,\"ai_connects\":%" PRIu32 ",\"ai_reuses\":%" PRIu32 ","
+        "\"prefetch_scans\":%" PRIu32 ",\"prefetch_scan_hits\":%" PRIu32 ","
+        "\"prefetch_scan_wasted\":%" PRIu32 ",\"prefetch_imu_hits\":%" PRIu32 ","
+        "\"ai_models\":[",
+        s_intent_hits.load(std::memory_order_relaxed),
+        s_intent_misses.load(std::memory_order_relaxed),
+        s_intent_saved_ms.load(std::memory_order_relaxed),
+        plan_stats.hits, plan_stats.misses, plan_stats.entries,
+        conn_stats.open ? "true" : "false", conn_stats.connects, conn_stats.reuses,
+        s_prefetch_scans.load(std::memory_order_relaxed),
+        s_prefetch_scan_hits.load(std::memory_order_relaxed),
+        s_prefetch_scan_wasted.load(std::memory_order_relaxed),
+        s_prefetch_imu_hits.load(std::memory_order_relaxed));
+  }
+  if (err == ESP_OK) {
+    ai_model_stats_t model_stats[AI_MODEL_TIERS_MAX];
+    size_t model_count = ai_client_model_stats(model_stats, AI_MODEL_TIERS_MAX);
+    for (size_t i = 0; i < model_count && err == ESP_OK; ++i) {
+      const ai_model_stats_t *m = &model_stats[i];
+      err = send_chunk_fmt(req, buf, kStatusChunkMax,
+                           "%s{\"model\":\"%s\",\"req\":%" PRIu32 ",\"fail\":%" PRIu32 ","
+                           "\"hedges\":%" PRIu32 ",\"hedge_wins\":%" PRIu32 ","
+                           "\"p95_ms\":%" PRIu32 ",\"breaker\":\"%s\"}",
+                           i ? "," : "", m->model, m->requests, m->failures, m->hedges,
+                           m->hedge_wins, m->p95_ms, m->breaker_open ? "open" : "closed");
+    }
+  }
+  if (err == ESP_OK) {
+    err = send_chunk_fmt(
+        req, buf, kStatusChunkMax,
+        "],\"arena_peak\":%" PRIu32 ",\"arena_overflows\":%" PRIu32 ","
+        "\"turn_heap_min\":%" PRIu32 ",\"turn_heap_used\":%" PRIu32 ","
+        "\"llm_turns\":%" PRIu32 ",\"llm_tool_rounds\":%" PRIu32 ",\"llm_topics\":{",
+        arena_stats.peak, arena_stats.overflows,
+        s_turn_heap_min.load(std::memory_order_relaxed),
+        s_turn_heap_used.load(std::memory_order_relaxed),
+        s_llm_turns.load(std::memory_order_relaxed),
+        s_llm_tool_rounds.load(std::memory_order_relaxed));
+  }
+  // Per topic: turns, and request bytes and model time per turn.
+  for (int t = 0; t < INTENT_TOPIC_COUNT && err == ESP_OK; ++t) {
+    uint32_t turns = s_topic_turns[t].load(std::memory_order_relaxed);
+    uint32_t div = turns ? turns : 1;
+    err = send_chunk_fmt(req, buf, kStatusChunkMax,
+                         "%s\"%s\":{\"turns\":%" PRIu32 ",\"req_bytes\":%" PRIu32 ","
+                         "\"llm_ms\":%" PRIu32 "}",
+                         t ? "," : "", intent_topic_name((intent_topic_t)t), turns,
+                         s_topic_request_bytes[t].load(std::memory_order_relaxed) / div,
+                         s_topic_llm_ms[t].load(std::memory_order_relaxed) / div);
+  }
+  if (err == ESP_OK) {
+    err = send_chunk_fmt(
+        req, buf, kStatusChunkMax,
+        "},\"memory_tokens\":%" PRIu32 ",\"memory_turns\":%" PRIu32 ","
+        "\"memory_dropped\":%" PRIu32 ",\"memory_compactions\":%" PRIu32 ","
+        "\"scene_diffs\":%" PRIu32 ",\"scene_saved_tokens\":%" PRIu32 ","
+        "\"scene_skipped_scans\":%" PRIu32 ","
+        "\"ai_action_running\":%s,\"loop_max_ms\":%" PRIu32 ",\"loop_overruns\":%" PRIu32 ","
+        "\"track\":\"%s\",\"track_mode\":\"%s\",\"track_target\":\"%s\","
+        "\"bat_pct\":%d,\"vbus_mv\":%d}",
+        s_memory_tokens.load(std::memory_order_relaxed),
+        s_memory_turns.load(std::memory_order_relaxed),
+        s_memory_dropped.load(std::memory_order_relaxed),
+        s_memory_compactions.load(std::memory_order_relaxed),
+        s_scene_diffs.load(std::memory_order_relaxed),
+        s_scene_saved_bytes.load(std::memory_order_relaxed) / 4,
+        s_scene_skipped_scans.load(std::memory_order_relaxed),
+        s_ai_action_running.load(std::memory_order_relaxed) ? "true" : "false",
+        s_loop_max_us.load(std::memory_order_relaxed) / 1000,
+        s_loop_overruns.load(std::memory_order_relaxed),
+        track_phase_name(track_phase), track_mode_name(track_mode), track_label,
+        (int)bat_pct, (int)vbus_mv);
+  }
+  free(buf);
+  if (err == ESP_OK) {
+    err = httpd_resp_send_chunk(req, NULL, 0);
+  } else if (err == ESP_ERR_INVALID_SIZE) {
+    ESP_LOGE(TAG, "/status section over %u bytes, response cut", (unsigned)kStatusChunkMax);
+  }
+  log_httpd_stack("status", err);
+  return err;
+}
+
+// /track?mode=approach|follow|grab|stop&target=cup
+static esp_err_t handle_track(httpd_req_t *req) {
+  char query[96] = {0};
+  char mode[12] = "approach";
+  char target[VISION_WORLD_LABEL_MAX] = "";
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+    (void)httpd_query_key_value(query, "mode", mode, sizeof(mode));
+    (void)httpd_query_key_value(query, "target", target, sizeof(target));
+  }
+  mark_activity();
+  esp_err_t err = track_command(mode, target, "web");
+
   httpd_resp_set_type(req, "application/json");
-  return httpd_resp_send(req, body, n);
+  if (err == ESP_ERR_INVALID_ARG) {
+    httpd_resp_set_status(req, "400 Bad Request");
+    return httpd_resp_send(req, "{\"ok\":false,\"error\":\"invalid mode\"}", HTTPD_RESP_USE_STRLEN);
+  }
+  if (err != ESP_OK) {
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    return httpd_resp_send(req, "{\"ok\":false,\"error\":\"vision stream not running\"}",
+                           HTTPD_RESP_USE_STRLEN);
+  }
+  return httpd_resp_send(req, "{\"ok\":true}", HTTPD_RESP_USE_STRLEN);
 }
 
 static esp_err_t handle_vision(httpd_req_t *req) {
@@ -1765,10 +4224,12 @@ static esp_err_t handle_vision(httpd_req_t *req) {
   char cmd[16] = "SCAN";
   char mode[16] = "RELIABLE";
   char quality_str[8] = "";
+  char consumer_str[12] = "";
   if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
     (void)httpd_query_key_value(query, "cmd", cmd, sizeof(cmd));
     (void)httpd_query_key_value(query, "mode", mode, sizeof(mode));
     (void)httpd_query_key_value(query, "quality", quality_str, sizeof(quality_str));
+    (void)httpd_query_key_value(query, "for", consumer_str, sizeof(consumer_str));
   }
 
   // Whitelist commands
@@ -1784,15 +4245,16 @@ static esp_err_t handle_vision(httpd_req_t *req) {
 
   // CAPTURE: binary JPEG response
   if (strcmp(cmd, "CAPTURE") == 0) {
-    int quality = kCaptureDefaultQuality;
-    if (quality_str[0] != '\0') {
-      int q = atoi(quality_str);
-      if (q >= 10 && q <= 95) quality = q;
-    }
+    // An explicit quality is honoured as-is; otherwise the controller plans for the consumer.
+    int quality = quality_str[0] != '\0' ? atoi(quality_str) : 0;
+    capture_consumer_t consumer =
+        strcmp(consumer_str, "llm") == 0 ? CAPTURE_CONSUMER_LLM : CAPTURE_CONSUMER_PREVIEW;
     uint8_t *jpeg = NULL;
     size_t jpeg_size = 0;
     xSemaphoreTake(s_vision_mutex, portMAX_DELAY);
-    esp_err_t err = vision_capture(quality, &jpeg, &jpeg_size);
+    esp_err_t err = (quality >= 10 && quality <= 95)
+                        ? vision_capture(quality, CAPTURE_RES_QVGA, &jpeg, &jpeg_size)
+                        : vision_capture_auto(consumer, &jpeg, &jpeg_size);
     xSemaphoreGive(s_vision_mutex);
     if (err != ESP_OK) {
       s_vision_available.store(false, std::memory_order_relaxed);
@@ -1827,7 +4289,7 @@ static esp_err_t handle_vision(httpd_req_t *req) {
     return httpd_resp_send(req, "{\"ok\":false,\"error\":\"camera timeout\"}", HTTPD_RESP_USE_STRLEN);
   }
   // Update availability on any successful response
-  if (!s_vision_available.load(std::memory_order_relaxed) && strstr(resp, "\"ok\":true") != NULL) {
+  if (!s_vision_available.load(std::memory_order_relaxed) && json_tok_ok(resp, sizeof(resp))) {
     s_vision_available.store(true, std::memory_order_relaxed);
     rover_log_record_t rec1 = {
       .level = ESP_LOG_INFO,
@@ -1858,6 +4320,9 @@ static esp_err_t handle_cmd(httpd_req_t *req) {
   if (action[0] == '\0') {
     strlcpy(action, "stop", sizeof(action));
   }
+  if (strcmp(action, "stop") == 0) {
+    chat_cancel("stop");
+  }
 
   xSemaphoreTake(s_state_mutex, portMAX_DELAY);
 
@@ -1872,6 +4337,7 @@ static esp_err_t handle_cmd(httpd_req_t *req) {
     y = clamp_int(y, -100, 100);
     z = clamp_int(z, -100, 100);
     mark_activity();
+    track_stop_locked("web");
     bool active = (x != 0 || y != 0 || z != 0);
     set_motion((int8_t)x, (int8_t)y, (int8_t)z, active);
     s_web_motion_deadline = active ? xTaskGetTickCount() + pdMS_TO_TICKS(1500) : 0;
@@ -1913,45 +4379,79 @@ static esp_err_t handle_chat(httpd_req_t *req) {
       read_total += r;
     }
     prompt[read_total] = '\0';
-  } else if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+  }
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK && prompt[0] == '\0') {
     (void)httpd_query_key_value(query, "msg", prompt, CHAT_PROMPT_MAX);
   }
   if (prompt[0] == '\0') {
     httpd_resp_set_status(req, "400 Bad Request");
     return httpd_resp_send(req, "{\"ok\":false,\"error\":\"missing msg\"}", HTTPD_RESP_USE_STRLEN);
   }
-  if (s_ai == NULL || s_chat_queue == NULL) {
+  if (!s_ai_ready || s_chat_queue == NULL) {
     httpd_resp_set_status(req, "503 Service Unavailable");
     return httpd_resp_send(req, "{\"ok\":false,\"error\":\"ai unavailable\"}", HTTPD_RESP_USE_STRLEN);
   }
 
-  chat_job_t job = {};
+  // ?replace=1: the user changed their mind; abandon what is queued or in flight first.
+  char replace[4] = "";
+  (void)httpd_query_key_value(query, "replace", replace, sizeof(replace));
+  if (replace[0] == '1') {
+    chat_cancel("replace");
+  }
+
   xSemaphoreTake(s_chat_mutex, portMAX_DELAY);
-  if (s_chat_pending) {
+  chat_slot_t *slot = chat_slot_claim_locked();
+  if (slot == NULL) {
+    // Every slot is queued, running or being read: genuinely busy.
     xSemaphoreGive(s_chat_mutex);
     httpd_resp_set_status(req, "429 Too Many Requests");
     return httpd_resp_send(req, "{\"ok\":false,\"error\":\"chat busy\"}", HTTPD_RESP_USE_STRLEN);
   }
   s_chat_id++;
-  job.id = s_chat_id;
-  strlcpy(job.prompt, prompt, sizeof(job.prompt));
-  s_chat_pending = true;
+  uint32_t job_id = s_chat_id;
+  slot->id = job_id;
+  slot->state = CHAT_SLOT_QUEUED;
+  slot->err = ESP_OK;
+  slot->response_len = 0;
+  slot->last_used = xTaskGetTickCount();
+  strlcpy(slot->prompt, prompt, sizeof(slot->prompt));
   xSemaphoreGive(s_chat_mutex);
 
-  if (xQueueSend(s_chat_queue, &job, 0) != pdTRUE) {
+  s_chat_inflight.fetch_add(1, std::memory_order_relaxed);
+  if (xQueueSend(s_chat_queue, &job_id, 0) != pdTRUE) {
     xSemaphoreTake(s_chat_mutex, portMAX_DELAY);
-    s_chat_pending = false;
+    slot->state = CHAT_SLOT_FREE;
     xSemaphoreGive(s_chat_mutex);
+    s_chat_inflight.fetch_sub(1, std::memory_order_relaxed);
     httpd_resp_set_status(req, "503 Service Unavailable");
     return httpd_resp_send(req, "{\"ok\":false,\"error\":\"chat queue full\"}", HTTPD_RESP_USE_STRLEN);
   }
 
   char resp[96];
-  int n = snprintf(resp, sizeof(resp), "{\"ok\":true,\"id\":%" PRIu32 ",\"status\":\"pending\"}", job.id);
+  int n = snprintf(resp, sizeof(resp), "{\"ok\":true,\"id\":%" PRIu32 ",\"status\":\"pending\"}", job_id);
   httpd_resp_set_type(req, "application/json");
   return httpd_resp_send(req, resp, n);
 }
 
+// The UI calls this on load and when the user starts typing, so the TLS handshake overlaps
+// with typing instead of delaying the first round.
+static esp_err_t handle_ai_warm(httpd_req_t *req) {
+  bool queued = false;
+  TickType_t now = xTaskGetTickCount();
+  if (s_ai_ready && (s_ai_prewarm_tick == 0 || now - s_ai_prewarm_tick >= kAiPrewarmMinGap) &&
+      !s_ai_prewarm_pending.exchange(true, std::memory_order_relaxed)) {
+    if (xQueueSend(s_chat_queue, &kChatPrewarmJob, 0) == pdTRUE) {
+      s_ai_prewarm_tick = now;
+      queued = true;
+    } else {
+      s_ai_prewarm_pending.store(false, std::memory_order_relaxed);
+    }
+  }
+  httpd_resp_set_type(req, "application/json");
+  return httpd_resp_send(req, queued ? "{\"ok\":true,\"queued\":true}" : "{\"ok\":true,\"queued\":false}",
+                         HTTPD_RESP_USE_STRLEN);
+}
+
 static esp_err_t handle_chat_result(httpd_req_t *req) {
   char query[64] = {0};
   char id_str[24] = {0};
@@ -1963,39 +4463,235 @@ static esp_err_t handle_chat_result(httpd_req_t *req) {
     id = (uint32_t)strtoul(id_str, NULL, 10);
   }
 
-  xSemaphoreTake(s_chat_mutex, portMAX_DELAY);
-  uint32_t current_id = s_chat_id;
-  uint32_t done_id = s_chat_done_id;
-  bool pending = s_chat_pending;
-  esp_err_t err = s_chat_result_err;
-  char response[CHAT_RESPONSE_MAX];
-  strlcpy(response, s_chat_response, sizeof(response));
-  xSemaphoreGive(s_chat_mutex);
-
   if (id == 0) {
-    id = current_id;
+    xSemaphoreTake(s_chat_mutex, portMAX_DELAY);
+    id = s_chat_id;
+    xSemaphoreGive(s_chat_mutex);
   }
-  if (id == 0 || id > current_id) {
+  chat_slot_state_t state = CHAT_SLOT_FREE;
+  chat_slot_t *slot = chat_slot_acquire(id, &state);
+  if (slot == NULL) {
+    if (state == CHAT_SLOT_QUEUED || state == CHAT_SLOT_RUNNING) {
+      httpd_resp_set_status(req, "202 Accepted");
+      return httpd_resp_send(req, "pending", HTTPD_RESP_USE_STRLEN);
+    }
+    // Unknown, or finished long enough ago that its slot was reused.
     httpd_resp_set_status(req, "404 Not Found");
     return httpd_resp_send(req, "no such chat id", HTTPD_RESP_USE_STRLEN);
   }
-  if (pending && id == current_id) {
-    httpd_resp_set_status(req, "202 Accepted");
-    return httpd_resp_send(req, "pending", HTTPD_RESP_USE_STRLEN);
-  }
-  if (id > done_id) {
-    httpd_resp_set_status(req, "202 Accepted");
-    return httpd_resp_send(req, "pending", HTTPD_RESP_USE_STRLEN);
-  }
-  if (err != ESP_OK) {
+
+  esp_err_t ret;
+  if (slot->err == ESP_ERR_NOT_FINISHED) {
+    httpd_resp_set_status(req, "409 Conflict");
+    ret = httpd_resp_send(req, "cancelled", HTTPD_RESP_USE_STRLEN);
+  } else if (slot->err != ESP_OK) {
     char body[64];
-    int n = snprintf(body, sizeof(body), "ai error: 0x%x", (unsigned)err);
+    int n = snprintf(body, sizeof(body), "ai error: 0x%x", (unsigned)slot->err);
     httpd_resp_set_status(req, "502 Bad Gateway");
-    return httpd_resp_send(req, body, n);
+    ret = httpd_resp_send(req, body, n);
+  } else {
+    // Straight from the pinned slot, in chunks: no per-poll copy of the answer.
+    httpd_resp_set_type(req, "text/plain; charset=utf-8");
+    ret = ESP_OK;
+    for (size_t off = 0; ret == ESP_OK && off < slot->response_len; off += kChatResultChunk) {
+      size_t n = slot->response_len - off;
+      ret = httpd_resp_send_chunk(req, slot->response + off, n < kChatResultChunk ? n : kChatResultChunk);
+    }
+    if (ret == ESP_OK) ret = httpd_resp_send_chunk(req, NULL, 0);
+  }
+  chat_slot_release(slot);
+  return ret;
+}
+
+// Length of the prefix of buf that ends on a UTF-8 character boundary.
+static size_t utf8_complete_len(const char *buf, size_t len) {
+  for (size_t back = 1; back <= 3 && back <= len; ++back) {
+    unsigned char c = (unsigned char)buf[len - back];
+    if ((c & 0xC0) == 0x80) continue;  // continuation byte
+    size_t need = (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : (c & 0xF8) == 0xF0 ? 4 : 1;
+    return need > back ? len - back : len;
+  }
+  return len;
+}
+
+static esp_err_t chat_stream_send(httpd_req_t *req, const char *event, const char *data) {
+  static char frame[1024];
+  int n = snprintf(frame, sizeof(frame), "event: %s\ndata: %s\n\n", event, data);
+  if (n <= 0 || n >= (int)sizeof(frame)) return ESP_ERR_INVALID_SIZE;
+  return httpd_resp_send_chunk(req, frame, n);
+}
+
+static esp_err_t chat_stream_send_text(httpd_req_t *req, const char *text, size_t len) {
+  static char raw[kChatStreamTextMax + 4];
+  static char escaped[6 * (kChatStreamTextMax + 4) + 1];
+  static char data[sizeof(escaped) + 16];
+  memcpy(raw, text, len);
+  raw[len] = '\0';
+  json_escape_copy(escaped, sizeof(escaped), raw);
+  snprintf(data, sizeof(data), "{\"t\":\"%s\"}", escaped);
+  return chat_stream_send(req, "token", data);
+}
+
+// Final event: the full answer (tokens may have been dropped) or the error code.
+static esp_err_t chat_stream_send_result(httpd_req_t *req, const chat_slot_t *slot) {
+  esp_err_t result = slot->err;
+  size_t cap = 6 * slot->response_len + 32;  // "\u00XX" is the longest escape
+  char *body = result == ESP_OK ? (char *)malloc(cap) : NULL;
+  if (body != NULL) {
+    memcpy(body, "event: done\ndata: {\"text\":\"", 27);
+    size_t n = 27 + json_escape_copy(body + 27, cap - 27 - 4, slot->response);
+    memcpy(body + n, "\"}\n\n", 5);
+  }
+
+  if (result == ESP_ERR_NOT_FINISHED) return chat_stream_send(req, "error", "{\"err\":\"cancelled\"}");
+  if (result != ESP_OK) {
+    char data[64];
+    snprintf(data, sizeof(data), "{\"err\":\"0x%x\"}", (unsigned)result);
+    return chat_stream_send(req, "error", data);
+  }
+  if (body == NULL) return chat_stream_send(req, "error", "{\"err\":\"no memory\"}");
+  esp_err_t err = httpd_resp_send_chunk(req, body, HTTPD_RESP_USE_STRLEN);
+  free(body);
+  return err;
+}
+
+// Items left over from an earlier stream belong to other jobs and are skipped by id below;
+// draining them up front would also drop the first tokens of this job.
+static const char *chat_stream_serve(httpd_req_t *req, uint32_t id, uint32_t *events) {
+  httpd_resp_set_type(req, "text/event-stream");
+  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+  if (httpd_resp_send_chunk(req, ": stream\n\n", HTTPD_RESP_USE_STRLEN) != ESP_OK) return "client_gone";
+
+  static char pend[kChatStreamTextMax + 4];
+  size_t pend_len = 0;
+  TickType_t start = xTaskGetTickCount();
+  while (xTaskGetTickCount() - start < kChatStreamMaxDuration) {
+    chat_slot_state_t state = CHAT_SLOT_FREE;
+    chat_slot_t *slot = chat_slot_acquire(id, &state);
+    if (slot != NULL) {
+      // Also covers clients that attach after the job completed or whose "done" was dropped.
+      (*events)++;
+      esp_err_t err = chat_stream_send_result(req, slot);
+      chat_slot_release(slot);
+      return err == ESP_OK ? "done" : "client_gone";
+    }
+    if (state == CHAT_SLOT_FREE) {
+      chat_stream_send(req, "error", "{\"err\":\"expired\"}");
+      return "expired";
+    }
+
+    size_t sz = 0;
+    chat_stream_item_t *item =
+        (chat_stream_item_t *)xRingbufferReceive(s_chat_stream_ring, &sz, kChatStreamPingPeriod);
+    if (item == NULL) {
+      if (httpd_resp_send_chunk(req, ": ping\n\n", HTTPD_RESP_USE_STRLEN) != ESP_OK) {
+        return "client_gone";
+      }
+      continue;
+    }
+    esp_err_t err = ESP_OK;
+    if (item->job_id == id) {
+      (*events)++;
+      if (item->type == CHAT_STREAM_TOKEN) {
+        memcpy(pend + pend_len, item->text, item->len);
+        pend_len += item->len;
+        size_t ready = utf8_complete_len(pend, pend_len);
+        if (ready > 0) {
+          err = chat_stream_send_text(req, pend, ready);
+          memmove(pend, pend + ready, pend_len - ready);
+          pend_len -= ready;
+        }
+      } else if (item->type == CHAT_STREAM_TOOL_CALL || item->type == CHAT_STREAM_TOOL_DONE) {
+        // The name comes from the model: escape it like the text.
+        static char name[kChatStreamTextMax + 1];
+        static char escaped[6 * kChatStreamTextMax + 1];
+        static char data[sizeof(escaped) + 48];
+        memcpy(name, item->text, item->len);
+        name[item->len] = '\0';
+        json_escape_copy(escaped, sizeof(escaped), name);
+        snprintf(data, sizeof(data), "{\"name\":\"%s\",\"phase\":\"%s\"}", escaped,
+                 item->type == CHAT_STREAM_TOOL_CALL ? "call" : "done");
+        err = chat_stream_send(req, "tool", data);
+      } else {
+        pend_len = 0;  // a dangling partial character is superseded by the full text
+      }
+    }
+    vRingbufferReturnItem(s_chat_stream_ring, item);
+    if (err != ESP_OK) return "client_gone";
+  }
+  return "timeout";
+}
+
+static void chat_stream_task(void *arg) {
+  (void)arg;
+  httpd_req_t *req = NULL;
+  while (1) {
+    if (xQueueReceive(s_chat_stream_req_queue, &req, portMAX_DELAY) != pdTRUE) continue;
+
+    char query[64] = {0};
+    char id_str[24] = {0};
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+      (void)httpd_query_key_value(query, "id", id_str, sizeof(id_str));
+    }
+    uint32_t id = (uint32_t)strtoul(id_str, NULL, 10);
+    xSemaphoreTake(s_chat_mutex, portMAX_DELAY);
+    if (id == 0) id = s_chat_id;
+    bool known = id != 0 && id <= s_chat_id;
+    xSemaphoreGive(s_chat_mutex);
+
+    uint32_t events = 0;
+    uint32_t drops_before = s_chat_stream_drops.load(std::memory_order_relaxed);
+    const char *reason = "unknown_id";
+    if (known) {
+      reason = chat_stream_serve(req, id, &events);
+      httpd_resp_send_chunk(req, NULL, 0);
+    } else {
+      httpd_resp_set_status(req, "404 Not Found");
+      httpd_resp_send(req, "no such chat id", HTTPD_RESP_USE_STRLEN);
+    }
+    s_chat_stream_active.store(false, std::memory_order_relaxed);
+    httpd_req_async_handler_complete(req);
+
+    rover_log_field_t fields[] = {
+      rover_log_field_int("id", id),
+      rover_log_field_int("events", events),
+      rover_log_field_int("dropped", s_chat_stream_drops.load(std::memory_order_relaxed) - drops_before),
+      rover_log_field_str("end", reason),
+    };
+    rover_log_record_t rec = {
+      .level = ESP_LOG_INFO,
+      .component = TAG,
+      .event = "chat_stream_end",
+      .fields = fields,
+      .field_count = sizeof(fields) / sizeof(fields[0]),
+    };
+    rover_log(&rec);
   }
+}
 
-  httpd_resp_set_type(req, "text/plain; charset=utf-8");
-  return httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
+// Hands the socket to chat_stream_task so the long-lived SSE response does not hold the
+// httpd worker. One stream at a time; the ring has a single consumer.
+static esp_err_t handle_chat_stream(httpd_req_t *req) {
+  if (s_chat_stream_ring == NULL || s_chat_stream_req_queue == NULL) {
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    return httpd_resp_send(req, "stream unavailable", HTTPD_RESP_USE_STRLEN);
+  }
+  bool expected = false;
+  if (!s_chat_stream_active.compare_exchange_strong(expected, true)) {
+    httpd_resp_set_status(req, "409 Conflict");
+    return httpd_resp_send(req, "stream busy", HTTPD_RESP_USE_STRLEN);
+  }
+  httpd_req_t *async_req = NULL;
+  if (httpd_req_async_handler_begin(req, &async_req) != ESP_OK) {
+    s_chat_stream_active.store(false, std::memory_order_relaxed);
+    return ESP_FAIL;
+  }
+  if (xQueueSend(s_chat_stream_req_queue, &async_req, 0) != pdTRUE) {
+    s_chat_stream_active.store(false, std::memory_order_relaxed);
+    httpd_req_async_handler_complete(async_req);
+    return ESP_FAIL;
+  }
+  return ESP_OK;
 }
 
 static void start_mdns(void) {
@@ -2007,9 +4703,12 @@ static void start_mdns(void) {
       {(char *)"path", (char *)"/"},
       {(char *)"api_cmd", (char *)"/cmd"},
       {(char *)"api_status", (char *)"/status"},
+      {(char *)"api_metrics", (char *)"/metrics"},
       {(char *)"api_vision", (char *)"/vision"},
       {(char *)"api_chat", (char *)"/chat"},
       {(char *)"api_chat_result", (char *)"/chat_result"},
+      {(char *)"api_chat_stream", (char *)"/chat_stream"},
+      {(char *)"api_ai_warm", (char *)"/ai_warm"},
   };
   ESP_ERROR_CHECK(mdns_service_add("AI Rover", "_http", "_tcp", 80, txt,
                                    sizeof(txt) / sizeof(txt[0])));
@@ -2030,6 +4729,7 @@ static void start_web_server(void) {
   httpd_config_t config = HTTPD_DEFAULT_CONFIG();
   config.server_port = 80;
   config.stack_size = 8192;
+  config.max_uri_handlers = 12;
   ESP_ERROR_CHECK(httpd_start(&s_httpd, &config));
   httpd_handle_t server = s_httpd;
 
@@ -2040,114 +4740,131 @@ static void start_web_server(void) {
       .uri = "/chat", .method = HTTP_POST, .handler = handle_chat, .user_ctx = NULL};
   httpd_uri_t chat_result = {
       .uri = "/chat_result", .method = HTTP_GET, .handler = handle_chat_result, .user_ctx = NULL};
+  httpd_uri_t chat_stream = {
+      .uri = "/chat_stream", .method = HTTP_GET, .handler = handle_chat_stream, .user_ctx = NULL};
+  httpd_uri_t ai_warm = {
+      .uri = "/ai_warm", .method = HTTP_POST, .handler = handle_ai_warm, .user_ctx = NULL};
   httpd_uri_t status = {.uri = "/status", .method = HTTP_GET, .handler = handle_status, .user_ctx = NULL};
+  httpd_uri_t metrics = {.uri = "/metrics", .method = HTTP_GET, .handler = handle_metrics, .user_ctx = NULL};
   httpd_uri_t vision = {.uri = "/vision", .method = HTTP_GET, .handler = handle_vision, .user_ctx = NULL};
+  httpd_uri_t track = {.uri = "/track", .method = HTTP_GET, .handler = handle_track, .user_ctx = NULL};
 
   ESP_ERROR_CHECK(httpd_register_uri_handler(server, &root));
   ESP_ERROR_CHECK(httpd_register_uri_handler(server, &cmd));
   ESP_ERROR_CHECK(httpd_register_uri_handler(server, &chat));
   ESP_ERROR_CHECK(httpd_register_uri_handler(server, &chat_post));
   ESP_ERROR_CHECK(httpd_register_uri_handler(server, &chat_result));
+  ESP_ERROR_CHECK(httpd_register_uri_handler(server, &chat_stream));
+  ESP_ERROR_CHECK(httpd_register_uri_handler(server, &ai_warm));
   ESP_ERROR_CHECK(httpd_register_uri_handler(server, &status));
+  ESP_ERROR_CHECK(httpd_register_uri_handler(server, &metrics));
   ESP_ERROR_CHECK(httpd_register_uri_handler(server, &vision));
+  ESP_ERROR_CHECK(httpd_register_uri_handler(server, &track));
 }
 
-static void init_ai(void) {
-  static const char *kTurnDirEnum[] = {"left", "right", NULL};
-  static const openrouter_param_t kMoveParams[] = {
-      {"x", "number", "Lateral speed -100..100 (left negative)", true, NULL},
-      {"y", "number", "Forward speed -100..100 (back negative)", true, NULL},
-      {"z", "number", "Rotation speed -100..100", false, NULL},
-      {"duration_ms", "number", "Move duration ms (100-5000, default 1500)", false, NULL},
-      {NULL, NULL, NULL, false, NULL},
-  };
-  static const openrouter_param_t kTurnParams[] = {
-      {"direction", "string", "Turn direction", true, kTurnDirEnum},
-      {"angle_deg", "number", "Target angle in degrees (5-360)", false, NULL},
-      {"speed_percent", "number", "Rotation speed percent (20-100)", false, NULL},
-      {NULL, NULL, NULL, false, NULL},
-  };
-  static const openrouter_simple_function_t kTools[] = {
-      {"move", "Move the rover for duration_ms, then stop.", kMoveParams, cb_move, NULL},
-      {"turn", "Rotate the rover in place by angle_deg using IMU gyroscope feedback.", kTurnParams, cb_turn, NULL},
-      {"stop", "Stop all rover motion immediately.", NULL, cb_stop, NULL},
-      {"gripper_open", "Open the rover gripper.", NULL, cb_gripper_open, NULL},
-      {"gripper_close", "Close the rover gripper.", NULL, cb_gripper_close, NULL},
-      {"read_imu", "Read current accelerometer and gyroscope values.", NULL, cb_read_imu, NULL},
-      {"vision_scan", "Look at the scene using the camera. Returns detected faces and objects.", NULL, cb_vision_scan, NULL},
-  };
+typedef struct {
+  const char *role;
+  const char *const *tools;  // names from kTools, NULL-terminated; NULL: all of them
+} chat_topic_t;
+
+static const char *const kMotionToolNames[] = {
+    "move", "turn", "stop", "gripper_open", "gripper_close", "action_status", "wait_action", NULL};
+static const char *const kVisionToolNames[] = {"vision_scan", "vision_capture", "track", "stop", NULL};
+static const char *const kNoToolNames[] = {NULL};
+
+// By intent_topic_t.
+static const chat_topic_t kChatTopics[INTENT_TOPIC_COUNT] = {
+  {NULL, NULL},  // INTENT_TOPIC_ANY: s_ai_chat as configured below
+  {  // INTENT_TOPIC_MOTION
+      "You drive a mecanum-wheel rover with a gripper. Use the tools to do what the user asks. "
+      "move() blocks for duration_ms, turn() rotates by angle_deg using the IMU; both take "
+      "async:true to return a handle at once (see wait_action). "
+      "Each user message starts with a [rover ...] line with the current state. "
+      "Respond naturally in the user's language. Be brief.",
+      kMotionToolNames},
+  {  // INTENT_TOPIC_VISION
+      "You are the eyes of a rover robot with a camera. Each user message starts with a [rover ...] "
+      "line listing what the camera sees right now (x is the box centre in a 320 px wide frame, w its "
+      "width); call vision_scan() only when it says seen=unknown, vision_capture(question) for details "
+      "such as colours or text, and track() to follow or drive up to something. "
+      "Respond naturally in the user's language. Be brief.",
+      kVisionToolNames},
+  {  // INTENT_TOPIC_CHAT
+      "You are the voice of a small rover robot with a gripper and camera. Each user message starts "
+      "with a [rover ...] line with its current state. Respond naturally in the user's language. "
+      "Be brief.",
+      kNoToolNames},
+};
 
-  openrouter_config_t cfg = {};
-  cfg.api_key = OPENROUTER_API_KEY;
-  cfg.enable_streaming = false;
-  cfg.enable_tools = true;
-  cfg.http_timeout_ms = kAiHttpTimeoutMs;
-  cfg.max_tokens = 256;
-  cfg.default_model = "openai/gpt-4o-mini";
-  cfg.default_system_role =
+static void init_ai(void) {
+  s_ai_chat.client.api_key = OPENROUTER_API_KEY;
+  s_ai_chat.client.model = kAiChatModel;
+  s_ai_chat.client.fallback_models = kAiChatFallbackModels;
+  s_ai_chat.client.timeout_ms = kAiHttpTimeoutMs;
+  s_ai_chat.client.max_tokens = 256;
+  s_ai_chat.client.url = OPENROUTER_URL;
+  s_ai_chat.client.cert_pem = OPENROUTER_CERT_PEM;
+  s_ai_chat.system_role =
       "You are the AI brain of a mecanum-wheel rover robot with a gripper and camera. "
       "Use the provided tools to control the rover when the user asks. "
       "For movement commands with duration, call move() which blocks for the specified time then stops. "
+      "move() and turn() take async:true to return a handle at once, so you can look or plan while the "
+      "rover moves; wait_action(handle) before anything that depends on where it ended up. "
       "For angle-based rotations, use turn(direction, angle_deg) which uses IMU feedback. "
+      "Each user message starts with a [rover ...] line: current state, battery and what the camera "
+      "sees right now (x is the box centre in a 320 px wide frame, w its width). Trust it instead of "
+      "calling read_imu() or vision_scan() again; scan when it says seen=unknown. "
       "You can inspect sensors with read_imu(). "
       "Use vision_scan() to look at the scene — it returns detected faces (person field) and objects. "
+      "Use vision_capture(question) only when you need visual detail vision_scan cannot give. "
       "You can chain multiple tool calls for sequences like 'look around then move forward'. "
       "Respond naturally in the user's language. Be brief.";
-  s_ai = openrouter_create(&cfg);
-  if (s_ai == NULL) {
-    rover_log_record_t rec1 = {
-      .level = ESP_LOG_ERROR,
-      .component = TAG,
-      .event = "ai_openrouter_init_failed",
-      .fields = NULL,
-      .field_count = 0,
-    };
-    rover_log(&rec1);
-    rover_log_record_t rec2 = {
-      .level = ESP_LOG_ERROR,
-      .component = TAG,
-      .event = "ai_init_failed",
-      .fields = NULL,
-      .field_count = 0,
-    };
-    rover_log(&rec2);
-    return;
+  s_ai_chat.tools = kTools;
+  s_ai_chat.tool_count = sizeof(kTools) / sizeof(kTools[0]);
+  s_ai_chat.max_rounds = 5;
+  s_ai_chat.on_event = chat_stream_on_event;
+  s_ai_chat.is_cancelled = chat_is_cancelled;
+  s_ai_chat.round_note = ai_async_round_note;
+  s_ai_chat.event_ctx = NULL;
+  static_assert(sizeof(kTools) / sizeof(kTools[0]) <= kAiToolsMax, "raise kAiToolsMax");
+  for (int t = 0; t < INTENT_TOPIC_COUNT; ++t) {
+    ai_chat_config_t *cfg = &s_ai_chat_topic[t];
+    *cfg = s_ai_chat;
+    if (kChatTopics[t].tools == NULL) continue;
+    cfg->system_role = kChatTopics[t].role;
+    cfg->tools = s_ai_topic_tools[t];
+    cfg->tool_count = 0;
+    for (const char *const *name = kChatTopics[t].tools; *name; ++name) {
+      for (const ai_tool_t &tool : kTools) {
+        if (strcmp(tool.name, *name) == 0) s_ai_topic_tools[t][cfg->tool_count++] = tool;
+      }
+    }
   }
+  s_ai_summary.client = s_ai_chat.client;
+  s_ai_summary.client.model = kAiSummaryModel;
+  s_ai_summary.client.fallback_models = NULL;
+  s_ai_summary.client.max_tokens = kAiSummaryMaxTokens;
+  s_ai_summary.system_role =
+      "Summarise this conversation between a user and their rover robot in at most 50 words, in "
+      "the language it was held in. Extend the summary so far with the new exchanges. Keep what a "
+      "follow-up could refer to: commands and their distances, angles and speeds, objects and people "
+      "seen, and how things turned out. Plain text only.";
+  s_ai_summary.max_rounds = 1;
+  s_ai_summary.is_cancelled = chat_summary_cancelled;
+  chat_memory_clear(&s_chat_memory);
+  s_ai_ready = true;
 
-  esp_err_t reg_err = ESP_OK;
-  for (size_t i = 0; i < sizeof(kTools) / sizeof(kTools[0]) && reg_err == ESP_OK; i++) {
-    reg_err = openrouter_register_simple_function(s_ai, &kTools[i]);
-  }
-  if (reg_err != ESP_OK) {
-    rover_log_field_t fields[] = {
-      rover_log_field_str("err", esp_err_to_name(reg_err)),
-    };
-    rover_log_record_t rec1 = {
-      .level = ESP_LOG_ERROR,
-      .component = TAG,
-      .event = "ai_tool_registration_failed",
-      .fields = fields,
-      .field_count = sizeof(fields) / sizeof(fields[0]),
-    };
-    rover_log(&rec1);
-    rover_log_record_t rec2 = {
-      .level = ESP_LOG_ERROR,
-      .component = TAG,
-      .event = "ai_tools_failed",
-      .fields = NULL,
-      .field_count = 0,
-    };
-    rover_log(&rec2);
-  } else {
-    rover_log_record_t rec = {
-      .level = ESP_LOG_INFO,
-      .component = TAG,
-      .event = "ai_init_ok",
-      .fields = NULL,
-      .field_count = 0,
-    };
-    rover_log(&rec);
-  }
+  rover_log_field_t fields[] = {
+    rover_log_field_int("tools", (int)s_ai_chat.tool_count),
+  };
+  rover_log_record_t rec = {
+    .level = ESP_LOG_INFO,
+    .component = TAG,
+    .event = "ai_init_ok",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
 }
 
 static uint32_t state_color(rover_state_t s) {
@@ -2195,6 +4912,22 @@ static void update_local_display(bool btn_a, bool btn_b, bool chat_active) {
   static bool prev_btn_b = false;
   static rover_state_t prev_state = STATE_IDLE;
   static int32_t prev_bat_pct = -1;
+  static char prev_seen[40] = "";
+
+  // Streamed detections: a short "See: ..." line, read from the snapshot without UART.
+  char seen[40] = "";
+  vision_world_t world;
+  if (vision_world_latest(&world) && world.count > 0) {
+    int n = snprintf(seen, sizeof(seen), "See:");
+    uint8_t shown = 0;
+    for (; shown < world.count && shown < 3; shown++) {
+      int w = snprintf(seen + n, sizeof(seen) - n, "%s %s", shown ? "," : "", world.dets[shown].label);
+      if (w <= 0 || n + w >= (int)sizeof(seen) - 4) break;
+      n += w;
+    }
+    seen[n] = '\0';  // drop a label that did not fit
+    if (shown < world.count) snprintf(seen + n, sizeof(seen) - n, " +%u", (unsigned)(world.count - shown));
+  }
 
   int32_t bat_pct = -1;
   read_power_metrics(NULL, &bat_pct);
@@ -2223,7 +4956,8 @@ static void update_local_display(bool btn_a, bool btn_b, bool chat_active) {
       prev_gripper_open == gripper_open &&
       prev_btn_a == btn_a &&
       prev_btn_b == btn_b &&
-      prev_bat_pct == bat_pct) {
+      prev_bat_pct == bat_pct &&
+      strcmp(prev_seen, seen) == 0) {
     return;
   }
 
@@ -2236,12 +4970,13 @@ static void update_local_display(bool btn_a, bool btn_b, bool chat_active) {
   prev_btn_a = btn_a;
   prev_btn_b = btn_b;
   prev_bat_pct = bat_pct;
+  strlcpy(prev_seen, seen, sizeof(prev_seen));
   initialized = true;
 
   // Layout: 240x135, 5 rows packed tight
   // Row 0 (y=0..23):   FSM state bar (colored)
   // Row 1 (y=26..49):  IP address bar (dark)
-  // Row 2 (y=52..71):  Motion info
+  // Row 2 (y=52..71):  Motion info, streamed detections below it
   // Row 3 (y=74..93):  Three pills: gripper | wifi | battery
   // Row 4 (y=96..135):  Button hints + extra info
 
@@ -2289,6 +5024,12 @@ static void update_local_display(bool btn_a, bool btn_b, bool chat_active) {
     M5.Display.setCursor((240 - 7 * 6) / 2, 68);
     M5.Display.print("Stopped");
   }
+  if (seen[0] != '\0') {
+    M5.Display.setTextSize(1);
+    M5.Display.setTextColor(0x34D399u, bg);
+    M5.Display.setCursor((240 - (int)strlen(seen) * 6) / 2, 82);
+    M5.Display.print(seen);
+  }
 
   // ── Row 3: Three pills ──
   const int py = 93;
@@ -2394,7 +5135,7 @@ static void wifi_reconnect_task(void *arg) {
 
       s_syslog_sock = open_syslog_socket();
 
-      if (s_ai == NULL) init_ai();
+      if (!s_ai_ready) init_ai();
       start_mdns();
       if (s_httpd == NULL) start_web_server();
 
@@ -2413,6 +5154,8 @@ static void wifi_reconnect_task(void *arg) {
   }
 }
 
+// Owns the camera link: consumes the detection stream between commands and falls back to
+// PING polling whenever the stream is not running.
 static void vision_ping_task(void *arg) {
   (void)arg;
 
@@ -2420,16 +5163,52 @@ static void vision_ping_task(void *arg) {
   vTaskDelay(pdMS_TO_TICKS(500));
   TickType_t last_vision_ping = xTaskGetTickCount() - kVisionPingPeriod;
   while (1) {
+    if (xSemaphoreTake(s_vision_mutex, 0) == pdTRUE) {
+      vision_events_drain();
+      int32_t stream_age = vision_stream_age_ms();
+      if (stream_age > kVisionEventStaleMs) {
+        // Stream went quiet: PING right away to tell a stalled stream from a lost camera.
+        s_vision_subscribed.store(false, std::memory_order_relaxed);
+        vision_world_clear();
+        last_vision_ping = xTaskGetTickCount() - kVisionPingPeriod;
+        rover_log_field_t fields[] = {
+          rover_log_field_int("age_ms", stream_age),
+        };
+        rover_log_record_t rec = {
+          .level = ESP_LOG_WARN,
+          .component = TAG,
+          .event = "vision_stream_stalled",
+          .fields = fields,
+          .field_count = sizeof(fields) / sizeof(fields[0]),
+        };
+        rover_log(&rec);
+      }
+      xSemaphoreGive(s_vision_mutex);
+    }
+
     TickType_t now = xTaskGetTickCount();
-    if ((now - last_vision_ping) >= kVisionPingPeriod) {
+    if (!s_vision_subscribed.load(std::memory_order_relaxed) &&
+        (now - last_vision_ping) >= kVisionPingPeriod) {
       last_vision_ping = now;
       if (xSemaphoreTake(s_vision_mutex, 0) == pdTRUE) {
         char ping_resp[128];
         esp_err_t ping_err =
             vision_cmd_timeout("PING", "{}", ping_resp, sizeof(ping_resp), kVisionPingTimeoutMs);
-        xSemaphoreGive(s_vision_mutex);
         bool was = s_vision_available.load(std::memory_order_relaxed);
-        bool now_available = (ping_err == ESP_OK && strstr(ping_resp, "\"ok\":true") != NULL);
+        bool now_available = (ping_err == ESP_OK && json_tok_ok(ping_resp, sizeof(ping_resp)));
+        if (now_available) {
+          vision_link_negotiate();
+          vision_link_probe_framing();
+          vision_link_subscribe();
+        } else {
+          if (ping_err != ESP_OK) vision_link_fallback("ping_failed");
+          // Camera may be reflashed while away; probe BAUD and framing again once it is back.
+          s_vision_baud_unsupported = false;
+          s_vision_framed.store(false, std::memory_order_relaxed);
+          s_vision_framed_unsupported = false;
+          s_vision_subscribe_unsupported = false;
+        }
+        xSemaphoreGive(s_vision_mutex);
         s_vision_available.store(now_available, std::memory_order_relaxed);
         if (ping_err != ESP_OK) {
           rover_log_field_t fields[] = {
@@ -2486,20 +5265,44 @@ static void main_loop_task(void *arg) {
 
   bool prev_btn_a = false;
   bool prev_btn_b = false;
+  bool prev_ai_running = false;
   TickType_t last_hb = 0;
+  TickType_t wake = xTaskGetTickCount();
+  int64_t prev_iter_us = 0;
 
   while (1) {
     esp_task_wdt_reset();
 
+    int64_t iter_us = esp_timer_get_time();
+    if (prev_iter_us != 0) {
+      uint32_t gap_us = (uint32_t)(iter_us - prev_iter_us);
+      if (gap_us > s_loop_max_us.load(std::memory_order_relaxed)) {
+        s_loop_max_us.store(gap_us, std::memory_order_relaxed);
+      }
+      if (gap_us > 2 * kLoopPeriod * portTICK_PERIOD_MS * 1000) {
+        s_loop_overruns.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    prev_iter_us = iter_us;
+
     M5.update();
-    ai_action_poll_and_execute();
     bool btn_a = M5.BtnA.isPressed();
     bool btn_b = M5.BtnB.isPressed();
+    s_btn_b_held.store(btn_b, std::memory_order_relaxed);
+    // While ai_action_task drives, the buttons only stop it (B) and the loop leaves the
+    // motors, tracking and the web deadman alone, as it did when it ran actions inline.
+    bool ai_running = s_ai_action_running.load(std::memory_order_relaxed);
+
+    // Outside s_state_mutex: cancelling takes the chat and action queue locks.
+    if (btn_b && !prev_btn_b) {
+      chat_cancel("button");
+    }
 
     xSemaphoreTake(s_state_mutex, portMAX_DELAY);
 
     if (btn_b && !prev_btn_b) {
       mark_activity();
+      track_stop_locked("button");
       rover_emergency_stop();
       set_motion(0, 0, 0, false);
       s_web_motion_deadline = 0;
@@ -2521,7 +5324,9 @@ static void main_loop_task(void *arg) {
       rover_log(&rec);
     }
 
-    if (btn_a && btn_b) {
+    if (ai_running) {
+      mark_activity();
+    } else if (btn_a && btn_b) {
       mark_activity();
       set_motion(0, 0, 60, true);
       s_web_motion_deadline = 0;
@@ -2537,7 +5342,7 @@ static void main_loop_task(void *arg) {
       }
     }
 
-    if (!btn_a && prev_btn_a && s_web_motion_deadline == 0) {
+    if (!ai_running && !btn_a && prev_btn_a && s_web_motion_deadline == 0) {
       mark_activity();
       set_motion(0, 0, 0, false);
       rover_log_field_t fields[] = {
@@ -2555,6 +5360,7 @@ static void main_loop_task(void *arg) {
     }
     if (btn_a && !prev_btn_a) {
       mark_activity();
+      track_stop_locked("button");
       rover_log_field_t fields[] = {
         rover_log_field_str("button", "A"),
         rover_log_field_str("action", "active"),
@@ -2569,18 +5375,60 @@ static void main_loop_task(void *arg) {
       rover_log(&rec);
     }
 
-    apply_motion();
+    if (!ai_running && M5.BtnA.wasDoubleClicked()) {
+      // No network needed: approach whatever the camera sees largest.
+      if (s_vision_subscribed.load(std::memory_order_relaxed)) {
+        track_start_locked(TRACK_MODE_APPROACH, "", "button");
+      } else {
+        ESP_LOGW(TAG, "track: vision stream not running");
+      }
+    }
+    if (!ai_running && s_track.active && !btn_a && !btn_b) {
+      vision_world_t world;
+      bool have_world =
+          s_vision_subscribed.load(std::memory_order_relaxed) && vision_world_latest(&world);
+      track_cmd_t cmd = track_ctl_update(&s_track, have_world ? &world : NULL,
+                                         (uint32_t)esp_log_timestamp());
+      mark_activity();
+      set_motion(cmd.x, cmd.y, cmd.z, cmd.moving);
+      if (cmd.close_gripper) {
+        s_gripper_open = false;
+        (void)rover_set_servo_angle(kGripperServo, kGripperCloseAngle);
+      }
+      if (cmd.finished) {
+        track_log_done(track_phase_name(s_track.phase));
+      }
+    }
+
+    if (!ai_running) {
+      // The executor wrote the motors itself; resend the current command after it.
+      if (prev_ai_running) motion_forget_applied();
+      apply_motion();
+    }
+    prev_ai_running = ai_running;
     xSemaphoreGive(s_state_mutex);
 
-    bool chat_pending = false;
-    xSemaphoreTake(s_chat_mutex, portMAX_DELAY);
-    chat_pending = s_chat_pending;
-    xSemaphoreGive(s_chat_mutex);
+    bool chat_pending = s_chat_inflight.load(std::memory_order_relaxed) > 0;
 
     update_local_display(btn_a, btn_b, chat_pending);
 
     TickType_t now = xTaskGetTickCount();
     if ((now - last_hb) >= kHeartbeatPeriod) {
+      uint32_t heap_free = esp_get_free_heap_size();
+      if (ai_client_drop_idle(heap_free < kAiLowHeapBytes ? 0 : kAiIdleCloseMs)) {
+        rover_log_field_t drop_fields[] = {
+          rover_log_field_int("heap_free", heap_free),
+          rover_log_field_bool("low_heap", heap_free < kAiLowHeapBytes),
+        };
+        rover_log_record_t drop_rec = {
+          .level = ESP_LOG_INFO,
+          .component = TAG,
+          .event = "ai_conn_idle_close",
+          .fields = drop_fields,
+          .field_count = sizeof(drop_fields) / sizeof(drop_fields[0]),
+        };
+        rover_log(&drop_rec);
+      }
       int32_t bat_pct = -1;
       read_power_metrics(NULL, &bat_pct);
       xSemaphoreTake(s_state_mutex, portMAX_DELAY);
@@ -2599,6 +5447,7 @@ static void main_loop_task(void *arg) {
         rover_log_field_int("z", z),
         rover_log_field_str("gripper", gripper),
         rover_log_field_int("bat_pct", (int)bat_pct),
+        rover_log_field_int("loop_max_ms", (int)(s_loop_max_us.exchange(0, std::memory_order_relaxed) / 1000)),
       };
       rover_log_record_t rec = {
         .level = ESP_LOG_INFO,
@@ -2622,6 +5471,7 @@ static void main_loop_task(void *arg) {
     read_power_metrics(&vbus_mv, NULL);
     bool usb_power = vbus_mv > 4000;  // USB ~5V, RoverC pogo ~0.8V
     should_sleep = (!btn_a && !btn_b &&
+                    !ai_running &&
                     !s_motion_active &&
                     !chat_pending &&
                     !usb_power &&
@@ -2634,7 +5484,8 @@ static void main_loop_task(void *arg) {
       enter_deep_sleep();
     }
 
-    vTaskDelay(kLoopPeriod);
+    // Fixed cadence: the loop's own work does not stretch the period.
+    vTaskDelayUntil(&wake, kLoopPeriod);
   }
 }
 
@@ -2645,6 +5496,13 @@ extern "C" void app_main(void) {
     ret = nvs_flash_init();
   }
   ESP_ERROR_CHECK(ret);
+  plan_cache_init();
+  if (turn_arena_init(kTurnArenaBytes)) {
+    cJSON_Hooks hooks = {turn_arena_malloc, turn_arena_free};
+    cJSON_InitHooks(&hooks);
+  } else {
+    ESP_LOGW(TAG, "turn arena unavailable, cJSON stays on the heap");
+  }
 
   s_state_mutex = xSemaphoreCreateMutex();
   s_i2c_mutex = xSemaphoreCreateMutex();
@@ -2652,15 +5510,22 @@ extern "C" void app_main(void) {
   s_ai_mutex = xSemaphoreCreateMutex();
   s_chat_mutex = xSemaphoreCreateMutex();
   s_ai_action_queue_mutex = xSemaphoreCreateMutex();
+  s_ai_async_mutex = xSemaphoreCreateMutex();
   s_vision_mutex = xSemaphoreCreateMutex();
-  s_chat_queue = xQueueCreate(1, sizeof(chat_job_t));
+  s_prefetch_mutex = xSemaphoreCreateMutex();
+  init_timeouts();
+  s_chat_queue = xQueueCreate(CHAT_SLOT_COUNT + 1, sizeof(uint32_t));  // + a prewarm request
+  s_chat_stream_ring = xRingbufferCreate(kChatStreamRingBytes, RINGBUF_TYPE_NOSPLIT);
+  s_chat_stream_req_queue = xQueueCreate(1, sizeof(httpd_req_t *));
   s_syslog_queue = xQueueCreate(8, kSyslogMsgMax);
   s_ai_action_queue = xQueueCreate(kAiActionQueueDepth, sizeof(ai_action_req_t));
   s_ai_action_result_queue = xQueueCreate(kAiActionQueueDepth, sizeof(ai_action_result_t));
   if (s_state_mutex == NULL || s_i2c_mutex == NULL || s_power_mutex == NULL ||
       s_ai_mutex == NULL || s_chat_mutex == NULL || s_ai_action_queue_mutex == NULL ||
+      s_ai_async_mutex == NULL ||
       s_vision_mutex == NULL ||
-      s_chat_queue == NULL || s_syslog_queue == NULL ||
+      s_chat_queue == NULL || s_chat_stream_ring == NULL || s_chat_stream_req_queue == NULL ||
+      s_syslog_queue == NULL ||
       s_ai_action_queue == NULL || s_ai_action_result_queue == NULL) {
     rover_log_record_t rec = {
       .level = ESP_LOG_ERROR,
@@ -2743,6 +5608,7 @@ extern "C" void app_main(void) {
     rover_log_field_t fields[] = {
       rover_log_field_int("tx_pin", 33),
       rover_log_field_int("rx_pin", 32),
+      rover_log_field_int("baud", kVisionBaud),
     };
     rover_log_record_t rec = {
       .level = ESP_LOG_INFO,
@@ -2821,17 +5687,21 @@ extern "C" void app_main(void) {
 
   // Chat worker — Core 1 (agent core, long HTTP calls)
   xTaskCreatePinnedToCore(chat_worker_task, "chat_worker", 16384, NULL, 4, NULL, 1);
+  xTaskCreatePinnedToCore(chat_stream_task, "chat_stream", 4096, NULL, 3, NULL, 1);
 
   // WiFi reconnect task — Core 1, low priority
   xTaskCreatePinnedToCore(wifi_reconnect_task, "wifi_reconn", 4096, NULL, 2, NULL, 1);
 
   // Vision ping task — Core 1, low priority (keeps camera health checks off main_loop)
   if (vision_uart_ready) {
-    xTaskCreatePinnedToCore(vision_ping_task, "vision_ping", 4096, NULL, 2, NULL, 1);
+    xTaskCreatePinnedToCore(vision_ping_task, "vision_ping", 6144, NULL, 2, NULL, 1);
+    // Speculative SCANs while the chat worker waits on the LLM
+    xTaskCreatePinnedToCore(sensor_prefetch_task, "sensor_prefetch", 6144, NULL, 3, &s_prefetch_task, 1);
   }
 
   // Main loop — Core 0 (RT core, motors, buttons, display)
   xTaskCreatePinnedToCore(main_loop_task, "main_loop", 4096, NULL, 5, NULL, 0);
+  xTaskCreatePinnedToCore(ai_action_task, "ai_action", 4096, NULL, 6, NULL, 0);
 
   rover_log_record_t rec1 = {
     .level = ESP_LOG_INFO,
@@ -0,0 +1,53 @@
+#include "model_health.h"
+
+#include <string.h>
+
+static const uint8_t kBreakerFailures = 3;
+static const int64_t kBreakerOpenUs = 30LL * 1000 * 1000;
+static const uint8_t kHedgeMinSamples = 5;
+static const uint32_t kHedgeColdMs = 6000;
+static const uint32_t kHedgeMinMs = 1500;
+
+void model_health_ok(model_health_t *h, uint32_t ttft_ms) {
+  h->consecutive_failures = 0;
+  h->open_until_us = 0;
+  h->ttft_ms[h->sample_next] = ttft_ms > UINT16_MAX ? UINT16_MAX : (uint16_t)ttft_ms;
+  h->sample_next = (h->sample_next + 1) % MODEL_HEALTH_SAMPLES;
+  if (h->sample_count < MODEL_HEALTH_SAMPLES) h->sample_count++;
+  uint16_t sorted[MODEL_HEALTH_SAMPLES];
+  memcpy(sorted, h->ttft_ms, h->sample_count * sizeof(sorted[0]));
+  for (int i = 1; i < h->sample_count; ++i) {
+    uint16_t v = sorted[i];
+    int j = i - 1;
+    while (j >= 0 && sorted[j] > v) {
+      sorted[j + 1] = sorted[j];
+      --j;
+    }
+    sorted[j + 1] = v;
+  }
+  h->p95_ms = sorted[(h->sample_count * 95 + 99) / 100 - 1];
+}
+
+bool model_health_failed(model_health_t *h, int64_t now_us) {
+  if (h->consecutive_failures < UINT8_MAX) h->consecutive_failures++;
+  if (h->consecutive_failures < kBreakerFailures) return false;
+  // A half-open trial that fails opens the breaker again straight away.
+  h->open_until_us = now_us + kBreakerOpenUs;
+  return true;
+}
+
+bool model_health_usable(const model_health_t *h, int64_t now_us) {
+  return now_us >= h->open_until_us;
+}
+
+uint32_t model_health_hedge_delay_ms(const model_health_t *h) {
+  if (h->sample_count < kHedgeMinSamples) return kHedgeColdMs;
+  return h->p95_ms < kHedgeMinMs ? kHedgeMinMs : h->p95_ms;
+}
+
+int model_health_pick(const model_health_t *const *tiers, int count, int after, int64_t now_us) {
+  for (int i = after + 1; i < count; ++i) {
+    if (model_health_usable(tiers[i], now_us)) return i;
+  }
+  return after < 0 && count > 0 ? 0 : -1;
+}
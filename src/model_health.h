@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-model health for the chat's model tiers: time to first streamed data over the last
+// answers (its p95 sets when a slow round is hedged to the next tier) and a circuit breaker
+// that skips a model for 30 s after 3 consecutive failures, then lets one round through
+// (half-open). Time is passed in. Not thread-safe: the chat worker owns these.
+
+#define MODEL_HEALTH_SAMPLES 32
+
+typedef struct {
+  uint16_t ttft_ms[MODEL_HEALTH_SAMPLES];
+  uint8_t sample_count;
+  uint8_t sample_next;
+  uint8_t consecutive_failures;
+  uint32_t p95_ms;        // 0 until the first sample
+  int64_t open_until_us;  // breaker open until then; 0: closed
+} model_health_t;
+
+// A round that streamed; ttft_ms: its time to first data. Closes the breaker.
+void model_health_ok(model_health_t *h, uint32_t ttft_ms);
+// A round that failed at now_us; true if the breaker is open now.
+bool model_health_failed(model_health_t *h, int64_t now_us);
+// Breaker closed, or open long enough to try again.
+bool model_health_usable(const model_health_t *h, int64_t now_us);
+// How long to wait for first data before hedging: the p95, at least 1.5 s, or 6 s until the
+// model has 5 samples.
+uint32_t model_health_hedge_delay_ms(const model_health_t *h);
+// First usable tier after `after` (-1: from the start). With none usable the primary (0) is
+// tried anyway, so an outage of every route still reaches the network; -1 when looking for
+// a tier after one that was already picked and none is left.
+int model_health_pick(const model_health_t *const *tiers, int count, int after, int64_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
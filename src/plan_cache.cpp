@@ -0,0 +1,185 @@
+#include "plan_cache.h"
+
+#include <atomic>
+#include <string.h>
+
+#include "nvs.h"
+
+static const char *kNvsNamespace = "plan_cache";
+static const char *kNvsKey = "table";
+static const uint32_t kFormat = 0x504C4331;        // "PLC1"; bump when entry_t changes
+static const uint8_t kMinConfidence = 2;           // identical LLM plans before replaying
+static const uint8_t kRevalidateAfter = 20;        // replays before asking the LLM again
+static const uint32_t kTtlS = 3 * 24 * 3600;       // powered-on time
+
+typedef struct {
+  uint32_t key;        // 0: empty
+  uint32_t stored_s;   // cache clock when the plan was last confirmed
+  uint32_t used;       // LRU stamp
+  uint8_t confidence;
+  uint8_t replays;
+  intent_plan_t plan;
+  char reply[PLAN_CACHE_REPLY_MAX];
+} entry_t;
+
+typedef struct {
+  uint32_t format;
+  uint32_t clock_s;  // powered-on seconds accumulated over earlier boots
+  uint32_t use_seq;
+  entry_t entries[PLAN_CACHE_ENTRIES];
+} table_t;
+
+static table_t s_table;
+static bool s_dirty = false;
+static std::atomic<uint32_t> s_hits{0};
+static std::atomic<uint32_t> s_misses{0};
+static std::atomic<uint32_t> s_stores{0};
+static std::atomic<uint32_t> s_evictions{0};
+static std::atomic<uint32_t> s_entries{0};
+
+static uint32_t now_s(uint32_t uptime_s) {
+  return s_table.clock_s + uptime_s;
+}
+
+static void count_entries(void) {
+  uint32_t n = 0;
+  for (int i = 0; i < PLAN_CACHE_ENTRIES; ++i) n += s_table.entries[i].key != 0;
+  s_entries.store(n, std::memory_order_relaxed);
+}
+
+void plan_cache_init(void) {
+  memset(&s_table, 0, sizeof(s_table));
+  nvs_handle_t nvs;
+  if (nvs_open(kNvsNamespace, NVS_READONLY, &nvs) == ESP_OK) {
+    size_t size = sizeof(s_table);
+    if (nvs_get_blob(nvs, kNvsKey, &s_table, &size) != ESP_OK || size != sizeof(s_table) ||
+        s_table.format != kFormat) {
+      memset(&s_table, 0, sizeof(s_table));
+    }
+    nvs_close(nvs);
+  }
+  s_table.format = kFormat;
+  s_dirty = false;
+  count_entries();
+}
+
+uint32_t plan_cache_key(const char *prompt, uint8_t state_bits) {
+  char norm[INTENT_PROMPT_MAX * 2];
+  if (!intent_normalize(prompt, norm, sizeof(norm)) || norm[0] == '\0') return 0;
+  uint32_t h = 2166136261u;  // FNV-1a
+  for (const char *p = norm; *p; ++p) {
+    h ^= (uint8_t)*p;
+    h *= 16777619u;
+  }
+  h ^= state_bits;
+  h *= 16777619u;
+  return h ? h : 1;
+}
+
+static entry_t *find(uint32_t key) {
+  for (int i = 0; key != 0 && i < PLAN_CACHE_ENTRIES; ++i) {
+    if (s_table.entries[i].key == key) return &s_table.entries[i];
+  }
+  return NULL;
+}
+
+static bool plans_equal(const intent_plan_t *a, const intent_plan_t *b) {
+  if (a->count != b->count) return false;
+  for (uint8_t i = 0; i < a->count; ++i) {
+    const intent_step_t *x = &a->steps[i];
+    const intent_step_t *y = &b->steps[i];
+    if (x->kind != y->kind || x->x != y->x || x->y != y->y || x->z != y->z ||
+        x->duration_ms != y->duration_ms || x->turn_left != y->turn_left ||
+        x->angle_deg != y->angle_deg || x->speed_pct != y->speed_pct) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool plan_cache_lookup(uint32_t key, uint32_t uptime_s, intent_plan_t *plan, char *reply,
+                       size_t reply_size) {
+  entry_t *e = find(key);
+  bool fresh = false;
+  if (e != NULL) {
+    uint32_t now = now_s(uptime_s);
+    fresh = now <= e->stored_s || now - e->stored_s <= kTtlS;  // the clock may lag after a reset
+  }
+  if (!fresh || e->confidence < kMinConfidence || e->replays >= kRevalidateAfter) {
+    s_misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  *plan = e->plan;
+  strlcpy(reply, e->reply, reply_size);
+  // Replay count and LRU stamp ride along with the next store; hits alone never write flash.
+  e->replays++;
+  e->used = ++s_table.use_seq;
+  s_hits.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void plan_cache_store(uint32_t key, uint32_t uptime_s, const intent_plan_t *plan, const char *reply) {
+  if (key == 0 || plan->count == 0 || strlen(reply) >= PLAN_CACHE_REPLY_MAX) return;
+  entry_t *e = find(key);
+  if (e != NULL && plans_equal(&e->plan, plan)) {
+    if (e->confidence < UINT8_MAX) e->confidence++;
+  } else {
+    if (e == NULL) {
+      e = &s_table.entries[0];
+      for (int i = 0; i < PLAN_CACHE_ENTRIES; ++i) {
+        entry_t *c = &s_table.entries[i];
+        if (c->key == 0) {
+          e = c;
+          break;
+        }
+        if (c->used < e->used) e = c;
+      }
+      if (e->key != 0) s_evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    memset(e, 0, sizeof(*e));
+    e->key = key;
+    e->plan = *plan;
+    e->confidence = 1;
+  }
+  strlcpy(e->reply, reply, sizeof(e->reply));
+  e->stored_s = now_s(uptime_s);
+  e->replays = 0;
+  e->used = ++s_table.use_seq;
+  s_dirty = true;
+  s_stores.fetch_add(1, std::memory_order_relaxed);
+  count_entries();
+}
+
+void plan_cache_invalidate(uint32_t key) {
+  entry_t *e = find(key);
+  if (e == NULL) return;
+  memset(e, 0, sizeof(*e));
+  s_dirty = true;
+  count_entries();
+}
+
+esp_err_t plan_cache_flush(uint32_t uptime_s) {
+  if (!s_dirty) return ESP_OK;
+  nvs_handle_t nvs;
+  esp_err_t err = nvs_open(kNvsNamespace, NVS_READWRITE, &nvs);
+  if (err != ESP_OK) return err;
+  // Persist the clock as of now: the next boot continues from here, so stored stamps keep
+  // their meaning (on-time between this flush and a reset is lost, which only makes
+  // entries look younger).
+  uint32_t base = s_table.clock_s;
+  s_table.clock_s = now_s(uptime_s);
+  err = nvs_set_blob(nvs, kNvsKey, &s_table, sizeof(s_table));
+  if (err == ESP_OK) err = nvs_commit(nvs);
+  nvs_close(nvs);
+  s_table.clock_s = base;
+  if (err == ESP_OK) s_dirty = false;
+  return err;
+}
+
+void plan_cache_stats(plan_cache_stats_t *out) {
+  out->hits = s_hits.load(std::memory_order_relaxed);
+  out->misses = s_misses.load(std::memory_order_relaxed);
+  out->stores = s_stores.load(std::memory_order_relaxed);
+  out->evictions = s_evictions.load(std::memory_order_relaxed);
+  out->entries = s_entries.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "intent.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Remembers the action sequence the LLM chose for a prompt so repeats replay locally.
+// Keyed by the normalised prompt plus coarse rover state; RAM LRU mirrored to NVS.
+// Only the chat worker calls lookup/store/flush; stats may be read from any task.
+
+#define PLAN_CACHE_ENTRIES 16
+#define PLAN_CACHE_REPLY_MAX 96
+
+#define PLAN_STATE_GRIPPER_OPEN 0x01
+#define PLAN_STATE_VISION_OK 0x02
+
+typedef struct {
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t stores;
+  uint32_t evictions;
+  uint32_t entries;
+} plan_cache_stats_t;
+
+// Loads the persisted table; an unreadable or old-format blob starts empty.
+void plan_cache_init(void);
+
+// 0 when the prompt does not normalise (too long): such prompts are never cached.
+uint32_t plan_cache_key(const char *prompt, uint8_t state_bits);
+
+// A hit needs an entry the LLM produced identically at least twice, younger than the TTL
+// and replayed fewer times than the revalidation limit. uptime_s: seconds since boot.
+bool plan_cache_lookup(uint32_t key, uint32_t uptime_s, intent_plan_t *plan, char *reply,
+                       size_t reply_size);
+
+// Records the plan an LLM turn executed; the same plan again raises confidence, a
+// different one replaces it. Replies longer than PLAN_CACHE_REPLY_MAX are not cached.
+void plan_cache_store(uint32_t key, uint32_t uptime_s, const intent_plan_t *plan, const char *reply);
+
+// Replay failed: forget the entry so the LLM decides next time.
+void plan_cache_invalidate(uint32_t key);
+
+// Writes the table to NVS if it changed since the last flush.
+esp_err_t plan_cache_flush(uint32_t uptime_s);
+
+void plan_cache_stats(plan_cache_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,41 @@
+#include "rto.h"
+
+static const uint8_t kMaxBackoff = 4;
+
+void rto_init(rto_est_t *e, uint32_t initial_ms, uint32_t min_ms, uint32_t max_ms) {
+  *e = {};
+  e->initial_ms = initial_ms;
+  e->min_ms = min_ms;
+  e->max_ms = max_ms;
+}
+
+void rto_sample(rto_est_t *e, uint32_t ms) {
+  if (e->samples == 0) {
+    e->srtt_ms = ms;
+    e->rttvar_ms = ms / 2;
+  } else {
+    uint32_t delta = ms > e->srtt_ms ? ms - e->srtt_ms : e->srtt_ms - ms;
+    e->rttvar_ms = (3 * e->rttvar_ms + delta) / 4;
+    e->srtt_ms = (7 * e->srtt_ms + ms) / 8;
+  }
+  e->samples++;
+  e->backoff = 0;
+}
+
+void rto_timed_out(rto_est_t *e) {
+  e->timeouts++;
+  if (e->backoff < kMaxBackoff) e->backoff++;
+}
+
+uint32_t rto_timeout_ms(const rto_est_t *e) {
+  uint64_t t = e->initial_ms;
+  if (e->samples > 0) {
+    // A very steady operation has almost no deviation: keep a quarter of the mean as margin.
+    uint32_t margin = 4 * e->rttvar_ms;
+    if (margin < e->srtt_ms / 4) margin = e->srtt_ms / 4;
+    t = (uint64_t)e->srtt_ms + margin;
+  }
+  if (t < e->min_ms) t = e->min_ms;
+  t <<= e->backoff;
+  return t > e->max_ms ? e->max_ms : (uint32_t)t;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Deadlines from observed latency, the way TCP sets its retransmission timeout (RFC 6298):
+// a smoothed mean and mean deviation of completed operations give mean + 4 * deviation,
+// clamped to [min_ms, max_ms]. Until the first sample the initial timeout applies; every
+// timeout doubles the deadline (up to max_ms) until an operation completes again.
+// Not thread-safe: each estimator belongs to one task or lock.
+
+typedef struct {
+  uint32_t initial_ms;
+  uint32_t min_ms;
+  uint32_t max_ms;
+  uint32_t srtt_ms;    // smoothed latency
+  uint32_t rttvar_ms;  // smoothed mean deviation
+  uint32_t samples;
+  uint32_t timeouts;
+  uint8_t backoff;     // doublings since the last sample
+} rto_est_t;
+
+void rto_init(rto_est_t *e, uint32_t initial_ms, uint32_t min_ms, uint32_t max_ms);
+// A completed operation and how long it took.
+void rto_sample(rto_est_t *e, uint32_t ms);
+// An operation that ran into the deadline rto_timeout_ms() gave it.
+void rto_timed_out(rto_est_t *e);
+uint32_t rto_timeout_ms(const rto_est_t *e);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,117 @@
+#include "scene_delta.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+static const float kMatchIou = 0.3f;
+static const int kMovedPx = 24;          // centre shift that counts as moved
+static const float kResizedRatio = 1.25f;  // width change that counts as moved (closer/farther)
+
+float scene_delta_iou(const vision_det_t *a, const vision_det_t *b) {
+  int ix = (a->x + a->w < b->x + b->w ? a->x + a->w : b->x + b->w) - (a->x > b->x ? a->x : b->x);
+  int iy = (a->y + a->h < b->y + b->h ? a->y + a->h : b->y + b->h) - (a->y > b->y ? a->y : b->y);
+  if (ix <= 0 || iy <= 0) return 0.0f;
+  float inter = (float)ix * iy;
+  float uni = (float)a->w * a->h + (float)b->w * b->h - inter;
+  return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+static bool same_object(const vision_det_t *a, const vision_det_t *b) {
+  return a->kind == b->kind && strcasecmp(a->label, b->label) == 0;
+}
+
+static bool changed(const vision_det_t *a, const vision_det_t *b) {
+  int dx = (b->x + b->w / 2) - (a->x + a->w / 2);
+  if (dx > kMovedPx || dx < -kMovedPx) return true;
+  float wa = a->w > 0 ? (float)a->w : 1.0f;
+  float ratio = (float)b->w / wa;
+  return ratio > kResizedRatio || ratio < 1.0f / kResizedRatio;
+}
+
+typedef struct {
+  char *out;
+  size_t size;
+  size_t len;
+  bool overflow;
+  const char *section;  // pending "new: " etc., written before the section's first item
+} writer_t;
+
+static void put(writer_t *w, const char *prefix, const vision_det_t *d, bool with_box) {
+  char item[48];
+  int n = with_box ? snprintf(item, sizeof(item), "%s%s x%d w%d", prefix, d->label, d->x + d->w / 2, d->w)
+                   : snprintf(item, sizeof(item), "%s%s", prefix, d->label);
+  if (n < 0) n = 0;
+  if ((size_t)n >= sizeof(item)) n = sizeof(item) - 1;
+  const char *sep = w->section ? (w->len ? "; " : "") : ", ";
+  int m = snprintf(w->out + w->len, w->size - w->len, "%s%s%.*s", sep, w->section ? w->section : "", n, item);
+  if (m < 0 || (size_t)m >= w->size - w->len) {
+    w->overflow = true;
+    return;
+  }
+  w->len += (size_t)m;
+  w->section = NULL;
+}
+
+int scene_delta_describe(const vision_world_t *prev, const vision_world_t *cur, char *out, size_t size,
+                         scene_delta_counts_t *counts) {
+  if (size == 0) return -1;
+  // match[i]: index into prev->dets of the detection cur->dets[i] continues, or -1.
+  int match[VISION_WORLD_MAX_DETS];
+  bool used[VISION_WORLD_MAX_DETS] = {};
+  for (uint8_t i = 0; i < cur->count; ++i) {
+    match[i] = -1;
+    float best = kMatchIou;
+    for (uint8_t j = 0; j < prev->count; ++j) {
+      if (used[j] || !same_object(&prev->dets[j], &cur->dets[i])) continue;
+      float iou = scene_delta_iou(&prev->dets[j], &cur->dets[i]);
+      if (iou >= best) {
+        best = iou;
+        match[i] = j;
+      }
+    }
+    if (match[i] >= 0) used[match[i]] = true;
+  }
+  // Same label but no overlap: the object moved rather than one left and another came.
+  for (uint8_t i = 0; i < cur->count; ++i) {
+    for (uint8_t j = 0; j < prev->count && match[i] < 0; ++j) {
+      if (!used[j] && same_object(&prev->dets[j], &cur->dets[i])) {
+        match[i] = j;
+        used[j] = true;
+      }
+    }
+  }
+
+  scene_delta_counts_t c = {};
+  writer_t w = {out, size, 0, false, NULL};
+  out[0] = '\0';
+  w.section = "new: ";
+  for (uint8_t i = 0; i < cur->count; ++i) {
+    if (match[i] >= 0) continue;
+    c.added++;
+    put(&w, cur->dets[i].kind == VISION_DET_FACE ? "face:" : "", &cur->dets[i], true);
+  }
+  w.section = "gone: ";
+  for (uint8_t j = 0; j < prev->count; ++j) {
+    if (used[j]) continue;
+    c.removed++;
+    put(&w, prev->dets[j].kind == VISION_DET_FACE ? "face:" : "", &prev->dets[j], false);
+  }
+  w.section = "moved: ";
+  for (uint8_t i = 0; i < cur->count; ++i) {
+    if (match[i] < 0) continue;
+    if (!changed(&prev->dets[match[i]], &cur->dets[i])) {
+      c.kept++;
+      continue;
+    }
+    c.moved++;
+    put(&w, cur->dets[i].kind == VISION_DET_FACE ? "face:" : "", &cur->dets[i], true);
+  }
+  if (counts) *counts = c;
+  if (w.overflow) return -1;
+  if (w.len == 0) {
+    size_t n = strlcpy(out, "unchanged", size);
+    return n < size ? (int)n : -1;
+  }
+  return (int)w.len;
+}
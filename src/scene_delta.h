@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "vision_world.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Scene diff between two detection snapshots, so a model that has already seen the scene gets
+// "unchanged" or "new: cup x160 w40; gone: person" instead of every box again. Detections are
+// matched by kind and label, first by box IoU, then (same label, far apart) as having moved.
+
+typedef struct {
+  uint8_t added;
+  uint8_t removed;
+  uint8_t moved;  // matched, but the centre or width changed noticeably
+  uint8_t kept;   // matched and still in place
+} scene_delta_counts_t;
+
+// Intersection over union of two boxes, 0..1.
+float scene_delta_iou(const vision_det_t *a, const vision_det_t *b);
+
+// Writes the diff from prev to cur ("unchanged" when nothing was added, removed or moved) in
+// the [rover ...] line's notation (x: box centre, w: width, in frame pixels). Returns its
+// length, or -1 if it does not fit in size. counts may be NULL.
+int scene_delta_describe(const vision_world_t *prev, const vision_world_t *cur, char *out, size_t size,
+                         scene_delta_counts_t *counts);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,114 @@
+#include "trace.h"
+
+#include <atomic>
+#include <stdio.h>
+
+#include "esp_timer.h"
+#include "logger_json.h"
+
+static const char *TAG = "trace";
+static const int kBuckets = 14;  // <=1, <=2, <=4 ... <=4096 ms, then everything above
+
+static const char *const kPhaseNames[TRACE_PHASE_COUNT] = {
+  "turn", "connect", "first_byte", "model_round", "tool", "action", "uart", "vision_model",
+};
+
+typedef struct {
+  std::atomic<uint32_t> count;
+  std::atomic<uint32_t> errors;
+  std::atomic<uint32_t> max_ms;
+  std::atomic<uint64_t> total_ms;
+  std::atomic<uint32_t> hist[kBuckets];
+} phase_stats_t;
+
+static phase_stats_t s_phases[TRACE_PHASE_COUNT];
+static std::atomic<uint32_t> s_turn{0};
+
+void trace_turn_set(uint32_t turn_id) {
+  s_turn.store(turn_id, std::memory_order_relaxed);
+}
+
+uint32_t trace_turn(void) {
+  return s_turn.load(std::memory_order_relaxed);
+}
+
+trace_span_t trace_begin_at(trace_phase_t phase, const char *name, int64_t start_us) {
+  trace_span_t span = {phase, name, s_turn.load(std::memory_order_relaxed), start_us};
+  return span;
+}
+
+trace_span_t trace_begin(trace_phase_t phase, const char *name) {
+  return trace_begin_at(phase, name, esp_timer_get_time());
+}
+
+static int bucket_of(uint32_t ms) {
+  int b = 0;
+  while (b < kBuckets - 1 && ms > (1u << b)) b++;
+  return b;
+}
+
+uint32_t trace_end(const trace_span_t *span, esp_err_t err) {
+  int64_t us = esp_timer_get_time() - span->start_us;
+  uint32_t ms = us <= 0 ? 0 : (uint32_t)((us + 500) / 1000);
+  phase_stats_t *p = &s_phases[span->phase];
+  p->count.fetch_add(1, std::memory_order_relaxed);
+  if (err != ESP_OK) p->errors.fetch_add(1, std::memory_order_relaxed);
+  p->total_ms.fetch_add(ms, std::memory_order_relaxed);
+  p->hist[bucket_of(ms)].fetch_add(1, std::memory_order_relaxed);
+  uint32_t prev = p->max_ms.load(std::memory_order_relaxed);
+  while (ms > prev && !p->max_ms.compare_exchange_weak(prev, ms, std::memory_order_relaxed)) {
+  }
+
+  rover_log_field_t fields[] = {
+    rover_log_field_int("turn", span->turn),
+    rover_log_field_str("phase", kPhaseNames[span->phase]),
+    rover_log_field_str("name", span->name ? span->name : ""),
+    rover_log_field_int("ms", ms),
+    rover_log_field_str("err", err == ESP_OK ? "ok" : esp_err_to_name(err)),
+  };
+  rover_log_record_t rec = {
+    .level = ESP_LOG_INFO,
+    .component = TAG,
+    .event = "span",
+    .fields = fields,
+    .field_count = sizeof(fields) / sizeof(fields[0]),
+  };
+  rover_log(&rec);
+  return ms;
+}
+
+// Upper bound of the bucket holding the q-th percentile, capped at the observed max.
+static uint32_t percentile_ms(const phase_stats_t *p, uint32_t count, uint32_t q) {
+  uint32_t max_ms = p->max_ms.load(std::memory_order_relaxed);
+  uint32_t rank = (count * q + 99) / 100;
+  uint32_t seen = 0;
+  for (int b = 0; b < kBuckets - 1; ++b) {
+    seen += p->hist[b].load(std::memory_order_relaxed);
+    if (seen >= rank) return (1u << b) < max_ms ? (1u << b) : max_ms;
+  }
+  return max_ms;
+}
+
+int trace_metrics_json(char *out, size_t size) {
+  size_t len = 0;
+  for (int i = 0; i < TRACE_PHASE_COUNT; ++i) {
+    const phase_stats_t *p = &s_phases[i];
+    uint32_t n = p->count.load(std::memory_order_relaxed);
+    uint64_t total = p->total_ms.load(std::memory_order_relaxed);
+    int w = snprintf(out + len, size - len,
+                     "%s\"%s\":{\"n\":%lu,\"err\":%lu,\"avg_ms\":%lu,\"p50_ms\":%lu,"
+                     "\"p95_ms\":%lu,\"max_ms\":%lu}",
+                     i == 0 ? "{" : ",", kPhaseNames[i], (unsigned long)n,
+                     (unsigned long)p->errors.load(std::memory_order_relaxed),
+                     (unsigned long)(n ? total / n : 0),
+                     (unsigned long)(n ? percentile_ms(p, n, 50) : 0),
+                     (unsigned long)(n ? percentile_ms(p, n, 95) : 0),
+                     (unsigned long)p->max_ms.load(std::memory_order_relaxed));
+    if (w < 0 || (size_t)w >= size - len) return -1;
+    len += (size_t)w;
+  }
+  if (len + 2 > size) return -1;
+  out[len++] = '}';
+  out[len] = '\0';
+  return (int)len;
+}
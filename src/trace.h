@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Latency spans for the chat pipeline. A span is a start timestamp on the caller's stack;
+// ending it emits a "span" log record tagged with the current chat turn and folds the
+// duration into per-phase aggregates (count, errors, max, log2 histogram) for /metrics.
+// Spans may end on any task.
+
+typedef enum {
+  TRACE_TURN = 0,      // whole chat job, prompt to answer
+  TRACE_CONNECT,       // DNS + TCP + TLS: esp_http_client does not separate them
+  TRACE_FIRST_BYTE,    // request sent to first streamed data line
+  TRACE_MODEL_ROUND,   // one model request, including the hedge race
+  TRACE_TOOL,          // one tool callback
+  TRACE_ACTION,        // tool waiting on the core-0 action queue (queueing + execution)
+  TRACE_UART,          // camera command or capture over the UART
+  TRACE_VISION_MODEL,  // image question upload and answer
+  TRACE_PHASE_COUNT,
+} trace_phase_t;
+
+typedef struct {
+  trace_phase_t phase;
+  const char *name;  // static string: tool name, model, UART command
+  uint32_t turn;
+  int64_t start_us;
+} trace_span_t;
+
+// Tags subsequent spans with this chat job id; 0 outside a turn.
+void trace_turn_set(uint32_t turn_id);
+uint32_t trace_turn(void);
+
+trace_span_t trace_begin(trace_phase_t phase, const char *name);
+// Same as trace_begin, for a phase whose start was taken earlier (esp_timer_get_time()).
+trace_span_t trace_begin_at(trace_phase_t phase, const char *name, int64_t start_us);
+// Logs and aggregates; returns the duration in ms.
+uint32_t trace_end(const trace_span_t *span, esp_err_t err);
+
+// {"turn":{"n":..,"err":..,"avg_ms":..,"p50_ms":..,"p95_ms":..,"max_ms":..},...}; the
+// percentiles are histogram bucket upper bounds. Returns length or -1 if it did not fit.
+int trace_metrics_json(char *out, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
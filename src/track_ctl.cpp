@@ -0,0 +1,138 @@
+#include "track_ctl.h"
+
+#include <string.h>
+#include <strings.h>
+
+static const int kFrameWidth = 320;      // QVGA, the camera's detection resolution
+static const uint32_t kStaleMs = 500;    // older snapshots count as "not in view"
+static const uint32_t kSearchAfterMs = 600;  // detector flicker: hold still this long first
+static const uint32_t kGiveUpMs = 8000;
+static const uint32_t kMaxRunMs = 60000;
+static const float kDeadband = 0.08f;    // of half the frame width
+static const float kTurnGain = 70.0f;    // rotation speed per unit of offset
+static const float kCenteredForDrive = 0.35f;  // no forward motion while further off than this
+static const int kMinSpeed = 20;         // below this the RoverC wheels do not turn
+static const int kMaxTurn = 60;
+static const int kMaxForward = 50;
+static const int kSearchTurn = 30;
+static const int kReachWidth = 140;      // box width (px) that counts as within gripper reach
+
+const char *track_phase_name(track_phase_t phase) {
+  switch (phase) {
+    case TRACK_SEARCHING: return "searching";
+    case TRACK_FOLLOWING: return "following";
+    case TRACK_REACHED: return "reached";
+    case TRACK_LOST: return "lost";
+    default: return "off";
+  }
+}
+
+const char *track_mode_name(track_mode_t mode) {
+  switch (mode) {
+    case TRACK_MODE_APPROACH: return "approach";
+    case TRACK_MODE_GRAB: return "grab";
+    default: return "follow";
+  }
+}
+
+void track_ctl_start(track_ctl_t *t, track_mode_t mode, const char *label, uint32_t now_ms) {
+  memset(t, 0, sizeof(*t));
+  t->active = true;
+  t->mode = mode;
+  strlcpy(t->label, label ? label : "", sizeof(t->label));
+  t->phase = TRACK_SEARCHING;
+  t->seen_ms = now_ms;
+  t->started_ms = now_ms;
+}
+
+void track_ctl_stop(track_ctl_t *t) {
+  t->active = false;
+  t->phase = TRACK_OFF;
+  t->x = t->y = t->z = 0;
+}
+
+static bool matches(const track_ctl_t *t, const vision_det_t *d) {
+  if (t->label[0] == '\0') return true;
+  if (strcasecmp(t->label, "face") == 0 && d->kind == VISION_DET_FACE) return true;
+  return strcasecmp(t->label, d->label) == 0;
+}
+
+static const vision_det_t *find_target(const track_ctl_t *t, const vision_world_t *world) {
+  const vision_det_t *best = NULL;
+  for (uint8_t i = 0; i < world->count; ++i) {
+    const vision_det_t *d = &world->dets[i];
+    if (d->w <= 0 || !matches(t, d)) continue;
+    if (best == NULL || (int32_t)d->w * d->h > (int32_t)best->w * best->h) best = d;
+  }
+  return best;
+}
+
+static int8_t with_floor(float v, int max) {
+  int s = (int)v;
+  if (s > max) s = max;
+  if (s < -max) s = -max;
+  if (s > 0 && s < kMinSpeed) s = kMinSpeed;
+  if (s < 0 && s > -kMinSpeed) s = -kMinSpeed;
+  return (int8_t)s;
+}
+
+static track_cmd_t finish(track_ctl_t *t, track_phase_t phase) {
+  track_cmd_t cmd = {};
+  cmd.finished = true;
+  cmd.close_gripper = phase == TRACK_REACHED && t->mode == TRACK_MODE_GRAB;
+  t->active = false;
+  t->phase = phase;
+  t->x = t->y = t->z = 0;
+  return cmd;
+}
+
+static track_cmd_t current(const track_ctl_t *t) {
+  track_cmd_t cmd = {};
+  cmd.x = t->x;
+  cmd.y = t->y;
+  cmd.z = t->z;
+  cmd.moving = t->x != 0 || t->y != 0 || t->z != 0;
+  return cmd;
+}
+
+track_cmd_t track_ctl_update(track_ctl_t *t, const vision_world_t *world, uint32_t now_ms) {
+  if (!t->active) return track_cmd_t{};
+  if (now_ms - t->started_ms > kMaxRunMs) return finish(t, TRACK_LOST);
+
+  bool fresh = world != NULL && now_ms - world->rx_ms <= kStaleMs;
+  if (fresh && world->seq != t->seq) {
+    t->seq = world->seq;
+    const vision_det_t *d = find_target(t, world);
+    if (d != NULL) {
+      if (t->label[0] == '\0') strlcpy(t->label, d->label, sizeof(t->label));
+      t->seen_ms = now_ms;
+      t->phase = TRACK_FOLLOWING;
+      t->width = (uint16_t)d->w;
+      float offset = (d->x + d->w / 2.0f - kFrameWidth / 2.0f) / (kFrameWidth / 2.0f);
+      t->last_side = offset < 0 ? -1 : 1;
+      bool reached = t->mode != TRACK_MODE_FOLLOW && d->w >= kReachWidth;
+      if (reached) return finish(t, TRACK_REACHED);
+      t->x = 0;
+      t->z = (offset > kDeadband || offset < -kDeadband) ? with_floor(offset * kTurnGain, kMaxTurn) : 0;
+      t->y = 0;
+      if (t->mode != TRACK_MODE_FOLLOW && offset < kCenteredForDrive && offset > -kCenteredForDrive) {
+        float remaining = (float)(kReachWidth - d->w) / kReachWidth;
+        t->y = with_floor(remaining * kMaxForward, kMaxForward);
+      }
+      return current(t);
+    }
+  }
+
+  // Not in view in this tick.
+  uint32_t unseen_ms = now_ms - t->seen_ms;
+  if (unseen_ms > kGiveUpMs) return finish(t, TRACK_LOST);
+  if (unseen_ms > kSearchAfterMs) {
+    t->phase = TRACK_SEARCHING;
+    t->x = 0;
+    t->y = 0;
+    t->z = (int8_t)(t->last_side < 0 ? -kSearchTurn : kSearchTurn);
+  } else if (!fresh) {
+    t->x = t->y = t->z = 0;  // blind: do not keep driving on an old command
+  }
+  return current(t);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "vision_world.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Local visual tracking: turns streamed detection boxes into mecanum speed commands that
+// keep a target centred and, optionally, drive up to it. Proportional on the horizontal
+// offset (rotation) and on the remaining box width (forward speed); no LLM involved.
+// Not thread-safe: main drives it from the core-0 loop under s_state_mutex.
+
+typedef enum {
+  TRACK_MODE_FOLLOW = 0,  // rotate to keep the target centred
+  TRACK_MODE_APPROACH,    // also drive forward until it is close
+  TRACK_MODE_GRAB,        // approach, then close the gripper
+} track_mode_t;
+
+typedef enum {
+  TRACK_OFF = 0,
+  TRACK_SEARCHING,  // target not in view (yet); turning towards where it was last seen
+  TRACK_FOLLOWING,
+  TRACK_REACHED,    // approach/grab finished; tracking has stopped
+  TRACK_LOST,       // not seen for too long; tracking has stopped
+} track_phase_t;
+
+typedef struct {
+  bool active;
+  track_mode_t mode;
+  char label[VISION_WORLD_LABEL_MAX];  // class or person name; "" locks onto the largest box
+  track_phase_t phase;
+  uint32_t seq;           // last event used
+  uint32_t seen_ms;       // when the target was last in view
+  uint32_t started_ms;
+  int8_t last_side;       // -1 left, 1 right: where to search
+  int8_t x, y, z;         // current command
+  uint16_t width;         // last target box width, px
+} track_ctl_t;
+
+typedef struct {
+  int8_t x, y, z;
+  bool moving;
+  bool close_gripper;  // once, when a GRAB run reaches its target
+  bool finished;       // this update ended the run (reached or lost)
+} track_cmd_t;
+
+const char *track_phase_name(track_phase_t phase);
+const char *track_mode_name(track_mode_t mode);
+
+void track_ctl_start(track_ctl_t *t, track_mode_t mode, const char *label, uint32_t now_ms);
+void track_ctl_stop(track_ctl_t *t);
+
+// world: latest snapshot, or NULL when the stream is down. Called every control tick; a
+// snapshot whose seq was already used only advances the timers.
+track_cmd_t track_ctl_update(track_ctl_t *t, const vision_world_t *world, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
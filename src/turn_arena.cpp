@@ -0,0 +1,113 @@
+#include "turn_arena.h"
+
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Every block starts with a header; blocks form a stack through prev.
+typedef struct {
+  uint32_t prev;  // offset of the previous header, kNone for the first block
+  uint32_t size;  // block size incl. this header; top bit: freed
+} block_t;
+
+static const uint32_t kNone = UINT32_MAX;
+static const uint32_t kFreed = 0x80000000u;
+static const size_t kAlign = 8;  // cJSON nodes hold a double
+
+static uint8_t *s_base = NULL;
+static uint32_t s_capacity = 0;
+static uint32_t s_top = 0;      // first free byte
+static uint32_t s_last = kNone;  // header of the topmost block
+static std::atomic<TaskHandle_t> s_owner{NULL};
+static uint32_t s_peak = 0;
+static uint32_t s_allocs = 0;
+static uint32_t s_overflows = 0;
+static std::atomic<uint32_t> s_last_peak{0};
+static std::atomic<uint32_t> s_last_allocs{0};
+static std::atomic<uint32_t> s_last_overflows{0};
+static std::atomic<uint32_t> s_last_leaked{0};
+
+bool turn_arena_init(size_t capacity) {
+  capacity &= ~(kAlign - 1);
+  s_base = (uint8_t *)malloc(capacity);
+  if (s_base == NULL) return false;
+  s_capacity = (uint32_t)capacity;
+  return true;
+}
+
+void turn_arena_begin(void) {
+  s_top = 0;
+  s_last = kNone;
+  s_peak = 0;
+  s_allocs = 0;
+  s_overflows = 0;
+  if (s_base != NULL) s_owner.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+}
+
+void turn_arena_end(void) {
+  s_owner.store(NULL, std::memory_order_release);
+  s_last_peak.store(s_peak, std::memory_order_relaxed);
+  s_last_allocs.store(s_allocs, std::memory_order_relaxed);
+  s_last_overflows.store(s_overflows, std::memory_order_relaxed);
+  s_last_leaked.store(s_top, std::memory_order_relaxed);
+  s_top = 0;
+  s_last = kNone;
+}
+
+static bool owns(const void *ptr) {
+  return s_base != NULL && (const uint8_t *)ptr >= s_base && (const uint8_t *)ptr < s_base + s_capacity;
+}
+
+void *turn_arena_malloc(size_t size) {
+  if (s_owner.load(std::memory_order_acquire) != xTaskGetCurrentTaskHandle()) return malloc(size);
+  // Checked before rounding: a size near SIZE_MAX would wrap to a small block.
+  size_t need = (sizeof(block_t) + size + kAlign - 1) & ~(kAlign - 1);
+  if (size > s_capacity || need > s_capacity - s_top) {
+    s_overflows++;
+    return malloc(size);
+  }
+  block_t *b = (block_t *)(s_base + s_top);
+  b->prev = s_last;
+  b->size = (uint32_t)need;
+  s_last = s_top;
+  s_top += (uint32_t)need;
+  if (s_top > s_peak) s_peak = s_top;
+  s_allocs++;
+  return b + 1;
+}
+
+void turn_arena_free(void *ptr) {
+  if (ptr == NULL) return;
+  if (!owns(ptr)) {
+    free(ptr);
+    return;
+  }
+  // A block freed after its turn closed, or by another task, is reclaimed by the reset.
+  if (s_owner.load(std::memory_order_acquire) != xTaskGetCurrentTaskHandle()) return;
+  block_t *b = (block_t *)ptr - 1;
+  b->size |= kFreed;
+  while (s_last != kNone) {
+    block_t *top = (block_t *)(s_base + s_last);
+    if (!(top->size & kFreed)) break;
+    s_top = s_last;
+    s_last = top->prev;
+  }
+}
+
+char *turn_arena_strdup(const char *s) {
+  size_t n = strlen(s) + 1;
+  char *out = (char *)turn_arena_malloc(n);
+  if (out != NULL) memcpy(out, s, n);
+  return out;
+}
+
+void turn_arena_stats(turn_arena_stats_t *out) {
+  out->capacity = s_capacity;
+  out->peak = s_last_peak.load(std::memory_order_relaxed);
+  out->allocs = s_last_allocs.load(std::memory_order_relaxed);
+  out->overflows = s_last_overflows.load(std::memory_order_relaxed);
+  out->leaked = s_last_leaked.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-chat-turn arena for the AI path. One block is reserved at boot; while a turn is
+// open, allocations made by the task that opened it (through the cJSON hooks and
+// turn_arena_strdup) are carved from it as a stack. A freed block is reclaimed as soon as
+// everything above it has been freed too, so parse/delete and print/free pairs never grow
+// it; whatever is left goes in one reset when the turn closes. Other tasks, and the owner
+// outside a turn or once the block is full, fall through to malloc.
+
+typedef struct {
+  uint32_t capacity;
+  uint32_t peak;       // high-water mark of the last closed turn, bytes incl. headers
+  uint32_t allocs;     // served from the arena in the last turn
+  uint32_t overflows;  // fell back to malloc in the last turn because the arena was full
+  uint32_t leaked;     // bytes still allocated when the last turn closed
+} turn_arena_stats_t;
+
+// Reserves the block; false if it could not be allocated (the hooks then always malloc).
+bool turn_arena_init(size_t capacity);
+
+// Opens a turn for the calling task; closing reports and resets.
+void turn_arena_begin(void);
+void turn_arena_end(void);
+
+// malloc/free replacements, meant for cJSON_InitHooks. turn_arena_free accepts any pointer
+// from turn_arena_malloc or plain malloc.
+void *turn_arena_malloc(size_t size);
+void turn_arena_free(void *ptr);
+char *turn_arena_strdup(const char *s);
+
+void turn_arena_stats(turn_arena_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
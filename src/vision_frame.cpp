@@ -0,0 +1,132 @@
+#include "vision_frame.h"
+
+#include <string.h>
+
+static void put_u16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)(v & 0xff);
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+  return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+uint16_t vision_crc16(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xffff;
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int b = 0; b < 8; ++b) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+size_t vision_cobs_encode(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_size) {
+  if (dst_size == 0) return 0;
+  size_t code_idx = 0;
+  size_t out = 1;
+  uint8_t code = 1;
+  for (size_t i = 0; i < len; ++i) {
+    if (src[i] != 0) {
+      if (out >= dst_size) return 0;
+      dst[out++] = src[i];
+      code++;
+    }
+    if (src[i] == 0 || code == 0xff) {
+      dst[code_idx] = code;
+      code = 1;
+      code_idx = out;
+      if (out >= dst_size) return 0;
+      out++;
+    }
+  }
+  dst[code_idx] = code;
+  return out;
+}
+
+size_t vision_cobs_decode(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_size) {
+  size_t in = 0;
+  size_t out = 0;
+  while (in < len) {
+    uint8_t code = src[in++];
+    if (code == 0) return 0;
+    for (uint8_t i = 1; i < code; ++i) {
+      if (in >= len || out >= dst_size) return 0;
+      uint8_t b = src[in++];
+      if (b == 0) return 0;
+      dst[out++] = b;
+    }
+    if (code != 0xff && in < len) {
+      if (out >= dst_size) return 0;
+      dst[out++] = 0;
+    }
+  }
+  return out;
+}
+
+size_t vision_frame_encode(const vision_frame_t *frame, uint8_t *out, size_t out_size) {
+  if (frame == NULL || out == NULL) return 0;
+  if (frame->len > VISION_FRAME_PAYLOAD_MAX) return 0;
+  if (frame->len > 0 && frame->payload == NULL) return 0;
+
+  uint8_t raw[VISION_FRAME_RAW_MAX];
+  raw[0] = frame->type;
+  raw[1] = frame->flags;
+  put_u16(&raw[2], frame->req_id);
+  put_u16(&raw[4], frame->seq);
+  put_u16(&raw[6], frame->total);
+  if (frame->len > 0) memcpy(&raw[VISION_FRAME_HDR_SIZE], frame->payload, frame->len);
+  size_t raw_len = VISION_FRAME_HDR_SIZE + frame->len;
+  put_u16(&raw[raw_len], vision_crc16(raw, raw_len));
+  raw_len += VISION_FRAME_CRC_SIZE;
+
+  if (out_size < 3) return 0;
+  out[0] = 0x00;
+  size_t enc = vision_cobs_encode(raw, raw_len, out + 1, out_size - 2);
+  if (enc == 0) return 0;
+  out[1 + enc] = 0x00;
+  return enc + 2;
+}
+
+void vision_frame_decoder_reset(vision_frame_decoder_t *dec) {
+  dec->len = 0;
+  dec->overflow = false;
+}
+
+vision_frame_status_t vision_frame_decoder_push(vision_frame_decoder_t *dec, uint8_t byte,
+                                                vision_frame_t *out) {
+  if (byte != 0x00) {
+    if (dec->len < sizeof(dec->buf)) {
+      dec->buf[dec->len++] = byte;
+    } else {
+      dec->overflow = true;
+    }
+    return VISION_FRAME_NEED_MORE;
+  }
+
+  // Delimiter: an empty frame is just back-to-back delimiters.
+  size_t enc_len = dec->len;
+  bool overflow = dec->overflow;
+  vision_frame_decoder_reset(dec);
+  if (enc_len == 0) return VISION_FRAME_NEED_MORE;
+  if (overflow) return VISION_FRAME_OVERFLOW;
+
+  size_t raw_len = vision_cobs_decode(dec->buf, enc_len, dec->buf, sizeof(dec->buf));
+  if (raw_len < VISION_FRAME_HDR_SIZE + VISION_FRAME_CRC_SIZE) return VISION_FRAME_MALFORMED;
+
+  size_t body_len = raw_len - VISION_FRAME_CRC_SIZE;
+  if (get_u16(&dec->buf[body_len]) != vision_crc16(dec->buf, body_len)) {
+    return VISION_FRAME_BAD_CRC;
+  }
+  if (body_len - VISION_FRAME_HDR_SIZE > VISION_FRAME_PAYLOAD_MAX) return VISION_FRAME_MALFORMED;
+
+  out->type = dec->buf[0];
+  out->flags = dec->buf[1];
+  out->req_id = get_u16(&dec->buf[2]);
+  out->seq = get_u16(&dec->buf[4]);
+  out->total = get_u16(&dec->buf[6]);
+  out->payload = &dec->buf[VISION_FRAME_HDR_SIZE];
+  out->len = (uint16_t)(body_len - VISION_FRAME_HDR_SIZE);
+  return VISION_FRAME_OK;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Framed UnitV transport (see docs/vision-protocol.md).
+// On the wire: 0x00 | COBS(header | payload | crc16) | 0x00
+// Header: type u8, flags u8, req_id u16, seq u16, total u16 (little endian).
+// CRC-16/CCITT-FALSE over header + payload, little endian.
+
+#define VISION_FRAME_HDR_SIZE 8
+#define VISION_FRAME_CRC_SIZE 2
+#define VISION_FRAME_PAYLOAD_MAX 1024
+#define VISION_FRAME_RAW_MAX (VISION_FRAME_HDR_SIZE + VISION_FRAME_PAYLOAD_MAX + VISION_FRAME_CRC_SIZE)
+#define VISION_FRAME_WIRE_MAX (VISION_FRAME_RAW_MAX + VISION_FRAME_RAW_MAX / 254 + 3)
+
+typedef enum {
+  VISION_FRAME_JSON = 1,  // request or response JSON (no trailing newline)
+  VISION_FRAME_DATA = 2,  // binary payload chunk (e.g. CAPTURE JPEG)
+  VISION_FRAME_EVENT = 3, // unsolicited subscription event (JSON)
+} vision_frame_type_t;
+
+typedef struct {
+  uint8_t type;
+  uint8_t flags;
+  uint16_t req_id;
+  uint16_t seq;
+  uint16_t total;
+  const uint8_t *payload;
+  uint16_t len;
+} vision_frame_t;
+
+typedef enum {
+  VISION_FRAME_NEED_MORE = 0,
+  VISION_FRAME_OK = 1,
+  VISION_FRAME_BAD_CRC = 2,
+  VISION_FRAME_MALFORMED = 3,
+  VISION_FRAME_OVERFLOW = 4,
+} vision_frame_status_t;
+
+typedef struct {
+  uint8_t buf[VISION_FRAME_WIRE_MAX];
+  size_t len;
+  bool overflow;
+} vision_frame_decoder_t;
+
+uint16_t vision_crc16(const uint8_t *data, size_t len);
+
+// Returns encoded length, or 0 if dst is too small. Output contains no 0x00 bytes.
+size_t vision_cobs_encode(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_size);
+// Returns decoded length, or 0 on malformed input. Safe to call with dst == src.
+size_t vision_cobs_decode(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_size);
+
+// Encodes a complete wire frame including both delimiters. Returns 0 if out is too small.
+size_t vision_frame_encode(const vision_frame_t *frame, uint8_t *out, size_t out_size);
+
+void vision_frame_decoder_reset(vision_frame_decoder_t *dec);
+// Feeds one wire byte. On VISION_FRAME_OK, *out points into the decoder buffer and stays
+// valid only until the next push. Any status other than NEED_MORE resynchronises the decoder.
+vision_frame_status_t vision_frame_decoder_push(vision_frame_decoder_t *dec, uint8_t byte,
+                                                vision_frame_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,131 @@
+#include "vision_world.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+
+#include "json_tok.h"
+
+// Two slots and a publish counter: the writer fills the slot readers are not pointed at,
+// then bumps the counter. A reader copies the current slot and retries if the counter moved
+// (the writer may then be reusing that slot). A writer preempted mid-copy never blocks readers.
+static vision_world_t s_slots[2];
+static std::atomic<uint32_t> s_version{0};
+static std::atomic<bool> s_valid{false};
+
+static const int kReadAttempts = 4;
+// A full event (8 detections) is about 110 tokens; a bigger one is cut at the budget.
+static const int kEventTokens = 128;
+// Only the single writer parses, so the token array need not live on its stack.
+static json_tok_t s_toks[kEventTokens];
+
+bool vision_world_is_event(const char *json, size_t len) {
+  static const char kPrefix[] = "{\"ev\":";
+  return len >= sizeof(kPrefix) - 1 && memcmp(json, kPrefix, sizeof(kPrefix) - 1) == 0;
+}
+
+static int16_t clamp_i16(double v) {
+  if (v < -32768.0) return -32768;
+  if (v > 32767.0) return 32767;
+  return (int16_t)v;
+}
+
+// Labels end up in JSON and on the display: keep a safe character set.
+static void copy_label(char *dst, const char *src, size_t len) {
+  size_t n = 0;
+  for (size_t i = 0; i < len && n < VISION_WORLD_LABEL_MAX - 1; ++i) {
+    char c = src[i];
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+        c == '_' || c == '-' || c == '.' || c == ' ') {
+      dst[n++] = c;
+    }
+  }
+  dst[n] = '\0';
+}
+
+bool vision_world_parse(const char *json, size_t len, vision_world_t *out) {
+  if (!vision_world_is_event(json, len)) return false;
+  json_doc_t doc;
+  int n = json_tok_parse(&doc, json, len, s_toks, kEventTokens);
+  if (n < 0 && n != JSON_TOK_ERR_NOMEM) return false;
+  bool cut = n == JSON_TOK_ERR_NOMEM;
+
+  memset(out, 0, sizeof(*out));
+  double seq = 0, t = 0;
+  int dets = json_tok_get(&doc, 0, "d");
+  if (!json_tok_number(&doc, json_tok_get(&doc, 0, "seq"), &seq) ||
+      (dets >= 0 && doc.toks[dets].type != JSON_TOK_ARRAY)) {
+    return false;
+  }
+  out->seq = (uint32_t)seq;
+  out->cam_ms = json_tok_number(&doc, json_tok_get(&doc, 0, "t"), &t) ? (uint32_t)t : 0;
+
+  int item;
+  for (int k = 0; (item = json_tok_at(&doc, dets, k)) >= 0; ++k) {
+    if (out->count >= VISION_WORLD_MAX_DETS) break;
+    if (cut && k == doc.toks[dets].size - 1) break;  // the detection the budget cut through
+    const char *name;
+    size_t name_len;
+    if (!json_tok_str(&doc, json_tok_get(&doc, item, "n"), &name, &name_len)) continue;
+
+    vision_det_t *d = &out->dets[out->count];
+    copy_label(d->label, name, name_len);
+    d->kind = json_tok_str_eq(&doc, json_tok_get(&doc, item, "k"), "face") ? VISION_DET_FACE
+                                                                          : VISION_DET_OBJECT;
+    double s = 0.0;
+    (void)json_tok_number(&doc, json_tok_get(&doc, item, "s"), &s);
+    d->score = (uint8_t)(s < 0.0 ? 0 : (s > 100.0 ? 100 : s));
+    int box = json_tok_get(&doc, item, "b");
+    double b[4];
+    if (box >= 0 && doc.toks[box].type == JSON_TOK_ARRAY && doc.toks[box].size == 4 &&
+        json_tok_number(&doc, json_tok_at(&doc, box, 0), &b[0]) &&
+        json_tok_number(&doc, json_tok_at(&doc, box, 1), &b[1]) &&
+        json_tok_number(&doc, json_tok_at(&doc, box, 2), &b[2]) &&
+        json_tok_number(&doc, json_tok_at(&doc, box, 3), &b[3])) {
+      d->x = clamp_i16(b[0]);
+      d->y = clamp_i16(b[1]);
+      d->w = clamp_i16(b[2]);
+      d->h = clamp_i16(b[3]);
+    }
+    out->count++;
+  }
+  return true;
+}
+
+void vision_world_publish(const vision_world_t *world) {
+  uint32_t next = s_version.load(std::memory_order_relaxed) + 1;
+  memcpy(&s_slots[next & 1], world, sizeof(*world));
+  s_version.store(next, std::memory_order_release);
+  s_valid.store(true, std::memory_order_release);
+}
+
+bool vision_world_latest(vision_world_t *out) {
+  for (int attempt = 0; attempt < kReadAttempts; ++attempt) {
+    if (!s_valid.load(std::memory_order_acquire)) return false;
+    uint32_t v = s_version.load(std::memory_order_acquire);
+    memcpy(out, &s_slots[v & 1], sizeof(*out));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (s_version.load(std::memory_order_relaxed) == v) return true;
+  }
+  return false;
+}
+
+void vision_world_clear(void) {
+  s_valid.store(false, std::memory_order_release);
+}
+
+int vision_world_to_json(const vision_world_t *world, uint32_t now_ms, char *out, size_t out_size) {
+  if (out_size == 0) return -1;
+  int n = snprintf(out, out_size, "{\"seq\":%u,\"age_ms\":%u,\"dets\":[",
+                   (unsigned)world->seq, (unsigned)(now_ms - world->rx_ms));
+  for (uint8_t i = 0; i < world->count && n > 0 && n < (int)out_size; ++i) {
+    const vision_det_t *d = &world->dets[i];
+    n += snprintf(out + n, out_size - n,
+                  "%s{\"kind\":\"%s\",\"label\":\"%s\",\"score\":%u,\"box\":[%d,%d,%d,%d]}",
+                  i ? "," : "", d->kind == VISION_DET_FACE ? "face" : "object", d->label,
+                  (unsigned)d->score, d->x, d->y, d->w, d->h);
+  }
+  if (n > 0 && n < (int)out_size) n += snprintf(out + n, out_size - n, "]}");
+  if (n <= 0 || n >= (int)out_size) return -1;
+  return n;
+}
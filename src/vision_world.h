@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Latest detections streamed by the UnitV in subscribe mode (see docs/vision-protocol.md).
+// One writer (the vision link task) publishes; any task may read without locking.
+
+#define VISION_WORLD_MAX_DETS 8
+#define VISION_WORLD_LABEL_MAX 16
+
+typedef enum {
+  VISION_DET_OBJECT = 0,
+  VISION_DET_FACE = 1,
+} vision_det_kind_t;
+
+typedef struct {
+  char label[VISION_WORLD_LABEL_MAX];  // class name, or person name for faces
+  uint8_t kind;                        // vision_det_kind_t
+  uint8_t score;                       // 0..100
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+} vision_det_t;
+
+typedef struct {
+  uint32_t seq;     // camera event counter
+  uint32_t cam_ms;  // camera uptime when the frame was analysed
+  uint32_t rx_ms;   // local log timestamp when the event arrived
+  uint8_t count;
+  vision_det_t dets[VISION_WORLD_MAX_DETS];
+} vision_world_t;
+
+// True if a received line/frame payload is a streamed event rather than a command reply.
+bool vision_world_is_event(const char *json, size_t len);
+// Parses an event into *out (rx_ms left at 0). Detections beyond the cap are dropped.
+bool vision_world_parse(const char *json, size_t len, vision_world_t *out);
+
+// Single writer only.
+void vision_world_publish(const vision_world_t *world);
+// Copies the latest snapshot. False before the first event, or if the writer kept
+// overwriting it during the copy.
+bool vision_world_latest(vision_world_t *out);
+// Drops the snapshot (e.g. when the stream is lost) so readers stop using stale detections.
+void vision_world_clear(void);
+
+// Compact JSON for tools and HTTP: {"seq":N,"age_ms":N,"dets":[...]}. Returns length or -1.
+int vision_world_to_json(const vision_world_t *world, uint32_t now_ms, char *out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
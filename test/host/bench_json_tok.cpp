@@ -0,0 +1,191 @@
+// json_tok against cJSON on the json_tok test corpus: parse, then read every key and value
+// the way the firmware pulls fields out of UnitV replies and OpenRouter chunks. Prints time
+// per document and heap use for both; the values both extract must agree.
+//   bench_json_tok [iterations]   (ctest runs a few iterations, for the cross-check only)
+
+#include <chrono>
+#include <stdlib.h>
+
+#include "cJSON.h"
+#include "check.h"
+#include "json_corpus.h"
+#include "json_tok.h"
+
+static const char *const kNames[] = {
+  "unitv faces", "unitv error", "unitv capture", "unitv world event", "unitv resend",
+  "or completion", "or stream text", "or stream tool", "or error",
+  "tool move", "tool scan", "mixed array",
+};
+static_assert(sizeof(kNames) / sizeof(kNames[0]) == sizeof(kCorpus) / sizeof(kCorpus[0]),
+              "one name per corpus document");
+
+static const int kMaxToks = 128;
+
+// What a walk read, to compare the parsers and to keep the work from being optimised away.
+typedef struct {
+  int values;
+  size_t key_bytes;
+  size_t str_bytes;
+  double num_sum;
+  int trues;
+} extract_t;
+
+static bool same(const extract_t &a, const extract_t &b) {
+  return a.values == b.values && a.key_bytes == b.key_bytes && a.str_bytes == b.str_bytes &&
+         a.num_sum == b.num_sum && a.trues == b.trues;
+}
+
+// cJSON heap use, through its allocator hooks as on the rover (where they point at the arena).
+static size_t s_allocs;
+static size_t s_live;
+static size_t s_peak;
+static const size_t kHeader = 16;  // keeps the caller's block aligned
+
+static void *count_malloc(size_t size) {
+  uint8_t *p = (uint8_t *)malloc(size + kHeader);
+  if (p == NULL) return NULL;
+  memcpy(p, &size, sizeof(size));
+  s_allocs++;
+  s_live += size;
+  if (s_live > s_peak) s_peak = s_live;
+  return p + kHeader;
+}
+
+static void count_free(void *ptr) {
+  if (ptr == NULL) return;
+  uint8_t *p = (uint8_t *)ptr - kHeader;
+  size_t size;
+  memcpy(&size, p, sizeof(size));
+  s_live -= size;
+  free(p);
+}
+
+static void tok_visit(const json_doc_t *doc, int i, extract_t *x) {
+  const json_tok_t *t = &doc->toks[i];
+  if (t->type == JSON_TOK_OBJECT) {
+    int k = i + 1;
+    for (int n = 0; n < t->size; ++n) {
+      const char *key;
+      size_t key_len;
+      if (json_tok_str(doc, k, &key, &key_len)) x->key_bytes += key_len;
+      tok_visit(doc, k + 1, x);
+      k = json_tok_next(doc, k + 1);
+    }
+    return;
+  }
+  if (t->type == JSON_TOK_ARRAY) {
+    int e = i + 1;
+    for (int n = 0; n < t->size; ++n) {
+      tok_visit(doc, e, x);
+      e = json_tok_next(doc, e);
+    }
+    return;
+  }
+  x->values++;
+  char buf[256];
+  double d;
+  bool b;
+  int len = json_tok_str_copy(doc, i, buf, sizeof(buf));
+  if (len >= 0) {
+    x->str_bytes += (size_t)len;
+  } else if (json_tok_number(doc, i, &d)) {
+    x->num_sum += d;
+  } else if (json_tok_bool(doc, i, &b)) {
+    x->trues += b;
+  }
+}
+
+static void cjson_visit(const cJSON *item, extract_t *x) {
+  if (cJSON_IsObject(item) || cJSON_IsArray(item)) {
+    for (const cJSON *c = item->child; c != NULL; c = c->next) {
+      if (cJSON_IsObject(item)) x->key_bytes += strlen(c->string);
+      cjson_visit(c, x);
+    }
+    return;
+  }
+  x->values++;
+  if (cJSON_IsString(item)) {
+    x->str_bytes += strlen(item->valuestring);
+  } else if (cJSON_IsNumber(item)) {
+    x->num_sum += item->valuedouble;
+  } else if (cJSON_IsTrue(item)) {
+    x->trues++;
+  }
+}
+
+static bool tok_run(const char *js, size_t len, extract_t *x, int *count) {
+  json_tok_t toks[kMaxToks];
+  json_doc_t doc;
+  *count = json_tok_parse(&doc, js, len, toks, kMaxToks);
+  if (*count <= 0) return false;
+  tok_visit(&doc, 0, x);
+  return true;
+}
+
+static bool cjson_run(const char *js, size_t len, extract_t *x) {
+  cJSON *root = cJSON_ParseWithLength(js, len);
+  if (root == NULL) return false;
+  cjson_visit(root, x);
+  cJSON_Delete(root);
+  return true;
+}
+
+template <typename F>
+static double ns_per_run(int iterations, F run) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) run();
+  std::chrono::duration<double, std::nano> spent = std::chrono::steady_clock::now() - start;
+  return spent.count() / iterations;
+}
+
+int main(int argc, char **argv) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+  if (iterations < 1) iterations = 1;
+  cJSON_Hooks hooks = {count_malloc, count_free};
+  cJSON_InitHooks(&hooks);
+
+  printf("%-18s %6s %5s %9s | %10s %7s %7s %8s\n", "payload", "bytes", "toks", "tok_ns",
+         "cjson_ns", "allocs", "peak_B", "speedup");
+  double tok_total = 0.0, cjson_total = 0.0;
+  size_t allocs_total = 0, peak_max = 0;
+  volatile double sink = 0.0;
+  for (size_t d = 0; d < sizeof(kCorpus) / sizeof(kCorpus[0]); ++d) {
+    const char *js = kCorpus[d];
+    size_t len = strlen(js);
+
+    extract_t by_tok = {}, by_cjson = {};
+    int count = 0;
+    CHECK(tok_run(js, len, &by_tok, &count));
+    s_allocs = s_live = s_peak = 0;
+    CHECK(cjson_run(js, len, &by_cjson));
+    size_t allocs = s_allocs, peak = s_peak;
+    CHECK_EQ(s_live, 0);
+    if (!same(by_tok, by_cjson)) {
+      fprintf(stderr, "%s: json_tok and cJSON read different values\n", kNames[d]);
+      s_check_failures++;
+    }
+
+    double tok_ns = ns_per_run(iterations, [&] {
+      extract_t x = {};
+      int n;
+      tok_run(js, len, &x, &n);
+      sink = sink + x.num_sum;
+    });
+    double cjson_ns = ns_per_run(iterations, [&] {
+      extract_t x = {};
+      cjson_run(js, len, &x);
+      sink = sink + x.num_sum;
+    });
+    printf("%-18s %6zu %5d %9.0f | %10.0f %7zu %7zu %7.1fx\n", kNames[d], len, count, tok_ns,
+           cjson_ns, allocs, peak, cjson_ns / tok_ns);
+    tok_total += tok_ns;
+    cjson_total += cjson_ns;
+    allocs_total += allocs;
+    if (peak > peak_max) peak_max = peak;
+  }
+  printf("%-18s %6s %5s %9.0f | %10.0f %7zu %7zu %7.1fx\n", "total", "", "", tok_total,
+         cjson_total, allocs_total, peak_max, cjson_total / tok_total);
+  printf("json_tok: 0 heap allocations, %zu-byte tokens in the caller's array (%zu bytes for %d)\n",
+         sizeof(json_tok_t), sizeof(json_tok_t) * kMaxToks, kMaxToks);
+  return check_result("bench_json_tok");
+}
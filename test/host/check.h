@@ -0,0 +1,46 @@
+#pragma once
+
+// Minimal checks for the host tests: a failed check prints where and what, the test goes on,
+// and main returns check_result() so ctest reports the failure.
+
+#include <stdio.h>
+#include <string.h>
+
+static int s_check_failures = 0;
+
+#define CHECK(cond)                                                               \
+  do {                                                                            \
+    if (!(cond)) {                                                                \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);    \
+      s_check_failures++;                                                         \
+    }                                                                             \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                            \
+  do {                                                                            \
+    long long check_a_ = (long long)(a), check_b_ = (long long)(b);               \
+    if (check_a_ != check_b_) {                                                   \
+      fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, \
+              __LINE__, #a, #b, check_a_, check_b_);                              \
+      s_check_failures++;                                                         \
+    }                                                                             \
+  } while (0)
+
+#define CHECK_STR(a, b)                                                           \
+  do {                                                                            \
+    const char *check_a_ = (a), *check_b_ = (b);                                  \
+    if (strcmp(check_a_, check_b_) != 0) {                                        \
+      fprintf(stderr, "%s:%d: CHECK_STR(%s, %s) failed: \"%s\" != \"%s\"\n",      \
+              __FILE__, __LINE__, #a, #b, check_a_, check_b_);                    \
+      s_check_failures++;                                                         \
+    }                                                                             \
+  } while (0)
+
+static inline int check_result(const char *name) {
+  if (s_check_failures) {
+    fprintf(stderr, "%s: %d check(s) failed\n", name, s_check_failures);
+    return 1;
+  }
+  printf("%s: ok\n", name);
+  return 0;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+// Host stand-in for ESP-IDF's esp_crt_bundle.h. The fake esp_http_client verifies against the
+// system's CA store when a config attaches the bundle (see esp_http_client.cpp).
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t esp_crt_bundle_attach(void *conf);
+
+#ifdef __cplusplus
+}
+#endif
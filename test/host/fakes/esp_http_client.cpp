@@ -0,0 +1,495 @@
+#include "esp_http_client.h"
+
+#include <algorithm>
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <string>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#include "esp_crt_bundle.h"
+
+static std::atomic<uint32_t> s_handshakes{0};
+static std::atomic<uint32_t> s_resumed{0};
+static std::atomic<uint32_t> s_clients{0};
+static std::atomic<uint32_t> s_connections{0};
+
+struct esp_http_client {
+  std::string host;
+  std::string port;
+  std::string path;
+  bool tls;
+  esp_http_client_method_t method;
+  int timeout_ms;
+  http_event_handle_cb handler;
+  void *user_data;
+  bool save_session;
+  std::vector<std::pair<std::string, std::string>> headers;
+  SSL_CTX *ctx;
+  SSL_SESSION *session;
+  SSL *ssl;
+  int fd;
+  // The response being read.
+  std::string in;  // received, not yet consumed
+  bool head_request;
+  bool headers_done;
+  int status;
+  int64_t content_length;  // -1: until the connection closes
+  bool chunked;
+  int64_t chunk_left;      // of the current chunk; 0 between chunks
+  bool chunk_crlf;         // the CRLF closing a chunk is still to come
+  bool last_chunk;         // the zero-size chunk was read, its final CRLF is not
+  bool body_done;
+};
+
+esp_err_t esp_crt_bundle_attach(void *conf) {
+  (void)conf;
+  return ESP_OK;
+}
+
+static void dispatch(esp_http_client_handle_t c, esp_http_client_event_id_t id) {
+  if (c->handler == nullptr) return;
+  esp_http_client_event_t evt = {};
+  evt.event_id = id;
+  evt.client = c;
+  evt.user_data = c->user_data;
+  c->handler(&evt);
+}
+
+// Session tickets arrive after the handshake (TLS 1.3); the newest one is kept.
+static int on_new_session(SSL *ssl, SSL_SESSION *session) {
+  esp_http_client_handle_t c = (esp_http_client_handle_t)SSL_get_app_data(ssl);
+  if (c == nullptr || !c->save_session) return 0;
+  if (c->session) SSL_SESSION_free(c->session);
+  c->session = session;
+  return 1;  // the handle owns it now
+}
+
+static bool load_cert_pem(SSL_CTX *ctx, const char *pem) {
+  BIO *bio = BIO_new_mem_buf(pem, -1);
+  X509_STORE *store = SSL_CTX_get_cert_store(ctx);
+  int added = 0;
+  X509 *cert;
+  while ((cert = PEM_read_bio_X509(bio, nullptr, nullptr, nullptr)) != nullptr) {
+    if (X509_STORE_add_cert(store, cert) == 1) added++;
+    X509_free(cert);
+  }
+  ERR_clear_error();  // the read that ends the loop leaves an error behind
+  BIO_free(bio);
+  return added > 0;
+}
+
+static bool parse_url(esp_http_client_handle_t c, const char *url) {
+  std::string u = url;
+  size_t scheme = u.find("://");
+  if (scheme == std::string::npos) return false;
+  c->tls = u.compare(0, scheme, "https") == 0;
+  size_t host_at = scheme + 3;
+  size_t path_at = u.find('/', host_at);
+  std::string authority = u.substr(host_at, path_at == std::string::npos ? std::string::npos : path_at - host_at);
+  c->path = path_at == std::string::npos ? "/" : u.substr(path_at);
+  size_t colon = authority.rfind(':');
+  if (colon == std::string::npos) {
+    c->host = authority;
+    c->port = c->tls ? "443" : "80";
+  } else {
+    c->host = authority.substr(0, colon);
+    c->port = authority.substr(colon + 1);
+  }
+  return !c->host.empty();
+}
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config) {
+  // lwIP has no SIGPIPE; a write to a connection the server dropped must just fail.
+  signal(SIGPIPE, SIG_IGN);
+  esp_http_client_handle_t c = new esp_http_client();
+  c->fd = -1;
+  c->method = config->method;
+  c->timeout_ms = config->timeout_ms > 0 ? config->timeout_ms : 5000;
+  c->handler = config->event_handler;
+  c->user_data = config->user_data;
+  c->save_session = config->save_client_session;
+  if (config->url == nullptr || !parse_url(c, config->url)) {
+    delete c;
+    return nullptr;
+  }
+  if (c->tls) {
+    c->ctx = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_verify(c->ctx, SSL_VERIFY_PEER, nullptr);
+    bool trusted = config->cert_pem ? load_cert_pem(c->ctx, config->cert_pem)
+                                    : SSL_CTX_set_default_verify_paths(c->ctx) == 1;
+    if (!trusted) {
+      SSL_CTX_free(c->ctx);
+      delete c;
+      return nullptr;
+    }
+    SSL_CTX_set_session_cache_mode(c->ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(c->ctx, on_new_session);
+  }
+  s_clients.fetch_add(1);
+  return c;
+}
+
+static int64_t now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int remaining_ms(int64_t deadline_ms) {
+  int64_t left = deadline_ms - now_ms();
+  return left > 0 ? (int)left : 0;
+}
+
+// 1 ready, 0 timed out, -1 error.
+static int wait_fd(int fd, short events, int64_t deadline_ms) {
+  struct pollfd p = {fd, events, 0};
+  for (;;) {
+    int r = poll(&p, 1, remaining_ms(deadline_ms));
+    if (r > 0) return 1;
+    if (r == 0) return 0;
+    if (errno != EINTR) return -1;
+  }
+}
+
+static void drop_connection(esp_http_client_handle_t c) {
+  if (c->ssl) {
+    // Closed without a close_notify, but as a clean shutdown: OpenSSL would otherwise mark the
+    // saved session unresumable.
+    SSL_set_shutdown(c->ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+    SSL_free(c->ssl);
+    c->ssl = nullptr;
+  }
+  if (c->fd >= 0) {
+    close(c->fd);
+    c->fd = -1;
+    s_connections.fetch_sub(1);
+  }
+}
+
+static esp_err_t connect_to(esp_http_client_handle_t c) {
+  int64_t deadline = now_ms() + c->timeout_ms;
+  struct addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo *res = nullptr;
+  if (getaddrinfo(c->host.c_str(), c->port.c_str(), &hints, &res) != 0) return ESP_ERR_HTTP_CONNECT;
+  int fd = -1;
+  for (struct addrinfo *a = res; a && fd < 0; a = a->ai_next) {
+    fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+    if (fd < 0) continue;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (connect(fd, a->ai_addr, a->ai_addrlen) != 0 &&
+        (errno != EINPROGRESS || wait_fd(fd, POLLOUT, deadline) != 1 ||
+         getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0 || err != 0)) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  freeaddrinfo(res);
+  if (fd < 0) return ESP_ERR_HTTP_CONNECT;
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  c->fd = fd;
+  s_connections.fetch_add(1);
+  if (!c->tls) return ESP_OK;
+
+  c->ssl = SSL_new(c->ctx);
+  SSL_set_app_data(c->ssl, c);
+  SSL_set_fd(c->ssl, fd);
+  SSL_set_tlsext_host_name(c->ssl, c->host.c_str());
+  SSL_set1_host(c->ssl, c->host.c_str());
+  if (c->session) SSL_set_session(c->ssl, c->session);
+  for (;;) {
+    int r = SSL_connect(c->ssl);
+    if (r == 1) break;
+    int e = SSL_get_error(c->ssl, r);
+    short want = e == SSL_ERROR_WANT_READ ? POLLIN : e == SSL_ERROR_WANT_WRITE ? POLLOUT : 0;
+    if (want == 0 || wait_fd(fd, want, deadline) != 1) {
+      ERR_clear_error();
+      drop_connection(c);
+      return ESP_ERR_HTTP_CONNECT;
+    }
+  }
+  s_handshakes.fetch_add(1);
+  if (SSL_session_reused(c->ssl)) s_resumed.fetch_add(1);
+  return ESP_OK;
+}
+
+// Bytes read into c->in: >0 on data, 0 when the peer closed, -1 on error, -2 on a timeout.
+static int fill(esp_http_client_handle_t c) {
+  if (c->fd < 0) return -1;
+  int64_t deadline = now_ms() + c->timeout_ms;
+  char buf[2048];
+  for (;;) {
+    int n;
+    short want = POLLIN;
+    if (c->ssl) {
+      n = SSL_read(c->ssl, buf, sizeof(buf));
+      if (n <= 0) {
+        int e = SSL_get_error(c->ssl, n);
+        ERR_clear_error();
+        if (e == SSL_ERROR_ZERO_RETURN) return 0;
+        if (e == SSL_ERROR_WANT_WRITE) want = POLLOUT;
+        else if (e != SSL_ERROR_WANT_READ) return e == SSL_ERROR_SYSCALL && errno == 0 ? 0 : -1;
+      }
+    } else {
+      n = (int)recv(c->fd, buf, sizeof(buf), 0);
+      if (n == 0) return 0;
+      if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return -1;
+    }
+    if (n > 0) {
+      c->in.append(buf, (size_t)n);
+      return n;
+    }
+    int w = wait_fd(c->fd, want, deadline);
+    if (w == 0) return -2;
+    if (w < 0) return -1;
+  }
+}
+
+static bool write_all(esp_http_client_handle_t c, const char *data, size_t len) {
+  if (c->fd < 0) return false;
+  int64_t deadline = now_ms() + c->timeout_ms;
+  while (len > 0) {
+    int n;
+    short want = POLLOUT;
+    if (c->ssl) {
+      n = SSL_write(c->ssl, data, (int)len);
+      if (n <= 0) {
+        int e = SSL_get_error(c->ssl, n);
+        ERR_clear_error();
+        if (e == SSL_ERROR_WANT_READ) want = POLLIN;
+        else if (e != SSL_ERROR_WANT_WRITE) return false;
+      }
+    } else {
+      n = (int)send(c->fd, data, len, MSG_NOSIGNAL);
+      if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return false;
+    }
+    if (n > 0) {
+      data += n;
+      len -= (size_t)n;
+      continue;
+    }
+    if (wait_fd(c->fd, want, deadline) != 1) return false;
+  }
+  return true;
+}
+
+static const char *method_name(esp_http_client_method_t m) {
+  switch (m) {
+    case HTTP_METHOD_GET: return "GET";
+    case HTTP_METHOD_POST: return "POST";
+    case HTTP_METHOD_PUT: return "PUT";
+    case HTTP_METHOD_PATCH: return "PATCH";
+    case HTTP_METHOD_DELETE: return "DELETE";
+    case HTTP_METHOD_HEAD: return "HEAD";
+  }
+  return "GET";
+}
+
+esp_err_t esp_http_client_open(esp_http_client_handle_t c, int write_len) {
+  if (c->fd < 0) {
+    c->in.clear();
+    esp_err_t err = connect_to(c);
+    if (err != ESP_OK) return err;
+    dispatch(c, HTTP_EVENT_ON_CONNECTED);
+  }
+  c->head_request = c->method == HTTP_METHOD_HEAD;
+  c->headers_done = false;
+  c->status = 0;
+  c->content_length = -1;
+  c->chunked = false;
+  c->chunk_left = 0;
+  c->chunk_crlf = false;
+  c->last_chunk = false;
+  c->body_done = false;
+
+  std::string req = std::string(method_name(c->method)) + " " + c->path + " HTTP/1.1\r\n";
+  req += "Host: " + c->host + "\r\nUser-Agent: ESP32 HTTP Client/1.0\r\n";
+  for (const auto &h : c->headers) req += h.first + ": " + h.second + "\r\n";
+  if (write_len < 0) {
+    req += "Transfer-Encoding: chunked\r\n";
+  } else if (write_len > 0 || c->method == HTTP_METHOD_POST) {
+    req += "Content-Length: " + std::to_string(write_len) + "\r\n";
+  }
+  req += "\r\n";
+  return write_all(c, req.data(), req.size()) ? ESP_OK : ESP_FAIL;
+}
+
+int esp_http_client_write(esp_http_client_handle_t c, const char *buffer, int len) {
+  return write_all(c, buffer, (size_t)len) ? len : -1;
+}
+
+int64_t esp_http_client_fetch_headers(esp_http_client_handle_t c) {
+  size_t end;
+  while ((end = c->in.find("\r\n\r\n")) == std::string::npos) {
+    int r = fill(c);
+    if (r == -2) return -ESP_ERR_HTTP_EAGAIN;
+    if (r <= 0) return ESP_FAIL;
+  }
+  std::string head = c->in.substr(0, end);
+  c->in.erase(0, end + 4);
+  if (sscanf(head.c_str(), "HTTP/%*d.%*d %d", &c->status) != 1) return ESP_FAIL;
+  size_t at = head.find("\r\n");
+  while (at != std::string::npos) {
+    size_t next = head.find("\r\n", at + 2);
+    std::string line = head.substr(at + 2, next == std::string::npos ? std::string::npos : next - at - 2);
+    size_t colon = line.find(':');
+    if (colon != std::string::npos) {
+      std::string key = line.substr(0, colon);
+      const char *value = line.c_str() + colon + 1;
+      while (*value == ' ') value++;
+      if (strcasecmp(key.c_str(), "Content-Length") == 0) c->content_length = strtoll(value, nullptr, 10);
+      if (strcasecmp(key.c_str(), "Transfer-Encoding") == 0 && strcasecmp(value, "chunked") == 0) {
+        c->chunked = true;
+      }
+    }
+    at = next;
+  }
+  c->headers_done = true;
+  if (c->head_request) c->content_length = 0;
+  if (c->content_length == 0) c->body_done = true;
+  return c->chunked || c->content_length < 0 ? 0 : c->content_length;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t c) { return c->status; }
+
+int esp_http_client_read(esp_http_client_handle_t c, char *buffer, int len) {
+  if (!c->headers_done) {
+    int64_t r = esp_http_client_fetch_headers(c);
+    if (r < 0) return (int)r;
+  }
+  for (;;) {
+    if (c->body_done) return 0;
+    if (c->chunked) {
+      if (c->chunk_left > 0 && !c->in.empty()) {
+        size_t n = std::min({(size_t)len, (size_t)c->chunk_left, c->in.size()});
+        memcpy(buffer, c->in.data(), n);
+        c->in.erase(0, n);
+        c->chunk_left -= (int64_t)n;
+        c->chunk_crlf = c->chunk_left == 0;
+        return (int)n;
+      }
+      if (c->chunk_left == 0 && (c->chunk_crlf || c->last_chunk) && c->in.size() >= 2) {
+        c->in.erase(0, 2);
+        c->chunk_crlf = false;
+        if (c->last_chunk) c->body_done = true;
+        continue;
+      }
+      size_t eol;
+      if (c->chunk_left == 0 && !c->chunk_crlf && !c->last_chunk &&
+          (eol = c->in.find("\r\n")) != std::string::npos) {
+        c->chunk_left = strtoll(c->in.c_str(), nullptr, 16);
+        c->in.erase(0, eol + 2);
+        if (c->chunk_left == 0) c->last_chunk = true;
+        continue;
+      }
+    } else if (!c->in.empty()) {
+      size_t n = std::min((size_t)len, c->in.size());
+      if (c->content_length >= 0 && (int64_t)n > c->content_length) n = (size_t)c->content_length;
+      memcpy(buffer, c->in.data(), n);
+      c->in.erase(0, n);
+      if (c->content_length >= 0) {
+        c->content_length -= (int64_t)n;
+        if (c->content_length == 0) c->body_done = true;
+      }
+      return (int)n;
+    }
+    int r = fill(c);
+    if (r == -2) return -ESP_ERR_HTTP_EAGAIN;
+    if (r == 0 && !c->chunked && c->content_length < 0) {
+      c->body_done = true;  // a body delimited by the connection closing
+      continue;
+    }
+    if (r <= 0) return -1;
+  }
+}
+
+int esp_http_client_read_response(esp_http_client_handle_t c, char *buffer, int len) {
+  int total = 0;
+  while (total < len) {
+    int n = esp_http_client_read(c, buffer + total, len - total);
+    if (n <= 0) break;
+    total += n;
+  }
+  return total;
+}
+
+esp_err_t esp_http_client_flush_response(esp_http_client_handle_t c, int *len) {
+  char buf[512];
+  int total = 0;
+  int n;
+  while ((n = esp_http_client_read(c, buf, sizeof(buf))) > 0) total += n;
+  if (len) *len = total;
+  return n == 0 ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t c, const char *key, const char *value) {
+  for (auto &h : c->headers) {
+    if (strcasecmp(h.first.c_str(), key) == 0) {
+      h.second = value;
+      return ESP_OK;
+    }
+  }
+  c->headers.emplace_back(key, value);
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_method(esp_http_client_handle_t c, esp_http_client_method_t method) {
+  c->method = method;
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_timeout_ms(esp_http_client_handle_t c, int timeout_ms) {
+  c->timeout_ms = timeout_ms;
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_user_data(esp_http_client_handle_t c, void *data) {
+  c->user_data = data;
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t c) {
+  dispatch(c, HTTP_EVENT_DISCONNECTED);
+  drop_connection(c);
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t c) {
+  if (c == nullptr) return ESP_FAIL;
+  esp_http_client_close(c);
+  if (c->session) SSL_SESSION_free(c->session);
+  if (c->ctx) SSL_CTX_free(c->ctx);
+  delete c;
+  s_clients.fetch_sub(1);
+  return ESP_OK;
+}
+
+void fake_http_client_stats(fake_http_client_stats_t *out) {
+  out->handshakes = s_handshakes.load();
+  out->resumed = s_resumed.load();
+  out->clients = s_clients.load();
+  out->connections = s_connections.load();
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+// Host stand-in for ESP-IDF's esp_http_client.h over real sockets and OpenSSL: the streaming
+// calls ai_client uses (open/write/fetch_headers/read on a kept-alive connection), chunked
+// responses, connect/disconnect events and saved TLS sessions, so the client can be driven
+// against a local server (tools/openrouter_standin.py).
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_ERR_HTTP_BASE 0x7000
+#define ESP_ERR_HTTP_CONNECT (ESP_ERR_HTTP_BASE + 3)
+#define ESP_ERR_HTTP_EAGAIN (ESP_ERR_HTTP_BASE + 7)  // timed out before anything arrived
+
+typedef struct esp_http_client *esp_http_client_handle_t;
+
+typedef enum {
+  HTTP_EVENT_ERROR = 0,
+  HTTP_EVENT_ON_CONNECTED,
+  HTTP_EVENT_HEADERS_SENT,
+  HTTP_EVENT_ON_HEADER,
+  HTTP_EVENT_ON_DATA,
+  HTTP_EVENT_ON_FINISH,
+  HTTP_EVENT_DISCONNECTED,
+  HTTP_EVENT_REDIRECT,
+} esp_http_client_event_id_t;
+
+typedef struct esp_http_client_event {
+  esp_http_client_event_id_t event_id;
+  esp_http_client_handle_t client;
+  void *data;
+  int data_len;
+  void *user_data;
+  char *header_key;
+  char *header_value;
+} esp_http_client_event_t;
+
+typedef esp_err_t (*http_event_handle_cb)(esp_http_client_event_t *evt);
+
+typedef enum {
+  HTTP_METHOD_GET = 0,
+  HTTP_METHOD_POST,
+  HTTP_METHOD_PUT,
+  HTTP_METHOD_PATCH,
+  HTTP_METHOD_DELETE,
+  HTTP_METHOD_HEAD,
+} esp_http_client_method_t;
+
+typedef struct {
+  const char *url;                            // http:// or https://host[:port]/path
+  esp_http_client_method_t method;
+  int timeout_ms;                             // per socket wait
+  http_event_handle_cb event_handler;
+  void *user_data;
+  const char *cert_pem;                       // trust only this CA (or self-signed server)
+  esp_err_t (*crt_bundle_attach)(void *conf);  // the system CA store
+  bool save_client_session;                   // reconnects resume the TLS session
+} esp_http_client_config_t;
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config);
+// Connects unless the connection is still open, then sends the request line and headers;
+// write_len -1 announces a chunked body.
+esp_err_t esp_http_client_open(esp_http_client_handle_t client, int write_len);
+int esp_http_client_write(esp_http_client_handle_t client, const char *buffer, int len);
+// Response headers: the content length (0 when chunked), -ESP_ERR_HTTP_EAGAIN when they did
+// not arrive within the timeout (call again), ESP_FAIL on a closed or broken connection.
+int64_t esp_http_client_fetch_headers(esp_http_client_handle_t client);
+int esp_http_client_get_status_code(esp_http_client_handle_t client);
+// Body bytes, chunked framing removed: 0 at the end, -ESP_ERR_HTTP_EAGAIN on a timeout with
+// nothing read, -1 on a broken connection.
+int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len);
+int esp_http_client_read_response(esp_http_client_handle_t client, char *buffer, int len);
+esp_err_t esp_http_client_flush_response(esp_http_client_handle_t client, int *len);
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char *key,
+                                     const char *value);
+esp_err_t esp_http_client_set_method(esp_http_client_handle_t client,
+                                     esp_http_client_method_t method);
+esp_err_t esp_http_client_set_timeout_ms(esp_http_client_handle_t client, int timeout_ms);
+esp_err_t esp_http_client_set_user_data(esp_http_client_handle_t client, void *data);
+// Closes the connection (reporting HTTP_EVENT_DISCONNECTED); a saved session is kept.
+esp_err_t esp_http_client_close(esp_http_client_handle_t client);
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client);
+
+// ── Test hooks ──
+typedef struct {
+  uint32_t handshakes;   // TLS handshakes completed
+  uint32_t resumed;      // of which resumed a saved session
+  uint32_t clients;      // handles initialised and not yet cleaned up
+  uint32_t connections;  // connections open right now
+} fake_http_client_stats_t;
+
+void fake_http_client_stats(fake_http_client_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,9 @@
+#include "esp_system.h"
+
+#include <atomic>
+
+static std::atomic<uint32_t> s_free{200 * 1024};  // an idle rover with Wi-Fi up
+
+uint32_t esp_get_free_heap_size(void) { return s_free.load(); }
+
+void fake_heap_set_free(uint32_t bytes) { s_free.store(bytes); }
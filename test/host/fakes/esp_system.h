@@ -0,0 +1,18 @@
+#pragma once
+
+// Host stand-in for ESP-IDF's esp_system.h: a free-heap figure the test can set.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t esp_get_free_heap_size(void);
+
+// ── Test hooks ──
+void fake_heap_set_free(uint32_t bytes);
+
+#ifdef __cplusplus
+}
+#endif
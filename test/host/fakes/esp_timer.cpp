@@ -0,0 +1,25 @@
+#include "esp_timer.h"
+
+#include <atomic>
+#include <chrono>
+
+static std::atomic<int64_t> s_now_us{0};
+static std::atomic<bool> s_follow_clock{false};
+
+static int64_t clock_us(void) {
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+int64_t esp_timer_get_time(void) {
+  return s_follow_clock.load() ? clock_us() + s_now_us.load() : s_now_us.load();
+}
+
+void fake_timer_set_us(int64_t now_us) { s_now_us.store(now_us); }
+
+void fake_timer_advance_us(int64_t delta_us) { s_now_us.fetch_add(delta_us); }
+
+void fake_timer_follow_clock(void) {
+  s_now_us.store(0);
+  s_follow_clock.store(true);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+// Host stand-in for ESP-IDF's esp_timer.h: a clock the test sets and advances by hand, or
+// the real monotonic clock for tests that talk to a server.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int64_t esp_timer_get_time(void);
+
+// ── Test hooks ──
+void fake_timer_set_us(int64_t now_us);
+void fake_timer_advance_us(int64_t delta_us);
+// From now on time follows the monotonic clock (plus any later advances).
+void fake_timer_follow_clock(void);
+
+#ifdef __cplusplus
+}
+#endif
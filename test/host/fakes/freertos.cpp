@@ -0,0 +1,6 @@
+#include "freertos/task.h"
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+  static thread_local char s_task;
+  return &s_task;
+}
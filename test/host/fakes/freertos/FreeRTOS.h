@@ -0,0 +1,7 @@
+#pragma once
+
+// Host stand-in for the FreeRTOS headers: only what the pure modules use.
+
+#include <stdint.h>
+
+typedef void *TaskHandle_t;
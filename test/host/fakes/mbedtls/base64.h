@@ -0,0 +1,20 @@
+#pragma once
+
+// Host stand-in for mbedTLS's base64.h: the encoder, with mbedTLS's buffer rules.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL -0x002A
+
+// *olen gets the encoded length; with dst too small it gets the size needed (terminator
+// included) and nothing is written.
+int mbedtls_base64_encode(unsigned char *dst, size_t dlen, size_t *olen,
+                          const unsigned char *src, size_t slen);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,25 @@
+#include "mbedtls/base64.h"
+
+static const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+int mbedtls_base64_encode(unsigned char *dst, size_t dlen, size_t *olen,
+                          const unsigned char *src, size_t slen) {
+  size_t need = (slen + 2) / 3 * 4;
+  if (dlen < need + 1) {
+    *olen = need + 1;
+    return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+  }
+  unsigned char *p = dst;
+  for (size_t i = 0; i < slen; i += 3) {
+    unsigned v = (unsigned)src[i] << 16;
+    if (i + 1 < slen) v |= (unsigned)src[i + 1] << 8;
+    if (i + 2 < slen) v |= src[i + 2];
+    *p++ = kAlphabet[(v >> 18) & 63];
+    *p++ = kAlphabet[(v >> 12) & 63];
+    *p++ = i + 1 < slen ? kAlphabet[(v >> 6) & 63] : '=';
+    *p++ = i + 2 < slen ? kAlphabet[v & 63] : '=';
+  }
+  *p = '\0';
+  *olen = need;
+  return 0;
+}
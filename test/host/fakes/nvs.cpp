@@ -0,0 +1,81 @@
+#include "nvs.h"
+
+#include <map>
+#include <string>
+#include <string.h>
+#include <vector>
+
+// A namespace opened READONLY that was never written does not exist, as on the device.
+static std::map<std::string, std::map<std::string, std::vector<uint8_t>>> s_store;
+static std::vector<std::string> s_handles;  // handle - 1 -> namespace
+static esp_err_t s_open_err = ESP_OK;
+static int s_writes = 0;
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle) {
+  if (s_open_err != ESP_OK) return s_open_err;
+  if (open_mode == NVS_READONLY && s_store.find(name) == s_store.end()) return ESP_ERR_NVS_NOT_FOUND;
+  s_store[name];
+  s_handles.push_back(name);
+  *out_handle = (nvs_handle_t)s_handles.size();
+  return ESP_OK;
+}
+
+static std::map<std::string, std::vector<uint8_t>> *space(nvs_handle_t handle) {
+  if (handle == 0 || handle > s_handles.size() || s_handles[handle - 1].empty()) return NULL;
+  return &s_store[s_handles[handle - 1]];
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length) {
+  auto *ns = space(handle);
+  if (ns == NULL) return ESP_ERR_INVALID_ARG;
+  auto it = ns->find(key);
+  if (it == ns->end()) return ESP_ERR_NVS_NOT_FOUND;
+  if (out_value == NULL) {
+    *length = it->second.size();
+    return ESP_OK;
+  }
+  if (*length < it->second.size()) {
+    *length = it->second.size();
+    return ESP_ERR_NVS_INVALID_LENGTH;
+  }
+  memcpy(out_value, it->second.data(), it->second.size());
+  *length = it->second.size();
+  return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length) {
+  auto *ns = space(handle);
+  if (ns == NULL) return ESP_ERR_INVALID_ARG;
+  const uint8_t *bytes = (const uint8_t *)value;
+  (*ns)[key].assign(bytes, bytes + length);
+  s_writes++;
+  return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+  return space(handle) != NULL ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+void nvs_close(nvs_handle_t handle) {
+  if (handle != 0 && handle <= s_handles.size()) s_handles[handle - 1].clear();
+}
+
+void fake_nvs_reset(void) {
+  s_store.clear();
+  s_handles.clear();
+  s_open_err = ESP_OK;
+  s_writes = 0;
+}
+
+void fake_nvs_fail_open(esp_err_t err) { s_open_err = err; }
+
+int fake_nvs_writes(void) { return s_writes; }
+
+size_t fake_nvs_blob(const char *name, const char *key, uint8_t **data) {
+  auto ns = s_store.find(name);
+  if (ns == s_store.end()) return 0;
+  auto it = ns->second.find(key);
+  if (it == ns->second.end()) return 0;
+  if (data != NULL) *data = it->second.data();
+  return it->second.size();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+// Host stand-in for ESP-IDF's nvs.h: an in-memory key/value store with the blob calls the
+// firmware uses, plus hooks for tests to inspect it and make it fail.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum {
+  NVS_READONLY,
+  NVS_READWRITE,
+} nvs_open_mode_t;
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle);
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length);
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length);
+esp_err_t nvs_commit(nvs_handle_t handle);
+void nvs_close(nvs_handle_t handle);
+
+// ── Test hooks ──
+
+// Erases every namespace and clears the counters and injected failure.
+void fake_nvs_reset(void);
+// Every nvs_open() fails with err until set back to ESP_OK.
+void fake_nvs_fail_open(esp_err_t err);
+// nvs_set_blob() calls since the last reset.
+int fake_nvs_writes(void);
+// Stored size of namespace/key, or 0 if absent; data is the stored bytes (may be written).
+size_t fake_nvs_blob(const char *name, const char *key, uint8_t **data);
+
+#ifdef __cplusplus
+}
+#endif
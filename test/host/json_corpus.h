@@ -0,0 +1,26 @@
+#pragma once
+
+// Payloads the firmware really parses: UnitV replies and events, OpenRouter replies and
+// stream chunks, tool arguments. Shared by test_json_tok and bench_json_tok.
+
+static const char *const kCorpus[] = {
+  // UnitV
+  "{\"ok\":true,\"req_id\":\"17\",\"result\":{\"faces\":[{\"name\":\"alice\",\"score\":93,\"box\":[112,40,64,64]}]}}",
+  "{\"ok\":false,\"req_id\":\"17\",\"error\":\"unknown cmd\"}",
+  "{\"ok\":true,\"result\":{\"size\":18342,\"chunk\":1024}}",
+  "{\"ev\":\"world\",\"seq\":412,\"t\":183220,\"d\":[{\"k\":\"face\",\"n\":\"alice\",\"s\":93,\"b\":[112,40,64,64]},"
+  "{\"k\":\"obj\",\"n\":\"cup\",\"s\":81,\"b\":[20,150,40,52]}]}",
+  "{\"cmd\":\"RESEND\",\"req_id\":\"42\",\"args\":{\"req_id\":41,\"seqs\":[3,7,8]}}",
+  // OpenRouter completion and stream chunks
+  "{\"id\":\"gen-1\",\"choices\":[{\"index\":0,\"message\":{\"role\":\"assistant\",\"content\":"
+  "\"I see a cup \\u2014 \\\"red\\\", on the left.\\n\\ud83d\\ude00\"},\"finish_reason\":\"stop\"}],"
+  "\"usage\":{\"prompt_tokens\":812,\"completion_tokens\":17,\"total_tokens\":829}}",
+  "{\"id\":\"gen-2\",\"choices\":[{\"index\":0,\"delta\":{\"content\":\"Driving\"},\"finish_reason\":null}]}",
+  "{\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,\"id\":\"call_7\",\"type\":\"function\",\"function\":"
+  "{\"name\":\"move\",\"arguments\":\"{\\\"y\\\":60,\\\"duration_ms\\\":1500}\"}}]}}]}",
+  "{\"error\":{\"code\":429,\"message\":\"Rate limit exceeded\",\"metadata\":{\"retry_after\":1.5e1}}}",
+  // Tool arguments
+  "{\"x\":-40,\"y\":0,\"z\":12.75,\"duration_ms\":800,\"open\":false,\"target\":\"cup\"}",
+  "{\"mode\":\"reliable\",\"frames\":3,\"labels\":[\"cup\",\"person\"],\"note\":null}",
+  " [ 1 , -2.5e-3 , true , false , null , \"\" , { } , [ ] ] ",
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+// Runs tools/openrouter_standin.py for a test: a throwaway self-signed certificate for
+// localhost, the server on a free port, and its stdin/stdout as the command channel. Counters
+// come back as JSON and are read with json_tok. STANDIN_PYTHON and STANDIN_SCRIPT are set by
+// CMakeLists.txt.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+
+#include "json_tok.h"
+
+typedef struct {
+  pid_t pid;
+  FILE *cmd;
+  FILE *out;
+  char dir[64];
+  char url[96];
+  char *cert_pem;  // the certificate to trust (ai_client_config_t.cert_pem)
+  char reply[1024];
+} standin_t;
+
+static char *standin_path(const standin_t *s, const char *file) {
+  static char path[128];
+  snprintf(path, sizeof(path), "%s/%s", s->dir, file);
+  return path;
+}
+
+// EC P-256, valid for a day, for DNS:localhost and 127.0.0.1.
+static bool standin_make_cert(standin_t *s) {
+  EVP_PKEY *key = EVP_EC_gen("P-256");
+  X509 *cert = X509_new();
+  if (key == NULL || cert == NULL) return false;
+  X509_set_version(cert, 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+  X509_gmtime_adj(X509_getm_notBefore(cert), -60);
+  X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 3600);
+  X509_set_pubkey(cert, key);
+  X509_NAME *name = X509_get_subject_name(cert);
+  X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *)"localhost", -1, -1, 0);
+  X509_set_issuer_name(cert, name);
+  X509V3_CTX ctx;
+  X509V3_set_ctx_nodb(&ctx);
+  X509V3_set_ctx(&ctx, cert, cert, NULL, NULL, 0);
+  X509_EXTENSION *san = X509V3_EXT_conf_nid(NULL, &ctx, NID_subject_alt_name, "DNS:localhost,IP:127.0.0.1");
+  X509_add_ext(cert, san, -1);
+  X509_EXTENSION_free(san);
+  bool ok = X509_sign(cert, key, EVP_sha256()) > 0;
+
+  FILE *f = fopen(standin_path(s, "key.pem"), "w");
+  ok = ok && f && PEM_write_PrivateKey(f, key, NULL, NULL, 0, NULL, NULL);
+  if (f) fclose(f);
+  BIO *bio = BIO_new(BIO_s_mem());
+  ok = ok && PEM_write_bio_X509(bio, cert);
+  char *pem = NULL;
+  long len = BIO_get_mem_data(bio, &pem);
+  s->cert_pem = (char *)calloc(1, (size_t)len + 1);
+  memcpy(s->cert_pem, pem, (size_t)len);
+  BIO_free(bio);
+  f = fopen(standin_path(s, "cert.pem"), "w");
+  ok = ok && f && fputs(s->cert_pem, f) >= 0;
+  if (f) fclose(f);
+  X509_free(cert);
+  EVP_PKEY_free(key);
+  return ok;
+}
+
+// Sends one command and returns its one-line reply ("" if the server is gone).
+static const char *standin_command(standin_t *s, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static const char *standin_command(standin_t *s, const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vfprintf(s->cmd, fmt, args);
+  va_end(args);
+  fputc('\n', s->cmd);
+  fflush(s->cmd);
+  if (fgets(s->reply, sizeof(s->reply), s->out) == NULL) s->reply[0] = '\0';
+  s->reply[strcspn(s->reply, "\n")] = '\0';
+  return s->reply;
+}
+
+static bool standin_start(standin_t *s) {
+  memset(s, 0, sizeof(*s));
+  strlcpy(s->dir, "/tmp/standin.XXXXXX", sizeof(s->dir));
+  if (mkdtemp(s->dir) == NULL || !standin_make_cert(s)) return false;
+  int to_child[2], from_child[2];
+  if (pipe(to_child) != 0 || pipe(from_child) != 0) return false;
+  s->pid = fork();
+  if (s->pid == 0) {
+    dup2(to_child[0], 0);
+    dup2(from_child[1], 1);
+    close(to_child[1]);
+    close(from_child[0]);
+    char cert[128], key[128];
+    strlcpy(cert, standin_path(s, "cert.pem"), sizeof(cert));
+    strlcpy(key, standin_path(s, "key.pem"), sizeof(key));
+    execl(STANDIN_PYTHON, STANDIN_PYTHON, STANDIN_SCRIPT, "--cert", cert, "--key", key, "--host",
+          "127.0.0.1", "--port", "0", (char *)NULL);
+    _exit(127);
+  }
+  close(to_child[0]);
+  close(from_child[1]);
+  s->cmd = fdopen(to_child[1], "w");
+  s->out = fdopen(from_child[0], "r");
+  int port = 0;
+  if (s->pid < 0 || fgets(s->reply, sizeof(s->reply), s->out) == NULL ||
+      sscanf(s->reply, "listening %d", &port) != 1) {
+    fprintf(stderr, "standin: %s did not start\n", STANDIN_SCRIPT);
+    return false;
+  }
+  snprintf(s->url, sizeof(s->url), "https://localhost:%d/api/v1/chat/completions", port);
+  return true;
+}
+
+static void standin_stop(standin_t *s) {
+  if (s->cmd) {
+    fputs("quit\n", s->cmd);
+    fclose(s->cmd);
+  }
+  if (s->out) fclose(s->out);
+  if (s->pid > 0) waitpid(s->pid, NULL, 0);
+  unlink(standin_path(s, "cert.pem"));
+  unlink(standin_path(s, "key.pem"));
+  rmdir(s->dir);
+  free(s->cert_pem);
+}
+
+// A counter from "stats": top-level when model is NULL, else the model's entry in group
+// ("requests", "aborted", "last_ms"); 0 when absent.
+static long standin_stat(standin_t *s, const char *group, const char *model) {
+  standin_command(s, "stats");
+  json_tok_t toks[96];
+  json_doc_t doc;
+  if (json_tok_parse(&doc, s->reply, strlen(s->reply), toks, 96) < 0) return -1;
+  int i = json_tok_get(&doc, 0, group);
+  if (model) i = json_tok_get(&doc, i, model);
+  double v = 0;
+  return json_tok_number(&doc, i, &v) ? (long)v : 0;
+}
@@ -0,0 +1,134 @@
+// Chat connection reuse (ai_client) against the local OpenRouter stand-in over TLS: the HEAD
+// prewarm, keep-alive reuse across turns, ai_client_drop_idle and the session-ticket
+// resumption after it, and the one resend when a kept-alive connection turns out stale.
+// Counts come from ai_client_conn_stats, the fake client's handshakes and the server.
+
+#include "ai_client.h"
+#include "check.h"
+#include "esp_http_client.h"
+#include "esp_timer.h"
+#include "standin.h"
+
+static const char *kModel = "test/conn";
+
+static standin_t s_srv;
+static ai_chat_config_t s_chat;
+
+static esp_err_t chat(const char *expect) {
+  char response[128];
+  esp_err_t err = ai_chat_with_tools(&s_chat, NULL, "hi", response, sizeof(response));
+  CHECK_STR(response, expect);
+  return err;
+}
+
+static void check_conn(uint32_t connects, uint32_t reuses, uint32_t retries, bool open) {
+  ai_conn_stats_t st;
+  ai_client_conn_stats(&st);
+  CHECK_EQ(st.connects, connects);
+  CHECK_EQ(st.reuses, reuses);
+  CHECK_EQ(st.retries, retries);
+  CHECK_EQ(st.open, open);
+}
+
+static void test_prewarm_and_reuse(void) {
+  CHECK_EQ(ai_client_prewarm(&s_chat.client), ESP_OK);
+  check_conn(1, 0, 0, true);
+  CHECK_EQ(standin_stat(&s_srv, "heads", NULL), 1);
+
+  // Both turns ride the prewarmed connection.
+  CHECK_EQ(chat("hello there"), ESP_OK);
+  CHECK_EQ(chat("hello there"), ESP_OK);
+  check_conn(1, 2, 0, true);
+  CHECK_EQ(standin_stat(&s_srv, "connections", NULL), 1);
+  CHECK_EQ(standin_stat(&s_srv, "requests", kModel), 2);
+
+  // Already open: no second HEAD.
+  CHECK_EQ(ai_client_prewarm(&s_chat.client), ESP_OK);
+  ai_conn_stats_t st;
+  ai_client_conn_stats(&st);
+  CHECK_EQ(st.prewarms, 1);
+  CHECK_EQ(standin_stat(&s_srv, "heads", NULL), 1);
+}
+
+static void test_drop_idle_and_resume(void) {
+  CHECK(!ai_client_drop_idle(60000));  // used a moment ago
+  fake_timer_advance_us(61 * 1000 * 1000);
+  CHECK(ai_client_drop_idle(60000));
+  CHECK(!ai_client_drop_idle(0));  // nothing open any more
+  ai_conn_stats_t st;
+  ai_client_conn_stats(&st);
+  CHECK_EQ(st.idle_drops, 1);
+  check_conn(1, 2, 0, false);
+  fake_http_client_stats_t fs;
+  fake_http_client_stats(&fs);
+  CHECK_EQ(fs.connections, 0);
+  CHECK_EQ(fs.clients, 1);  // the handle stays pooled with its session
+
+  // The next turn reconnects with an abbreviated handshake.
+  CHECK_EQ(chat("hello there"), ESP_OK);
+  check_conn(2, 2, 0, true);
+  fake_http_client_stats(&fs);
+  CHECK_EQ(fs.handshakes, 2);
+  CHECK_EQ(fs.resumed, 1);
+  CHECK_EQ(standin_stat(&s_srv, "resumed", NULL), 1);
+}
+
+static void test_stale_resend(void) {
+  // The server quietly drops the kept-alive connection; the client still counts it open.
+  CHECK_STR(standin_command(&s_srv, "close_idle"), "ok 1");
+  check_conn(2, 2, 0, true);
+
+  // The request goes out on it, fails before any header, and is sent once more.
+  CHECK_EQ(chat("hello there"), ESP_OK);
+  check_conn(3, 3, 1, true);
+  fake_http_client_stats_t fs;
+  fake_http_client_stats(&fs);
+  CHECK_EQ(fs.resumed, 2);
+  CHECK_EQ(standin_stat(&s_srv, "requests", kModel), 4);  // the stale copy never arrived
+
+  // A server that is gone for good is not retried twice.
+  CHECK_STR(standin_command(&s_srv, "close_idle"), "ok 1");
+  CHECK_STR(standin_command(&s_srv, "set %s drop=1", kModel), "ok");
+  CHECK(chat("") != ESP_OK);
+  check_conn(4, 4, 2, false);
+  CHECK_STR(standin_command(&s_srv, "set %s drop=0", kModel), "ok");
+}
+
+static void test_prewarm_after_drop(void) {
+  fake_timer_advance_us(61 * 1000 * 1000);
+  ai_client_drop_idle(60000);
+  CHECK_EQ(ai_client_prewarm(&s_chat.client), ESP_OK);
+  ai_conn_stats_t st;
+  ai_client_conn_stats(&st);
+  CHECK_EQ(st.prewarms, 2);
+  CHECK(st.open);
+  CHECK_EQ(standin_stat(&s_srv, "heads", NULL), 2);
+  CHECK_EQ(chat("hello there"), ESP_OK);
+  ai_client_conn_stats(&st);
+  CHECK_EQ(st.reuses, 5);
+
+  fake_http_client_stats_t fs;
+  fake_http_client_stats(&fs);
+  CHECK_EQ(fs.clients, 1);
+  CHECK_EQ(fs.connections, 1);
+}
+
+int main(void) {
+  fake_timer_follow_clock();
+  if (!standin_start(&s_srv)) return 1;
+  standin_command(&s_srv, "set %s reply=hello there", kModel);
+  s_chat.client.api_key = "test-key";
+  s_chat.client.model = kModel;
+  s_chat.client.timeout_ms = 3000;
+  s_chat.client.max_tokens = 64;
+  s_chat.client.url = s_srv.url;
+  s_chat.client.cert_pem = s_srv.cert_pem;
+  s_chat.max_rounds = 1;
+
+  test_prewarm_and_reuse();
+  test_drop_idle_and_resume();
+  test_stale_resend();
+  test_prewarm_after_drop();
+  standin_stop(&s_srv);
+  return check_result("test_ai_client_conn");
+}
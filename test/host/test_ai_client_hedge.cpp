@@ -0,0 +1,160 @@
+// Model hedging (ai_client) against the local OpenRouter stand-in: a slow primary is hedged
+// to the fallback at its p95 (1.5 s floor), the first leg to stream wins, the loser's
+// connection is closed and its client freed, and the winning hedge client becomes the pooled
+// one. A failing primary is hedged at once; three failures open its breaker.
+
+#include <unistd.h>
+
+#include "ai_client.h"
+#include "check.h"
+#include "esp_http_client.h"
+#include "esp_timer.h"
+#include "standin.h"
+
+static const char *kPrimary = "test/primary";
+static const char *kFallback = "test/fallback";
+static const char *const kFallbacks[] = {kFallback, NULL};
+
+static standin_t s_srv;
+static ai_chat_config_t s_chat;
+
+static esp_err_t chat(const char *expect) {
+  char response[128];
+  esp_err_t err = ai_chat_with_tools(&s_chat, NULL, "hi", response, sizeof(response));
+  CHECK_STR(response, expect);
+  return err;
+}
+
+static ai_model_stats_t model_stats(const char *model) {
+  ai_model_stats_t all[AI_MODEL_TIERS_MAX] = {};
+  size_t n = ai_client_model_stats(all, AI_MODEL_TIERS_MAX);
+  for (size_t i = 0; i < n; ++i) {
+    if (strcmp(all[i].model, model) == 0) return all[i];
+  }
+  return ai_model_stats_t{};
+}
+
+// The server counts an aborted stream when it notices the hang-up, a moment after the client.
+static long aborted(const char *model, long expect) {
+  long n = 0;
+  for (int i = 0; i < 50 && (n = standin_stat(&s_srv, "aborted", model)) != expect; ++i) usleep(20 * 1000);
+  return n;
+}
+
+static void check_clients(uint32_t clients, uint32_t connections) {
+  fake_http_client_stats_t fs;
+  fake_http_client_stats(&fs);
+  CHECK_EQ(fs.clients, clients);
+  CHECK_EQ(fs.connections, connections);
+}
+
+static void test_warm_up(void) {
+  // Five quick answers give the primary a p95; its hedge delay drops to the 1.5 s floor.
+  for (int i = 0; i < 5; ++i) CHECK_EQ(chat("from primary"), ESP_OK);
+  ai_model_stats_t p = model_stats(kPrimary);
+  CHECK_EQ(p.requests, 5);
+  CHECK(p.p95_ms < 1500);
+  CHECK_EQ(p.hedges, 0);
+  CHECK_EQ(standin_stat(&s_srv, "requests", kFallback), 0);
+}
+
+static void test_slow_primary(void) {
+  standin_command(&s_srv, "set %s first_byte_ms=3000", kPrimary);
+  ai_conn_stats_t before;
+  ai_client_conn_stats(&before);
+  CHECK_EQ(chat("from fallback"), ESP_OK);
+
+  // The hedge went out at the p95 floor, not at once and not after the primary answered.
+  long gap = standin_stat(&s_srv, "last_ms", kFallback) - standin_stat(&s_srv, "last_ms", kPrimary);
+  CHECK(gap >= 1500 && gap < 1500 + 400);
+  CHECK_EQ(model_stats(kPrimary).hedges, 1);
+  CHECK_EQ(model_stats(kPrimary).failures, 0);  // slow is not failed
+  CHECK_EQ(model_stats(kFallback).hedge_wins, 1);
+  ai_chat_turn_stats_t turn;
+  ai_chat_last_turn(&turn);
+  CHECK_EQ(turn.rounds, 1);
+
+  // The primary's stream was abandoned mid-wait and its client freed: one handle is left,
+  // the hedge client, pooled with its connection open.
+  CHECK_EQ(aborted(kPrimary, 1), 1);
+  check_clients(1, 1);
+  ai_conn_stats_t st;
+  ai_client_conn_stats(&st);
+  CHECK(st.open);
+  CHECK_EQ(st.connects, before.connects + 1);
+
+  // The next turn rides the hedge connection.
+  standin_command(&s_srv, "set %s first_byte_ms=0", kPrimary);
+  CHECK_EQ(chat("from primary"), ESP_OK);
+  ai_client_conn_stats(&st);
+  CHECK_EQ(st.connects, before.connects + 1);
+  CHECK_EQ(st.reuses, before.reuses + 2);  // the slow primary's leg went out on one too
+
+  // Its connection events now feed the pool's state: only the connect event marks the pool
+  // open after a prewarm, which the hedge client would otherwise report to its freed leg.
+  fake_timer_advance_us(61 * 1000 * 1000);
+  CHECK(ai_client_drop_idle(60000));
+  ai_client_conn_stats(&st);
+  CHECK(!st.open);
+  CHECK_EQ(ai_client_prewarm(&s_chat.client), ESP_OK);
+  ai_client_conn_stats(&st);
+  CHECK(st.open);
+  CHECK_EQ(st.connects, before.connects + 2);
+  CHECK_EQ(chat("from primary"), ESP_OK);
+  ai_client_conn_stats(&st);
+  CHECK_EQ(st.connects, before.connects + 2);
+  check_clients(1, 1);
+}
+
+static void test_failing_primary(void) {
+  // An error status ends the primary leg at once, so the hedge does not wait for the p95.
+  standin_command(&s_srv, "set %s status=500", kPrimary);
+  CHECK_EQ(chat("from fallback"), ESP_OK);
+  long gap = standin_stat(&s_srv, "last_ms", kFallback) - standin_stat(&s_srv, "last_ms", kPrimary);
+  CHECK(gap >= 0 && gap < 500);
+  CHECK_EQ(model_stats(kPrimary).failures, 1);
+  CHECK_EQ(model_stats(kPrimary).hedges, 2);
+  CHECK_EQ(model_stats(kFallback).hedge_wins, 2);
+  check_clients(1, 1);
+
+  // Both tiers failing: the turn fails, the hedge client is freed, the pooled one closed.
+  standin_command(&s_srv, "set %s status=503", kFallback);
+  CHECK(chat("") != ESP_OK);
+  CHECK_EQ(model_stats(kPrimary).failures, 2);
+  CHECK_EQ(model_stats(kFallback).failures, 1);
+  check_clients(1, 0);
+  ai_conn_stats_t st;
+  ai_client_conn_stats(&st);
+  CHECK(!st.open);
+
+  // A third failure opens the primary's breaker; rounds then go straight to the fallback.
+  standin_command(&s_srv, "set %s status=200", kFallback);
+  CHECK_EQ(chat("from fallback"), ESP_OK);
+  CHECK(model_stats(kPrimary).breaker_open);
+  long primary_requests = standin_stat(&s_srv, "requests", kPrimary);
+  CHECK_EQ(chat("from fallback"), ESP_OK);
+  CHECK_EQ(standin_stat(&s_srv, "requests", kPrimary), primary_requests);
+  CHECK_EQ(model_stats(kFallback).hedge_wins, 3);  // only the hedged round counts
+  check_clients(1, 1);
+}
+
+int main(void) {
+  fake_timer_follow_clock();
+  if (!standin_start(&s_srv)) return 1;
+  standin_command(&s_srv, "set %s reply=from primary", kPrimary);
+  standin_command(&s_srv, "set %s reply=from fallback", kFallback);
+  s_chat.client.api_key = "test-key";
+  s_chat.client.model = kPrimary;
+  s_chat.client.fallback_models = kFallbacks;
+  s_chat.client.timeout_ms = 3000;
+  s_chat.client.max_tokens = 64;
+  s_chat.client.url = s_srv.url;
+  s_chat.client.cert_pem = s_srv.cert_pem;
+  s_chat.max_rounds = 1;
+
+  test_warm_up();
+  test_slow_primary();
+  test_failing_primary();
+  standin_stop(&s_srv);
+  return check_result("test_ai_client_hedge");
+}
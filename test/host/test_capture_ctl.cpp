@@ -0,0 +1,115 @@
+// CAPTURE planning (capture_ctl): plans stay inside each consumer's budget, a run of failures
+// or slow transfers never talks the link estimate below the 115200 fallback rate, and good
+// transfers pull it back up. The module keeps its estimates in statics, so the steps build
+// on each other.
+
+#include "capture_ctl.h"
+#include "check.h"
+
+// The budgets of capture_ctl.cpp: latency, bytes, quality range, QQVGA allowed.
+static const uint32_t kBudgetMs[CAPTURE_CONSUMER_COUNT] = {1200, 4000};
+static const uint32_t kBudgetBytes[CAPTURE_CONSUMER_COUNT] = {16384, 30720};
+static const int kQualityMin[CAPTURE_CONSUMER_COUNT] = {30, 50};
+static const int kQualityMax[CAPTURE_CONSUMER_COUNT] = {80, 90};
+
+static const int kBauds[] = {115200, 460800, 921600};
+static const float kFloorBps = 115200 / 10 * 0.9f;  // 8N1 at the fallback rate
+
+static void check_plan(capture_consumer_t consumer, const capture_plan_t &p) {
+  CHECK(p.quality >= kQualityMin[consumer] && p.quality <= kQualityMax[consumer]);
+  if (consumer == CAPTURE_CONSUMER_LLM) CHECK(p.res == CAPTURE_RES_QVGA);
+  if (p.within_budget) {
+    CHECK(p.predicted_ms <= kBudgetMs[consumer]);
+    CHECK(p.predicted_bytes <= kBudgetBytes[consumer]);
+  }
+}
+
+// Slowest prediction the floor allows; the overhead is 150 ms until test_recovery.
+static uint32_t max_ms_at_floor(const capture_plan_t &p) {
+  return (uint32_t)(150.0f + (float)p.predicted_bytes * 1000.0f / kFloorBps) + 1;
+}
+
+static void test_cold(void) {
+  // 115200: preview gets QVGA q60 (q70 would take ~1.35 s), the LLM the top quality.
+  capture_plan_t p = capture_ctl_plan(CAPTURE_CONSUMER_PREVIEW, 115200);
+  CHECK(p.within_budget);
+  CHECK_EQ(p.quality, 60);
+  CHECK(p.res == CAPTURE_RES_QVGA);
+  check_plan(CAPTURE_CONSUMER_PREVIEW, p);
+  p = capture_ctl_plan(CAPTURE_CONSUMER_LLM, 115200);
+  CHECK(p.within_budget);
+  CHECK_EQ(p.quality, 90);
+  check_plan(CAPTURE_CONSUMER_LLM, p);
+  // A faster link lets the preview go up to its cap.
+  p = capture_ctl_plan(CAPTURE_CONSUMER_PREVIEW, 921600);
+  CHECK(p.within_budget);
+  CHECK_EQ(p.quality, 80);
+  CHECK_EQ(capture_ctl_plan((capture_consumer_t)7, 921600).quality, 80);  // unknown: preview
+}
+
+static void test_failures_floor(void) {
+  for (int baud : kBauds) {
+    for (int i = 0; i < 60; ++i) {
+      capture_ctl_observe_failure(CAPTURE_RES_QVGA, 90, baud);
+      capture_ctl_observe_failure(CAPTURE_RES_QQVGA, 50, baud);
+      for (int c = 0; c < CAPTURE_CONSUMER_COUNT; ++c) {
+        capture_plan_t p = capture_ctl_plan((capture_consumer_t)c, baud);
+        check_plan((capture_consumer_t)c, p);
+        CHECK(p.predicted_ms <= max_ms_at_floor(p));
+      }
+    }
+  }
+  // Scenes assumed 4x as large: the preview drops to QQVGA but still fits its budget; the
+  // LLM keeps QVGA at its lowest quality, best effort at the floor rate.
+  capture_plan_t p = capture_ctl_plan(CAPTURE_CONSUMER_PREVIEW, 115200);
+  CHECK(p.within_budget);
+  CHECK(p.res == CAPTURE_RES_QQVGA);
+  CHECK_EQ(p.quality, 50);
+  p = capture_ctl_plan(CAPTURE_CONSUMER_LLM, 115200);
+  CHECK(!p.within_budget);
+  CHECK_EQ(p.quality, 50);
+  CHECK_EQ(p.predicted_bytes, 36000);
+  CHECK_EQ(p.predicted_ms, max_ms_at_floor(p) - 1);
+  // A link slower than the fallback rate is floored at its own nominal rate.
+  capture_ctl_observe_failure(CAPTURE_RES_QVGA, 50, 57600);
+  p = capture_ctl_plan(CAPTURE_CONSUMER_LLM, 57600);
+  CHECK_EQ(p.predicted_ms, (uint32_t)(150.0f + 36000.0f * 1000.0f / (57600 / 10 * 0.9f)));
+}
+
+static void test_slow_success_floor(void) {
+  // Transfers that crawled (10 s for 2 KB) are learned, but only down to the floor.
+  for (int i = 0; i < 40; ++i) {
+    capture_ctl_observe(CAPTURE_RES_QVGA, 50, 460800, 2000, 10150, 10000);
+  }
+  capture_plan_t p = capture_ctl_plan(CAPTURE_CONSUMER_LLM, 460800);
+  CHECK(p.predicted_ms <= max_ms_at_floor(p));
+  CHECK(p.predicted_ms + 1 >= max_ms_at_floor(p));  // and sits right on it
+  check_plan(CAPTURE_CONSUMER_LLM, p);
+}
+
+static void test_recovery(void) {
+  // Good captures at 921600: sizes as the prior, about 90 KB/s, 120 ms overhead.
+  for (int i = 0; i < 60; ++i) {
+    capture_ctl_observe(CAPTURE_RES_QVGA, 90, 921600, 24000, 380, 260);
+    capture_ctl_observe(CAPTURE_RES_QQVGA, 50, 921600, 2600, 150, 30);
+  }
+  for (int c = 0; c < CAPTURE_CONSUMER_COUNT; ++c) {
+    capture_plan_t p = capture_ctl_plan((capture_consumer_t)c, 921600);
+    CHECK(p.within_budget);
+    CHECK_EQ(p.quality, kQualityMax[c]);
+    CHECK(p.res == CAPTURE_RES_QVGA);
+    check_plan((capture_consumer_t)c, p);
+  }
+  // Estimates learned at one rate are dropped when the link changes rate.
+  capture_plan_t p = capture_ctl_plan(CAPTURE_CONSUMER_PREVIEW, 115200);
+  CHECK(p.within_budget);
+  CHECK_EQ(p.quality, 60);
+}
+
+int main(void) {
+  test_cold();
+  test_failures_floor();
+  test_slow_success_floor();
+  test_recovery();
+  return check_result("test_capture_ctl");
+}
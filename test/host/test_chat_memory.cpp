@@ -0,0 +1,179 @@
+// Conversation memory (chat_memory): packed exchanges and their eviction by count and by
+// bytes, UTF-8-safe cuts at the prompt and reply limits, and the summarisation input that
+// folds only as many old exchanges as fit.
+
+#include <string>
+
+#include "check.h"
+#include "chat_memory.h"
+
+static chat_memory_t s_mem;
+
+static std::string repeat(const char *s, size_t n) {
+  std::string out;
+  for (size_t i = 0; i < n; ++i) out += s;
+  return out;
+}
+
+static void test_add_and_turns(void) {
+  chat_memory_clear(&s_mem);
+  CHECK(chat_memory_empty(&s_mem));
+  CHECK_EQ(chat_memory_tokens(&s_mem), 0);
+  chat_memory_add(&s_mem, "drive forward", "Driving forward.", 100);
+  chat_memory_add(&s_mem, "", "", 200);  // empty texts still make an exchange
+  chat_memory_add(&s_mem, "again", "Driving again.", 300);
+  CHECK(!chat_memory_empty(&s_mem));
+  CHECK_EQ(s_mem.count, 3);
+  CHECK_EQ(s_mem.used, 14 + 17 + 2 + 6 + 15);
+  CHECK_EQ(s_mem.last_ms, 300);
+  CHECK_EQ(chat_memory_tokens(&s_mem), (54 + 3) / 4);
+
+  chat_memory_turn_t turns[CHAT_MEMORY_TURNS_MAX];
+  CHECK_EQ(chat_memory_turns(&s_mem, turns, CHAT_MEMORY_TURNS_MAX), 3);
+  CHECK_STR(turns[0].user, "drive forward");
+  CHECK_STR(turns[0].reply, "Driving forward.");
+  CHECK_STR(turns[1].user, "");
+  CHECK_STR(turns[1].reply, "");
+  CHECK_STR(turns[2].user, "again");
+  CHECK_STR(turns[2].reply, "Driving again.");
+  CHECK_EQ(chat_memory_turns(&s_mem, turns, 2), 2);  // max respected
+  CHECK_EQ(s_mem.dropped, 0);
+}
+
+static void test_utf8_cut(void) {
+  chat_memory_clear(&s_mem);
+  // 96 two-byte letters fill CHAT_MEMORY_USER_MAX exactly; one more is cut whole.
+  std::string fits = repeat("\xd0\xb6", CHAT_MEMORY_USER_MAX / 2);
+  chat_memory_add(&s_mem, fits.c_str(), "ok", 0);
+  std::string over = fits + "\xd0\xb6";
+  chat_memory_add(&s_mem, over.c_str(), "ok", 0);
+  // 'a' + 96 letters: byte 192 falls inside a letter, so the cut stops at 191.
+  std::string odd = "a" + repeat("\xd0\xb6", CHAT_MEMORY_USER_MAX / 2);
+  chat_memory_add(&s_mem, odd.c_str(), "ok", 0);
+  // Reply: three-byte characters, 256 is not a multiple of 3.
+  std::string dash = repeat("\xe2\x80\x94", 100);
+  chat_memory_add(&s_mem, "?", dash.c_str(), 0);
+
+  chat_memory_turn_t turns[CHAT_MEMORY_TURNS_MAX];
+  CHECK_EQ(chat_memory_turns(&s_mem, turns, CHAT_MEMORY_TURNS_MAX), 4);
+  CHECK_EQ(strlen(turns[0].user), CHAT_MEMORY_USER_MAX);
+  CHECK(turns[1].user == fits);
+  CHECK_EQ(strlen(turns[2].user), CHAT_MEMORY_USER_MAX - 1);
+  CHECK(turns[2].user == odd.substr(0, CHAT_MEMORY_USER_MAX - 1));
+  CHECK_EQ(strlen(turns[3].reply), 255);
+  CHECK(turns[3].reply == dash.substr(0, 255));
+
+  // A summary longer than the slot is cut the same way.
+  std::string summary = repeat("\xd0\xb6", CHAT_MEMORY_SUMMARY_MAX);  // 319 splits a letter
+  chat_memory_compact(&s_mem, summary.c_str(), 0);
+  CHECK_EQ(strlen(s_mem.summary), CHAT_MEMORY_SUMMARY_MAX - 2);
+  CHECK(summary.compare(0, CHAT_MEMORY_SUMMARY_MAX - 2, s_mem.summary) == 0);
+  CHECK_EQ(s_mem.count, 4);
+}
+
+static void test_eviction(void) {
+  // By count: the ninth exchange pushes out the first.
+  chat_memory_clear(&s_mem);
+  char user[16], reply[16];
+  for (int i = 0; i < CHAT_MEMORY_TURNS_MAX + 3; ++i) {
+    snprintf(user, sizeof(user), "u%d", i);
+    snprintf(reply, sizeof(reply), "r%d", i);
+    chat_memory_add(&s_mem, user, reply, (uint32_t)i);
+  }
+  chat_memory_turn_t turns[CHAT_MEMORY_TURNS_MAX];
+  CHECK_EQ(s_mem.count, CHAT_MEMORY_TURNS_MAX);
+  CHECK_EQ(s_mem.dropped, 3);
+  CHECK_EQ(chat_memory_turns(&s_mem, turns, CHAT_MEMORY_TURNS_MAX), CHAT_MEMORY_TURNS_MAX);
+  CHECK_STR(turns[0].user, "u3");
+  CHECK_STR(turns[CHAT_MEMORY_TURNS_MAX - 1].reply, "r10");
+  CHECK_EQ(s_mem.used, 7 * 6 + 8);  // "u3\0r3\0" .. "u10\0r10\0"
+
+  // By bytes: full-size exchanges (193 + 257 bytes) fit twice in CHAT_MEMORY_BYTES.
+  chat_memory_clear(&s_mem);
+  std::string big_user = repeat("u", 300);
+  std::string big_reply = repeat("r", 400);
+  for (int i = 0; i < 5; ++i) {
+    big_user[0] = (char)('A' + i);
+    chat_memory_add(&s_mem, big_user.c_str(), big_reply.c_str(), 0);
+    CHECK(s_mem.used <= CHAT_MEMORY_BYTES);
+  }
+  CHECK_EQ(s_mem.count, 2);
+  CHECK_EQ(s_mem.used, 2 * (CHAT_MEMORY_USER_MAX + 1 + CHAT_MEMORY_REPLY_MAX + 1));
+  CHECK_EQ(s_mem.dropped, 3);
+  CHECK_EQ(chat_memory_turns(&s_mem, turns, CHAT_MEMORY_TURNS_MAX), 2);
+  CHECK_EQ(turns[0].user[0], 'D');
+  CHECK_EQ(turns[1].user[0], 'E');
+  // A small one still fits beside them; the next big one evicts just the oldest.
+  chat_memory_add(&s_mem, "hi", "hello", 0);
+  CHECK_EQ(s_mem.count, 3);
+  chat_memory_add(&s_mem, big_user.c_str(), big_reply.c_str(), 0);
+  CHECK_EQ(chat_memory_turns(&s_mem, turns, CHAT_MEMORY_TURNS_MAX), 3);
+  CHECK_EQ(turns[0].user[0], 'E');
+  CHECK_STR(turns[1].user, "hi");
+  CHECK_EQ(s_mem.dropped, 4);
+}
+
+static void test_compaction(void) {
+  chat_memory_clear(&s_mem);
+  char out[1024];
+  chat_memory_add(&s_mem, "a", "b", 0);
+  chat_memory_add(&s_mem, "c", "d", 0);
+  CHECK_EQ(chat_memory_compaction_input(&s_mem, out, sizeof(out)), 0);  // below COMPACT_AT
+
+  // Four exchanges of 144 bytes: worth it; all but the newest are folded.
+  chat_memory_clear(&s_mem);
+  std::string reply = repeat("y", 140);
+  char user[8];
+  for (int i = 0; i < 4; ++i) {
+    snprintf(user, sizeof(user), "q%d", i);
+    chat_memory_add(&s_mem, user, reply.c_str(), 0);
+  }
+  CHECK(s_mem.used >= CHAT_MEMORY_COMPACT_AT);
+  CHECK_EQ(chat_memory_compaction_input(&s_mem, out, sizeof(out)), 3);
+  std::string in = out;
+  CHECK(in.rfind("Summary so far: (none)\nUser: q0\nRover: y", 0) == 0);
+  CHECK(in.find("User: q2\n") != std::string::npos);
+  CHECK(in.find("q3") == std::string::npos);
+  CHECK(in.back() == '\n');
+
+  // Too small for every old exchange: only whole ones are written.
+  size_t header = strlen("Summary so far: (none)\n");
+  size_t one = strlen("User: q0\nRover: \n") + reply.size();
+  CHECK_EQ(chat_memory_compaction_input(&s_mem, out, header + 2 * one + 1), 2);
+  CHECK_EQ(strlen(out), header + 2 * one);
+  CHECK_EQ(chat_memory_compaction_input(&s_mem, out, header + 2 * one), 1);
+  CHECK_EQ(strlen(out), header + one);
+  CHECK_EQ(chat_memory_compaction_input(&s_mem, out, header + 1), 0);
+  CHECK_EQ(chat_memory_compaction_input(&s_mem, out, header), 0);  // header does not fit
+  CHECK_EQ(chat_memory_compaction_input(&s_mem, out, 0), 0);
+
+  // Folding two: the summary replaces them, the rest move up.
+  chat_memory_compact(&s_mem, "user asked twice", 2);
+  CHECK_EQ(s_mem.count, 2);
+  chat_memory_turn_t turns[CHAT_MEMORY_TURNS_MAX];
+  CHECK_EQ(chat_memory_turns(&s_mem, turns, CHAT_MEMORY_TURNS_MAX), 2);
+  CHECK_STR(turns[0].user, "q2");
+  CHECK_STR(turns[1].user, "q3");
+  CHECK_STR(s_mem.summary, "user asked twice");
+  CHECK_EQ(chat_memory_tokens(&s_mem), (16 + 2 * 144 + 3) / 4);
+
+  // The next input starts from the summary.
+  for (int i = 4; i < 6; ++i) {
+    snprintf(user, sizeof(user), "q%d", i);
+    chat_memory_add(&s_mem, user, reply.c_str(), 0);
+  }
+  CHECK_EQ(chat_memory_compaction_input(&s_mem, out, sizeof(out)), 3);
+  CHECK(std::string(out).rfind("Summary so far: user asked twice\nUser: q2\n", 0) == 0);
+  chat_memory_compact(&s_mem, "", 10);  // more than there are: all go
+  CHECK_EQ(s_mem.count, 0);
+  CHECK_EQ(s_mem.used, 0);
+  CHECK(chat_memory_empty(&s_mem));
+}
+
+int main(void) {
+  test_add_and_turns();
+  test_utf8_cut();
+  test_eviction();
+  test_compaction();
+  return check_result("test_chat_memory");
+}
@@ -0,0 +1,79 @@
+// Connection pool slot (conn_pool): take/put/idle rules, then the chat worker and the idle
+// reaper racing on two threads, which must never hold the connection at the same time.
+
+#include <atomic>
+#include <thread>
+
+#include "check.h"
+#include "conn_pool.h"
+
+static int s_conn;  // stands in for an esp_http_client handle
+
+static void test_slot(void) {
+  CHECK(conn_pool_take() == NULL);
+  CHECK(!conn_pool_put(NULL, 0));
+  CHECK(conn_pool_put(&s_conn, 1000));
+  int other;
+  CHECK(!conn_pool_put(&other, 1000));  // occupied: the caller frees its handle
+  CHECK(conn_pool_take() == &s_conn);
+  CHECK(conn_pool_take() == NULL);
+
+  // Idle reaping: only after min_idle_us, and never while a turn holds the handle.
+  CHECK(conn_pool_put(&s_conn, 1000));
+  CHECK(conn_pool_take_idle(1999, 1000) == NULL);
+  CHECK(conn_pool_take_idle(2000, 1000) == &s_conn);
+  CHECK(conn_pool_take_idle(9000, 1000) == NULL);
+  CHECK(conn_pool_put(&s_conn, 2000));
+  CHECK(conn_pool_take() == &s_conn);
+  CHECK(conn_pool_take_idle(9000, 1000) == NULL);
+  CHECK(conn_pool_put(&s_conn, 9000));
+  CHECK(conn_pool_take_idle(9500, 1000) == NULL);  // put back restarts the idle time
+  CHECK(conn_pool_take() == &s_conn);
+}
+
+static void test_race(void) {
+  static const int kTurns = 100000;
+  std::atomic<int> holders{0};
+  std::atomic<int> overlaps{0};
+  std::atomic<int> lost{0};
+  std::atomic<bool> done{false};
+  std::atomic<int64_t> clock{0};
+  CHECK(conn_pool_put(&s_conn, 0));
+
+  auto hold = [&](void *h) {
+    if (h != &s_conn) {
+      lost++;
+      return;
+    }
+    if (holders.fetch_add(1) != 0) overlaps++;
+    holders.fetch_sub(1);
+    if (!conn_pool_put(h, clock.fetch_add(1))) lost++;
+  };
+  std::thread reaper([&] {
+    while (!done.load()) {
+      void *h = conn_pool_take_idle(clock.load(), 0);
+      if (h) hold(h);
+      std::this_thread::yield();  // the real reaper runs once a second
+    }
+  });
+  int turns = 0;
+  while (turns < kTurns) {
+    void *h = conn_pool_take();
+    if (h == NULL) continue;  // the reaper has it; a real turn would open a new client
+    turns++;
+    hold(h);
+  }
+  done.store(true);
+  reaper.join();
+
+  CHECK_EQ(overlaps.load(), 0);
+  CHECK_EQ(lost.load(), 0);
+  CHECK(conn_pool_take() == &s_conn);  // still pooled, exactly once
+  CHECK(conn_pool_take() == NULL);
+}
+
+int main(void) {
+  test_slot();
+  test_race();
+  return check_result("test_conn_pool");
+}
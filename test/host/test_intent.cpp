@@ -0,0 +1,138 @@
+// Local command matcher (intent): a corpus of EN/RU prompts it must answer itself, and of
+// prompts it must leave to the model, with the numbers at and past the edges of their ranges;
+// then the topic picked for the prompts it leaves.
+
+#include "check.h"
+#include "intent.h"
+
+static void expect_plan(const char *prompt, const char *summary) {
+  intent_plan_t plan;
+  char got[128] = "";
+  if (!intent_parse(prompt, &plan)) {
+    fprintf(stderr, "no match: \"%s\"\n", prompt);
+    s_check_failures++;
+    return;
+  }
+  CHECK(intent_describe(&plan, got, sizeof(got)) >= 0);
+  if (strcmp(got, summary) != 0) {
+    fprintf(stderr, "\"%s\": \"%s\" != \"%s\"\n", prompt, got, summary);
+    s_check_failures++;
+  }
+}
+
+static void expect_no_match(const char *prompt) {
+  intent_plan_t plan;
+  if (intent_parse(prompt, &plan)) {
+    char got[128] = "";
+    intent_describe(&plan, got, sizeof(got));
+    fprintf(stderr, "unexpected match: \"%s\" -> \"%s\"\n", prompt, got);
+    s_check_failures++;
+  }
+}
+
+static void test_matches(void) {
+  expect_plan("forward 2 seconds", "forward 2.0s");
+  expect_plan("Go forward for 1.5 s, then turn left 90", "forward 1.5s; turn left 90deg");
+  expect_plan("drive back 500 ms", "back 0.5s");
+  expect_plan("move left", "left 1.0s");
+  expect_plan("turn right 45°", "turn right 45deg");
+  expect_plan("turn around", "turn left 180deg");
+  expect_plan("stop", "stop");
+  expect_plan("open the gripper and close the gripper", "open gripper; close gripper");
+  expect_plan("едь вперед 3 секунды", "forward 3.0s");
+  expect_plan("Поверни направо на 30 градусов, потом стоп", "turn right 30deg; stop");
+  expect_plan("открой захват", "open gripper");
+  expect_plan("назад две секунды", "back 2.0s");
+
+  // The edges of the ranges are still commands.
+  expect_plan("forward 0.1 seconds", "forward 0.1s");
+  expect_plan("forward 5 seconds", "forward 5.0s");
+  expect_plan("forward 5000 ms", "forward 5.0s");
+  expect_plan("turn left 5 degrees", "turn left 5deg");
+  expect_plan("turn left 360 degrees", "turn left 360deg");
+
+  intent_plan_t plan;
+  CHECK(intent_parse("вперед 1 секунду", &plan));
+  CHECK(plan.russian);
+  CHECK_EQ(plan.steps[0].y, 60);
+  CHECK(intent_parse("slowly back", &plan));
+  CHECK_EQ(plan.steps[0].y, -35);
+}
+
+static void test_no_matches(void) {
+  // Words the matcher does not know, or commands it cannot express.
+  expect_no_match("");
+  expect_no_match("hello");
+  expect_no_match("go to the cup");
+  expect_no_match("turn");
+  expect_no_match("forward and stop now forward forward forward");
+  expect_no_match("forward back");
+  expect_no_match("forward 2 seconds 3 seconds");
+  expect_no_match("forward 90 degrees");
+
+  // Out-of-range, negative and unreadable numbers: never clamped into a command.
+  expect_no_match("forward 99999999999999999999 seconds");
+  expect_no_match("forward 1" "00000000000000000000000000000000000000000000 seconds");
+  expect_no_match("forward 100 seconds");
+  expect_no_match("forward 6 seconds");
+  expect_no_match("forward 0 seconds");
+  expect_no_match("forward 0.05 seconds");
+  expect_no_match("forward 99 ms");
+  expect_no_match("forward -2 seconds");
+  expect_no_match("forward, -2 seconds");
+  expect_no_match("вперед -2 секунды");
+  expect_no_match("turn left 1000 degrees");
+  expect_no_match("turn left 1000°");
+  expect_no_match("turn left 361");
+  expect_no_match("turn left 4 degrees");
+  expect_no_match("turn left -90");
+  expect_no_match("turn left 0 degrees");
+  expect_no_match("поверни налево на 720 градусов");
+}
+
+static void test_normalize(void) {
+  char out[64];
+  CHECK(intent_normalize("Go-forward, 2s!", out, sizeof(out)));
+  CHECK_STR(out, "go forward then 2 s");
+  CHECK(intent_normalize("back -1.5sec", out, sizeof(out)));
+  CHECK_STR(out, "back -1.5 sec");
+  CHECK(intent_normalize("ЕЩЁ раз", out, sizeof(out)));
+  CHECK_STR(out, "еще раз");
+  CHECK(!intent_normalize("this prompt is far too long for the output buffer given here", out, 16));
+}
+
+static void expect_topic(const char *prompt, intent_topic_t topic) {
+  intent_topic_t got = intent_topic(prompt);
+  if (got != topic) {
+    fprintf(stderr, "topic \"%s\": %s != %s\n", prompt, intent_topic_name(got), intent_topic_name(topic));
+    s_check_failures++;
+  }
+}
+
+static void test_topic(void) {
+  expect_topic("drive forward a little bit, then spin", INTENT_TOPIC_MOTION);
+  expect_topic("dance for me", INTENT_TOPIC_MOTION);
+  expect_topic("spin around twice", INTENT_TOPIC_MOTION);
+  expect_topic("поедем немного вперед", INTENT_TOPIC_MOTION);
+  expect_topic("what do you see", INTENT_TOPIC_VISION);
+  expect_topic("найди красный предмет", INTENT_TOPIC_VISION);
+  expect_topic("hello there", INTENT_TOPIC_CHAT);
+  expect_topic("как дела", INTENT_TOPIC_CHAT);
+
+  // Motion towards or onto something named needs the camera as well.
+  expect_topic("go to the cup", INTENT_TOPIC_ANY);
+  expect_topic("grab the cup", INTENT_TOPIC_ANY);
+  expect_topic("move closer to the box", INTENT_TOPIC_ANY);
+  expect_topic("drive forward until the wall", INTENT_TOPIC_ANY);
+  expect_topic("едь к двери", INTENT_TOPIC_ANY);
+  expect_topic("схвати мяч", INTENT_TOPIC_ANY);
+  expect_topic("turn left and look for a face", INTENT_TOPIC_ANY);
+}
+
+int main(void) {
+  test_matches();
+  test_no_matches();
+  test_normalize();
+  test_topic();
+  return check_result("test_intent");
+}
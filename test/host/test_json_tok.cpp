@@ -0,0 +1,210 @@
+// JSON tokenizer (json_tok): the payloads the firmware really parses (json_corpus.h), every
+// prefix of each, every token budget, and random mutations of them. Whatever the input, the
+// result is one of the documented codes and the tokens it leaves stay inside the text and
+// properly nested, so every accessor can walk them. Built with ASan/UBSan when available.
+
+#include <stdlib.h>
+#include <string>
+
+#include "check.h"
+#include "json_corpus.h"
+#include "json_tok.h"
+
+static const int kMaxToks = 128;
+
+static bool valid_result(int r) {
+  return r >= 0 || r == JSON_TOK_ERR_NOMEM || r == JSON_TOK_ERR_INVAL || r == JSON_TOK_ERR_PART;
+}
+
+// Structural invariants of whatever tokens a parse left in doc, and a walk through every
+// accessor on every token.
+static void check_doc(const json_doc_t *doc, size_t len, bool complete) {
+  const json_tok_t *t = doc->toks;
+  for (int i = 0; i < doc->count; ++i) {
+    CHECK(t[i].type >= JSON_TOK_OBJECT && t[i].type <= JSON_TOK_PRIMITIVE);
+    CHECK(t[i].start <= t[i].end && t[i].end <= len);
+    if (i > 0) CHECK(t[i].start > t[i - 1].start);
+    if (t[i].type == JSON_TOK_STRING) CHECK(t[i].start > 0 && doc->js[t[i].start - 1] == '"');
+    if (t[i].type == JSON_TOK_OBJECT) CHECK(doc->js[t[i].start] == '{');
+    if (t[i].type == JSON_TOK_ARRAY) CHECK(doc->js[t[i].start] == '[');
+
+    int next = json_tok_next(doc, i);
+    CHECK(next > i && next <= doc->count);
+    for (int j = i + 1; j < next; ++j) CHECK(t[j].end <= t[i].end);  // nested inside
+    if (complete && (t[i].type == JSON_TOK_OBJECT || t[i].type == JSON_TOK_ARRAY)) {
+      int children = 0;
+      for (int j = i + 1; j < next; j = json_tok_next(doc, j)) children++;
+      CHECK_EQ(children, t[i].type == JSON_TOK_OBJECT ? 2 * t[i].size : t[i].size);
+    }
+
+    double d;
+    int n;
+    bool b;
+    const char *raw;
+    size_t raw_len;
+    char copy[64];
+    (void)json_tok_number(doc, i, &d);
+    (void)json_tok_int(doc, i, &n);
+    (void)json_tok_bool(doc, i, &b);
+    int copied = json_tok_str_copy(doc, i, copy, sizeof(copy));
+    CHECK(copied < (int)sizeof(copy));
+    if (copied >= 0) CHECK_EQ(strlen(copy), copied);
+    CHECK(json_tok_raw(doc, i, &raw, &raw_len));
+    CHECK(raw >= doc->js && raw + raw_len <= doc->js + len);
+    (void)json_tok_get(doc, i, "ok");
+    (void)json_tok_at(doc, i, 0);
+    (void)json_tok_at(doc, i, 1000);
+  }
+}
+
+static int parse_checked(const char *js, size_t len, int max) {
+  json_tok_t toks[kMaxToks];
+  json_doc_t doc;
+  int r = json_tok_parse(&doc, js, len, toks, max);
+  CHECK(valid_result(r));
+  if (r >= 0) CHECK_EQ(doc.count, r);
+  if (r >= 0 || r == JSON_TOK_ERR_NOMEM) {
+    check_doc(&doc, len, r >= 0);
+  } else {
+    CHECK_EQ(doc.count, 0);
+  }
+  (void)json_tok_ok(js, len);
+  return r;
+}
+
+static void test_corpus(void) {
+  for (const char *js : kCorpus) {
+    size_t len = strlen(js);
+    int full = parse_checked(js, len, kMaxToks);
+    CHECK(full > 0);
+    // Every token budget below the document's: truncated, never corrupt.
+    for (int max = 0; max < full; ++max) CHECK_EQ(parse_checked(js, len, max), JSON_TOK_ERR_NOMEM);
+    // Every strict prefix is JSON cut short (trailing spaces aside).
+    size_t body = len;
+    while (body > 0 && js[body - 1] == ' ') body--;
+    for (size_t cut = 0; cut < body; ++cut) {
+      std::string prefix(js, cut);
+      CHECK_EQ(parse_checked(prefix.c_str(), cut, kMaxToks), JSON_TOK_ERR_PART);
+    }
+  }
+}
+
+static void test_values(void) {
+  json_tok_t toks[kMaxToks];
+  json_doc_t doc;
+  const char *reply = kCorpus[5];
+  CHECK(json_tok_parse(&doc, reply, strlen(reply), toks, kMaxToks) > 0);
+  int msg = json_tok_get(&doc, json_tok_at(&doc, json_tok_get(&doc, 0, "choices"), 0), "message");
+  char content[64];
+  CHECK(json_tok_str_copy(&doc, json_tok_get(&doc, msg, "content"), content, sizeof(content)) > 0);
+  CHECK_STR(content, "I see a cup \xe2\x80\x94 \"red\", on the left.\n\xf0\x9f\x98\x80");
+  int total = 0;
+  CHECK(json_tok_int(&doc, json_tok_get(&doc, json_tok_get(&doc, 0, "usage"), "total_tokens"), &total));
+  CHECK_EQ(total, 829);
+
+  const char *event = kCorpus[3];
+  CHECK(json_tok_parse(&doc, event, strlen(event), toks, kMaxToks) > 0);
+  int dets = json_tok_get(&doc, 0, "d");
+  int w = 0;
+  CHECK(json_tok_int(&doc, json_tok_at(&doc, json_tok_get(&doc, json_tok_at(&doc, dets, 1), "b"), 3), &w));
+  CHECK_EQ(w, 52);
+  CHECK_EQ(json_tok_at(&doc, dets, 2), -1);
+
+  // A lookup stays inside its object: keys after it belong to the parent.
+  const char *nested = "{\"a\":{\"x\":1,\"y\":\"s\"},\"b\":2,\"c\":[true,{}]}";
+  CHECK(json_tok_parse(&doc, nested, strlen(nested), toks, kMaxToks) > 0);
+  int a = json_tok_get(&doc, 0, "a");
+  CHECK_EQ(doc.toks[0].size, 3);
+  CHECK_EQ(doc.toks[a].size, 2);
+  CHECK(json_tok_get(&doc, a, "y") > a);
+  CHECK_EQ(json_tok_get(&doc, a, "b"), -1);
+  CHECK_EQ(json_tok_get(&doc, a, "c"), -1);
+  CHECK_EQ(doc.toks[json_tok_get(&doc, 0, "c")].size, 2);
+  int b = 0;
+  CHECK(json_tok_int(&doc, json_tok_get(&doc, 0, "b"), &b));
+  CHECK_EQ(b, 2);
+
+  CHECK(json_tok_ok(kCorpus[0], strlen(kCorpus[0])));
+  CHECK(!json_tok_ok(kCorpus[1], strlen(kCorpus[1])));
+  CHECK(json_tok_ok(kCorpus[2], strlen(kCorpus[2]) - 1) == false);  // cut short
+}
+
+static void test_malformed(void) {
+  static const char *const kBad[] = {
+    "", " ", "{", "}", "[1,]", "{\"a\"}", "{\"a\":}", "{\"a\":1,}", "{,}", "[1 2]", "{\"a\" 1}",
+    "{1:2}", "\"\\x\"", "\"\\u12G4\"", "\"a\nb\"", "tru", "nul", "truex",
+    "[[[[[[[[[[[[[[[[[[1]]]]]]]]]]]]]]]]]", "{\"a\":1}}", "[1]]", "\"unterminated",
+    "{\"a\":\"\\", "{\"a\":\"\\u00", "[1,2", "1 2",
+  };
+  for (const char *js : kBad) {
+    if (parse_checked(js, strlen(js), kMaxToks) >= 0) {
+      fprintf(stderr, "accepted: %s\n", js);
+      s_check_failures++;
+    }
+  }
+  // Numbers are only checked for their characters ("-" and "01" pass); strtod reads what it can.
+  // Depth limit: 16 levels parse, 17 do not.
+  std::string deep(JSON_TOK_MAX_DEPTH, '[');
+  deep += std::string(JSON_TOK_MAX_DEPTH, ']');
+  CHECK(parse_checked(deep.c_str(), deep.size(), kMaxToks) == JSON_TOK_MAX_DEPTH);
+  deep = "[" + deep + "]";
+  CHECK_EQ(parse_checked(deep.c_str(), deep.size(), kMaxToks), JSON_TOK_ERR_INVAL);
+  // Longer than a token offset can address.
+  std::string huge = "[\"" + std::string(JSON_TOK_MAX_LEN, 'a') + "\"]";
+  CHECK_EQ(parse_checked(huge.c_str(), huge.size(), kMaxToks), JSON_TOK_ERR_INVAL);
+  // Stops at a NUL inside len.
+  CHECK_EQ(parse_checked("[1]\0garbage", 11, kMaxToks), 2);
+}
+
+// Random edits of corpus documents: flips, JSON-significant inserts, deletions, cuts and
+// duplicated spans. Only the invariants are checked; any result code is acceptable.
+static void test_mutations(void) {
+  static const char kAlphabet[] = "{}[]:,\"\\u0123456789.eE+-tfnrl \t\n\x01\xff";
+  srand(41);
+  int parsed = 0;
+  for (int round = 0; round < 60000; ++round) {
+    std::string js = kCorpus[rand() % (sizeof(kCorpus) / sizeof(kCorpus[0]))];
+    int edits = 1 + rand() % 4;
+    for (int e = 0; e < edits && !js.empty(); ++e) {
+      size_t at = (size_t)rand() % js.size();
+      switch (rand() % 5) {
+        case 0: js[at] = (char)(js[at] ^ (1 << (rand() % 8))); break;
+        case 1: js.insert(at, 1, kAlphabet[rand() % (sizeof(kAlphabet) - 1)]); break;
+        case 2: js.erase(at, 1 + rand() % 3); break;
+        case 3: js.resize(at); break;
+        default: js.insert(at, js.substr(at, 1 + rand() % 12)); break;
+      }
+    }
+    int max = rand() % 3 == 0 ? 1 + rand() % 16 : kMaxToks;
+    // Exactly sized heap copy, without a terminator: reading past len is an ASan error.
+    char *buf = (char *)malloc(js.size() + 1);
+    memcpy(buf, js.data(), js.size());
+    parsed += parse_checked(buf, js.size(), max) >= 0;
+    free(buf);
+  }
+  CHECK(parsed > 0);  // some mutations are still JSON
+}
+
+static void test_unescape(void) {
+  char out[32];
+  CHECK_EQ(json_tok_unescape(out, sizeof(out), "a\\n\\t\\\"\\\\\\/b", 12), 7);
+  CHECK_STR(out, "a\n\t\"\\/b");
+  CHECK_EQ(json_tok_unescape(out, sizeof(out), "\\u00e9\\u20ac", 12), 5);
+  CHECK_STR(out, "\xc3\xa9\xe2\x82\xac");
+  CHECK_EQ(json_tok_unescape(out, 3, "\\u20ac", 6), 0);  // a character that does not fit is dropped
+  CHECK_EQ(json_tok_unescape(out, 4, "abcdef", 6), 3);
+  CHECK_STR(out, "abc");
+  // In place, as the stream parser does it.
+  char inplace[] = "x\\u0041\\ud83d\\ude00y";
+  CHECK_EQ(json_tok_unescape(inplace, sizeof(inplace), inplace, strlen(inplace)), 7);
+  CHECK_STR(inplace, "xA\xf0\x9f\x98\x80y");
+}
+
+int main(void) {
+  test_corpus();
+  test_values();
+  test_malformed();
+  test_mutations();
+  test_unescape();
+  return check_result("test_json_tok");
+}
@@ -0,0 +1,91 @@
+// Model tier health (model_health): the p95 window behind the hedge delay, the circuit
+// breaker's open/half-open cycle, and which tier a round and its hedge go to.
+
+#include "check.h"
+#include "model_health.h"
+
+static const int64_t kSecond = 1000 * 1000;
+
+static void test_p95_and_hedge_delay(void) {
+  model_health_t h = {};
+  CHECK_EQ(model_health_hedge_delay_ms(&h), 6000);  // cold: no samples
+  for (int i = 0; i < 4; ++i) model_health_ok(&h, 2000);
+  CHECK_EQ(h.p95_ms, 2000);
+  CHECK_EQ(model_health_hedge_delay_ms(&h), 6000);  // still fewer than 5
+  model_health_ok(&h, 2500);
+  CHECK_EQ(model_health_hedge_delay_ms(&h), 2500);
+
+  // 1..20 s: p95 of 20 samples is the 19th smallest.
+  h = {};
+  for (uint32_t ms = 20000; ms >= 1000; ms -= 1000) model_health_ok(&h, ms);
+  CHECK_EQ(h.sample_count, 20);
+  CHECK_EQ(h.p95_ms, 19000);
+
+  // The window keeps the last 32: old slow answers age out.
+  for (int i = 0; i < MODEL_HEALTH_SAMPLES; ++i) model_health_ok(&h, 800);
+  CHECK_EQ(h.sample_count, MODEL_HEALTH_SAMPLES);
+  CHECK_EQ(h.p95_ms, 800);
+  CHECK_EQ(model_health_hedge_delay_ms(&h), 1500);  // floor
+  model_health_ok(&h, 9000);
+  model_health_ok(&h, 9000);
+  CHECK_EQ(h.p95_ms, 9000);  // 2 of 32 above the 95th percentile rank (31st)
+  model_health_ok(&h, 100000);
+  CHECK_EQ(h.ttft_ms[(h.sample_next + MODEL_HEALTH_SAMPLES - 1) % MODEL_HEALTH_SAMPLES], UINT16_MAX);
+}
+
+static void test_breaker(void) {
+  model_health_t h = {};
+  int64_t t = 100 * kSecond;
+  CHECK(model_health_usable(&h, t));
+  CHECK(!model_health_failed(&h, t));
+  CHECK(!model_health_failed(&h, t));
+  model_health_ok(&h, 1000);  // a success in between resets the count
+  CHECK(!model_health_failed(&h, t));
+  CHECK(!model_health_failed(&h, t));
+  CHECK(model_health_usable(&h, t));
+  CHECK(model_health_failed(&h, t));  // third in a row
+  CHECK(!model_health_usable(&h, t));
+  CHECK(!model_health_usable(&h, t + 30 * kSecond - 1));
+  CHECK(model_health_usable(&h, t + 30 * kSecond));  // half-open: one round may try
+
+  // The trial fails: open again for another 30 s from then.
+  t += 30 * kSecond;
+  CHECK(model_health_failed(&h, t));
+  CHECK(!model_health_usable(&h, t + 29 * kSecond));
+  CHECK(model_health_usable(&h, t + 30 * kSecond));
+  // The trial succeeds: closed, and the count starts over.
+  model_health_ok(&h, 1000);
+  CHECK(model_health_usable(&h, t));
+  CHECK(!model_health_failed(&h, t));
+
+  // A long outage never wraps the failure count back to "healthy".
+  h = {};
+  for (int i = 0; i < 300; ++i) CHECK(model_health_failed(&h, t) == (i >= 2));
+}
+
+static void test_pick(void) {
+  model_health_t a = {}, b = {}, c = {};
+  const model_health_t *tiers[] = {&a, &b, &c};
+  int64_t t = 10 * kSecond;
+  CHECK_EQ(model_health_pick(tiers, 0, -1, t), -1);
+  CHECK_EQ(model_health_pick(tiers, 3, -1, t), 0);
+  CHECK_EQ(model_health_pick(tiers, 3, 0, t), 1);  // hedge: next tier
+  CHECK_EQ(model_health_pick(tiers, 1, 0, t), -1);  // single model: no hedge
+
+  for (int i = 0; i < 3; ++i) model_health_failed(&a, t);
+  CHECK_EQ(model_health_pick(tiers, 3, -1, t), 1);  // primary skipped while open
+  CHECK_EQ(model_health_pick(tiers, 3, 1, t), 2);
+  for (int i = 0; i < 3; ++i) model_health_failed(&c, t);
+  CHECK_EQ(model_health_pick(tiers, 3, 1, t), -1);
+  for (int i = 0; i < 3; ++i) model_health_failed(&b, t);
+  CHECK_EQ(model_health_pick(tiers, 3, -1, t), 0);  // all open: try the primary anyway
+  CHECK_EQ(model_health_pick(tiers, 3, 0, t), -1);
+  CHECK_EQ(model_health_pick(tiers, 3, -1, t + 30 * kSecond), 0);
+}
+
+int main(void) {
+  test_p95_and_hedge_delay();
+  test_breaker();
+  test_pick();
+  return check_result("test_model_health");
+}
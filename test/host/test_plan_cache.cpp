@@ -0,0 +1,216 @@
+// Plan cache (plan_cache): keying, the confidence and revalidation rules, LRU eviction, the
+// TTL on the powered-on clock, and the table's round trip through a fake NVS across reboots.
+
+#include "check.h"
+#include "nvs.h"
+#include "plan_cache.h"
+
+static const uint32_t kTtlS = 3 * 24 * 3600;
+
+static intent_plan_t plan_of(const char *command) {
+  intent_plan_t plan = {};
+  CHECK(intent_parse(command, &plan));
+  return plan;
+}
+
+static bool same_plan(const intent_plan_t *a, const intent_plan_t *b) {
+  char x[128], y[128];
+  return intent_describe(a, x, sizeof(x)) >= 0 && intent_describe(b, y, sizeof(y)) >= 0 &&
+         strcmp(x, y) == 0;
+}
+
+static bool hit(uint32_t key, uint32_t uptime_s) {
+  intent_plan_t plan;
+  char reply[PLAN_CACHE_REPLY_MAX];
+  return plan_cache_lookup(key, uptime_s, &plan, reply, sizeof(reply));
+}
+
+static uint32_t entries(void) {
+  plan_cache_stats_t st;
+  plan_cache_stats(&st);
+  return st.entries;
+}
+
+static void test_key(void) {
+  uint32_t k = plan_cache_key("drive forward 2 seconds", 0);
+  CHECK(k != 0);
+  CHECK_EQ(plan_cache_key("  Drive FORWARD 2 seconds!", 0), k);
+  CHECK_EQ(plan_cache_key("drive forward 2seconds", 0), k);
+  CHECK(plan_cache_key("drive forward 3 seconds", 0) != k);
+  CHECK(plan_cache_key("drive forward 2 seconds", PLAN_STATE_GRIPPER_OPEN) != k);
+  CHECK_EQ(plan_cache_key("", 0), 0);
+  CHECK_EQ(plan_cache_key("?!", 0), 0);
+  static char too_long[INTENT_PROMPT_MAX * 4];
+  memset(too_long, 'a', sizeof(too_long) - 1);
+  CHECK_EQ(plan_cache_key(too_long, 0), 0);
+}
+
+static void test_confidence(void) {
+  fake_nvs_reset();
+  plan_cache_init();
+  CHECK_EQ(entries(), 0);
+  uint32_t k = plan_cache_key("dance a little", 0);
+  intent_plan_t a = plan_of("forward 1 second then back 1 second");
+  intent_plan_t b = plan_of("turn left 90");
+
+  CHECK(!hit(k, 10));
+  plan_cache_store(k, 10, &a, "Dancing!");
+  CHECK_EQ(entries(), 1);
+  CHECK(!hit(k, 11));  // the LLM chose it once: not yet
+  plan_cache_store(k, 12, &a, "Dancing again!");
+  intent_plan_t got;
+  char reply[PLAN_CACHE_REPLY_MAX];
+  CHECK(plan_cache_lookup(k, 13, &got, reply, sizeof(reply)));
+  CHECK(same_plan(&got, &a));
+  CHECK_STR(reply, "Dancing again!");
+  char small[5];
+  CHECK(plan_cache_lookup(k, 13, &got, small, sizeof(small)));
+  CHECK_STR(small, "Danc");
+
+  // A different plan for the same prompt starts over.
+  plan_cache_store(k, 14, &b, "Turning.");
+  CHECK(!hit(k, 15));
+  plan_cache_store(k, 16, &b, "Turning.");
+  CHECK(plan_cache_lookup(k, 17, &got, reply, sizeof(reply)));
+  CHECK(same_plan(&got, &b));
+  CHECK_EQ(entries(), 1);
+
+  // After 20 replays the LLM is asked again; its answer re-arms the entry.
+  int replays = 1;
+  while (hit(k, 18)) replays++;
+  CHECK_EQ(replays, 20);
+  plan_cache_store(k, 19, &b, "Turning.");
+  CHECK(hit(k, 20));
+
+  plan_cache_invalidate(k);
+  CHECK(!hit(k, 21));
+  CHECK_EQ(entries(), 0);
+
+  // Not cacheable: empty plans, a zero key, replies that would not fit.
+  intent_plan_t empty = {};
+  plan_cache_store(k, 22, &empty, "");
+  plan_cache_store(0, 22, &a, "");
+  char long_reply[PLAN_CACHE_REPLY_MAX + 1];
+  memset(long_reply, 'x', PLAN_CACHE_REPLY_MAX);
+  long_reply[PLAN_CACHE_REPLY_MAX] = '\0';
+  plan_cache_store(k, 22, &a, long_reply);
+  CHECK_EQ(entries(), 0);
+}
+
+static void test_ttl(void) {
+  fake_nvs_reset();
+  plan_cache_init();
+  uint32_t k = plan_cache_key("wiggle", 0);
+  intent_plan_t a = plan_of("left 1 second then right 1 second");
+  plan_cache_store(k, 100, &a, "");
+  plan_cache_store(k, 100, &a, "");
+  CHECK(hit(k, 100 + kTtlS));
+  CHECK(!hit(k, 100 + kTtlS + 1));
+  CHECK(hit(k, 50));  // clock behind the stamp (e.g. after a reset): still fresh
+  // Confirming the plan again restarts its age.
+  plan_cache_store(k, 100 + kTtlS + 1, &a, "");
+  CHECK(hit(k, 100 + 2 * kTtlS));
+}
+
+static void test_lru(void) {
+  fake_nvs_reset();
+  plan_cache_init();
+  plan_cache_stats_t before, after;
+  plan_cache_stats(&before);
+  intent_plan_t a = plan_of("forward 1 second");
+  uint32_t keys[PLAN_CACHE_ENTRIES + 1];
+  for (int i = 0; i <= PLAN_CACHE_ENTRIES; ++i) {
+    char prompt[32];
+    snprintf(prompt, sizeof(prompt), "prompt number %d", i);
+    keys[i] = plan_cache_key(prompt, 0);
+  }
+  for (int i = 0; i < PLAN_CACHE_ENTRIES; ++i) {
+    plan_cache_store(keys[i], 1, &a, "");
+    plan_cache_store(keys[i], 1, &a, "");
+  }
+  CHECK_EQ(entries(), PLAN_CACHE_ENTRIES);
+  CHECK(hit(keys[0], 2));  // the oldest store is now the most recently used
+
+  plan_cache_store(keys[PLAN_CACHE_ENTRIES], 3, &a, "");
+  plan_cache_stats(&after);
+  CHECK_EQ(after.evictions - before.evictions, 1);
+  CHECK_EQ(entries(), PLAN_CACHE_ENTRIES);
+  CHECK(hit(keys[0], 4));
+  CHECK(!hit(keys[1], 4));  // least recently used: evicted
+  for (int i = 2; i < PLAN_CACHE_ENTRIES; ++i) CHECK(hit(keys[i], 4));
+
+  // An invalidated slot is reused before anything else is evicted.
+  plan_cache_invalidate(keys[5]);
+  plan_cache_store(keys[1], 5, &a, "");
+  plan_cache_stats(&before);
+  CHECK_EQ(before.evictions, after.evictions);
+  CHECK(hit(keys[0], 6));
+}
+
+static void test_nvs(void) {
+  fake_nvs_reset();
+  plan_cache_init();
+  CHECK_EQ(plan_cache_flush(0), ESP_OK);
+  CHECK_EQ(fake_nvs_writes(), 0);  // nothing changed: no flash write
+
+  uint32_t k = plan_cache_key("shake your head", 0);
+  intent_plan_t a = plan_of("turn left 30 then turn right 30");
+  plan_cache_store(k, 10, &a, "Shaking.");
+  plan_cache_store(k, 10, &a, "Shaking.");
+  CHECK(hit(k, 11));  // hits are not a reason to write
+  CHECK_EQ(plan_cache_flush(100), ESP_OK);
+  CHECK_EQ(fake_nvs_writes(), 1);
+  CHECK(fake_nvs_blob("plan_cache", "table", NULL) > 0);
+  CHECK_EQ(plan_cache_flush(200), ESP_OK);
+  CHECK_EQ(fake_nvs_writes(), 1);
+
+  // Reboot: the table comes back and the clock resumes from the flush (100 s on).
+  plan_cache_init();
+  CHECK_EQ(entries(), 1);
+  intent_plan_t got;
+  char reply[PLAN_CACHE_REPLY_MAX];
+  CHECK(plan_cache_lookup(k, 0, &got, reply, sizeof(reply)));
+  CHECK(same_plan(&got, &a));
+  CHECK_STR(reply, "Shaking.");
+  CHECK(hit(k, 10 + kTtlS - 100));
+  CHECK(!hit(k, 10 + kTtlS - 100 + 1));
+
+  // A failed write keeps the table dirty for the next flush.
+  plan_cache_invalidate(k);
+  fake_nvs_fail_open(ESP_ERR_NVS_NOT_FOUND);
+  CHECK(plan_cache_flush(5) != ESP_OK);
+  fake_nvs_fail_open(ESP_OK);
+  CHECK_EQ(plan_cache_flush(6), ESP_OK);
+  CHECK_EQ(fake_nvs_writes(), 2);
+  plan_cache_init();
+  CHECK_EQ(entries(), 0);
+
+  // A blob from another format or size is ignored, not misread.
+  plan_cache_store(k, 1, &a, "");
+  CHECK_EQ(plan_cache_flush(1), ESP_OK);
+  uint8_t *blob = NULL;
+  size_t size = fake_nvs_blob("plan_cache", "table", &blob);
+  CHECK(size > 4 && blob != NULL);
+  blob[0] ^= 0xFF;  // format word
+  plan_cache_init();
+  CHECK_EQ(entries(), 0);
+
+  fake_nvs_reset();
+  plan_cache_store(k, 1, &a, "");
+  CHECK_EQ(plan_cache_flush(1), ESP_OK);
+  nvs_handle_t nvs;
+  CHECK_EQ(nvs_open("plan_cache", NVS_READWRITE, &nvs), ESP_OK);
+  CHECK_EQ(nvs_set_blob(nvs, "table", "short", 5), ESP_OK);
+  nvs_close(nvs);
+  plan_cache_init();
+  CHECK_EQ(entries(), 0);
+}
+
+int main(void) {
+  test_key();
+  test_confidence();
+  test_ttl();
+  test_lru();
+  test_nvs();
+  return check_result("test_plan_cache");
+}
@@ -0,0 +1,103 @@
+// Adaptive timeouts (rto): the initial deadline, the first sample, RFC 6298 smoothing, the
+// quarter-mean floor on the margin, backoff doubling up to max_ms, and the min/max clamps.
+
+#include "check.h"
+#include "rto.h"
+
+static void test_initial(void) {
+  rto_est_t e;
+  rto_init(&e, 3000, 500, 20000);
+  CHECK_EQ(rto_timeout_ms(&e), 3000);
+  CHECK_EQ(e.samples, 0);
+  rto_init(&e, 100, 500, 20000);
+  CHECK_EQ(rto_timeout_ms(&e), 500);  // initial below min
+  rto_init(&e, 90000, 500, 20000);
+  CHECK_EQ(rto_timeout_ms(&e), 20000);  // and above max
+}
+
+static void test_samples(void) {
+  rto_est_t e;
+  rto_init(&e, 3000, 100, 60000);
+  // First sample: srtt = R, rttvar = R/2, timeout = R + 4 * R/2.
+  rto_sample(&e, 400);
+  CHECK_EQ(e.srtt_ms, 400);
+  CHECK_EQ(e.rttvar_ms, 200);
+  CHECK_EQ(rto_timeout_ms(&e), 1200);
+
+  // Then rttvar = 3/4 rttvar + 1/4 |srtt - R|, srtt = 7/8 srtt + 1/8 R.
+  rto_sample(&e, 800);
+  CHECK_EQ(e.rttvar_ms, (3 * 200 + 400) / 4);
+  CHECK_EQ(e.srtt_ms, (7 * 400 + 800) / 8);
+  CHECK_EQ(rto_timeout_ms(&e), 450 + 4 * 250);
+  rto_sample(&e, 100);
+  CHECK_EQ(e.rttvar_ms, (3 * 250 + 350) / 4);
+  CHECK_EQ(e.srtt_ms, (7 * 450 + 100) / 8);
+  CHECK_EQ(e.samples, 3);
+
+  // A steady operation: the deviation decays, the margin stays at a quarter of the mean.
+  rto_init(&e, 3000, 100, 60000);
+  for (int i = 0; i < 200; ++i) rto_sample(&e, 2000);
+  CHECK_EQ(e.srtt_ms, 2000);
+  CHECK_EQ(e.rttvar_ms, 0);
+  CHECK_EQ(rto_timeout_ms(&e), 2500);
+
+  // Converges on a new level after a shift.
+  for (int i = 0; i < 200; ++i) rto_sample(&e, 400);
+  CHECK(e.srtt_ms >= 400 && e.srtt_ms <= 407);  // integer smoothing stops just short
+  CHECK(rto_timeout_ms(&e) >= 500 && rto_timeout_ms(&e) <= 520);
+}
+
+static void test_clamps(void) {
+  rto_est_t e;
+  rto_init(&e, 3000, 1500, 8000);
+  rto_sample(&e, 10);
+  CHECK_EQ(rto_timeout_ms(&e), 1500);
+  rto_sample(&e, 60000);
+  CHECK_EQ(rto_timeout_ms(&e), 8000);
+  rto_init(&e, 3000, 0, 8000);
+  rto_sample(&e, 0);
+  CHECK_EQ(rto_timeout_ms(&e), 0);  // a zero min allows a zero deadline
+}
+
+static void test_backoff(void) {
+  rto_est_t e;
+  rto_init(&e, 1000, 200, 12000);
+  // Before any sample the initial timeout doubles.
+  rto_timed_out(&e);
+  CHECK_EQ(rto_timeout_ms(&e), 2000);
+  rto_timed_out(&e);
+  CHECK_EQ(rto_timeout_ms(&e), 4000);
+  rto_timed_out(&e);
+  CHECK_EQ(rto_timeout_ms(&e), 8000);
+  rto_timed_out(&e);
+  CHECK_EQ(rto_timeout_ms(&e), 12000);  // 16000 capped at max
+  for (int i = 0; i < 100; ++i) rto_timed_out(&e);
+  CHECK_EQ(rto_timeout_ms(&e), 12000);
+  CHECK_EQ(e.timeouts, 104);
+  CHECK_EQ(e.backoff, 4);  // the doublings stop counting, so a large max cannot overflow
+
+  // A completed operation ends the backoff; the doubling applies after the min clamp.
+  rto_sample(&e, 100);
+  CHECK_EQ(e.backoff, 0);
+  CHECK_EQ(rto_timeout_ms(&e), 300);
+  rto_timed_out(&e);
+  CHECK_EQ(rto_timeout_ms(&e), 600);
+  rto_init(&e, 1000, 200, 60000);
+  rto_sample(&e, 20);
+  rto_timed_out(&e);
+  CHECK_EQ(rto_timeout_ms(&e), 400);
+
+  // The longest deadline a backoff can reach stays in range for the 64-bit intermediate.
+  rto_init(&e, 3000, 100, UINT32_MAX);
+  rto_sample(&e, 1000000000);
+  for (int i = 0; i < 10; ++i) rto_timed_out(&e);
+  CHECK_EQ(rto_timeout_ms(&e), UINT32_MAX);
+}
+
+int main(void) {
+  test_initial();
+  test_samples();
+  test_clamps();
+  test_backoff();
+  return check_result("test_rto");
+}
@@ -0,0 +1,129 @@
+// Scene diff (scene_delta): IoU matching, a same-label detection far away counted as moved,
+// the width ratio for closer/farther, face prefixes, "unchanged", and output that does not fit.
+
+#include <initializer_list>
+
+#include "check.h"
+#include "scene_delta.h"
+
+static vision_det_t det(const char *label, int x, int y, int w, int h,
+                        uint8_t kind = VISION_DET_OBJECT) {
+  vision_det_t d = {};
+  strlcpy(d.label, label, sizeof(d.label));
+  d.kind = kind;
+  d.score = 80;
+  d.x = (int16_t)x;
+  d.y = (int16_t)y;
+  d.w = (int16_t)w;
+  d.h = (int16_t)h;
+  return d;
+}
+
+static vision_world_t world(std::initializer_list<vision_det_t> dets) {
+  vision_world_t w = {};
+  for (const vision_det_t &d : dets) w.dets[w.count++] = d;
+  return w;
+}
+
+static void test_iou(void) {
+  vision_det_t a = det("cup", 0, 0, 10, 10);
+  vision_det_t b = det("cup", 5, 0, 10, 10);
+  CHECK(scene_delta_iou(&a, &a) == 1.0f);
+  CHECK(scene_delta_iou(&a, &b) == 50.0f / 150.0f);
+  vision_det_t touching = det("cup", 10, 0, 10, 10);
+  CHECK(scene_delta_iou(&a, &touching) == 0.0f);
+  vision_det_t empty = det("cup", 0, 0, 0, 0);
+  CHECK(scene_delta_iou(&empty, &empty) == 0.0f);
+}
+
+static void test_unchanged(void) {
+  char out[128];
+  scene_delta_counts_t c;
+  vision_world_t none = world({});
+  CHECK_EQ(scene_delta_describe(&none, &none, out, sizeof(out), &c), 9);
+  CHECK_STR(out, "unchanged");
+  CHECK_EQ(c.kept, 0);
+
+  // Small jitter: the same box within 24 px and a 1.25 width ratio.
+  vision_world_t prev =
+      world({det("cup", 100, 50, 40, 40), det("alice", 10, 10, 60, 60, VISION_DET_FACE)});
+  vision_world_t cur =
+      world({det("alice", 14, 8, 62, 60, VISION_DET_FACE), det("Cup", 110, 52, 44, 40)});
+  CHECK_EQ(scene_delta_describe(&prev, &cur, out, sizeof(out), &c), 9);
+  CHECK_STR(out, "unchanged");
+  CHECK_EQ(c.kept, 2);
+  CHECK_EQ(c.added + c.removed + c.moved, 0);
+  CHECK_EQ(scene_delta_describe(&prev, &cur, out, 9, NULL), -1);  // no room for the terminator
+}
+
+static void test_changes(void) {
+  char out[160];
+  scene_delta_counts_t c;
+  // cup stays, a person leaves, a bottle and a face arrive.
+  vision_world_t prev = world({det("cup", 100, 50, 40, 40), det("person", 200, 0, 80, 200)});
+  vision_world_t cur = world({det("cup", 102, 50, 40, 40), det("bottle", 10, 60, 20, 60),
+                              det("bob", 150, 20, 50, 50, VISION_DET_FACE)});
+  CHECK(scene_delta_describe(&prev, &cur, out, sizeof(out), &c) > 0);
+  CHECK_STR(out, "new: bottle x20 w20, face:bob x175 w50; gone: person");
+  CHECK_EQ(c.added, 2);
+  CHECK_EQ(c.removed, 1);
+  CHECK_EQ(c.kept, 1);
+
+  // Same label far away with no overlap: moved, not gone plus new.
+  prev = world({det("cup", 0, 50, 40, 40)});
+  cur = world({det("cup", 200, 50, 40, 40)});
+  CHECK(scene_delta_describe(&prev, &cur, out, sizeof(out), &c) > 0);
+  CHECK_STR(out, "moved: cup x220 w40");
+  CHECK_EQ(c.moved, 1);
+  CHECK_EQ(c.added + c.removed, 0);
+
+  // Same centre, width up by more than 1.25 (came closer) or down (went away): moved.
+  prev = world({det("cup", 100, 50, 40, 40), det("ball", 200, 50, 40, 40)});
+  cur = world({det("cup", 90, 40, 60, 60), det("ball", 204, 54, 32, 32)});
+  CHECK(scene_delta_describe(&prev, &cur, out, sizeof(out), &c) > 0);
+  CHECK_STR(out, "moved: cup x120 w60");
+  CHECK_EQ(c.moved, 1);
+  CHECK_EQ(c.kept, 1);  // 32/40 = 0.8 is the edge, still in place
+  cur.dets[1].w = 31;
+  CHECK(scene_delta_describe(&prev, &cur, out, sizeof(out), &c) > 0);
+  CHECK_STR(out, "moved: cup x120 w60, ball x219 w31");
+
+  // A face and an object with the same label are different things.
+  prev = world({det("alice", 0, 0, 40, 40, VISION_DET_FACE)});
+  cur = world({det("alice", 0, 0, 40, 40)});
+  CHECK(scene_delta_describe(&prev, &cur, out, sizeof(out), &c) > 0);
+  CHECK_STR(out, "new: alice x20 w40; gone: face:alice");
+
+  // Two cups: each continues the one it overlaps, not the first by index.
+  prev = world({det("cup", 0, 0, 40, 40), det("cup", 200, 0, 40, 40)});
+  cur = world({det("cup", 204, 0, 40, 40), det("cup", 4, 0, 40, 40)});
+  CHECK_EQ(scene_delta_describe(&prev, &cur, out, sizeof(out), &c), 9);
+  CHECK_EQ(c.kept, 2);
+}
+
+static void test_overflow(void) {
+  vision_world_t prev = world({});
+  vision_world_t cur = {};
+  for (int i = 0; i < VISION_WORLD_MAX_DETS; ++i) {
+    cur.dets[cur.count++] = det("longlabelname12", 10 * i, 0, 100, 100);
+  }
+  char out[512];
+  int full = scene_delta_describe(&prev, &cur, out, sizeof(out), NULL);
+  CHECK(full > 0);
+  CHECK_EQ(strlen(out), full);
+  for (size_t size = 1; size <= (size_t)full; ++size) {
+    scene_delta_counts_t c;
+    CHECK_EQ(scene_delta_describe(&prev, &cur, out, size, &c), -1);
+    CHECK_EQ(c.added, VISION_WORLD_MAX_DETS);  // counted even when the text does not fit
+  }
+  CHECK_EQ(scene_delta_describe(&prev, &cur, out, (size_t)full + 1, NULL), full);
+  CHECK_EQ(scene_delta_describe(&prev, &cur, out, 0, NULL), -1);
+}
+
+int main(void) {
+  test_iou();
+  test_unchanged();
+  test_changes();
+  test_overflow();
+  return check_result("test_scene_delta");
+}
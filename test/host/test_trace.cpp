@@ -0,0 +1,133 @@
+// Latency spans (trace): the "span" log record each span emits, the per-phase aggregates and
+// their histogram percentiles in the /metrics JSON, and spans ending on several threads.
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "esp_timer.h"
+#include "logger_json.h"
+#include "trace.h"
+
+static std::vector<std::string> s_lines;
+
+static void capture(const char *json_line, void *ctx) {
+  (void)ctx;
+  s_lines.push_back(json_line);
+}
+
+static bool contains(const std::string &s, const char *part) {
+  return s.find(part) != std::string::npos;
+}
+
+// The phase's object in the metrics JSON, e.g. {"n":3,...}.
+static const char *phase_json(const char *phase) {
+  static char json[2048];
+  static std::string obj;
+  CHECK(trace_metrics_json(json, sizeof(json)) > 0);
+  std::string all = json;
+  size_t at = all.find(std::string("\"") + phase + "\":{");
+  obj.clear();
+  if (at != std::string::npos) {
+    at = all.find('{', at);
+    obj = all.substr(at, all.find('}', at) - at + 1);
+  }
+  return obj.c_str();
+}
+
+static void span_ms(trace_phase_t phase, const char *name, int64_t us, esp_err_t err) {
+  trace_span_t span = trace_begin(phase, name);
+  fake_timer_advance_us(us);
+  trace_end(&span, err);
+}
+
+static void test_span_record(void) {
+  fake_timer_set_us(1000000);
+  trace_turn_set(42);
+  CHECK_EQ(trace_turn(), 42);
+  trace_span_t span = trace_begin(TRACE_TOOL, "vision_scan");
+  trace_turn_set(0);  // the span keeps the turn it began in
+  fake_timer_advance_us(12499);
+  s_lines.clear();
+  CHECK_EQ(trace_end(&span, ESP_OK), 12);
+  CHECK_EQ(s_lines.size(), 1);
+  const std::string &line = s_lines[0];
+  CHECK(contains(line, "\"event\":\"span\""));
+  CHECK(contains(line, "\"component\":\"trace\""));
+  CHECK(contains(line, "\"turn\":42"));
+  CHECK(contains(line, "\"phase\":\"tool\""));
+  CHECK(contains(line, "\"name\":\"vision_scan\""));
+  CHECK(contains(line, "\"ms\":12"));
+  CHECK(contains(line, "\"err\":\"ok\""));
+
+  // A start taken earlier, an error, no name; a clock that went backwards counts as 0 ms.
+  span = trace_begin_at(TRACE_UART, NULL, esp_timer_get_time() - 500);
+  s_lines.clear();
+  CHECK_EQ(trace_end(&span, ESP_ERR_TIMEOUT), 1);
+  CHECK(contains(s_lines[0], "\"name\":\"\""));
+  CHECK(contains(s_lines[0], "\"err\":\"ESP_ERR_TIMEOUT\""));
+  span = trace_begin_at(TRACE_UART, "SCAN", esp_timer_get_time() + 5000);
+  CHECK_EQ(trace_end(&span, ESP_OK), 0);
+}
+
+static void test_aggregates(void) {
+  CHECK_STR(phase_json("connect"),
+            "{\"n\":0,\"err\":0,\"avg_ms\":0,\"p50_ms\":0,\"p95_ms\":0,\"max_ms\":0}");
+  // 18 fast spans in the <=64 ms bucket, one at 700 ms and one failed 5 s one.
+  for (int i = 0; i < 18; ++i) span_ms(TRACE_CONNECT, "openrouter.ai", 40000, ESP_OK);
+  span_ms(TRACE_CONNECT, "openrouter.ai", 700000, ESP_OK);
+  span_ms(TRACE_CONNECT, "openrouter.ai", 5000000, ESP_FAIL);
+  // avg (18*40 + 700 + 5000) / 20 = 321; p50 -> 64 bucket; p95 (19th) -> 1024 bucket;
+  // the last bucket is open-ended and reports the max.
+  CHECK_STR(phase_json("connect"),
+            "{\"n\":20,\"err\":1,\"avg_ms\":321,\"p50_ms\":64,\"p95_ms\":1024,\"max_ms\":5000}");
+
+  // Bucket bounds are capped at the observed max.
+  span_ms(TRACE_ACTION, "move", 3000, ESP_OK);
+  CHECK_STR(phase_json("action"),
+            "{\"n\":1,\"err\":0,\"avg_ms\":3,\"p50_ms\":3,\"p95_ms\":3,\"max_ms\":3}");
+  span_ms(TRACE_VISION_MODEL, "gpt", 0, ESP_OK);
+  CHECK_STR(phase_json("vision_model"),
+            "{\"n\":1,\"err\":0,\"avg_ms\":0,\"p50_ms\":0,\"p95_ms\":0,\"max_ms\":0}");
+}
+
+static void test_metrics_size(void) {
+  char json[2048];
+  int n = trace_metrics_json(json, sizeof(json));
+  CHECK(n > 0);
+  CHECK_EQ(strlen(json), n);
+  CHECK(json[0] == '{' && json[n - 1] == '}');
+  CHECK(contains(json, "\"turn\":{") && contains(json, "\"vision_model\":{"));
+  CHECK_EQ(trace_metrics_json(json, (size_t)n), -1);  // no room for the terminator
+  CHECK_EQ(trace_metrics_json(json, (size_t)n + 1), n);
+  CHECK_EQ(trace_metrics_json(json, 16), -1);
+}
+
+static void test_threads(void) {
+  static const int kThreads = 4;
+  static const int kSpans = 5000;
+  rover_log_set_sink(NULL, NULL);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([t] {
+      for (int i = 0; i < kSpans; ++i) {
+        trace_span_t span = trace_begin_at(TRACE_FIRST_BYTE, "model", esp_timer_get_time() - 1000 * (t + 1));
+        trace_end(&span, i % 10 == 0 ? ESP_FAIL : ESP_OK);
+      }
+    });
+  }
+  for (std::thread &t : threads) t.join();
+  // Every span counted once; the max is the slowest thread's.
+  CHECK_STR(phase_json("first_byte"),
+            "{\"n\":20000,\"err\":2000,\"avg_ms\":2,\"p50_ms\":2,\"p95_ms\":4,\"max_ms\":4}");
+}
+
+int main(void) {
+  rover_log_set_sink(capture, NULL);
+  test_span_record();
+  test_aggregates();
+  test_metrics_size();
+  test_threads();
+  return check_result("test_trace");
+}
@@ -0,0 +1,125 @@
+// Per-turn arena (turn_arena): stack-like reuse of freed blocks, alignment, the malloc
+// fallbacks (outside a turn, on another task, when full), and what a closed turn reports.
+
+#include <stdlib.h>
+#include <thread>
+
+#include "check.h"
+#include "turn_arena.h"
+
+static const size_t kCapacity = 1024;
+static const size_t kHeader = 8;
+
+static uint8_t *s_base;  // the block the arena reserved, found from its first allocation
+
+static bool in_arena(const void *p) {
+  return (const uint8_t *)p >= s_base && (const uint8_t *)p < s_base + kCapacity;
+}
+
+static turn_arena_stats_t stats(void) {
+  turn_arena_stats_t st;
+  turn_arena_stats(&st);
+  return st;
+}
+
+static void test_before_init(void) {
+  // No block yet: everything is plain malloc, inside a turn or not.
+  turn_arena_begin();
+  void *p = turn_arena_malloc(16);
+  CHECK(p != NULL);
+  turn_arena_free(p);
+  turn_arena_end();
+  CHECK_EQ(stats().allocs, 0);
+}
+
+static void test_stack(void) {
+  CHECK(turn_arena_init(kCapacity + 5));
+  CHECK_EQ(stats().capacity, kCapacity);  // rounded down to the alignment
+
+  void *outside = turn_arena_malloc(32);  // no turn open
+  turn_arena_begin();
+  uint8_t *a = (uint8_t *)turn_arena_malloc(1);
+  s_base = a - kHeader;
+  CHECK(!in_arena(outside));
+  free(outside);
+
+  uint8_t *b = (uint8_t *)turn_arena_malloc(13);
+  uint8_t *c = (uint8_t *)turn_arena_malloc(8);
+  CHECK_EQ((uintptr_t)a % 8, 0);
+  CHECK_EQ((uintptr_t)b % 8, 0);
+  CHECK_EQ(b - a, 16);  // 8-byte header + 1 byte, rounded up
+  CHECK_EQ(c - b, 24);
+  memset(b, 0xEE, 13);
+
+  // Freed out of order: nothing is reclaimed until the top goes, then all of it.
+  turn_arena_free(b);
+  CHECK((uint8_t *)turn_arena_malloc(8) == c + 16);
+  turn_arena_free(c + 16);
+  turn_arena_free(c);
+  CHECK((uint8_t *)turn_arena_malloc(8) == b);  // b and c reclaimed together
+
+  // Parse/delete pairs in a loop never grow the arena.
+  for (int i = 0; i < 1000; ++i) {
+    char *s = turn_arena_strdup("{\"tool\":\"move\",\"args\":{\"y\":60}}");
+    CHECK(in_arena(s));
+    CHECK_STR(s, "{\"tool\":\"move\",\"args\":{\"y\":60}}");
+    turn_arena_free(s);
+  }
+  turn_arena_end();
+  turn_arena_stats_t st = stats();
+  CHECK_EQ(st.allocs, 1005);
+  CHECK_EQ(st.overflows, 0);
+  CHECK_EQ(st.peak, 16 + 24 + 16 + 16);  // a, b, c and the block above c; the strdups reach 72 too
+  CHECK_EQ(st.leaked, 16 + 16);  // a and the last 8-byte block were never freed
+
+  // A new turn starts from the bottom again; freeing a block of a closed turn is harmless.
+  turn_arena_free(a);
+  turn_arena_begin();
+  CHECK((uint8_t *)turn_arena_malloc(100) == a);
+  turn_arena_end();
+}
+
+static void test_overflow(void) {
+  turn_arena_begin();
+  void *big = turn_arena_malloc(kCapacity - kHeader);  // exactly the whole block
+  CHECK(in_arena(big));
+  void *more = turn_arena_malloc(1);
+  CHECK(more != NULL && !in_arena(more));
+  turn_arena_free(more);  // went to malloc: goes back to free
+  turn_arena_free(big);
+  CHECK(turn_arena_malloc(SIZE_MAX) == NULL);  // the size never wraps into an arena block
+  CHECK(turn_arena_malloc(SIZE_MAX - 4) == NULL);
+  void *again = turn_arena_malloc(kCapacity);  // header does not fit alongside
+  CHECK(again != NULL && !in_arena(again));
+  free(again);
+  turn_arena_end();
+  turn_arena_stats_t st = stats();
+  CHECK_EQ(st.overflows, 4);
+  CHECK_EQ(st.peak, kCapacity);
+  CHECK_EQ(st.leaked, 0);
+}
+
+static void test_other_task(void) {
+  turn_arena_begin();
+  void *mine = turn_arena_malloc(64);
+  CHECK(in_arena(mine));
+  void *theirs = NULL;
+  std::thread other([&] {
+    theirs = turn_arena_malloc(64);  // not the turn's task: heap
+    turn_arena_free(mine);           // ignored: only the owner pops the stack
+  });
+  other.join();
+  CHECK(theirs != NULL && !in_arena(theirs));
+  turn_arena_free(theirs);
+  CHECK((uint8_t *)turn_arena_malloc(8) == (uint8_t *)mine + 72);  // mine still in place
+  turn_arena_end();
+  CHECK_EQ(stats().allocs, 2);
+}
+
+int main(void) {
+  test_before_init();
+  test_stack();
+  test_overflow();
+  test_other_task();
+  return check_result("test_turn_arena");
+}
@@ -0,0 +1,232 @@
+// COBS/CRC16 framing of the UnitV link (vision_frame): codec edge cases, then frames written
+// to one end of a pseudo-terminal in raw mode and decoded byte by byte from the other, as the
+// ESP32 reads its UART, including corrupted, truncated and runaway frames in between.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "check.h"
+#include "vision_frame.h"
+
+static void test_crc(void) {
+  const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  CHECK_EQ(vision_crc16(check, sizeof(check)), 0x29B1);  // CRC-16/CCITT-FALSE check value
+  CHECK_EQ(vision_crc16(check, 0), 0xFFFF);
+}
+
+static void cobs_round_trip(const uint8_t *src, size_t len) {
+  uint8_t enc[VISION_FRAME_WIRE_MAX];
+  uint8_t dec[VISION_FRAME_RAW_MAX];
+  size_t n = vision_cobs_encode(src, len, enc, sizeof(enc));
+  CHECK(n > 0);
+  CHECK(memchr(enc, 0, n) == NULL);
+  CHECK(n <= len + len / 254 + 1);
+  size_t m = vision_cobs_decode(enc, n, dec, sizeof(dec));
+  CHECK_EQ(m, len);
+  CHECK(memcmp(dec, src, len) == 0);
+}
+
+static void test_cobs(void) {
+  uint8_t buf[VISION_FRAME_RAW_MAX] = {};
+  cobs_round_trip(buf, 0);
+  buf[0] = 0;
+  cobs_round_trip(buf, 1);
+  memset(buf, 0, 4);
+  cobs_round_trip(buf, 4);
+  // Around the 254-byte run where a code byte is 0xFF and no zero follows.
+  static const size_t kRuns[] = {253, 254, 255, 508, 509};
+  for (size_t len : kRuns) {
+    memset(buf, 0x55, len);
+    cobs_round_trip(buf, len);
+    buf[len - 1] = 0;
+    cobs_round_trip(buf, len);
+  }
+  srand(27);
+  for (int round = 0; round < 200; ++round) {
+    size_t len = (size_t)rand() % sizeof(buf);
+    for (size_t i = 0; i < len; ++i) buf[i] = (uint8_t)(rand() % 4 == 0 ? 0 : rand());
+    cobs_round_trip(buf, len);
+  }
+
+  uint8_t enc[8];
+  memset(buf, 1, 16);
+  CHECK_EQ(vision_cobs_encode(buf, 16, enc, sizeof(enc)), 0);  // does not fit
+  const uint8_t bad[] = {0x03, 0x11, 0x00, 0x22};
+  CHECK_EQ(vision_cobs_decode(bad, sizeof(bad), buf, sizeof(buf)), 0);
+  const uint8_t short_run[] = {0x05, 0x11, 0x22};
+  CHECK_EQ(vision_cobs_decode(short_run, sizeof(short_run), buf, sizeof(buf)), 0);
+}
+
+static void test_encode_limits(void) {
+  static uint8_t payload[VISION_FRAME_PAYLOAD_MAX + 1];
+  uint8_t out[VISION_FRAME_WIRE_MAX];
+  vision_frame_t f = {VISION_FRAME_DATA, 0, 1, 0, 1, payload, VISION_FRAME_PAYLOAD_MAX};
+  CHECK(vision_frame_encode(&f, out, sizeof(out)) > 0);
+  f.len = VISION_FRAME_PAYLOAD_MAX + 1;
+  CHECK_EQ(vision_frame_encode(&f, out, sizeof(out)), 0);
+  f.len = 4;
+  f.payload = NULL;
+  CHECK_EQ(vision_frame_encode(&f, out, sizeof(out)), 0);
+  f.payload = payload;
+  CHECK_EQ(vision_frame_encode(&f, out, 8), 0);
+}
+
+// ── Through a pty ──
+
+typedef struct {
+  int master;
+  int slave;
+} pty_t;
+
+static bool pty_open(pty_t *p) {
+  p->master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (p->master < 0 || grantpt(p->master) != 0 || unlockpt(p->master) != 0) return false;
+  p->slave = open(ptsname(p->master), O_RDWR | O_NOCTTY);
+  if (p->slave < 0) return false;
+  // Raw 8-bit line both ways, like the UART: no echo, no CR/LF mapping, no flow control.
+  const int fds[] = {p->master, p->slave};
+  for (int fd : fds) {
+    struct termios t;
+    if (tcgetattr(fd, &t) != 0) return false;
+    cfmakeraw(&t);
+    if (tcsetattr(fd, TCSANOW, &t) != 0) return false;
+  }
+  return true;
+}
+
+static void pty_close(pty_t *p) {
+  close(p->slave);
+  close(p->master);
+}
+
+static void pty_write(const pty_t *p, const uint8_t *data, size_t len) {
+  while (len > 0) {
+    ssize_t n = write(p->master, data, len);
+    if (n <= 0) {
+      CHECK(n > 0);
+      return;
+    }
+    data += n;
+    len -= (size_t)n;
+  }
+}
+
+// Reads from the slave and feeds the decoder until it reports something other than
+// NEED_MORE, or the line stays quiet for 500 ms (returns NEED_MORE then).
+static vision_frame_status_t pty_read_frame(const pty_t *p, vision_frame_decoder_t *dec,
+                                            vision_frame_t *out) {
+  static uint8_t pending[4096];
+  static size_t pending_len = 0, pending_at = 0;
+  while (1) {
+    while (pending_at < pending_len) {
+      vision_frame_status_t st = vision_frame_decoder_push(dec, pending[pending_at++], out);
+      if (st != VISION_FRAME_NEED_MORE) return st;
+    }
+    struct pollfd pfd = {p->slave, POLLIN, 0};
+    if (poll(&pfd, 1, 500) <= 0) return VISION_FRAME_NEED_MORE;
+    ssize_t n = read(p->slave, pending, sizeof(pending));
+    if (n <= 0) return VISION_FRAME_NEED_MORE;
+    pending_len = (size_t)n;
+    pending_at = 0;
+  }
+}
+
+static size_t encode(uint8_t type, uint16_t req_id, uint16_t seq, uint16_t total, const uint8_t *payload,
+                     uint16_t len, uint8_t *out) {
+  vision_frame_t f = {type, 0, req_id, seq, total, payload, len};
+  size_t n = vision_frame_encode(&f, out, VISION_FRAME_WIRE_MAX);
+  CHECK(n > 0);
+  return n;
+}
+
+static void expect_frame(const pty_t *p, vision_frame_decoder_t *dec, uint8_t type, uint16_t req_id,
+                         uint16_t seq, const uint8_t *payload, uint16_t len) {
+  vision_frame_t got = {};
+  CHECK_EQ(pty_read_frame(p, dec, &got), VISION_FRAME_OK);
+  CHECK_EQ(got.type, type);
+  CHECK_EQ(got.req_id, req_id);
+  CHECK_EQ(got.seq, seq);
+  CHECK_EQ(got.len, len);
+  CHECK(got.len != len || memcmp(got.payload, payload, len) == 0);
+}
+
+static void test_pty_round_trip(void) {
+  pty_t p;
+  if (!pty_open(&p)) {
+    fprintf(stderr, "no pty available\n");
+    s_check_failures++;
+    return;
+  }
+  vision_frame_decoder_t dec;
+  vision_frame_decoder_reset(&dec);
+  static uint8_t wire[VISION_FRAME_WIRE_MAX];
+
+  // A JSON reply and a CAPTURE in chunks of binary data full of zeros.
+  const char *json = "{\"ok\":true,\"req_id\":\"17\",\"result\":{\"faces\":[]}}";
+  size_t n = encode(VISION_FRAME_JSON, 17, 0, 1, (const uint8_t *)json, (uint16_t)strlen(json), wire);
+  pty_write(&p, wire, n);
+  expect_frame(&p, &dec, VISION_FRAME_JSON, 17, 0, (const uint8_t *)json, (uint16_t)strlen(json));
+
+  static uint8_t jpeg[3000];
+  for (size_t i = 0; i < sizeof(jpeg); ++i) jpeg[i] = (uint8_t)(i % 7 == 0 ? 0 : i * 31);
+  const uint16_t chunk = VISION_FRAME_PAYLOAD_MAX;
+  const uint16_t total = (uint16_t)((sizeof(jpeg) + chunk - 1) / chunk);
+  for (uint16_t seq = 0; seq < total; ++seq) {
+    uint16_t len = (uint16_t)(sizeof(jpeg) - seq * chunk < chunk ? sizeof(jpeg) - seq * chunk : chunk);
+    n = encode(VISION_FRAME_DATA, 18, seq, total, jpeg + seq * chunk, len, wire);
+    pty_write(&p, wire, n);
+    expect_frame(&p, &dec, VISION_FRAME_DATA, 18, seq, jpeg + seq * chunk, len);
+  }
+
+  // One flipped bit: rejected, and the next frame decodes at once.
+  n = encode(VISION_FRAME_DATA, 19, 0, 2, jpeg, 200, wire);
+  wire[n / 2] ^= 0x04;
+  if (wire[n / 2] == 0) wire[n / 2] = 0x01;  // keep the delimiters where they are
+  pty_write(&p, wire, n);
+  vision_frame_t got = {};
+  vision_frame_status_t st = pty_read_frame(&p, &dec, &got);
+  CHECK(st == VISION_FRAME_BAD_CRC || st == VISION_FRAME_MALFORMED);
+  n = encode(VISION_FRAME_DATA, 19, 1, 2, jpeg + 200, 200, wire);
+  pty_write(&p, wire, n);
+  expect_frame(&p, &dec, VISION_FRAME_DATA, 19, 1, jpeg + 200, 200);
+
+  // A byte lost on the wire: the same.
+  n = encode(VISION_FRAME_EVENT, 20, 1, 0, (const uint8_t *)json, (uint16_t)strlen(json), wire);
+  memmove(wire + 10, wire + 11, n - 11);
+  pty_write(&p, wire, n - 1);
+  st = pty_read_frame(&p, &dec, &got);
+  CHECK(st == VISION_FRAME_BAD_CRC || st == VISION_FRAME_MALFORMED);
+  n = encode(VISION_FRAME_EVENT, 20, 2, 0, (const uint8_t *)json, (uint16_t)strlen(json), wire);
+  pty_write(&p, wire, n);
+  expect_frame(&p, &dec, VISION_FRAME_EVENT, 20, 2, (const uint8_t *)json, (uint16_t)strlen(json));
+
+  // Line noise longer than any frame: reported as an overflow at the next delimiter.
+  static uint8_t noise[VISION_FRAME_WIRE_MAX + 100];
+  memset(noise, 0xA5, sizeof(noise));
+  pty_write(&p, noise, sizeof(noise));
+  n = encode(VISION_FRAME_JSON, 21, 0, 1, (const uint8_t *)json, (uint16_t)strlen(json), wire);
+  pty_write(&p, wire, n);
+  CHECK_EQ(pty_read_frame(&p, &dec, &got), VISION_FRAME_OVERFLOW);
+  // The overflow used the new frame's opening delimiter; its body still arrives intact.
+  expect_frame(&p, &dec, VISION_FRAME_JSON, 21, 0, (const uint8_t *)json, (uint16_t)strlen(json));
+
+  // Back-to-back delimiters between frames are ignored.
+  const uint8_t idle[] = {0, 0, 0};
+  pty_write(&p, idle, sizeof(idle));
+  n = encode(VISION_FRAME_JSON, 22, 0, 1, NULL, 0, wire);
+  pty_write(&p, wire, n);
+  expect_frame(&p, &dec, VISION_FRAME_JSON, 22, 0, NULL, 0);
+
+  pty_close(&p);
+}
+
+int main(void) {
+  test_crc();
+  test_cobs();
+  test_encode_limits();
+  test_pty_round_trip();
+  return check_result("test_vision_frame");
+}
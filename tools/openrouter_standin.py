@@ -0,0 +1,289 @@
+#!/usr/bin/env python3
+"""Local stand-in for OpenRouter's chat completions endpoint, for testing the rover's AI
+client without the internet: TLS with keep-alive and session tickets, SSE streaming, and
+per-model knobs for latency and failures.
+
+    python3 tools/openrouter_standin.py --cert standin.pem --key standin.key [--port 8443]
+
+Prints "listening <port>" once it accepts connections, then reads commands from stdin (one
+per line, each answered with one line on stdout):
+
+    set <model> [delay_ms=N] [first_byte_ms=N] [status=N] [drop=0|1] [reply=TEXT...]
+        delay_ms       wait before the response headers
+        first_byte_ms  wait after the headers (and an SSE comment) before the first data line
+        status         answer with this HTTP status and a JSON error instead of a stream
+        drop           close the connection after reading the request, without an answer
+        reply          streamed text, one chunk per word; takes the rest of the line
+    close_idle    quietly close every kept-alive connection once it waits for a request (no TLS
+                  close_notify), like a server or NAT timing it out; answers "ok <count>"
+    stats         one JSON line: connections, resumed (session tickets), heads, and per model
+                  requests, aborted (client closed before the stream ended) and last_ms (arrival
+                  of its latest request, ms since start)
+    reset         forget knobs and counters
+    quit
+
+Knobs apply to requests that arrive after the command. HEAD requests get an empty 200.
+"""
+
+import argparse
+import json
+import select
+import socket
+import ssl
+import sys
+import threading
+import time
+
+_START = time.monotonic()
+_lock = threading.Lock()
+_knobs = {}
+_stats = {}
+_conns = {}  # open connections: socket -> [close_idle asked to close it, closed event]
+
+
+def _now_ms():
+    return int((time.monotonic() - _START) * 1000)
+
+
+def _reset():
+    _knobs.clear()
+    _stats.clear()
+    _stats.update(connections=0, resumed=0, heads=0, requests={}, aborted={}, last_ms={})
+
+
+def _count(key, model):
+    _stats[key][model] = _stats[key].get(model, 0) + 1
+
+
+def _knob(model):
+    k = dict(delay_ms=0, first_byte_ms=0, status=200, drop=0, reply="ok from " + model)
+    k.update(_knobs.get(model, {}))
+    return k
+
+
+class _Closed(Exception):
+    pass
+
+
+def _wait(sock, ms):
+    """Sleeps ms, raising _Closed if the client hangs up meanwhile."""
+    end = time.monotonic() + ms / 1000.0
+    while True:
+        left = end - time.monotonic()
+        if left <= 0:
+            return
+        readable, _, _ = select.select([sock], [], [], left)
+        if readable:
+            try:
+                if not sock.recv(1):
+                    raise _Closed()
+            except (OSError, ssl.SSLError):
+                raise _Closed()
+
+
+def _send(sock, data):
+    try:
+        sock.sendall(data)
+    except (OSError, ssl.SSLError):
+        raise _Closed()
+
+
+def _chunk(sock, text):
+    data = text.encode()
+    _send(sock, b"%x\r\n%s\r\n" % (len(data), data))
+
+
+def _read_request(sock, buf):
+    """Returns (method, headers, body, rest of buf), or None once the client is gone."""
+    while b"\r\n\r\n" not in buf:
+        data = sock.recv(4096)
+        if not data:
+            return None
+        buf += data
+    head, buf = buf.split(b"\r\n\r\n", 1)
+    lines = head.decode("latin-1").split("\r\n")
+    method = lines[0].split(" ")[0]
+    headers = {}
+    for line in lines[1:]:
+        name, _, value = line.partition(":")
+        headers[name.strip().lower()] = value.strip()
+    body = b""
+    if headers.get("transfer-encoding", "").lower() == "chunked":
+        while True:
+            while b"\r\n" not in buf:
+                data = sock.recv(4096)
+                if not data:
+                    return None
+                buf += data
+            size_line, buf = buf.split(b"\r\n", 1)
+            size = int(size_line, 16)
+            while len(buf) < size + 2:
+                data = sock.recv(4096)
+                if not data:
+                    return None
+                buf += data
+            body += buf[:size]
+            buf = buf[size + 2:]
+            if size == 0:
+                break
+    else:
+        length = int(headers.get("content-length", "0"))
+        while len(buf) < length:
+            data = sock.recv(4096)
+            if not data:
+                return None
+            buf += data
+        body, buf = buf[:length], buf[length:]
+    return method, headers, body, buf
+
+
+def _answer(sock, body):
+    try:
+        model = json.loads(body or b"{}").get("model") or "?"
+    except ValueError:
+        model = "?"
+    with _lock:
+        _count("requests", model)
+        _stats["last_ms"][model] = _now_ms()
+        k = _knob(model)
+    if k["drop"]:
+        raise _Closed()
+    try:
+        _wait(sock, k["delay_ms"])
+        if k["status"] != 200:
+            err = json.dumps({"error": {"code": k["status"], "message": "stand-in failure"}}).encode()
+            _send(sock, b"HTTP/1.1 %d Error\r\nContent-Type: application/json\r\n"
+                        b"Content-Length: %d\r\n\r\n%s" % (k["status"], len(err), err))
+            return
+        _send(sock, b"HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+                    b"Transfer-Encoding: chunked\r\n\r\n")
+        _chunk(sock, ": OPENROUTER PROCESSING\n\n")
+        _wait(sock, k["first_byte_ms"])
+        words = k["reply"].split(" ")
+        for i, word in enumerate(words):
+            delta = {"content": word + (" " if i + 1 < len(words) else "")}
+            event = {"object": "chat.completion.chunk", "model": model,
+                     "choices": [{"index": 0, "delta": delta}]}
+            _chunk(sock, "data: " + json.dumps(event) + "\n\n")
+        _chunk(sock, "data: [DONE]\n\n")
+        _send(sock, b"0\r\n\r\n")
+    except _Closed:
+        with _lock:
+            _count("aborted", model)
+        raise
+
+
+def _idle_wait(sock):
+    """Waits for the next request; False once close_idle asked for the connection."""
+    while sock.pending() == 0:
+        if _conns[sock][0]:
+            sock.shutdown(socket.SHUT_RDWR)  # drops the TLS state, no close_notify
+            return False
+        readable, _, _ = select.select([sock], [], [], 0.02)
+        if readable:
+            return True
+    return True
+
+
+def _serve(raw, ctx):
+    try:
+        sock = ctx.wrap_socket(raw, server_side=True)
+    except (OSError, ssl.SSLError):
+        raw.close()
+        return
+    with _lock:
+        _stats["connections"] += 1
+        _stats["resumed"] += int(sock.session_reused)
+        _conns[sock] = [False, threading.Event()]
+    buf = b""
+    try:
+        while buf or _idle_wait(sock):
+            req = _read_request(sock, buf)
+            if req is None:
+                break
+            method, _, body, buf = req
+            if method == "HEAD":
+                with _lock:
+                    _stats["heads"] += 1
+                _send(sock, b"HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n")
+                continue
+            _answer(sock, body)
+    except (_Closed, OSError, ssl.SSLError, ValueError):
+        pass
+    finally:
+        sock.close()
+        with _lock:
+            _conns.pop(sock)[1].set()
+
+
+def _close_idle():
+    """Closes each connection once it waits for a request; returns how many closed."""
+    with _lock:
+        marked = list(_conns.values())
+        for conn in marked:
+            conn[0] = True
+    return sum(1 for conn in marked if conn[1].wait(2.0))
+
+
+def _command(line):
+    line = line.strip()
+    words = line.split()
+    if not words:
+        return None
+    if words[0] == "set" and len(words) >= 2:
+        knobs = {}
+        rest = line.split(None, 2)[2] if len(words) > 2 else ""
+        while rest:
+            key, _, rest = rest.partition("=")
+            key = key.strip()
+            if key == "reply":
+                knobs[key] = rest
+                break
+            value, _, rest = rest.partition(" ")
+            knobs[key] = int(value)
+        with _lock:
+            _knobs.setdefault(words[1], {}).update(knobs)
+        return "ok"
+    if words[0] == "close_idle":
+        return "ok %d" % _close_idle()
+    if words[0] == "stats":
+        with _lock:
+            return json.dumps(_stats, sort_keys=True)
+    if words[0] == "reset":
+        with _lock:
+            _reset()
+        return "ok"
+    return "error: unknown command"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--cert", required=True, help="PEM certificate (chain) to serve")
+    parser.add_argument("--key", required=True, help="PEM private key")
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8443, help="0: pick a free one")
+    args = parser.parse_args()
+
+    ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    ctx.load_cert_chain(args.cert, args.key)
+    listener = socket.create_server((args.host, args.port))
+    _reset()
+
+    def accept():
+        while True:
+            raw, _ = listener.accept()
+            raw.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            threading.Thread(target=_serve, args=(raw, ctx), daemon=True).start()
+
+    threading.Thread(target=accept, daemon=True).start()
+    print("listening %d" % listener.getsockname()[1], flush=True)
+    for line in sys.stdin:
+        if line.strip() == "quit":
+            break
+        reply = _command(line)
+        if reply is not None:
+            print(reply, flush=True)
+
+
+if __name__ == "__main__":
+    main()